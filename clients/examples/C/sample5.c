@@ -0,0 +1,101 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+/* fetch a result set in binary form into column buffers */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <mapi.h>
+
+#define die(dbh,hdl)	do {						\
+				if (hdl)				\
+					mapi_explain_result(hdl,stderr); \
+				else if (dbh)				\
+					mapi_explain(dbh,stderr);	\
+				else					\
+					fprintf(stderr,"command failed\n"); \
+				exit(-1);				\
+			} while (0)
+
+#define NROWS 1000
+
+int
+main(int argc, char **argv)
+{
+	Mapi dbh;
+	MapiHdl hdl = NULL;
+	int32_t ids[NROWS];
+	int64_t amounts[NROWS];
+	char names[NROWS * 16];
+	size_t offsets[NROWS];
+	MapiColumnBuffer cols[3] = {
+		{ .data = ids, .size = sizeof(ids) },
+		{ .data = amounts, .size = sizeof(amounts) },
+		{ .data = names, .size = sizeof(names), .offsets = offsets },
+	};
+	int64_t rows;
+
+	if (argc != 4) {
+		fprintf(stderr, "usage:%s <host> <port> <language>\n", argv[0]);
+		exit(-1);
+	}
+
+	dbh = mapi_connect(argv[1], atoi(argv[2]), "monetdb", "monetdb", argv[3], NULL);
+	if (dbh == NULL || mapi_error(dbh))
+		die(dbh, hdl);
+
+	mapi_cache_limit(dbh, 10);
+	if (mapi_set_size_header(dbh, true) != MOK)
+		die(dbh, hdl);
+	if ((hdl = mapi_query(dbh, "select cast(value as int) as id, cast(case when value % 10 = 0 then null else value * 100 end as decimal(12,2)) as amount, 'n' || value as name from generate_series(0, 1000)")) == NULL || mapi_error(dbh))
+		die(dbh, hdl);
+	if (mapi_get_binary_width(hdl, 0) != 4 || mapi_get_binary_width(hdl, 1) != 8 || mapi_get_binary_width(hdl, 2) != 0)
+		fprintf(stderr, "unexpected widths %d %d %d\n", mapi_get_binary_width(hdl, 0), mapi_get_binary_width(hdl, 1), mapi_get_binary_width(hdl, 2));
+
+	rows = mapi_fetch_columns(hdl, 0, -1, cols);
+	if (rows < 0)
+		die(dbh, hdl);
+	if (rows != NROWS)
+		fprintf(stderr, "rows received %" PRId64 "\n", rows);
+	for (int i = 0; i < rows; i++) {
+		char name[16];
+
+		snprintf(name, sizeof(name), "n%d", i);
+		if (ids[i] != i)
+			fprintf(stderr, "unexpected id %d in row %d\n", ids[i], i);
+		if (i % 10 == 0 ? amounts[i] != INT64_MIN : amounts[i] != (int64_t) i * 10000)
+			fprintf(stderr, "unexpected amount %" PRId64 " in row %d\n", amounts[i], i);
+		if (strcmp(names + offsets[i], name) != 0)
+			fprintf(stderr, "unexpected name %s in row %d\n", names + offsets[i], i);
+	}
+
+	/* a chunk from the middle, skipping a column */
+	cols[1].data = NULL;
+	rows = mapi_fetch_columns(hdl, 995, 10, cols);
+	if (rows < 0)
+		die(dbh, hdl);
+	if (rows != 5 || ids[0] != 995 || ids[4] != 999 || strcmp(names + offsets[4], "n999") != 0)
+		fprintf(stderr, "unexpected chunk of %" PRId64 " rows\n", rows);
+
+	/* the text interface still works */
+	if (mapi_fetch_row(hdl) != 3 || strcmp(mapi_fetch_field(hdl, 2), "n0") != 0)
+		fprintf(stderr, "unexpected text row\n");
+
+	if (mapi_close_handle(hdl) != MOK)
+		die(dbh, hdl);
+	mapi_destroy(dbh);
+
+	return 0;
+}
@@ -2321,7 +2321,7 @@ dump_function(Mapi mid, stream *sqlf, const char *fid, bool hashge)
 					 "s.name, "
 					 "f.name, "
 					 "ft.function_type_keyword, "
-					 "fl.language_keyword, "
+					 "fl.language_keyword || CASE WHEN f.mod IN ('pyapi3map', 'capimap') THEN '_MAP' ELSE '' END, "
 		             "c.remark "
 		      "FROM sys.functions f "
 			   "JOIN sys.schemas s ON f.schema_id = s.id "
@@ -581,6 +581,23 @@ mapi_handshake(Mapi mid)
 		}
 	}
 
+	/* the compression methods the server offers, we only ask for one of
+	 * those and do without compression otherwise */
+	const char *method = msetting_string(mid->settings, MP_COMPRESSION_METHOD);
+	bool compression_offered = false;
+	char *compressions = strtok_r(NULL, ":", &strtok_state);
+	if (compressions && strncmp(compressions, "COMPRESSION=", 12) == 0) {
+		char *offered_state = NULL;
+		for (char *m = strtok_r(compressions + 12, ",", &offered_state);
+		     m != NULL;
+		     m = strtok_r(NULL, ",", &offered_state)) {
+			if (strcmp(m, method) == 0) {
+				compression_offered = true;
+				break;
+			}
+		}
+	}
+
 	/* hash password, if not already */
 	if (password[0] != '\1') {
 		char *pwdhash = NULL;
@@ -713,6 +730,18 @@ mapi_handshake(Mapi mid)
 	if (mid->handshake_options > MAPI_HANDSHAKE_TIME_ZONE) {
 		CHECK_SNPRINTF(",time_zone=%ld", msetting_long(mid->settings, MP_TIMEZONE));
 	}
+	if (mid->handshake_options > MAPI_HANDSHAKE_BLOCK_SIZE) {
+		CHECK_SNPRINTF(",block_size=%d", MAX_BLOCK);
+	}
+	bs_compression compression = BS_COMPRESSION_NONE;
+	if (!compression_offered
+	    || mid->handshake_options <= MAPI_HANDSHAKE_COMPRESSION
+	    || !block_stream_compression(method, &compression))
+		compression = BS_COMPRESSION_NONE;
+	long compression_level = msetting_long(mid->settings, MP_COMPRESSION_LEVEL);
+	if (compression != BS_COMPRESSION_NONE) {
+		CHECK_SNPRINTF(",compression=%s,compression_level=%ld", method, compression_level);
+	}
 	if (mid->handshake_options > 0) {
 		CHECK_SNPRINTF(":");
 	}
@@ -860,6 +889,23 @@ mapi_handshake(Mapi mid)
 	if (mid->error != MOK)
 		return mid->error;
 
+	/* the server switched to large blocks after its welcome */
+	if (mid->handshake_options > MAPI_HANDSHAKE_BLOCK_SIZE) {
+		if (block_stream_set_size(mid->to, MAX_BLOCK) < 0 ||
+		    block_stream_set_size(mid->from, MAX_BLOCK) < 0) {
+			mapi_setError(mid, "could not switch to large blocks", __func__, MERROR);
+			close_connection(mid);
+			return mid->error;
+		}
+		mid->blocksize = MAX_BLOCK;
+		if (block_stream_set_compression(mid->to, compression, (int) compression_level) < 0 ||
+		    block_stream_set_compression(mid->from, compression, (int) compression_level) < 0) {
+			mapi_setError(mid, "could not switch on compression", __func__, MERROR);
+			close_connection(mid);
+			return mid->error;
+		}
+	}
+
 	/* use X commands to send options that couldn't be sent in the handshake */
 	/* tell server about auto_complete and cache limit if handshake options weren't used */
 	bool autocommit = msetting_bool(mid->settings, MP_AUTOCOMMIT);
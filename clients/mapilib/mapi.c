@@ -273,12 +273,14 @@
  * @item mapi_explain()	@tab	Display error message and context on stream
  * @item mapi_explain_query()	@tab	Display error message and context on stream
  * @item mapi_fetch_all_rows()	@tab	Fetch all answers from server into cache
+ * @item mapi_fetch_columns()	@tab	Fetch rows in binary form into column buffers
  * @item mapi_fetch_field()	@tab Fetch a field from the current row
  * @item mapi_fetch_field_len()	@tab Fetch the length of a field from the current row
  * @item mapi_fetch_line()	@tab	Retrieve the next line
  * @item mapi_fetch_reset()	@tab	Set the cache reader to the beginning
  * @item mapi_fetch_row()	@tab	Fetch row of values
  * @item mapi_finish()	@tab	Terminate the current query
+ * @item mapi_get_binary_width()	@tab	Width of a column in binary form
  * @item mapi_get_dbname()	@tab	Database being served
  * @item mapi_get_field_count()	@tab Number of fields in current row
  * @item mapi_get_host()	@tab	Host name of server
@@ -499,6 +501,34 @@
  * @code{mapi_fetch_row()} will take the row from the cache. The number or
  * rows cached is returned.
  *
+ * @item int64_t mapi_fetch_columns(MapiHdl hdl, int64_t offset, int64_t nrows, MapiColumnBuffer *cols)
+ *
+ * Fetch at most @code{nrows} rows (all remaining rows if negative) of
+ * the current result set, starting at row @code{offset}, in the binary
+ * format of @code{COPY BINARY}, without going through the text cache.
+ * The array @code{cols} has one entry per field.  Fixed width values
+ * are stored in @code{data} in native byte order,
+ * @code{mapi_get_binary_width()} bytes each, NULL being represented by
+ * the nil value of the type.  For string and blob columns @code{data}
+ * receives the records as sent by the server (zero terminated text
+ * with NULL as "\200", or a 64 bit length followed by the bytes, the
+ * length being all ones for NULL), and @code{offsets} the start of
+ * each row's record.  The number of rows fetched is returned, or a
+ * negative value on error, which can be analyzed using
+ * @code{mapi_error()}.  When @code{data} is too small for a column,
+ * its @code{used} is set to the required size, so that the call can
+ * be repeated with a larger buffer.  The result set must still be open
+ * on the server, which is not the case when all its rows were already
+ * sent with the response to the query, see @code{mapi_cache_limit()}.
+ *
+ * @item int mapi_get_binary_width(MapiHdl hdl, int fnr)
+ *
+ * Return the width in bytes of the values of the field in binary form,
+ * 0 for string and blob fields, or a negative value if the type of the
+ * field can not be fetched in binary form.  The width of decimals is
+ * only known when the size header is enabled with
+ * @code{mapi_set_size_header()}.
+ *
  * @item MapiMsg mapi_seek_row(MapiHdl hdl, int64_t rownr, int whence)
  *
  * Reset the row pointer to the requested row number.  If whence is
@@ -1769,6 +1799,7 @@ const struct MapiStruct MapiStructDefaults = {
 	.redirmax = 10,
 	.blk.eos = false,
 	.blk.lim = BLOCK,
+	.blocksize = BLOCK,
 };
 
 /* Allocate a new connection handle. */
@@ -2693,13 +2724,13 @@ read_line(Mapi mid)
 	while ((nl = strchr(s, '\n')) == NULL && !mid->blk.eos) {
 		ssize_t len;
 
-		if (mid->blk.lim - mid->blk.end < BLOCK) {
+		if (mid->blk.lim - mid->blk.end < (int) mid->blocksize) {
 			int len;
 
 			len = mid->blk.lim;
-			if (mid->blk.nxt <= BLOCK) {
+			if (mid->blk.nxt <= (int) mid->blocksize) {
 				/* extend space */
-				len += BLOCK;
+				len += (int) mid->blocksize;
 			}
 			REALLOC(mid->blk.buf, len + 1);
 			if (mid->blk.nxt > 0) {
@@ -2716,7 +2747,7 @@ read_line(Mapi mid)
 		if (mid->trace)
 			printf("fetch next block: start at:%d\n", mid->blk.end);
 		for (;;) {
-			len = mnstr_read(mid->from, mid->blk.buf + mid->blk.end, 1, BLOCK);
+			len = mnstr_read(mid->from, mid->blk.buf + mid->blk.end, 1, mid->blocksize);
 			if (len == -1 && mnstr_errnr(mid->from) == MNSTR_INTERRUPT) {
 				mnstr_clearerr(mid->from);
 				if (mid->oobintr && !mid->active->aborted) {
@@ -4449,6 +4480,270 @@ mapi_fetch_all_rows(MapiHdl hdl)
 	return result ? result->cache.tuplecount : 0;
 }
 
+/*
+ * Binary fetching of result chunks.  The "exportbin" command returns
+ * a header line with the table id, number of columns, number of rows
+ * and the offset, followed by the columns as dumped by COPY BINARY and
+ * a table of contents holding the start and length of each column and
+ * finally the position of the table of contents itself.
+ */
+static const struct {
+	const char *type;
+	int width;
+} mapi_binary_types[] = {
+	{"boolean", 1},
+	{"tinyint", 1},
+	{"smallint", 2},
+	{"int", 4},
+	{"bigint", 8},
+#ifdef HAVE_HGE
+	{"hugeint", 16},
+#endif
+	{"real", 4},
+	{"double", 8},
+	{"month_interval", 4},
+	{"day_interval", 8},
+	{"sec_interval", 8},
+	{"date", 4},
+	{"time", 8},
+	{"timetz", 8},
+	{"timestamp", 12},
+	{"timestamptz", 12},
+	{"uuid", 16},
+	{"char", 0},
+	{"varchar", 0},
+	{"clob", 0},
+	{"json", 0},
+	{"url", 0},
+	{"blob", 0},
+};
+
+int
+mapi_get_binary_width(MapiHdl hdl, int fnr)
+{
+	struct MapiResultSet *result;
+	const char *type;
+
+	mapi_hdl_check(hdl);
+	if ((result = hdl->result) == NULL || fnr < 0 || fnr >= result->fieldcnt)
+		return mapi_setError(hdl->mid, "Illegal field number", __func__, MERROR);
+	if ((type = result->fields[fnr].columntype) == NULL)
+		return mapi_setError(hdl->mid, "Unknown field type", __func__, MERROR);
+	if (strcmp(type, "decimal") == 0) {
+		int digits = result->fields[fnr].digits;
+		if (digits == 0)
+			return mapi_setError(hdl->mid, "Width of decimal needs the size header", __func__, MERROR);
+		return digits <= 2 ? 1 : digits <= 4 ? 2 : digits <= 9 ? 4 : digits <= 18 ? 8 : 16;
+	}
+	for (size_t i = 0; i < sizeof(mapi_binary_types) / sizeof(mapi_binary_types[0]); i++)
+		if (strcmp(type, mapi_binary_types[i].type) == 0)
+			return mapi_binary_types[i].width;
+	return mapi_printError(hdl->mid, __func__, MERROR, "Type %s can not be fetched in binary form", type);
+}
+
+static void
+mapi_swap_bytes(char *p, int width)
+{
+	for (int i = 0, j = width - 1; i < j; i++, j--) {
+		char c = p[i];
+		p[i] = p[j];
+		p[j] = c;
+	}
+}
+
+/* convert the fixed width values of a column sent by a server with
+ * the other byte order */
+static void
+mapi_swap_column(char *data, int64_t nrows, int width, const char *type)
+{
+	if (strcmp(type, "uuid") == 0 || width == 1)
+		return;
+	for (int64_t i = 0; i < nrows; i++, data += width) {
+		if (strcmp(type, "date") == 0) {
+			mapi_swap_bytes(data + 2, 2);	/* year */
+		} else if (strncmp(type, "timestamp", 9) == 0) {
+			mapi_swap_bytes(data, 4);	/* ms */
+			mapi_swap_bytes(data + 10, 2);	/* year */
+		} else if (strncmp(type, "time", 4) == 0) {
+			mapi_swap_bytes(data, 4);	/* ms */
+		} else {
+			mapi_swap_bytes(data, width);
+		}
+	}
+}
+
+static MapiMsg
+mapi_store_column(MapiHdl hdl, int fnr, const char *src, uint64_t length, int64_t nrows, bool swap, MapiColumnBuffer *col)
+{
+	Mapi mid = hdl->mid;
+	const char *type = hdl->result->fields[fnr].columntype;
+	uint64_t pos = 0;
+	int width;
+
+	if (col->data == NULL)
+		return MOK;		/* not bound, whatever its type */
+	if (type && strcmp(type, "decimal") == 0 && hdl->result->fields[fnr].digits == 0)
+		width = nrows > 0 ? (int) (length / nrows) : 1;	/* no size header, go by the data */
+	else
+		width = mapi_get_binary_width(hdl, fnr);
+
+	if (width < 0)
+		return mid->error;
+	if (width > 0 && length != (uint64_t) nrows * width)
+		return mapi_printError(mid, __func__, MERROR, "Unexpected size of binary column %d", fnr);
+	if (length > col->size) {
+		col->used = length;	/* tell the caller how much to allocate */
+		return mapi_printError(mid, __func__, MERROR, "Buffer of column %d too small, %" PRIu64 " bytes needed", fnr, length);
+	}
+	memcpy(col->data, src, length);
+	col->used = length;
+	if (width > 0) {
+		if (swap)
+			mapi_swap_column(col->data, nrows, width, type);
+		return MOK;
+	}
+	if (col->offsets == NULL)
+		return mapi_printError(mid, __func__, MERROR, "No offsets given for column %d", fnr);
+	bool blob = strcmp(type, "blob") == 0;
+	for (int64_t i = 0; i < nrows; i++) {
+		char *rec = (char *) col->data + pos;
+		uint64_t reclen;
+
+		col->offsets[i] = pos;
+		if (blob) {
+			if (length - pos < sizeof(reclen))
+				return mapi_printError(mid, __func__, MERROR, "Malformed binary column %d", fnr);
+			if (swap)
+				mapi_swap_bytes(rec, sizeof(reclen));
+			memcpy(&reclen, rec, sizeof(reclen));
+			if (reclen == ~(uint64_t) 0)
+				reclen = 0;	/* NULL */
+			if (length - pos - sizeof(reclen) < reclen)
+				return mapi_printError(mid, __func__, MERROR, "Malformed binary column %d", fnr);
+			reclen += sizeof(reclen);
+		} else {
+			char *end = memchr(rec, 0, length - pos);
+
+			if (end == NULL)
+				return mapi_printError(mid, __func__, MERROR, "Malformed binary column %d", fnr);
+			reclen = end - rec + 1;
+		}
+		pos += reclen;
+	}
+	return MOK;
+}
+
+int64_t
+mapi_fetch_columns(MapiHdl hdl, int64_t offset, int64_t nrows, MapiColumnBuffer *cols)
+{
+	Mapi mid;
+	struct MapiResultSet *result;
+	char *buf = NULL;
+	size_t len = 0, size = 0;
+	int tableid, ncols, e;
+	int64_t rows, off;
+	uint64_t tocpos;
+	bool swap;
+
+	mapi_hdl_check(hdl);
+	mid = hdl->mid;
+	if ((result = hdl->result) == NULL || result->querytype != Q_TABLE)
+		return mapi_setError(mid, "No result set", __func__, MERROR);
+	if (offset < 0 || offset > INT_MAX)
+		return mapi_setError(mid, "Illegal row offset", __func__, MERROR);
+	if (nrows < 0 || nrows > INT_MAX)
+		nrows = -1;
+
+	/* finish reading any outstanding text output first */
+	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+		return mid->error;
+
+	mapi_log_record(mid, "SEND", "X" "exportbin %d %d %d\n",
+			     result->tableid, (int) offset, (int) nrows);
+	if ((e = mnstr_printf(mid->to, "X" "exportbin %d %d %d\n",
+			      result->tableid, (int) offset, (int) nrows)) < 0 ||
+	    (e = mnstr_flush(mid->to, MNSTR_FLUSH_DATA)) < 0)
+		check_stream(mid, mid->to, e, "sending exportbin command", mid->error);
+
+	/* the response is read as a whole, the table of contents is at
+	 * the end */
+	for (;;) {
+		ssize_t n;
+
+		if (size - len <= mid->blocksize) {
+			size += size + mid->blocksize + 1;
+			REALLOC(buf, size);
+			if (buf == NULL)
+				return mapi_setError(mid, "Memory allocation failure", __func__, MERROR);
+		}
+		n = mnstr_read(mid->from, buf + len, 1, size - len - 1);
+		check_stream(mid, mid->from, n, "Connection terminated during binary fetch", (free(buf), mid->error));
+		if (n == 0) {
+			if (mnstr_eof(mid->from)) {
+				free(buf);
+				return mapi_setError(mid, "unexpected end of file", __func__, MTIMEOUT);
+			}
+			break;
+		}
+		mapi_log_data(mid, "RECV", buf + len, n);
+		len += n;
+	}
+	buf[len] = 0;
+
+	if (len == 0) {
+		/* the server closes a result set once all rows are sent */
+		free(buf);
+		return mapi_setError(mid, "Result set no longer available on the server", __func__, MERROR);
+	}
+	if (buf[0] != '&') {
+		/* an error message: !SQLSTATE!message */
+		char *msg = buf, *nl;
+
+		if (*msg == '!')
+			msg++;
+		if (strlen(msg) > 6 && msg[5] == '!')
+			msg += 6;
+		if ((nl = strchr(msg, '\n')) != NULL)
+			*nl = 0;
+		e = mapi_setError(mid, msg, __func__, MSERVER);
+		free(buf);
+		return e;
+	}
+	swap = mnstr_get_swapbytes(mid->from);
+	if (sscanf(buf, "&6 %d %d %" SCNd64 " %" SCNd64, &tableid, &ncols, &rows, &off) != 4 ||
+	    tableid != result->tableid || ncols != result->fieldcnt || rows < 0 ||
+	    len < sizeof(tocpos) + (size_t) ncols * 2 * sizeof(uint64_t)) {
+		free(buf);
+		return mapi_setError(mid, "Malformed binary result", __func__, MERROR);
+	}
+	if (swap)
+		mapi_swap_bytes(buf + len - sizeof(tocpos), sizeof(tocpos));
+	memcpy(&tocpos, buf + len - sizeof(tocpos), sizeof(tocpos));
+	if (tocpos != len - sizeof(tocpos) - (size_t) ncols * 2 * sizeof(uint64_t)) {
+		free(buf);
+		return mapi_setError(mid, "Malformed binary result", __func__, MERROR);
+	}
+	for (int i = 0; i < ncols; i++) {
+		uint64_t toc[2];	/* start and length */
+
+		memcpy(toc, buf + tocpos + i * sizeof(toc), sizeof(toc));
+		if (swap) {
+			mapi_swap_bytes((char *) &toc[0], sizeof(toc[0]));
+			mapi_swap_bytes((char *) &toc[1], sizeof(toc[1]));
+		}
+		if (toc[0] > tocpos || toc[1] > tocpos - toc[0]) {
+			free(buf);
+			return mapi_setError(mid, "Malformed binary result", __func__, MERROR);
+		}
+		if (mapi_store_column(hdl, i, buf + toc[0], toc[1], rows, swap, &cols[i]) != MOK) {
+			free(buf);
+			return mid->error;
+		}
+	}
+	free(buf);
+	return rows;
+}
+
 char *
 mapi_fetch_field(MapiHdl hdl, int fnr)
 {
@@ -4814,6 +5109,7 @@ mapi_wrap_streams(Mapi mid, stream *rstream, stream *wstream)
 
 	mid->to = bwstream;
 	mid->from = brstream;
+	mid->blocksize = BLOCK;
 	return MOK;
 bailout:
 	// adapted from the check_stream macro
@@ -38,6 +38,8 @@ enum mapi_handshake_options_levels {
 	MAPI_HANDSHAKE_SIZE_HEADER = 3,
 	MAPI_HANDSHAKE_COLUMNAR_PROTOCOL = 4,
 	MAPI_HANDSHAKE_TIME_ZONE = 5,
+	MAPI_HANDSHAKE_BLOCK_SIZE = 6,
+	MAPI_HANDSHAKE_COMPRESSION = 7,
 	// make sure to insert new option levels before this one.
 	// it is the value sent by the server during the initial handshake.
 	MAPI_HANDSHAKE_OPTIONS_LEVEL,
@@ -54,6 +56,15 @@ typedef struct MapiStruct *Mapi;
 
 typedef struct MapiStatement *MapiHdl;
 
+/* Caller provided storage for one column of a binary result chunk,
+ * see mapi_fetch_columns() */
+typedef struct MapiColumnBuffer {
+	void *data;		/* the values, or NULL to skip the column */
+	size_t size;		/* capacity of data in bytes */
+	size_t used;		/* bytes stored in data, or needed if too small */
+	size_t *offsets;	/* string and blob columns: start of each row */
+} MapiColumnBuffer;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -218,6 +229,10 @@ mapi_export int mapi_fetch_row(MapiHdl hdl)
 	__attribute__((__nonnull__(1)));
 mapi_export int64_t mapi_fetch_all_rows(MapiHdl hdl)
 	__attribute__((__nonnull__(1)));
+mapi_export int64_t mapi_fetch_columns(MapiHdl hdl, int64_t offset, int64_t nrows, MapiColumnBuffer *cols)
+	__attribute__((__nonnull__(1, 4)));
+mapi_export int mapi_get_binary_width(MapiHdl hdl, int fnr)
+	__attribute__((__nonnull__(1)));
 mapi_export int mapi_get_field_count(MapiHdl hdl)
 	__attribute__((__nonnull__(1)));
 mapi_export int64_t mapi_get_row_count(MapiHdl hdl)
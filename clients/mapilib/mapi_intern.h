@@ -248,6 +248,7 @@ struct MapiStruct {
 	bool sizeheader;
 	bool oobintr;
 	bool clientinfo_supported;
+	size_t blocksize;	/* size of the blocks read and written */
 	MapiHdl first;		/* start of doubly-linked list */
 	MapiHdl active;		/* set when not all rows have been received */
 
@@ -89,6 +89,8 @@ by_name[] = {
 	{ .name="client_remark", .parm=MP_CLIENT_REMARK },
 	{ .name="clientcert", .parm=MP_CLIENTCERT },
 	{ .name="clientkey", .parm=MP_CLIENTKEY },
+	{ .name="compression_level", .parm=MP_COMPRESSION_LEVEL },
+	{ .name="compression_method", .parm=MP_COMPRESSION_METHOD },
 	{ .name="connect_timeout", .parm=MP_CONNECT_TIMEOUT },
 	{ .name="database", .parm=MP_DATABASE },
 	{ .name="host", .parm=MP_HOST },
@@ -148,6 +150,8 @@ mparm_name(mparm parm)
 		case MP_CLIENT_REMARK: return "client_remark";
 		case MP_CLIENTCERT: return "clientcert";
 		case MP_CLIENTKEY: return "clientkey";
+		case MP_COMPRESSION_LEVEL: return "compression_level";
+		case MP_COMPRESSION_METHOD: return "compression_method";
 		case MP_CONNECT_TIMEOUT: return "connect_timeout";
 		case MP_DATABASE: return "database";
 		case MP_HOST: return "host";
@@ -207,6 +211,7 @@ struct msettings {
 	long map_to_long_varchar;
 	long connect_timeout;
 	long reply_timeout;
+	long compression_level;
 	long dummy_end_long;
 
 	// Must match EXACTLY the order of enum mparm
@@ -229,6 +234,7 @@ struct msettings {
 	struct string logfile;
 	struct string client_application;
 	struct string client_remark;
+	struct string compression_method;
 	struct string dummy_end_string;
 
 	char **unknown_parameters;
@@ -258,6 +264,7 @@ const msettings msettings_default_values = {
 
 	.sockdir = { "/tmp", false },
 	.binary = { "on", false },
+	.compression_method = { "none", false },
 
 	.unknown_parameters = NULL,
 	.nr_unknown = 0,
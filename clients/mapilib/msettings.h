@@ -59,6 +59,7 @@ typedef enum mparm {
 	MP_MAPTOLONGVARCHAR,   // specific to ODBC
 	MP_CONNECT_TIMEOUT,
 	MP_REPLY_TIMEOUT,
+	MP_COMPRESSION_LEVEL,
 	// Note: if you change anything about this enum whatsoever, make sure to
 	// make the corresponding change to struct msettings in msettings.c as well.
 
@@ -81,6 +82,7 @@ typedef enum mparm {
 	MP_LOGFILE,
 	MP_CLIENT_APPLICATION,
 	MP_CLIENT_REMARK,
+	MP_COMPRESSION_METHOD,
 	// Note: if you change anything about this enum whatsoever, make sure to
 	// make the corresponding change to struct msettings in msettings.c as well.
 
@@ -2881,6 +2881,62 @@ ODBCFetch(ODBCStmt *stmt,
 			buf[bufpos++] = (value)[_i];			\
 	} while (0)
 
+/* the distance between the values of C type ctype in a column-wise
+ * bound array, buflen being the length of variable size values */
+SQLLEN
+ODBCCtypeSize(SQLSMALLINT ctype, SQLLEN buflen)
+{
+	switch (ctype) {
+	case SQL_C_BIT:
+	case SQL_C_TINYINT:
+	case SQL_C_STINYINT:
+	case SQL_C_UTINYINT:
+		return sizeof(unsigned char);
+	case SQL_C_SHORT:
+	case SQL_C_SSHORT:
+	case SQL_C_USHORT:
+		return sizeof(short);
+	case SQL_C_LONG:
+	case SQL_C_SLONG:
+	case SQL_C_ULONG:
+		return sizeof(int);
+	case SQL_C_SBIGINT:
+	case SQL_C_UBIGINT:
+		return sizeof(SQLBIGINT);
+	case SQL_C_FLOAT:
+		return sizeof(float);
+	case SQL_C_DOUBLE:
+		return sizeof(double);
+	case SQL_C_NUMERIC:
+		return sizeof(SQL_NUMERIC_STRUCT);
+	case SQL_C_TYPE_DATE:
+		return sizeof(DATE_STRUCT);
+	case SQL_C_TYPE_TIME:
+		return sizeof(TIME_STRUCT);
+	case SQL_C_TYPE_TIMESTAMP:
+		return sizeof(TIMESTAMP_STRUCT);
+	case SQL_C_GUID:
+		return sizeof(SQLGUID);
+	case SQL_C_INTERVAL_YEAR:
+	case SQL_C_INTERVAL_MONTH:
+	case SQL_C_INTERVAL_YEAR_TO_MONTH:
+	case SQL_C_INTERVAL_DAY:
+	case SQL_C_INTERVAL_HOUR:
+	case SQL_C_INTERVAL_MINUTE:
+	case SQL_C_INTERVAL_SECOND:
+	case SQL_C_INTERVAL_DAY_TO_HOUR:
+	case SQL_C_INTERVAL_DAY_TO_MINUTE:
+	case SQL_C_INTERVAL_DAY_TO_SECOND:
+	case SQL_C_INTERVAL_HOUR_TO_MINUTE:
+	case SQL_C_INTERVAL_HOUR_TO_SECOND:
+	case SQL_C_INTERVAL_MINUTE_TO_SECOND:
+		return sizeof(SQL_INTERVAL_STRUCT);
+	default:
+		/* SQL_C_CHAR, SQL_C_WCHAR, SQL_C_BINARY */
+		return buflen;
+	}
+}
+
 SQLRETURN
 ODBCStore(ODBCStmt *stmt,
 	  SQLUSMALLINT param,
@@ -2919,11 +2975,9 @@ ODBCStore(ODBCStmt *stmt,
 
 	bind_type = stmt->ApplParamDescr->sql_desc_bind_type;
 	ptr = apdrec->sql_desc_data_ptr;
-	if (ptr && offset)
-		ptr = (SQLPOINTER) ((char *) ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLPOINTER) : bind_type));
 	strlen_or_ind_ptr = apdrec->sql_desc_indicator_ptr;
-	if (strlen_or_ind_ptr && offset)
-		strlen_or_ind_ptr = (SQLLEN *) ((char *) strlen_or_ind_ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLINTEGER) : bind_type));
+	if (strlen_or_ind_ptr && (offset || row > 0))
+		strlen_or_ind_ptr = (SQLLEN *) ((char *) strlen_or_ind_ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLLEN) : bind_type));
 	if (ptr == NULL &&
 	    (strlen_or_ind_ptr == NULL || *strlen_or_ind_ptr != SQL_NULL_DATA)) {
 		/* COUNT field incorrect */
@@ -2935,6 +2989,8 @@ ODBCStore(ODBCStmt *stmt,
 	sqltype = ipdrec->sql_desc_concise_type;
 	if (ctype == SQL_C_DEFAULT)
 		ctype = ODBCDefaultType(ipdrec);
+	if (ptr && (offset || row > 0))
+		ptr = (SQLPOINTER) ((char *) ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? ODBCCtypeSize(ctype, apdrec->sql_desc_octet_length) : bind_type));
 
 	switch (ctype) {
 	case SQL_C_TINYINT:
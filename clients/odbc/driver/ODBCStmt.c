@@ -71,6 +71,7 @@ newODBCStmt(ODBCDbc *dbc)
 		.queryid = -1,
 		.nparams = 0,
 		.querytype = -1,
+		.binaryfetch = false,
 		.rowcount = 0,
 
 		.qtimeout = dbc->qtimeout, /* inherit query timeout */
@@ -83,6 +83,7 @@ typedef struct tODBCDRIVERSTMT {
 	int nparams;		/* the number of parameters expected */
 
 	int querytype;		/* query type as returned by server */
+	bool binaryfetch;	/* rowsets can be fetched in binary form */
 
 	SQLULEN qtimeout;	/* query timeout requested */
 
@@ -185,6 +186,7 @@ SQLRETURN ODBCFetch(ODBCStmt *stmt, SQLUSMALLINT col, SQLSMALLINT type,
 SQLRETURN ODBCStore(ODBCStmt *stmt, SQLUSMALLINT param, SQLLEN offset,
 		    SQLULEN row, char **bufp, size_t *bufposp, size_t *buflenp,
 		    const char *sep);
+SQLLEN ODBCCtypeSize(SQLSMALLINT ctype, SQLLEN buflen);
 SQLRETURN ODBCFreeStmt_(ODBCStmt *stmt);
 SQLRETURN ODBCInitResult(ODBCStmt *stmt);
 const char *ODBCGetTypeInfo(int concise_type, int *data_type,
@@ -137,6 +137,7 @@ ODBCInitResult(ODBCStmt *stmt)
 	}
 	nrCols = mapi_get_field_count(hdl);
 	stmt->querytype = mapi_get_querytype(hdl);
+	stmt->binaryfetch = false;
 #if SIZEOF_SIZE_T == SIZEOF_INT
 	if (mapi_rows_affected(hdl) >= (int64_t) 1 << (sizeof(int) * CHAR_BIT)) {
 		/* General error */
@@ -157,6 +158,10 @@ ODBCInitResult(ODBCStmt *stmt)
 		/* result set generating query */
 		assert(nrCols > 0);
 		stmt->State = EXECUTED1;
+		/* only results that didn't fit in the first response
+		 * stay available on the server for binary fetches */
+		stmt->binaryfetch = stmt->Dbc->cachelimit > 0 &&
+			stmt->rowcount > (SQLULEN) stmt->Dbc->cachelimit;
 		break;
 	case Q_UPDATE:		/* Q_UPDATE */
 		/* result count generating query */
@@ -421,6 +426,62 @@ ODBCInitResult(ODBCStmt *stmt)
 	return SQL_ERROR;
 }
 
+/* Collect the results of the statements that were executed for an
+ * array of parameter sets, one for each set that wasn't ignored. */
+static SQLRETURN
+ODBCInitParamResults(ODBCStmt *stmt, SQLULEN nsets, bool more)
+{
+	ODBCDesc *apd = stmt->ApplParamDescr, *ipd = stmt->ImplParamDescr;
+	MapiHdl hdl = stmt->hdl;
+	SQLULEN set, processed = 0, failed = 0;
+	SQLUSMALLINT status;
+
+	stmt->currentRow = 0;
+	stmt->startRow = 0;
+	stmt->rowSetSize = 0;
+	stmt->retrieved = 0;
+	stmt->currentCol = 0;
+	stmt->querytype = Q_UPDATE;
+	stmt->rowcount = 0;
+	stmt->binaryfetch = false;
+
+	for (set = 0; set < nsets; set++) {
+		if (!more ||
+		    (apd->sql_desc_array_status_ptr &&
+		     apd->sql_desc_array_status_ptr[set] == SQL_PARAM_IGNORE)) {
+			status = SQL_PARAM_UNUSED;
+		} else {
+			const char *errstr = mapi_result_error(hdl);
+
+			processed++;
+			if (errstr) {
+				const char *sqlstate = mapi_result_errorcode(hdl);
+
+				/* General error if the server didn't
+				 * tell us */
+				addStmtError(stmt, sqlstate ? sqlstate : "HY000", errstr, 0);
+				status = SQL_PARAM_ERROR;
+				failed++;
+			} else {
+				if (mapi_get_querytype(hdl) == Q_UPDATE)
+					stmt->rowcount += (SQLULEN) mapi_rows_affected(hdl);
+				status = SQL_PARAM_SUCCESS;
+			}
+			more = mapi_next_result(hdl) == 1;
+		}
+		if (ipd->sql_desc_array_status_ptr)
+			WriteValue(&ipd->sql_desc_array_status_ptr[set], status);
+	}
+	if (ipd->sql_desc_rows_processed_ptr)
+		*ipd->sql_desc_rows_processed_ptr = processed;
+
+	setODBCDescRecCount(stmt->ImplRowDescr, 0);
+	stmt->State = EXECUTED0;
+	if (processed > 0 && failed == processed)
+		return SQL_ERROR;
+	return stmt->Error ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+}
+
 SQLRETURN
 MNDBExecute(ODBCStmt *stmt)
 {
@@ -434,6 +495,7 @@ MNDBExecute(ODBCStmt *stmt)
 	int i;
 	ODBCDesc *desc;
 	SQLLEN offset;
+	SQLULEN nsets, set;
 	long timeout;
 
 	/* check statement cursor state, query should be prepared */
@@ -480,32 +542,55 @@ MNDBExecute(ODBCStmt *stmt)
 		if (mapi_query_handle(hdl, query) == MOK)
 			stmt->Dbc->qtimeout = stmt->qtimeout;
 	}
-	querypos = snprintf(query, querylen, "execute %d (", stmt->queryid);
 	/* XXX fill in parameter values */
 	if (desc->sql_desc_bind_offset_ptr)
 		offset = *desc->sql_desc_bind_offset_ptr;
 	else
 		offset = 0;
-	sep = "";
-	for (i = 1; i <= stmt->nparams; i++) {
-		if (ODBCStore(stmt, i, offset, 0, &query, &querypos, &querylen, sep) == SQL_ERROR) {
-			if (query)
+	/* an array of parameter sets is executed in a single request,
+	 * one statement per set, unless the statement produces a result
+	 * set */
+	nsets = desc->sql_desc_array_size;
+	if (nsets == 0 || stmt->ImplRowDescr->sql_desc_count > 0)
+		nsets = 1;
+	querypos = 0;
+	for (set = 0; set < nsets; set++) {
+		if (nsets > 1 && desc->sql_desc_array_status_ptr &&
+		    desc->sql_desc_array_status_ptr[set] == SQL_PARAM_IGNORE)
+			continue;
+		if (querylen - querypos < 32) {
+			char *q = realloc(query, querylen += 1024);
+			if (q == NULL) {
 				free(query);
-			return SQL_ERROR;
+				addStmtError(stmt, "HY001", NULL, 0);
+				return SQL_ERROR;
+			}
+			query = q;
 		}
-		sep = ",";
-	}
-	if (querypos + 1 >= querylen) {
-		char *q = realloc(query, querylen += 10);
-		if (q == NULL) {
-			free(query);
-			addStmtError(stmt, "HY001", NULL, 0);
-			return SQL_ERROR;
+		querypos += snprintf(query + querypos, querylen - querypos,
+				     "%sexecute %d (", querypos > 0 ? ";\n" : "",
+				     stmt->queryid);
+		sep = "";
+		for (i = 1; i <= stmt->nparams; i++) {
+			if (ODBCStore(stmt, i, offset, set, &query, &querypos, &querylen, sep) == SQL_ERROR) {
+				if (query)
+					free(query);
+				return SQL_ERROR;
+			}
+			sep = ",";
 		}
-		query = q;
+		if (querypos + 1 >= querylen) {
+			char *q = realloc(query, querylen += 10);
+			if (q == NULL) {
+				free(query);
+				addStmtError(stmt, "HY001", NULL, 0);
+				return SQL_ERROR;
+			}
+			query = q;
+		}
+		query[querypos++] = ')';
+		query[querypos] = 0;
 	}
-	query[querypos++] = ')';
-	query[querypos] = 0;
 
 #ifdef ODBCDEBUG
 	ODBCLOG("SQLExecute %p %s\n", stmt, query);
@@ -523,11 +608,21 @@ MNDBExecute(ODBCStmt *stmt)
 			mapi_cache_limit(stmt->Dbc->mid, 100);
 		stmt->Dbc->cachelimit = 100;
 	}
+	if (querypos == 0) {
+		/* all parameter sets are to be ignored */
+		free(query);
+		return ODBCInitParamResults(stmt, nsets, false);
+	}
 	msg = mapi_query_handle(hdl, query);
 	free(query);
 	switch (msg) {
 	case MOK:
 		break;
+	case MSERVER:
+		/* the errors are reported per parameter set */
+		if (nsets > 1)
+			break;
+		/* fall through */
 	case MTIMEOUT:
 		/* Connection timeout expired / Communication link failure */
 		timeout = msetting_long(stmt->Dbc->settings, MP_REPLY_TIMEOUT);
@@ -552,6 +647,8 @@ MNDBExecute(ODBCStmt *stmt)
 
 	/* now get the result data and store it to our internal data structure */
 
+	if (nsets > 1)
+		return ODBCInitParamResults(stmt, nsets, true);
 	return ODBCInitResult(stmt);
 }
 
@@ -32,6 +32,316 @@
 #include "ODBCGlobal.h"
 #include "ODBCStmt.h"
 #include "ODBCUtil.h"
+#include <math.h>		/* for isnan */
+
+/* Rowsets of result sets that are still open on the server can be
+ * fetched in binary form with mapi_fetch_columns(), provided that the
+ * binary representation of each bound column can be stored directly
+ * in its C type.  This saves the conversion of each value to and from
+ * text. */
+
+enum binkind {
+	BIN_NONE,		/* fetch as text */
+	BIN_INT,		/* tinyint, smallint, int, bigint */
+	BIN_REAL,
+	BIN_DOUBLE,
+	BIN_BOOL,
+	BIN_STR,		/* char, varchar, clob */
+};
+
+static enum binkind
+binaryKind(MapiHdl hdl, int col, SQLSMALLINT ctype)
+{
+	const char *type = mapi_get_type(hdl, col);
+
+	if (type == NULL)
+		return BIN_NONE;
+	if (strcmp(type, "tinyint") == 0 || strcmp(type, "smallint") == 0 ||
+	    strcmp(type, "int") == 0 || strcmp(type, "bigint") == 0) {
+		switch (ctype) {
+		case SQL_C_STINYINT:
+		case SQL_C_TINYINT:
+		case SQL_C_SSHORT:
+		case SQL_C_SHORT:
+		case SQL_C_SLONG:
+		case SQL_C_LONG:
+		case SQL_C_SBIGINT:
+		case SQL_C_DOUBLE:
+			return BIN_INT;
+		}
+	} else if (strcmp(type, "real") == 0) {
+		if (ctype == SQL_C_FLOAT || ctype == SQL_C_DOUBLE)
+			return BIN_REAL;
+	} else if (strcmp(type, "double") == 0) {
+		if (ctype == SQL_C_DOUBLE)
+			return BIN_DOUBLE;
+	} else if (strcmp(type, "boolean") == 0) {
+		if (ctype == SQL_C_BIT)
+			return BIN_BOOL;
+	} else if (strcmp(type, "char") == 0 ||
+		   strcmp(type, "varchar") == 0 ||
+		   strcmp(type, "clob") == 0) {
+		if (ctype == SQL_C_CHAR)
+			return BIN_STR;
+	}
+	return BIN_NONE;
+}
+
+static int64_t
+binaryInt(const char *src, int width)
+{
+	switch (width) {
+	case 1: {
+		int8_t v;
+		memcpy(&v, src, sizeof(v));
+		return v == INT8_MIN ? INT64_MIN : v;
+	}
+	case 2: {
+		int16_t v;
+		memcpy(&v, src, sizeof(v));
+		return v == INT16_MIN ? INT64_MIN : v;
+	}
+	case 4: {
+		int32_t v;
+		memcpy(&v, src, sizeof(v));
+		return v == INT32_MIN ? INT64_MIN : v;
+	}
+	default: {
+		int64_t v;
+		memcpy(&v, src, sizeof(v));
+		return v;
+	}
+	}
+}
+
+/* Store a value of the binary rowset in the application's buffer,
+ * returns SQL_ERROR if the row gets status SQL_ROW_SUCCESS_WITH_INFO */
+static SQLRETURN
+binaryStore(ODBCStmt *stmt, enum binkind kind, int width, const char *src,
+	    ODBCDescRec *rec, SQLPOINTER ptr, SQLLEN *lenp, SQLLEN *nullp)
+{
+	int64_t ival = 0;
+	double dval = 0;
+	bool isnull;
+
+	switch (kind) {
+	case BIN_INT:
+		ival = binaryInt(src, width);
+		isnull = ival == INT64_MIN;
+		break;
+	case BIN_REAL: {
+		float f;
+		memcpy(&f, src, sizeof(f));
+		dval = f;
+		isnull = isnan(f);
+		break;
+	}
+	case BIN_DOUBLE:
+		memcpy(&dval, src, sizeof(dval));
+		isnull = isnan(dval);
+		break;
+	case BIN_BOOL:
+		isnull = (unsigned char) *src == 0x80;
+		break;
+	default:
+		isnull = strcmp(src, "\200") == 0;
+		break;
+	}
+	if (isnull) {
+		if (nullp == NULL) {
+			/* Indicator variable required but not supplied */
+			addStmtError(stmt, "22002", NULL, 0);
+			return SQL_ERROR;
+		}
+		*nullp = SQL_NULL_DATA;
+		if (lenp)
+			*lenp = SQL_NULL_DATA;
+		return SQL_SUCCESS;
+	}
+	if (nullp && nullp != lenp)
+		*nullp = 0;
+
+	switch (rec->sql_desc_concise_type) {
+	case SQL_C_STINYINT:
+	case SQL_C_TINYINT:
+		if (ival < INT8_MIN || ival > INT8_MAX)
+			goto outofrange;
+		WriteData(ptr, (signed char) ival, signed char);
+		break;
+	case SQL_C_SSHORT:
+	case SQL_C_SHORT:
+		if (ival < INT16_MIN || ival > INT16_MAX)
+			goto outofrange;
+		WriteData(ptr, (short) ival, short);
+		break;
+	case SQL_C_SLONG:
+	case SQL_C_LONG:
+		if (ival < INT32_MIN || ival > INT32_MAX)
+			goto outofrange;
+		WriteData(ptr, (int) ival, int);
+		break;
+	case SQL_C_SBIGINT:
+		WriteData(ptr, (SQLBIGINT) ival, SQLBIGINT);
+		break;
+	case SQL_C_FLOAT:
+		WriteData(ptr, (float) dval, float);
+		break;
+	case SQL_C_DOUBLE:
+		WriteData(ptr, kind == BIN_INT ? (double) ival : dval, double);
+		break;
+	case SQL_C_BIT:
+		WriteData(ptr, (unsigned char) (*src != 0), unsigned char);
+		break;
+	case SQL_C_CHAR:
+		copyString(src, strlen(src), ptr, rec->sql_desc_octet_length,
+			   lenp, SQLLEN, addStmtError, stmt, return SQL_ERROR);
+		return SQL_SUCCESS;
+	}
+	if (lenp)
+		*lenp = ODBCCtypeSize(rec->sql_desc_concise_type, 0);
+	return SQL_SUCCESS;
+
+  outofrange:
+	/* Numeric value out of range */
+	addStmtError(stmt, "22003", NULL, 0);
+	return SQL_ERROR;
+}
+
+/* Fetch the next rowset in binary form.  Returns false if it needs to
+ * be fetched as text, otherwise *rc is the return code of the fetch. */
+static bool
+MNDBFetchBinary(ODBCStmt *stmt, SQLUSMALLINT *RowStatusArray, SQLRETURN *rc)
+{
+	ODBCDesc *ard = stmt->ApplRowDescr, *ird = stmt->ImplRowDescr;
+	int ncols = ird->sql_desc_count;
+	MapiColumnBuffer *bufs = NULL;
+	enum binkind *kinds = NULL;
+	int *widths = NULL;
+	SQLLEN nrows, offset;
+	SQLINTEGER bind_type = ard->sql_desc_bind_type;
+	int64_t got = -1;
+	SQLULEN row;
+	int i;
+	bool retry;
+
+	if (!stmt->binaryfetch || ard->sql_desc_array_size <= 1)
+		return false;
+	nrows = (SQLLEN) ard->sql_desc_array_size;
+	if (stmt->startRow + nrows > (SQLLEN) stmt->rowcount)
+		nrows = stmt->rowcount - stmt->startRow;
+	if (nrows <= 0)
+		return false;
+
+	bufs = calloc(ncols, sizeof(MapiColumnBuffer));
+	kinds = calloc(ncols, sizeof(enum binkind));
+	widths = calloc(ncols, sizeof(int));
+	if (bufs == NULL || kinds == NULL || widths == NULL)
+		goto cleanup;
+	for (i = 1; i <= ncols && i <= ard->sql_desc_count; i++) {
+		ODBCDescRec *rec = &ard->descRec[i];
+
+		if (rec->sql_desc_data_ptr == NULL)
+			continue;
+		kinds[i - 1] = binaryKind(stmt->hdl, i - 1, rec->sql_desc_concise_type);
+		if (kinds[i - 1] == BIN_NONE ||
+		    (kinds[i - 1] == BIN_STR && rec->sql_desc_octet_length < 0))
+			goto cleanup;
+		widths[i - 1] = mapi_get_binary_width(stmt->hdl, i - 1);
+		if (widths[i - 1] < 0)
+			goto cleanup;
+		if (widths[i - 1] > 0) {
+			bufs[i - 1].size = (size_t) nrows * widths[i - 1];
+		} else {
+			bufs[i - 1].size = (size_t) nrows * 32;
+			bufs[i - 1].offsets = malloc(nrows * sizeof(size_t));
+			if (bufs[i - 1].offsets == NULL)
+				goto cleanup;
+		}
+		bufs[i - 1].data = malloc(bufs[i - 1].size);
+		if (bufs[i - 1].data == NULL)
+			goto cleanup;
+	}
+
+	/* string columns tell us how much room they need if their
+	 * buffer is too small */
+	do {
+		retry = false;
+		for (i = 0; i < ncols; i++)
+			bufs[i].used = 0;
+		got = mapi_fetch_columns(stmt->hdl, stmt->startRow, nrows, bufs);
+		if (got >= 0)
+			break;
+		for (i = 0; i < ncols; i++) {
+			if (bufs[i].data && bufs[i].used > bufs[i].size) {
+				void *p = realloc(bufs[i].data, bufs[i].used);
+				if (p == NULL)
+					goto bailout;
+				bufs[i].data = p;
+				bufs[i].size = bufs[i].used;
+				retry = true;
+			}
+		}
+	} while (retry);
+	if (got <= 0)
+		goto bailout;
+
+	stmt->rowSetSize = (SQLLEN) got;
+	for (i = 1; i <= ird->sql_desc_count; i++)
+		ird->descRec[i].already_returned = -1;
+	offset = ard->sql_desc_bind_offset_ptr ? *ard->sql_desc_bind_offset_ptr : 0;
+	for (row = 0; (SQLLEN) row < stmt->rowSetSize; row++) {
+		SQLUSMALLINT status = SQL_ROW_SUCCESS;
+
+		for (i = 1; i <= ncols && i <= ard->sql_desc_count; i++) {
+			ODBCDescRec *rec = &ard->descRec[i];
+			const char *src;
+			char *ptr;
+			SQLLEN *lenp, *nullp;
+
+			if (rec->sql_desc_data_ptr == NULL)
+				continue;
+			if (widths[i - 1] > 0)
+				src = (const char *) bufs[i - 1].data + row * widths[i - 1];
+			else
+				src = (const char *) bufs[i - 1].data + bufs[i - 1].offsets[row];
+			ptr = (char *) rec->sql_desc_data_ptr + offset +
+				row * (bind_type == SQL_BIND_BY_COLUMN ? ODBCCtypeSize(rec->sql_desc_concise_type, rec->sql_desc_octet_length) : bind_type);
+			lenp = rec->sql_desc_octet_length_ptr;
+			if (lenp)
+				lenp = (SQLLEN *) ((char *) lenp + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? sizeof(SQLLEN) : (size_t) bind_type));
+			nullp = rec->sql_desc_indicator_ptr;
+			if (nullp)
+				nullp = (SQLLEN *) ((char *) nullp + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? sizeof(SQLLEN) : (size_t) bind_type));
+			if (binaryStore(stmt, kinds[i - 1], widths[i - 1], src, rec, ptr, lenp, nullp) == SQL_ERROR)
+				status = SQL_ROW_SUCCESS_WITH_INFO;
+		}
+		if (RowStatusArray)
+			WriteValue(&RowStatusArray[row], status);
+	}
+	if (ird->sql_desc_rows_processed_ptr)
+		*ird->sql_desc_rows_processed_ptr = (SQLULEN) stmt->rowSetSize;
+	if (RowStatusArray)
+		for (; row < ard->sql_desc_array_size; row++)
+			WriteValue(&RowStatusArray[row], SQL_ROW_NOROW);
+	*rc = stmt->Error ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+
+  bailout:
+	if (got <= 0) {
+		/* don't try again, the text fetch reports problems */
+		stmt->binaryfetch = false;
+	}
+  cleanup:
+	if (bufs) {
+		for (i = 0; i < ncols; i++) {
+			free(bufs[i].data);
+			free(bufs[i].offsets);
+		}
+	}
+	free(bufs);
+	free(kinds);
+	free(widths);
+	return got > 0;
+}
 
 SQLRETURN
 MNDBFetch(ODBCStmt *stmt, SQLUSMALLINT *RowStatusArray)
@@ -42,6 +352,7 @@ MNDBFetch(ODBCStmt *stmt, SQLUSMALLINT *RowStatusArray)
 	SQLULEN row;
 	SQLLEN offset;
 	long timeout;
+	SQLRETURN rc;
 
 	/* stmt->startRow is the (0 based) index of the first row we
 	 * stmt->need to fetch */
@@ -87,6 +398,9 @@ MNDBFetch(ODBCStmt *stmt, SQLUSMALLINT *RowStatusArray)
 		return SQL_SUCCESS;
 	}
 
+	if (MNDBFetchBinary(stmt, RowStatusArray, &rc))
+		return rc;
+
 	if (ard->sql_desc_bind_offset_ptr)
 		offset = *ard->sql_desc_bind_offset_ptr;
 	else
@@ -833,8 +833,9 @@ MNDBGetInfo(ODBCDbc *dbc,
 		sValue = "N";	/* "Y" */
 		break;
 	case SQL_PARAM_ARRAY_ROW_COUNTS:
-		nValue = SQL_PARC_BATCH; /* ? */
-		/* SQL_PARC_NO_BATCH */
+		/* parameter arrays give a cumulative row count */
+		nValue = SQL_PARC_NO_BATCH;
+		/* SQL_PARC_BATCH */
 		break;
 	case SQL_PARAM_ARRAY_SELECTS:
 		nValue = SQL_PAS_NO_SELECT;
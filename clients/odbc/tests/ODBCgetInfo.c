@@ -878,7 +878,7 @@ const struct {
 		.info = SQL_PARAM_ARRAY_ROW_COUNTS,
 		.name = "SQL_PARAM_ARRAY_ROW_COUNTS",
 		.type = INTEGER,
-		.i = SQL_PARC_BATCH,
+		.i = SQL_PARC_NO_BATCH,
 	},
 	{
 		.info = SQL_POS_OPERATIONS,
@@ -212,6 +212,129 @@ testGetDataTruncatedString(SQLHANDLE stmt, SWORD ctype)
 	return ret;
 }
 
+#define NSETS	20000
+#define NROWS	1000
+
+static SQLRETURN
+testParamAndRowArrays(SQLHANDLE stmt)
+{
+	SQLRETURN ret;
+	static SQLINTEGER ivals[NSETS];
+	static SQLCHAR svals[NSETS][8];
+	static SQLLEN ilens[NSETS], slens[NSETS];
+	static SQLUSMALLINT operations[NSETS], statuses[NSETS];
+	SQLINTEGER cols_i[NROWS];
+	SQLCHAR cols_s[NROWS][8];
+	SQLLEN cols_ilen[NROWS], cols_slen[NROWS];
+	SQLUSMALLINT rowstatuses[NROWS];
+	SQLULEN processed = 0, fetched = 0;
+	SQLLEN RowCount = 0;
+	int64_t sum = 0;
+	size_t succeeded = 0, unused = 0, rows = 0, nulls = 0, mismatches = 0;
+	char outp[400];
+	size_t pos = 0;
+
+	ret = SQLExecDirect(stmt, (SQLCHAR *) "create table arrays (i int, s varchar(7))", SQL_NTS);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLExecDirect (create)");
+
+	/* insert all rows with a single SQLExecute, skipping one */
+	for (int i = 0; i < NSETS; i++) {
+		ivals[i] = i;
+		ilens[i] = i % 1000 == 999 ? SQL_NULL_DATA : 0;
+		snprintf((char *) svals[i], sizeof(svals[i]), "s%d", i);
+		slens[i] = SQL_NTS;
+		operations[i] = i == 5 ? SQL_PARAM_IGNORE : SQL_PARAM_PROCEED;
+	}
+	ret = SQLPrepare(stmt, (SQLCHAR *) "insert into arrays values (?, ?)", SQL_NTS);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLPrepare");
+	ret = SQLBindParameter(stmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, ivals, 0, ilens);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLBindParameter(1)");
+	ret = SQLBindParameter(stmt, 2, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_VARCHAR, 7, 0, svals, sizeof(svals[0]), slens);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLBindParameter(2)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) (uintptr_t) NSETS, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAMSET_SIZE)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_OPERATION_PTR, operations, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAM_OPERATION_PTR)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_STATUS_PTR, statuses, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAM_STATUS_PTR)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAMS_PROCESSED_PTR, &processed, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAMS_PROCESSED_PTR)");
+	ret = SQLExecute(stmt);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLExecute");
+	ret = SQLRowCount(stmt, &RowCount);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLRowCount");
+	for (int i = 0; i < NSETS; i++) {
+		if (statuses[i] == SQL_PARAM_SUCCESS)
+			succeeded++;
+		else if (statuses[i] == SQL_PARAM_UNUSED)
+			unused++;
+	}
+	pos += snprintf(outp + pos, sizeof(outp) - pos, "SQLRowCount is " LLFMT ", processed " LLFMT ", succeeded %zu, unused %zu\n", (int64_t) RowCount, (int64_t) processed, succeeded, unused);
+
+	ret = SQLFreeStmt(stmt, SQL_RESET_PARAMS);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLFreeStmt(SQL_RESET_PARAMS)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) (uintptr_t) 1, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAMSET_SIZE)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_OPERATION_PTR, NULL, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAM_OPERATION_PTR)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAM_STATUS_PTR)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_PARAMS_PROCESSED_PTR, NULL, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_PARAMS_PROCESSED_PTR)");
+
+	/* fetch them back, NROWS rows at a time */
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) (uintptr_t) NROWS, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_ROW_ARRAY_SIZE)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_STATUS_PTR, rowstatuses, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_ROW_STATUS_PTR)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROWS_FETCHED_PTR, &fetched, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_ROWS_FETCHED_PTR)");
+	ret = SQLExecDirect(stmt, (SQLCHAR *) "select i, s from arrays", SQL_NTS);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLExecDirect (select)");
+	ret = SQLBindCol(stmt, 1, SQL_C_SLONG, cols_i, 0, cols_ilen);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLBindCol(1)");
+	ret = SQLBindCol(stmt, 2, SQL_C_CHAR, cols_s, sizeof(cols_s[0]), cols_slen);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLBindCol(2)");
+	while ((ret = SQLFetch(stmt)) == SQL_SUCCESS) {
+		for (SQLULEN r = 0; r < fetched; r++) {
+			char expected[8];
+
+			if (rowstatuses[r] != SQL_ROW_SUCCESS)
+				mismatches++;
+			if (cols_ilen[r] == SQL_NULL_DATA) {
+				nulls++;
+				continue;
+			}
+			sum += cols_i[r];
+			snprintf(expected, sizeof(expected), "s%d", (int) cols_i[r]);
+			if (strcmp((char *) cols_s[r], expected) != 0 ||
+			    cols_slen[r] != (SQLLEN) strlen(expected))
+				mismatches++;
+		}
+		rows += fetched;
+	}
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLFetch");
+	pos += snprintf(outp + pos, sizeof(outp) - pos, "fetched %zu rows, %zu nulls, sum " LLFMT ", %zu mismatches\n", rows, nulls, sum, mismatches);
+
+	ret = SQLCloseCursor(stmt);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLCloseCursor");
+	ret = SQLFreeStmt(stmt, SQL_UNBIND);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLFreeStmt(SQL_UNBIND)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) (uintptr_t) 1, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_ROW_ARRAY_SIZE)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_ROW_STATUS_PTR)");
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLSetStmtAttr(SQL_ATTR_ROWS_FETCHED_PTR)");
+	ret = SQLExecDirect(stmt, (SQLCHAR *) "drop table arrays", SQL_NTS);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLExecDirect (drop)");
+
+	compareResult("testParamAndRowArrays", outp,
+		"SQLRowCount is 19999, processed 19999, succeeded 19999, unused 1\n"
+		"fetched 19999 rows, 20 nulls, sum 199780015, 0 mismatches\n");
+	return ret;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -266,6 +389,12 @@ main(int argc, char **argv)
 	ret = testGetDataTruncatedString(stmt, SQL_C_WCHAR);
 	check(ret, SQL_HANDLE_STMT, stmt, "testGetDataTruncatedString(STMT, SQL_C_WCHAR)");
 
+	ret = SQLCloseCursor(stmt);
+	check(ret, SQL_HANDLE_STMT, stmt, "SQLCloseCursor");
+
+	ret = testParamAndRowArrays(stmt);
+	check(ret, SQL_HANDLE_STMT, stmt, "testParamAndRowArrays(STMT)");
+
 	/* cleanup */
 	ret = SQLFreeHandle(SQL_HANDLE_STMT, stmt);
 	check(ret, SQL_HANDLE_STMT, stmt, "SQLFreeHandle (STMT)");
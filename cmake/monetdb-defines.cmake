@@ -31,6 +31,7 @@ function(monetdb_configure_defines)
   check_include_file("stdatomic.h" HAVE_STDATOMIC_H)
   check_include_file("strings.h" HAVE_STRINGS_H)
   check_include_file("stropts.h" HAVE_STROPTS_H)
+  check_include_file("sys/epoll.h" HAVE_SYS_EPOLL_H)
   check_include_file("sys/file.h" HAVE_SYS_FILE_H)
   check_include_file("sys/ioctl.h" HAVE_SYS_IOCTL_H)
   check_include_file("sys/mman.h" HAVE_SYS_MMAN_H)
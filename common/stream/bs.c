@@ -13,14 +13,135 @@
 #include "monetdb_config.h"
 #include "stream.h"
 #include "stream_internal.h"
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBLZ4
+#include <lz4.h>
+#endif
 
 /* ------------------------------------------------------------------ */
 
 /* A buffered stream consists of a sequence of blocks.  Each block
  * consists of a count followed by the data in the block.  A flush is
  * indicated by an empty block (i.e. just a count of 0).
+ *
+ * The count is a two byte integer, limiting the blocks to BLOCK bytes.
+ * After both sides agreed on it, a stream can be switched to large
+ * blocks of up to MAX_BLOCK bytes with a four byte count.  Large writes
+ * then go straight from the caller's buffer to the underlying stream.
+ *
+ * Large blocks may be compressed.  The high order bit of the count then
+ * tells that the block is compressed, and the count is the size of the
+ * compressed data.  Blocks which do not shrink are sent as is.
  */
 
+#define BS_COMPRESSED	((uint32_t) 1 << 31)
+#define BS_MINCOMPRESS	256	/* smaller blocks are not compressed */
+
+static bool
+bs_reserve(char **buf, size_t *size, size_t need)
+{
+	char *p;
+
+	if (need <= *size)
+		return true;
+	if ((p = realloc(*buf, need)) == NULL)
+		return false;
+	*buf = p;
+	*size = need;
+	return true;
+}
+
+static size_t
+bs_compressbound(const bs *s, size_t n)
+{
+	switch (s->compression) {
+#ifdef HAVE_LIBZ
+	case BS_COMPRESSION_ZLIB:
+		return (size_t) compressBound((uLong) n);
+#endif
+#ifdef HAVE_LIBLZ4
+	case BS_COMPRESSION_LZ4:
+		return (size_t) LZ4_compressBound((int) n);
+#endif
+	default:
+		return 0;
+	}
+}
+
+/* Compress the buffered data into zbuf.  Returns the compressed size,
+ * or 0 if the data is to be sent as is. */
+static size_t
+bs_compress(bs *s)
+{
+	size_t bound = bs_compressbound(s, s->nr), zlen = 0;
+
+	if (bound == 0 || !bs_reserve(&s->zbuf, &s->zbufsize, bound))
+		return 0;
+	switch (s->compression) {
+#ifdef HAVE_LIBZ
+	case BS_COMPRESSION_ZLIB: {
+		uLongf len = (uLongf) bound;
+
+		if (compress2((Bytef *) s->zbuf, &len, (const Bytef *) s->big,
+			      (uLong) s->nr, s->level > 0 ? s->level : 1) == Z_OK)
+			zlen = (size_t) len;
+		break;
+	}
+#endif
+#ifdef HAVE_LIBLZ4
+	case BS_COMPRESSION_LZ4: {
+		/* LZ4 has an acceleration instead of levels: the low
+		 * levels map onto a high acceleration, the default and
+		 * the high levels onto its default of 1 */
+		int acceleration = s->level > 0 && s->level < 9 ? 10 - s->level : 1;
+		int len = LZ4_compress_fast(s->big, s->zbuf, (int) s->nr,
+					    (int) bound, acceleration);
+
+		if (len > 0)
+			zlen = (size_t) len;
+		break;
+	}
+#endif
+	default:
+		break;
+	}
+	return zlen < s->nr ? zlen : 0;
+}
+
+/* Decompress zlen bytes of zbuf into big.  Returns the decompressed
+ * size, or -1 on error. */
+static ssize_t
+bs_decompress(bs *s, size_t zlen)
+{
+	if (!bs_reserve(&s->big, &s->bigsize, s->size))
+		return -1;
+	switch (s->compression) {
+#ifdef HAVE_LIBZ
+	case BS_COMPRESSION_ZLIB: {
+		uLongf len = (uLongf) s->size;
+
+		if (uncompress((Bytef *) s->big, &len, (const Bytef *) s->zbuf,
+			       (uLong) zlen) != Z_OK)
+			return -1;
+		return (ssize_t) len;
+	}
+#endif
+#ifdef HAVE_LIBLZ4
+	case BS_COMPRESSION_LZ4: {
+		int len = LZ4_decompress_safe(s->zbuf, s->big, (int) zlen,
+					      (int) s->size);
+
+		return len < 0 ? -1 : (ssize_t) len;
+	}
+#endif
+	default:
+		(void) zlen;
+		return -1;
+	}
+}
+
 static bs *
 bs_create(void)
 {
@@ -33,6 +154,90 @@ bs_create(void)
 	return ns;
 }
 
+/* Write a large block consisting of the buffered data followed by len
+ * bytes of data, in a single gather write if the underlying stream
+ * supports it. */
+static int
+bs_writeblock(stream *ss, bs *s, const void *data, size_t len, bool final)
+{
+	size_t n = s->nr + len;
+	uint32_t blksize = (uint32_t) (n << 1) | final;
+	const char *blk = s->big;
+	size_t blklen = s->nr;
+	bool ok;
+
+	if (s->compression != BS_COMPRESSION_NONE && len == 0 &&
+	    n >= BS_MINCOMPRESS && (blklen = bs_compress(s)) > 0) {
+		blksize = (uint32_t) (blklen << 1) | final | BS_COMPRESSED;
+		blk = s->zbuf;
+	} else
+		blklen = s->nr;
+
+	unsigned char hdr[4] = {
+		(unsigned char) blksize,
+		(unsigned char) (blksize >> 8),
+		(unsigned char) (blksize >> 16),
+		(unsigned char) (blksize >> 24),
+	};
+
+#ifdef HAVE_SYS_UIO_H
+	if (ss->inner->writev) {
+		struct iovec iov[3] = {
+			{.iov_base = hdr, .iov_len = sizeof(hdr)},
+			{.iov_base = (void *) blk, .iov_len = blklen},
+			{.iov_base = (void *) data, .iov_len = len},
+		};
+
+		ok = ss->inner->writev(ss->inner, iov, 3) == (ssize_t) (sizeof(hdr) + blklen + len);
+	} else
+#endif
+		ok = ss->inner->write(ss->inner, hdr, 1, sizeof(hdr)) == (ssize_t) sizeof(hdr) &&
+			(blklen == 0 || ss->inner->write(ss->inner, blk, 1, blklen) == (ssize_t) blklen) &&
+			(len == 0 || ss->inner->write(ss->inner, data, 1, len) == (ssize_t) len);
+	s->nr = 0;
+	if (!ok) {
+		/* data is lost due to error */
+		mnstr_copy_error(ss, ss->inner);
+		return -1;
+	}
+	s->bytes += n;
+	s->blks++;
+	return 0;
+}
+
+static ssize_t
+bs_write_large(stream *restrict ss, bs *restrict s, const void *restrict buf, size_t cnt, size_t todo)
+{
+	while (todo > 0) {
+		size_t n = s->size - s->nr;
+
+		if (todo >= n && s->compression == BS_COMPRESSION_NONE) {
+			/* complete the block straight from the caller's data */
+			if (bs_writeblock(ss, s, buf, n, false) < 0)
+				return -1;
+		} else {
+			if (todo < n)
+				n = todo;
+			if (s->nr + n > s->bigsize &&
+			    !bs_reserve(&s->big, &s->bigsize,
+					s->bigsize * 2 < s->nr + n ? s->nr + n :
+					s->bigsize * 2 > s->size ? s->size :
+					s->bigsize * 2)) {
+				mnstr_set_error(ss, MNSTR_WRITE_ERROR, "allocation failure");
+				return -1;
+			}
+			memcpy(s->big + s->nr, buf, n);
+			s->nr += (unsigned) n;
+			/* a compressed block is sent once it is full */
+			if (s->nr == s->size && bs_writeblock(ss, s, NULL, 0, false) < 0)
+				return -1;
+		}
+		todo -= n;
+		buf = ((const char *) buf + n);
+	}
+	return (ssize_t) cnt;
+}
+
 /* Collect data until the internal buffer is filled, then write the
  * filled buffer to the underlying stream.
  * Struct field usage:
@@ -54,6 +259,8 @@ bs_write(stream *restrict ss, const void *restrict buf, size_t elmsize, size_t c
 	if (s == NULL)
 		return -1;
 	assert(!ss->readonly);
+	if (s->size > 0)
+		return bs_write_large(ss, s, buf, cnt, todo);
 	assert(s->nr < sizeof(s->buf));
 	while (todo > 0) {
 		size_t n = sizeof(s->buf) - s->nr;
@@ -115,6 +322,10 @@ bs_flush(stream *ss, mnstr_flush_level flush_level)
 	if (s == NULL)
 		return -1;
 	assert(!ss->readonly);
+	if (s->size > 0) {
+		(void) flush_level;
+		return bs_writeblock(ss, s, NULL, 0, true);
+	}
 	assert(s->nr < sizeof(s->buf));
 	if (!ss->readonly) {
 		/* flush the rest of buffer (if s->nr > 0), then set the
@@ -154,6 +365,91 @@ bs_flush(stream *ss, mnstr_flush_level flush_level)
 	return 0;
 }
 
+/* Read the count of the next block.  Returns 1 on success, 0 at end of
+ * file, and -1 on error. */
+static int
+bs_readhdr(stream *ss, bs *s)
+{
+	uint32_t blksize;
+
+	if (s->size > 0) {
+		unsigned char hdr[4];
+
+		/* the count is little endian, see bs_writeblock */
+		switch (ss->inner->read(ss->inner, hdr, sizeof(hdr), 1)) {
+		case -1:
+			mnstr_copy_error(ss, ss->inner);
+			return -1;
+		case 0:
+			ss->eof |= ss->inner->eof;
+			return 0;
+		}
+		blksize = (uint32_t) hdr[0]
+			| (uint32_t) hdr[1] << 8
+			| (uint32_t) hdr[2] << 16
+			| (uint32_t) hdr[3] << 24;
+		s->inbig = false;
+		if (blksize & BS_COMPRESSED) {
+			size_t zlen = (blksize & ~BS_COMPRESSED) >> 1;
+			ssize_t len;
+
+			if (s->compression == BS_COMPRESSION_NONE ||
+			    zlen > bs_compressbound(s, s->size)) {
+				mnstr_set_error(ss, MNSTR_READ_ERROR, "invalid compressed block size %zu", zlen);
+				return -1;
+			}
+			if (!bs_reserve(&s->zbuf, &s->zbufsize, zlen)) {
+				mnstr_set_error(ss, MNSTR_READ_ERROR, "allocation failure");
+				return -1;
+			}
+			for (size_t n = 0; n < zlen; n += (size_t) len) {
+				if ((len = ss->inner->read(ss->inner, s->zbuf + n, 1, zlen - n)) <= 0) {
+					ss->eof |= ss->inner->eof;
+					mnstr_copy_error(ss, ss->inner);
+					return -1;
+				}
+			}
+			if ((len = bs_decompress(s, zlen)) < 0) {
+				mnstr_set_error(ss, MNSTR_READ_ERROR, "corrupt compressed block");
+				return -1;
+			}
+			/* continue as if the block was not compressed */
+			blksize = (uint32_t) len << 1 | (blksize & 1);
+			s->inbig = true;
+			s->rpos = 0;
+		} else if (blksize >> 1 > s->size) {
+			mnstr_set_error(ss, MNSTR_READ_ERROR, "invalid block size %u", blksize);
+			return -1;
+		}
+	} else {
+		int16_t v = 0;
+
+		switch (mnstr_readSht(ss->inner, &v)) {
+		case -1:
+			mnstr_copy_error(ss, ss->inner);
+			return -1;
+		case 0:
+			ss->eof |= ss->inner->eof;
+			return 0;
+		}
+		blksize = (uint16_t) v;
+		if (blksize > (BLOCK << 1 | 1)) {
+			mnstr_set_error(ss, MNSTR_READ_ERROR, "invalid block size %d", v);
+			return -1;
+		}
+	}
+#ifdef BSTREAM_DEBUG
+	fprintf(stderr, "RC size: %u, final: %s\n", blksize >> 1, blksize & 1 ? "true" : "false");
+	fprintf(stderr, "RC %s %u\n", ss->name, blksize);
+#endif
+	s->itotal = blksize >> 1;	/* amount readable */
+	/* store whether this was the last block or not */
+	s->nr = blksize & 1;
+	s->bytes += s->itotal;
+	s->blks++;
+	return 1;
+}
+
 /* Read buffered data and return the number of items read.  At the
  * flush boundary we will return 0 to indicate the end of a block,
  * unless prompt and pstream are set. In that case, only return 0
@@ -181,8 +477,6 @@ bs_read(stream *restrict ss, void *restrict buf, size_t elmsize, size_t cnt)
 	assert(s->nr <= 1);
 
 	if (s->itotal == 0) {
-		int16_t blksize = 0;
-
 		if (s->nr) {
 			/* We read the closing block but hadn't
 			 * returned that yet. Return it now, and note
@@ -196,29 +490,12 @@ bs_read(stream *restrict ss, void *restrict buf, size_t elmsize, size_t cnt)
 
 		/* There is nothing more to read in the current block,
 		 * so read the count for the next block */
-		switch (mnstr_readSht(ss->inner, &blksize)) {
+		switch (bs_readhdr(ss, s)) {
 		case -1:
-			mnstr_copy_error(ss, ss->inner);
 			return -1;
 		case 0:
-			ss->eof |= ss->inner->eof;
 			return 0;
-		case 1:
-			break;
 		}
-		if ((uint16_t) blksize > (BLOCK << 1 | 1)) {
-			mnstr_set_error(ss, MNSTR_READ_ERROR, "invalid block size %d", blksize);
-			return -1;
-		}
-#ifdef BSTREAM_DEBUG
-		fprintf(stderr, "RC size: %u, final: %s\n", (uint16_t) blksize >> 1, (uint16_t) blksize & 1 ? "true" : "false");
-		fprintf(stderr, "RC %s %u\n", ss->name, (uint16_t) blksize);
-#endif
-		s->itotal = (uint16_t) blksize >> 1;	/* amount readable */
-		/* store whether this was the last block or not */
-		s->nr = (uint16_t) blksize & 1;
-		s->bytes += s->itotal;
-		s->blks++;
 	}
 
 	/* Fill the caller's buffer. */
@@ -228,7 +505,15 @@ bs_read(stream *restrict ss, void *restrict buf, size_t elmsize, size_t cnt)
 		 * read it */
 		n = todo < s->itotal ? todo : s->itotal;
 		while (n > 0) {
-			ssize_t m = ss->inner->read(ss->inner, buf, 1, n);
+			ssize_t m;
+
+			if (s->inbig) {
+				/* a decompressed block */
+				memcpy(buf, s->big + s->rpos, n);
+				s->rpos += n;
+				m = (ssize_t) n;
+			} else
+				m = ss->inner->read(ss->inner, buf, 1, n);
 
 			if (m <= 0) {
 				ss->eof |= ss->inner->eof;
@@ -257,37 +542,17 @@ bs_read(stream *restrict ss, void *restrict buf, size_t elmsize, size_t cnt)
 		}
 
 		if (s->itotal == 0) {
-			int16_t blksize = 0;
-
 			/* The current block has been completely read,
 			 * so read the count for the next block, only
 			 * if the previous was not the last one */
 			if (s->nr)
 				break;
-			switch (mnstr_readSht(ss->inner, &blksize)) {
+			switch (bs_readhdr(ss, s)) {
 			case -1:
-				mnstr_copy_error(ss, ss->inner);
 				return -1;
 			case 0:
-				ss->eof |= ss->inner->eof;
 				return 0;
-			case 1:
-				break;
 			}
-			if ((uint16_t) blksize > (BLOCK << 1 | 1)) {
-				mnstr_set_error(ss, MNSTR_READ_ERROR, "invalid block size %d", blksize);
-				return -1;
-			}
-#ifdef BSTREAM_DEBUG
-			fprintf(stderr, "RC size: %d, final: %s\n", (uint16_t) blksize >> 1, (uint16_t) blksize & 1 ? "true" : "false");
-			fprintf(stderr, "RC %s %d\n", ss->name, s->nr);
-			fprintf(stderr, "RC %s %d\n", ss->name, blksize);
-#endif
-			s->itotal = (uint16_t) blksize >> 1;	/* amount readable */
-			/* store whether this was the last block or not */
-			s->nr = (uint16_t) blksize & 1;
-			s->bytes += s->itotal;
-			s->blks++;
 		}
 	}
 	/* if we got an empty block with the end-of-sequence marker
@@ -325,6 +590,8 @@ bs_destroy(stream *ss)
 	if (s) {
 		if (ss->inner)
 			ss->inner->destroy(ss->inner);
+		free(s->big);
+		free(s->zbuf);
 		free(s);
 	}
 	destroy_stream(ss);
@@ -337,6 +604,110 @@ bs_clrerr(stream *s)
 		mnstr_clearerr(s->inner);
 }
 
+/* Switch a block stream between BLOCK sized and large blocks.  This
+ * must happen at a block boundary, i.e. after a flush, or after the
+ * end of a block was read. */
+int
+block_stream_set_size(stream *ss, size_t size)
+{
+	bs *s;
+
+	if (ss == NULL || !isa_block_stream(ss) || (s = ss->stream_data.p) == NULL)
+		return -1;
+	if (size <= BLOCK)
+		size = 0;
+	else if (size > MAX_BLOCK)
+		size = MAX_BLOCK;
+	if (size == s->size)
+		return 0;
+	if (s->nr != 0 || s->itotal != 0) {
+		mnstr_set_error(ss, MNSTR_WRITE_ERROR, "block size changed within a block");
+		return -1;
+	}
+	s->size = size;
+	if (size == 0) {
+		free(s->big);
+		s->big = NULL;
+		s->bigsize = 0;
+		free(s->zbuf);
+		s->zbuf = NULL;
+		s->zbufsize = 0;
+		s->compression = BS_COMPRESSION_NONE;
+	}
+	return 0;
+}
+
+/* The names of the compression methods available in this build, as a
+ * comma separated list. */
+const char *
+block_stream_compressions(void)
+{
+	return ""
+#ifdef HAVE_LIBZ
+		"zlib"
+#ifdef HAVE_LIBLZ4
+		","
+#endif
+#endif
+#ifdef HAVE_LIBLZ4
+		"lz4"
+#endif
+		;
+}
+
+/* Look up a compression method by name.  Returns false if it is not
+ * known, or not available in this build. */
+bool
+block_stream_compression(const char *name, bs_compression *method)
+{
+	if (name == NULL || strcmp(name, "none") == 0) {
+		*method = BS_COMPRESSION_NONE;
+		return true;
+	}
+#ifdef HAVE_LIBZ
+	if (strcmp(name, "zlib") == 0) {
+		*method = BS_COMPRESSION_ZLIB;
+		return true;
+	}
+#endif
+#ifdef HAVE_LIBLZ4
+	if (strcmp(name, "lz4") == 0) {
+		*method = BS_COMPRESSION_LZ4;
+		return true;
+	}
+#endif
+	return false;
+}
+
+/* Compress the large blocks of a block stream.  Like a change of the
+ * block size, this must happen at a block boundary.  The level is the
+ * zlib level from 1 (fast) to 9 (small), 0 selects a fast default. */
+int
+block_stream_set_compression(stream *ss, bs_compression method, int level)
+{
+	bs *s;
+
+	if (ss == NULL || !isa_block_stream(ss) || (s = ss->stream_data.p) == NULL)
+		return -1;
+	if (method == s->compression && level == s->level)
+		return 0;
+	if (method != BS_COMPRESSION_NONE && s->size == 0) {
+		mnstr_set_error(ss, MNSTR_WRITE_ERROR, "compression requires large blocks");
+		return -1;
+	}
+	if (s->nr != 0 || s->itotal != 0) {
+		mnstr_set_error(ss, MNSTR_WRITE_ERROR, "compression changed within a block");
+		return -1;
+	}
+#ifdef HAVE_LIBZ
+	if (method == BS_COMPRESSION_ZLIB && level > Z_BEST_COMPRESSION)
+		level = Z_BEST_COMPRESSION;
+#endif
+	s->compression = method;
+	s->level = level;
+	return 0;
+}
+
 stream *
 bs_stream(stream *s)
 {
@@ -209,7 +209,7 @@ socket_write(stream *restrict s, const void *restrict buf, size_t elmsize, size_
 #ifdef _MSC_VER
 						   (int) min(size - res, 1 << 16)
 #else
-						   size
+						   size - res
 #endif
 						   , 0)) > 0)
 		       || (nr < 0 &&	/* syscall failed */
@@ -262,6 +262,60 @@ socket_write(stream *restrict s, const void *restrict buf, size_t elmsize, size_
 	return 0;
 }
 
+#ifdef HAVE_SYS_UIO_H
+/* write all of the buffers, resuming after partial writes */
+static ssize_t
+socket_writev(stream *restrict s, const struct iovec *iov, int iovcnt)
+{
+	struct iovec v[8];
+	ssize_t nr, res = 0;
+	int i = 0;
+
+	if (s->errkind != MNSTR_NO__ERROR)
+		return -1;
+	if (iovcnt > (int) (sizeof(v) / sizeof(v[0]))) {
+		mnstr_set_error(s, MNSTR_WRITE_ERROR, "too many buffers");
+		return -1;
+	}
+	memcpy(v, iov, iovcnt * sizeof(v[0]));
+	for (;;) {
+		while (i < iovcnt && v[i].iov_len == 0)
+			i++;
+		if (i == iovcnt)
+			return res;
+		errno = 0;
+		nr = writev(s->stream_data.s, v + i, iovcnt - i);
+		if (nr < 0) {
+			if (errno == EINTR)
+				continue;
+			if ((errno == EAGAIN
+#if EAGAIN != EWOULDBLOCK
+			     || errno == EWOULDBLOCK
+#endif
+				    ) && s->timeout > 0) {
+				if (s->timeout_func != NULL &&
+				    !s->timeout_func(s->timeout_data))
+					continue;
+				mnstr_set_error(s, MNSTR_TIMEOUT, NULL);
+			} else
+				mnstr_set_error_errno(s, MNSTR_WRITE_ERROR, "socket write");
+			return -1;
+		}
+		res += nr;
+		/* skip what was written */
+		while (nr > 0) {
+			size_t n = (size_t) nr < v[i].iov_len ? (size_t) nr : v[i].iov_len;
+
+			v[i].iov_base = (char *) v[i].iov_base + n;
+			v[i].iov_len -= n;
+			nr -= (ssize_t) n;
+			if (v[i].iov_len == 0)
+				i++;
+		}
+	}
+}
+#endif
+
 static ssize_t
 socket_read(stream *restrict s, void *restrict buf, size_t elmsize, size_t cnt)
 {
@@ -575,6 +629,9 @@ socket_open(SOCKET sock, const char *name)
 		return NULL;
 	s->read = socket_read;
 	s->write = socket_write;
+#ifdef HAVE_SYS_UIO_H
+	s->writev = socket_writev;
+#endif
 	s->close = socket_close;
 	s->stream_data.s = sock;
 	s->update_timeout = socket_update_timeout;
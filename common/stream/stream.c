@@ -730,6 +730,16 @@ mnstr_set_bigendian(stream *s, bool bigendian)
 #endif
 }
 
+/* mark a stream as carrying binary data, e.g. a callback stream that
+ * is used as the inner stream of a compressed binary stream */
+void
+mnstr_set_binary(stream *s, bool binary)
+{
+	if (s == NULL)
+		return;
+	s->binary = binary;
+}
+
 
 void
 close_stream(stream *s)
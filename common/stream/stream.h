@@ -158,6 +158,7 @@ stream_export const char *mnstr_name(const stream *s); // used when wrapping in
 stream_export bool mnstr_isbinary(const stream *s); // unused
 stream_export bool mnstr_get_swapbytes(const stream *s); // sql_result.c/mapi10
 stream_export void mnstr_set_bigendian(stream *s, bool bigendian); // used in mapi.c and mal_session.c
+stream_export void mnstr_set_binary(stream *s, bool binary); // gdk_logger.c
 stream_export void mnstr_settimeout(stream *s, unsigned int ms, bool (*func)(void *), void *data); // used in mapi.c and mal_session.c
 stream_export int mnstr_isalive(const stream *s); // used once in mal_interpreter.c
 stream_export int mnstr_getoob(const stream *s);
@@ -230,6 +231,23 @@ stream_export stream *block_stream(stream *s); // mapi.c, mal_mapi.c, client.c,
 stream_export bool isa_block_stream(const stream *s); // mapi.c, mal_client.c, remote.c, sql_scenario.c/sqlReader, sql_scan.c
 stream_export stream *bs_stream(stream *s); // unused
 
+/* The maximum size of the large blocks a block stream can be switched
+ * to.  Large blocks have a four byte header, so both sides of the
+ * connection need to switch at the same point in the conversation. */
+#define MAX_BLOCK (1024 * 1024)
+stream_export int block_stream_set_size(stream *s, size_t size); // mapi.c, sql_scenario.c
+
+/* Large blocks can be compressed, using the same method in both
+ * directions. */
+typedef enum {
+	BS_COMPRESSION_NONE = 0,
+	BS_COMPRESSION_ZLIB = 1,
+	BS_COMPRESSION_LZ4 = 2,
+} bs_compression;
+stream_export const char *block_stream_compressions(void); // mal_mapi.c
+stream_export bool block_stream_compression(const char *name, bs_compression *method); // connect.c, sql_scenario.c
+stream_export int block_stream_set_compression(stream *s, bs_compression method, int level); // connect.c, sql_scenario.c
+
 typedef enum {
 	PROTOCOL_AUTO = 0, // unused
 	PROTOCOL_9 = 1, // mal_mapi.c, mal_client.c;
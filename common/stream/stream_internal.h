@@ -42,6 +42,9 @@
 #ifdef HAVE_POLL_H
 #include <poll.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
 #ifdef NATIVE_WIN32
 #include <io.h>
@@ -167,6 +170,10 @@ struct stream {
 	int (*isalive)(const stream *s);
 	int (*getoob)(const stream *s);
 	int (*putoob)(const stream *s, char val);
+#ifdef HAVE_SYS_UIO_H
+	/* gather write, only provided by some streams */
+	ssize_t (*writev)(stream *restrict s, const struct iovec *iov, int iovcnt);
+#endif
 	mnstr_error_kind errkind;
 	char errmsg[1024]; // avoid allocation on error. We don't have THAT many streams..
 };
@@ -263,6 +270,17 @@ struct bs {
 	unsigned itotal;	/* amount available in current read block */
 	int64_t blks;		/* read/written blocks (possibly partial) */
 	int64_t bytes;		/* read/written bytes */
+	size_t size;		/* maximum size of a large block, 0 if the
+				 * stream uses the BLOCK sized blocks */
+	size_t bigsize;		/* allocated size of big */
+	char *big;		/* the buffered data of a large block */
+	bs_compression compression; /* of the large blocks */
+	int level;		/* compression level */
+	size_t zbufsize;	/* allocated size of zbuf */
+	char *zbuf;		/* a compressed block */
+	size_t rpos;		/* read position in big */
+	bool inbig;		/* the block being read was decompressed
+				 * into big */
 	char buf[BLOCK];	/* the buffered data (minus the size of
 				 * size-short */
 };
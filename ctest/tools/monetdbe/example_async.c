@@ -0,0 +1,124 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+#include "monetdbe.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define error(msg) {fprintf(stderr, "Failure: %s\n", msg); return -1;}
+
+#define LONG_QUERY "SELECT spin(100000000)"
+
+static int
+fetch_count(monetdbe_result *result, int64_t *cnt)
+{
+	monetdbe_column *rcol;
+
+	if (result->ncols != 1 || result->nrows != 1 ||
+		monetdbe_result_fetch(result, &rcol, 0) != NULL ||
+		rcol->type != monetdbe_int64_t)
+		return -1;
+	*cnt = ((monetdbe_column_int64_t *) rcol)->data[0];
+	return 0;
+}
+
+static void *
+other_thread(void *arg)
+{
+	monetdbe_database mdbe = arg;
+	monetdbe_result *result = NULL;
+	int64_t cnt = 0;
+
+	if (monetdbe_query(mdbe, "SELECT count(*) FROM test", &result, NULL) != NULL ||
+		fetch_count(result, &cnt) != 0 ||
+		monetdbe_cleanup_result(mdbe, result) != NULL)
+		return NULL;
+	return cnt == 3 ? arg : NULL;
+}
+
+int
+main(void)
+{
+	char* err = NULL;
+	monetdbe_database mdbe1 = NULL, mdbe2 = NULL;
+	monetdbe_query_handle qh1 = NULL, qh2 = NULL;
+	monetdbe_result* result = NULL;
+	monetdbe_cnt affected = 0;
+	int64_t cnt = 0;
+	pthread_t thr;
+	void *ret = NULL;
+
+	if (monetdbe_open(&mdbe1, NULL, NULL))
+		error("Failed to open database")
+	if (monetdbe_open(&mdbe2, NULL, NULL))
+		error("Failed to open database")
+	if ((err = monetdbe_query(mdbe1, "CREATE TABLE test (x integer)", NULL, NULL)) != NULL)
+		error(err)
+	if ((err = monetdbe_query(mdbe1, "CREATE FUNCTION spin(n int) RETURNS int BEGIN DECLARE i int; SET i = 0; "
+							  "WHILE i < n DO SET i = i + 1; END WHILE; RETURN i; END", NULL, NULL)) != NULL)
+		error(err)
+
+	/* one query running in the background on each connection */
+	if ((err = monetdbe_query_submit(mdbe1, "INSERT INTO test VALUES (1), (2), (3)", &qh1)) != NULL)
+		error(err)
+	if ((err = monetdbe_query_submit(mdbe2, "SELECT count(*) FROM sys.tables", &qh2)) != NULL)
+		error(err)
+	if (monetdbe_query(mdbe1, "SELECT 1", NULL, NULL) == NULL)
+		error("Query accepted while a submitted query is pending")
+	if ((err = monetdbe_query_await(qh1, NULL, &affected)) != NULL)
+		error(err)
+	if (affected != 3)
+		error("Wrong number of affected rows")
+	if ((err = monetdbe_query_await(qh2, &result, NULL)) != NULL)
+		error(err)
+	if (fetch_count(result, &cnt) != 0 || cnt <= 0)
+		error("Wrong result of the submitted query")
+	if ((err = monetdbe_cleanup_result(mdbe2, result)) != NULL)
+		error(err)
+
+	/* a connection can be used from another thread */
+	if (pthread_create(&thr, NULL, other_thread, mdbe2) != 0)
+		error("Failed to start thread")
+	if (pthread_join(thr, &ret) != 0 || ret != mdbe2)
+		error("Query from another thread failed")
+
+	/* cancel a long running query */
+	if ((err = monetdbe_query_submit(mdbe1, LONG_QUERY, &qh1)) != NULL)
+		error(err)
+	usleep(100000);
+	if (monetdbe_query_poll(qh1))
+		error("Long query finished too early")
+	monetdbe_query_cancel(qh1);
+	if ((err = monetdbe_query_await(qh1, &result, NULL)) == NULL)
+		error("Cancelled query did not fail")
+	fprintf(stdout, "Cancelled: %s\n", err);
+
+	/* the connection is usable again afterwards */
+	if ((err = monetdbe_query(mdbe1, "SELECT count(*) FROM test", &result, NULL)) != NULL)
+		error(err)
+	if (fetch_count(result, &cnt) != 0 || cnt != 3)
+		error("Wrong result after cancel")
+	if ((err = monetdbe_cleanup_result(mdbe1, result)) != NULL)
+		error(err)
+
+	/* closing a connection stops its pending query */
+	if ((err = monetdbe_query_submit(mdbe2, LONG_QUERY, &qh2)) != NULL)
+		error(err)
+	if (monetdbe_close(mdbe2))
+		error("Failed to close database")
+	if (monetdbe_close(mdbe1))
+		error("Failed to close database")
+	return 0;
+}
@@ -1886,6 +1886,7 @@ gdk_export gdk_return BATrtree(BAT *wkb, BAT* mbr);
 /* inMBR is really a struct mbr * from geom module, but that is not
  * available here */
 gdk_export BUN* RTREEsearch(BAT *b, const void *inMBR, int result_limit);
+gdk_export gdk_return RTREEvisit(BAT *b, const void *inMBR, int (*visit)(oid o, void *arg), void *arg);
 #endif
 
 gdk_export void RTREEdestroy(BAT *b);
@@ -2278,6 +2279,19 @@ gdk_export BAT *BATslice(BAT *b, BUN low, BUN high);
 
 gdk_export BAT *BATunique(BAT *b, BAT *s);
 
+/* Run length encoding */
+gdk_export gdk_return BATrleencode(BAT **boundsp, BAT **valuesp, BAT *b)
+	__attribute__((__warn_unused_result__));
+gdk_export BAT *BATrledecode(BAT *b, BAT *v);
+gdk_export gdk_return BATrleproject(BAT **boundsp, BAT **valuesp, BAT *l, BAT *b, BAT *v)
+	__attribute__((__warn_unused_result__));
+gdk_export BAT *BATrleselect(BAT *b, BAT *v, BAT *s, const void *tl, const void *th, bool li, bool hi, bool anti, bool nil_matches);
+gdk_export BAT *BATrlethetaselect(BAT *b, BAT *v, BAT *s, const void *val, const char *op);
+gdk_export gdk_return BATrlegroup(BAT **groups, BAT **extents, BAT **histo, BAT *b, BAT *v)
+	__attribute__((__warn_unused_result__));
+gdk_export BAT *BATrlecount(BAT *b, BAT *v, BAT *g, BUN ngrp, bool skip_nils);
+gdk_export BAT *BATrlesum(BAT *b, BAT *v, BAT *g, BUN ngrp, int tp, bool skip_nils);
+
 gdk_export gdk_return BATfirstn(BAT **topn, BAT **gids, BAT *b, BAT *cands, BAT *grps, BUN n, bool asc, bool nilslast, bool distinct)
 	__attribute__((__warn_unused_result__));
 
@@ -2800,6 +2800,26 @@ BBPrelinquishbats(void)
 	MT_lock_unset(&GDKcacheLock);
 }
 
+/* Give up the ownership of a bat created by the current thread, so
+ * that other threads can work with it without it getting a logical
+ * reference, e.g. when it outlives the request of a session which may
+ * continue on another thread.  The ownership is only checked in debug
+ * builds. */
+void
+BBPdisown(bat i)
+{
+#ifndef NDEBUG
+	if (BBPcheck(i)) {
+		MT_lock_set(&GDKswapLock(i));
+		if (BBP_pid(i) == MT_getpid())
+			BBP_pid(i) = 0;
+		MT_lock_unset(&GDKswapLock(i));
+	}
+#else
+	(void) i;
+#endif
+}
+
 /*
  * @- BBP rename
  *
@@ -3855,7 +3875,159 @@ BBPcheckBBPdir(void)
  * back all backed up files; this is done by BBPrecover().
  *
  * The BBP.dir is also moved into the BAKDIR.
+ *
+ * Saving the heaps is the expensive part of BBPsync, and it is done
+ * by a number of I/O threads in parallel (option gdk_sync_threads).
+ * The rate at which data is written can be limited (option
+ * gdk_sync_maxrate, in MiB per second) so that a large checkpoint
+ * does not starve concurrent queries of I/O bandwidth.  The BBP.dir
+ * entries are written afterwards, in the original order.
  */
+struct syncbat {
+	bat bid;
+	BUN size;
+	BAT *b;			/* non-NULL if heaps need to be saved */
+	bool persistent;	/* bi is valid */
+	BATiter bi;
+};
+
+struct syncjobs {
+	struct syncbat *bats;
+	int cnt;		/* number of entries in bats */
+	bool lock;		/* whether to use the swap locks */
+	lng t0;			/* start time of the save phase */
+	lng maxrate;		/* max bytes written per second, 0: no max */
+	lng nbytes;		/* total bytes to be written */
+	int nsave;		/* number of bats to be saved */
+	ATOMIC_TYPE next;	/* next entry to be handled */
+	ATOMIC_TYPE written;	/* bytes written so far */
+	ATOMIC_TYPE saved;	/* number of bats saved so far */
+	ATOMIC_TYPE report;	/* time of last progress report */
+	ATOMIC_TYPE failed;
+};
+
+static inline lng
+syncbat_size(const struct syncbat *sb)
+{
+	lng sz = 0;
+	if (!sb->bi.copiedtodisk || sb->bi.hdirty)
+		sz += (lng) sb->bi.hfree;
+	if (sb->bi.vh && (!sb->bi.copiedtodisk || sb->bi.vhdirty))
+		sz += (lng) sb->bi.vhfree;
+	return sz;
+}
+
+static gdk_return
+BBPsync_save(struct syncjobs *jobs, struct syncbat *sb)
+{
+	bat i = sb->bid;
+	lng sz = syncbat_size(sb);
+	gdk_return ret;
+
+	if (jobs->maxrate > 0) {
+		/* wait until we are allowed to write more */
+		lng written = (lng) ATOMIC_ADD(&jobs->written, sz) - sz;
+		lng due = jobs->t0 + written * 1000000 / jobs->maxrate;
+		lng now = GDKusec();
+		if (due > now && !GDKexiting())
+			MT_sleep_ms((unsigned int) ((due - now) / 1000));
+	} else {
+		ATOMIC_ADD(&jobs->written, sz);
+	}
+
+	/* wait for BBPSAVING so that we can set it, wait for
+	 * BBPUNLOADING before attempting to save */
+	for (;;) {
+		if (jobs->lock)
+			MT_lock_set(&GDKswapLock(i));
+		if (!(BBP_status(i) & (BBPSAVING|BBPUNLOADING)))
+			break;
+		if (jobs->lock)
+			MT_lock_unset(&GDKswapLock(i));
+		BBPspin(i, __func__, BBPSAVING|BBPUNLOADING);
+	}
+	BBP_status_on(i, BBPSAVING);
+	if (jobs->lock)
+		MT_lock_unset(&GDKswapLock(i));
+	ret = BATsave_iter(sb->b, &sb->bi, sb->size);
+	BBP_status_off(i, BBPSAVING);
+
+	/* report progress at most every 10 seconds */
+	int saved = (int) ATOMIC_INC(&jobs->saved);
+	lng now = GDKusec();
+	ATOMIC_BASE_TYPE last = ATOMIC_GET(&jobs->report);
+	if (now - (lng) last >= 10 * 1000000 &&
+	    ATOMIC_CAS(&jobs->report, &last, now))
+		TRC_INFO(IO_, "saved %d of %d bats, " LLFMT " of " LLFMT " MiB\n",
+			 saved, jobs->nsave,
+			 (lng) ATOMIC_GET(&jobs->written) >> 20,
+			 jobs->nbytes >> 20);
+	return ret;
+}
+
+static void
+BBPsync_jobs(struct syncjobs *jobs)
+{
+	for (;;) {
+		int idx = (int) ATOMIC_INC(&jobs->next) - 1;
+		if (idx >= jobs->cnt || ATOMIC_GET(&jobs->failed))
+			break;
+		if (jobs->bats[idx].b != NULL &&
+		    BBPsync_save(jobs, &jobs->bats[idx]) != GDK_SUCCEED)
+			ATOMIC_SET(&jobs->failed, 1);
+	}
+}
+
+static void
+BBPsync_worker(void *arg)
+{
+	MT_thread_setworking("saving heaps");
+	BBPsync_jobs(arg);
+}
+
+/* save the heaps of all bats that need it, using a number of threads */
+static gdk_return
+BBPsync_heaps(struct syncjobs *jobs)
+{
+	int nthreads = GDKgetenv_int("gdk_sync_threads", GDKnr_threads < 4 ? GDKnr_threads : 4);
+	lng maxrate = GDKgetenv_int("gdk_sync_maxrate", 0);
+
+	jobs->maxrate = maxrate > 0 ? maxrate << 20 : 0;
+	jobs->t0 = GDKusec();
+	ATOMIC_SET(&jobs->report, jobs->t0);
+	if (nthreads > jobs->nsave)
+		nthreads = jobs->nsave;
+
+	/* the current thread is one of the workers; if we cannot get
+	 * (all) extra threads, we just do with fewer */
+	MT_Id *tids = NULL;
+	int nstarted = 0;
+	if (nthreads > 1 && (tids = GDKmalloc((nthreads - 1) * sizeof(MT_Id))) != NULL) {
+		for (int t = 0; t < nthreads - 1; t++) {
+			char name[MT_NAME_LEN];
+			snprintf(name, sizeof(name), "syncheaps%d", t);
+			if (MT_create_thread(&tids[t], BBPsync_worker, jobs, MT_THR_JOINABLE, name) < 0)
+				break;
+			nstarted++;
+		}
+	}
+	if (nstarted < nthreads - 1)
+		GDKclrerr();
+	BBPsync_jobs(jobs);
+	for (int t = 0; t < nstarted; t++)
+		MT_join_thread(tids[t]);
+	GDKfree(tids);
+
+	TRC_DEBUG(PERF, "saved %d bats, " LLFMT " bytes using %d threads in " LLFMT " usec\n",
+		  jobs->nsave, jobs->nbytes, nstarted + 1, GDKusec() - jobs->t0);
+	if (ATOMIC_GET(&jobs->failed)) {
+		if (nstarted > 0)
+			GDKerror("saving heaps failed\n");
+		return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+}
+
 gdk_return
 BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 {
@@ -3866,6 +4038,9 @@ BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 	char buf[3000];
 	int n = subcommit ? 0 : -1;
 	FILE *obbpf, *nbbpf;
+	struct syncjobs jobs = {
+		.lock = lock,
+	};
 
 	if ((bakdir = GDKfilepath(0, NULL, subcommit ? SUBDIR : BAKDIR, NULL)) == NULL)
 		return GDK_FAIL;
@@ -3873,6 +4048,12 @@ BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 		GDKfree(bakdir);
 		return GDK_FAIL;
 	}
+	if (cnt > 1 &&
+	    (jobs.bats = GDKmalloc((cnt - 1) * sizeof(struct syncbat))) == NULL) {
+		GDKfree(bakdir);
+		GDKfree(deldir);
+		return GDK_FAIL;
+	}
 
 	TRC_DEBUG_IF(PERF) t0 = t1 = GDKusec();
 
@@ -3885,10 +4066,12 @@ BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 		ret = BBPdir_first(subcommit != NULL, logno, &obbpf, &nbbpf);
 	}
 
+	/* first pass: make backups of the bats and remember what needs
+	 * to be saved */
 	for (int idx = 1; ret == GDK_SUCCEED && idx < cnt; idx++) {
 		bat i = subcommit ? subcommit[idx] : idx;
 		BUN size = sizes ? sizes[idx] : BUN_NONE;
-		BATiter bi, *bip;
+		struct syncbat *sb = &jobs.bats[jobs.cnt];
 
 		const bat bid = i;
 		if (lock)
@@ -3956,10 +4139,17 @@ BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 		if (ret != GDK_SUCCEED)
 			break;
 
+		*sb = (struct syncbat) {
+			.bid = i,
+		};
+		jobs.cnt++;
 		if (BBP_status(i) & BBPPERSISTENT) {
+			BATiter bi;
 			MT_lock_set(&BBP_desc(i)->theaplock);
 			bi = bat_iterator_nolock(BBP_desc(i));
 			bat_iterator_incref(&bi);
+			sb->bi = bi;
+			sb->persistent = true;
 			assert(sizes == NULL || size <= bi.count);
 			assert(sizes == NULL || bi.width == 0 || (bi.type == TYPE_msk ? ((size + 31) / 32) * 4 : size << bi.shift) <= bi.hfree);
 			if (size > bi.count) /* includes sizes==NULL */
@@ -3978,32 +4168,30 @@ BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 				}
 			}
 			MT_lock_unset(&bi.b->theaplock);
+			sb->size = size;
 			if (ret == GDK_SUCCEED && b && size != 0) {
-				/* wait for BBPSAVING so that we
-				 * can set it, wait for
-				 * BBPUNLOADING before
-				 * attempting to save */
-				for (;;) {
-					if (lock)
-						MT_lock_set(&GDKswapLock(i));
-					if (!(BBP_status(i) & (BBPSAVING|BBPUNLOADING)))
-						break;
-					if (lock)
-						MT_lock_unset(&GDKswapLock(i));
-					BBPspin(i, __func__, BBPSAVING|BBPUNLOADING);
-				}
-				BBP_status_on(i, BBPSAVING);
-				if (lock)
-					MT_lock_unset(&GDKswapLock(i));
-				ret = BATsave_iter(b, &bi, size);
-				BBP_status_off(i, BBPSAVING);
+				sb->b = b;
+				jobs.nsave++;
+				jobs.nbytes += syncbat_size(sb);
 			}
-			bip = &bi;
 		} else {
-			bip = NULL;
+			sb->size = size;
 		}
+	}
+
+	/* second pass: save the heaps */
+	if (ret == GDK_SUCCEED && jobs.nsave > 0)
+		ret = BBPsync_heaps(&jobs);
+
+	TRC_DEBUG(PERF, "write time "LLFMT" usec\n", (t0 = GDKusec()) - t1);
+
+	/* third pass: write the BBP.dir entries */
+	for (int idx = 0; idx < jobs.cnt; idx++) {
+		struct syncbat *sb = &jobs.bats[idx];
+		BATiter *bip = sb->persistent ? &sb->bi : NULL;
+
 		if (ret == GDK_SUCCEED) {
-			n = BBPdir_step(i, size, n, buf, sizeof(buf), &obbpf, nbbpf, bip);
+			n = BBPdir_step(sb->bid, sb->size, n, buf, sizeof(buf), &obbpf, nbbpf, bip);
 			if (n < -1)
 				ret = GDK_FAIL;
 		}
@@ -4011,8 +4199,7 @@ BBPsync(int cnt, bat *restrict subcommit, BUN *restrict sizes, lng logno)
 			bat_iterator_end(bip);
 		/* we once again have a saved heap */
 	}
-
-	TRC_DEBUG(PERF, "write time "LLFMT" usec\n", (t0 = GDKusec()) - t1);
+	GDKfree(jobs.bats);
 
 	if (ret == GDK_SUCCEED) {
 		ret = BBPdir_last(n, buf, sizeof(buf), obbpf, nbbpf);
@@ -39,6 +39,7 @@ static gdk_return log_del_bat(logger *lg, log_bid bid);
 #define LOG_SEQ		7
 #define LOG_CLEAR	8	/* DEPRECATED */
 #define LOG_BAT_GROUP	9
+#define LOG_UPDATE_BULK_COMPRESSED	10
 
 #ifdef NATIVE_WIN32
 #define getfilepos _ftelli64
@@ -65,8 +66,20 @@ static const char *log_commands[] = {
 	"LOG_SEQ",
 	"",			/* LOG_CLEAR IS DEPRECATED */
 	"LOG_BAT_GROUP",
+	"LOG_UPDATE_BULK_COMPRESSED",
 };
 
+/* compression methods for the payload of LOG_UPDATE_BULK_COMPRESSED
+ * records; the values are stored in the log files */
+#define LOG_COMPRESS_NONE	0
+#define LOG_COMPRESS_GZ		1
+#define LOG_COMPRESS_LZ4	2
+#define LOG_COMPRESS_XZ		3
+#define LOG_COMPRESS_BZ2	4
+
+/* bulk records with fewer values are never compressed */
+#define LOG_COMPRESS_MIN	4096
+
 typedef struct logaction {
 	int type;		/* type of change */
 	lng nr;
@@ -308,6 +321,130 @@ log_read_id(logger *lg, log_id *id)
 }
 #endif
 
+/*
+ * The payload of a LOG_UPDATE_BULK_COMPRESSED record is written
+ * through one of the compressing streams of the stream library.  The
+ * compressed bytes are stored in the log file as a sequence of frames
+ * ([lng length][bytes]) terminated by a zero length frame, so that
+ * when reading we never consume data beyond the end of the record.
+ */
+typedef struct log_frame {
+	stream *s;		/* the log file */
+	lng left;		/* bytes left in the current frame */
+	bool eof;		/* terminating frame was read */
+} log_frame;
+
+static ssize_t
+log_frame_read(void *restrict priv, void *restrict buf, size_t elmsize, size_t cnt)
+{
+	log_frame *f = priv;
+	size_t sz = elmsize * cnt;
+	ssize_t n;
+
+	assert(elmsize == 1);
+	if (f->left == 0) {
+		if (f->eof)
+			return 0;
+		if (mnstr_readLng(f->s, &f->left) != 1 || f->left < 0)
+			return -1;
+		if (f->left == 0) {
+			f->eof = true;
+			return 0;
+		}
+	}
+	if (sz > (size_t) f->left)
+		sz = (size_t) f->left;
+	if ((n = mnstr_read(f->s, buf, 1, sz)) <= 0)
+		return -1;
+	f->left -= n;
+	return n;
+}
+
+static ssize_t
+log_frame_write(void *restrict priv, const void *restrict buf, size_t elmsize, size_t cnt)
+{
+	stream *s = priv;
+	size_t sz = elmsize * cnt;
+
+	if (sz == 0)
+		return (ssize_t) cnt;
+	if (!mnstr_writeLng(s, (lng) sz) ||
+	    mnstr_write(s, buf, sz, 1) != 1)
+		return -1;
+	return (ssize_t) cnt;
+}
+
+static void
+log_frame_close(void *priv)
+{
+	/* errors show up on the log stream itself */
+	(void) mnstr_writeLng((stream *) priv, 0);
+}
+
+/* wrap the frame stream in a (de)compressing stream, on failure the
+ * frame stream is destroyed */
+static stream *
+log_compress_stream(stream *fs, bte method, int level)
+{
+	stream *s = NULL;
+
+	if (fs == NULL)
+		return NULL;
+	mnstr_set_binary(fs, true);
+	switch (method) {
+	case LOG_COMPRESS_GZ:
+		s = gz_stream(fs, level);
+		break;
+	case LOG_COMPRESS_LZ4:
+		s = lz4_stream(fs, level);
+		break;
+	case LOG_COMPRESS_XZ:
+		s = xz_stream(fs, level);
+		break;
+	case LOG_COMPRESS_BZ2:
+		s = bz2_stream(fs, level);
+		break;
+	default:
+		break;
+	}
+	if (s == NULL)
+		mnstr_destroy(fs);
+	return s;
+}
+
+/* start writing a compressed payload, returns NULL if that is not
+ * possible (the payload is then written uncompressed) */
+static stream *
+log_open_compressor(logger *lg)
+{
+	stream *fs = callback_stream(lg->current->output_log, NULL,
+				     log_frame_write, log_frame_close, NULL,
+				     "log_frame");
+	stream *s = log_compress_stream(fs, lg->compression, lg->compression_level);
+	if (s == NULL) {
+		TRC_WARNING(GDK, "cannot create compressing stream, switching off WAL compression\n");
+		lg->compression = LOG_COMPRESS_NONE;
+	}
+	return s;
+}
+
+/* finish the compressed payload, writing the terminating frame */
+static gdk_return
+log_close_compressor(logger *lg, bool flush)
+{
+	gdk_return ok = GDK_SUCCEED;
+
+	if (flush) {
+		mnstr_close(lg->wcomp);
+		if (mnstr_errnr(lg->wcomp) != MNSTR_NO__ERROR ||
+		    mnstr_errnr(lg->current->output_log) != MNSTR_NO__ERROR)
+			ok = GDK_FAIL;
+	}
+	mnstr_destroy(lg->wcomp);
+	lg->wcomp = NULL;
+	return ok;
+}
+
 static log_return
 string_reader(logger *lg, BAT *b, lng nr)
 {
@@ -381,14 +518,26 @@ log_read_updates(logger *lg, trans *tr, logformat *l, log_id id, BAT **cands)
 	lng nr, pnr;
 	bte type_id = -1;
 	int tpe;
+	logformat lf;
+	stream *input_log = NULL; /* log file while reading compressed payload */
+	log_frame frame;
 
 	assert(!lg->inmemory);
 	TRC_DEBUG(WAL, "found %d %s", id, l->flag == LOG_UPDATE ? "update" : "update_buld");
 
+	if (l->flag == LOG_UPDATE_BULK_COMPRESSED) {
+		/* apart from the payload, this is a normal bulk update */
+		lf = *l;
+		lf.flag = LOG_UPDATE_BULK;
+		l = &lf;
+		input_log = lg->input_log;
+	}
+
 	if (mnstr_readLng(lg->input_log, &nr) != 1 ||
 	    mnstr_read(lg->input_log, &type_id, 1, 1) != 1) {
 		TRC_CRITICAL(GDK, "read failed\n");
-		return LOG_EOF;
+		res = LOG_EOF;
+		goto bailout;
 	}
 
 	pnr = nr;
@@ -404,14 +553,16 @@ log_read_updates(logger *lg, trans *tr, logformat *l, log_id id, BAT **cands)
 			uid = COLnew(0, TYPE_oid, (BUN) nr, PERSISTENT);
 			if (uid == NULL) {
 				TRC_CRITICAL(GDK, "creating bat failed\n");
-				return LOG_ERR;
+				res = LOG_ERR;
+				goto bailout;
 			}
 		}
 
 		if (l->flag == LOG_UPDATE_CONST) {
 			if (mnstr_readLng(lg->input_log, &offset) != 1) {
 				TRC_CRITICAL(GDK, "read failed\n");
-				return LOG_EOF;
+				res = LOG_EOF;
+				goto bailout;
 			}
 			if (cands) {
 				/* This const range actually represents a segment of candidates corresponding to updated bat entries */
@@ -454,7 +605,7 @@ log_read_updates(logger *lg, trans *tr, logformat *l, log_id id, BAT **cands)
 					TRC_CRITICAL(GDK, "read failed\n");
 					res = LOG_EOF;
 				}
-				return res;
+				goto bailout;
 			}
 		}
 
@@ -463,7 +614,8 @@ log_read_updates(logger *lg, trans *tr, logformat *l, log_id id, BAT **cands)
 			if (r == NULL) {
 				if (uid)
 					BBPreclaim(uid);
-				return LOG_ERR;
+				res = LOG_ERR;
+				goto bailout;
 			}
 		}
 
@@ -490,7 +642,25 @@ log_read_updates(logger *lg, trans *tr, logformat *l, log_id id, BAT **cands)
 				if (r)
 					BBPreclaim(r);
 				TRC_CRITICAL(GDK, "read failed\n");
-				return LOG_EOF;
+				res = LOG_EOF;
+				goto bailout;
+			}
+			if (input_log) {
+				bte method;
+				stream *s = NULL;
+
+				frame = (log_frame) {
+					.s = input_log,
+				};
+				if (mnstr_read(input_log, &method, 1, 1) != 1 ||
+				    (s = log_compress_stream(callback_stream(&frame, log_frame_read, NULL, NULL, NULL, "log_frame"), method, 0)) == NULL) {
+					if (r)
+						BBPreclaim(r);
+					TRC_CRITICAL(GDK, "cannot read compressed payload\n");
+					res = LOG_ERR;
+					goto bailout;
+				}
+				lg->input_log = s;
 			}
 			if (tpe == TYPE_msk) {
 				if (r) {
@@ -682,6 +852,28 @@ log_read_updates(logger *lg, trans *tr, logformat *l, log_id id, BAT **cands)
 		TRC_CRITICAL(GDK, "unknown type\n");
 		res = LOG_ERR;
 	}
+  bailout:
+	/* restore the log file, also on errors */
+	if (input_log && lg->input_log != input_log) {
+		/* skip to the end of the compressed payload */
+		ssize_t n;
+		while (res == LOG_OK &&
+		       (n = mnstr_read(lg->input_log, lg->rbuf, 1, lg->rbufsize)) != 0) {
+			if (n < 0) {
+				TRC_CRITICAL(GDK, "read failed\n");
+				res = LOG_EOF;
+			}
+		}
+		while (res == LOG_OK &&
+		       (n = log_frame_read(&frame, lg->rbuf, 1, lg->rbufsize)) != 0) {
+			if (n < 0) {
+				TRC_CRITICAL(GDK, "read failed\n");
+				res = LOG_EOF;
+			}
+		}
+		close_stream(lg->input_log);
+		lg->input_log = input_log;
+	}
 	return res;
 }
 
@@ -1271,6 +1463,7 @@ log_read_transaction(logger *lg, uint32_t *updated, BUN maxupdated)
 		switch (l.flag) {
 		case LOG_UPDATE_CONST:
 		case LOG_UPDATE_BULK:
+		case LOG_UPDATE_BULK_COMPRESSED:
 		case LOG_UPDATE:
 		case LOG_CREATE:
 		case LOG_DESTROY:
@@ -1350,6 +1543,7 @@ log_read_transaction(logger *lg, uint32_t *updated, BUN maxupdated)
 			break;
 		case LOG_UPDATE_CONST:
 		case LOG_UPDATE_BULK:
+		case LOG_UPDATE_BULK_COMPRESSED:
 		case LOG_UPDATE:
 			if (tr == NULL)
 				err = LOG_EOF;
@@ -2357,6 +2551,21 @@ log_new(int debug, const char *fn, const char *logdir, int version, preversionfi
 		max_file_size = max_file_size_str ? strtoul(max_file_size_str, NULL, 10) : 2147483648;
 	}
 
+	const char *compression_str = GDKgetenv("wal_compression");
+	bte compression = LOG_COMPRESS_NONE;
+	if (compression_str == NULL || strcmp(compression_str, "none") == 0)
+		compression = LOG_COMPRESS_NONE;
+	else if (strcmp(compression_str, "gz") == 0)
+		compression = LOG_COMPRESS_GZ;
+	else if (strcmp(compression_str, "lz4") == 0)
+		compression = LOG_COMPRESS_LZ4;
+	else if (strcmp(compression_str, "xz") == 0)
+		compression = LOG_COMPRESS_XZ;
+	else if (strcmp(compression_str, "bz2") == 0)
+		compression = LOG_COMPRESS_BZ2;
+	else
+		TRC_WARNING(GDK, "unknown wal_compression method %s, not compressing\n", compression_str);
+
 	if (!GDKinmemory(0) && MT_path_absolute(logdir)) {
 		TRC_CRITICAL(GDK, "logdir must be relative path\n");
 		return NULL;
@@ -2395,6 +2604,8 @@ log_new(int debug, const char *fn, const char *logdir, int version, preversionfi
 		.rbuf = GDKmalloc(64 * 1024),
 		.wbufsize = 64 * 1024,
 		.wbuf = GDKmalloc(64 * 1024),
+		.compression = compression,
+		.compression_level = GDKgetenv_int("wal_compression_level", 0),
 	};
 
 	/* probably open file and check version first, then call call old logger code */
@@ -2833,7 +3044,7 @@ log_constant(logger *lg, int type, ptr val, log_id id, lng offset, lng cnt)
 }
 
 static gdk_return
-string_writer(logger *lg, BAT *b, lng offset, lng nr)
+string_writer(logger *lg, stream *out, BAT *b, lng offset, lng nr)
 {
 	size_t bufsz = lg->wbufsize, resize = 0;
 	BUN end = (BUN) (offset + nr);
@@ -2842,8 +3053,8 @@ string_writer(logger *lg, BAT *b, lng offset, lng nr)
 
 	if (!buf)
 		return GDK_FAIL;
-	assert(mnstr_errnr(lg->current->output_log) == MNSTR_NO__ERROR);
-	if (mnstr_errnr(lg->current->output_log) != MNSTR_NO__ERROR)
+	assert(mnstr_errnr(out) == MNSTR_NO__ERROR);
+	if (mnstr_errnr(out) != MNSTR_NO__ERROR)
 		return GDK_FAIL;
 	BATiter bi = bat_iterator(b);
 	BUN p = (BUN) offset;
@@ -2873,8 +3084,8 @@ string_writer(logger *lg, BAT *b, lng offset, lng nr)
 			}
 		}
 		if (sz &&
-		    (!mnstr_writeLng(lg->current->output_log, (lng) sz) ||
-		     mnstr_write(lg->current->output_log, buf, sz, 1) != 1)) {
+		    (!mnstr_writeLng(out, (lng) sz) ||
+		     mnstr_write(out, buf, sz, 1) != 1)) {
 			res = GDK_FAIL;
 			break;
 		}
@@ -2910,14 +3121,21 @@ internal_log_bat(logger *lg, BAT *b, log_id id, lng offset, lng cnt, int sliced,
 		goto bailout;
 	}
 
-	if (lg->total_cnt == 0)	/* signals single bulk message or first part of bat logged in parts */
+	if (lg->total_cnt == 0) {	/* signals single bulk message or first part of bat logged in parts */
+		assert(lg->wcomp == NULL);
+		if (lg->compression != LOG_COMPRESS_NONE &&
+		    (total_cnt ? total_cnt : cnt) >= LOG_COMPRESS_MIN &&
+		    (lg->wcomp = log_open_compressor(lg)) != NULL)
+			l.flag = LOG_UPDATE_BULK_COMPRESSED;
 		if (log_write_format(lg, &l) != GDK_SUCCEED ||
 		    !mnstr_writeLng(lg->current->output_log, total_cnt ? total_cnt : cnt) ||
 		    mnstr_write(lg->current->output_log, &tpe, 1, 1) != 1 ||
-		    !mnstr_writeLng(lg->current->output_log, total_cnt ? -1 : offset)) {	/* offset = -1 indicates bat was logged in parts */
+		    !mnstr_writeLng(lg->current->output_log, total_cnt ? -1 : offset) ||	/* offset = -1 indicates bat was logged in parts */
+		    (lg->wcomp && mnstr_write(lg->current->output_log, &lg->compression, 1, 1) != 1)) {
 			ok = GDK_FAIL;
 			goto bailout;
 		}
+	}
 	if (!total_cnt)
 		total_cnt = cnt;
 	lg->total_cnt += cnt;
@@ -2925,13 +3143,16 @@ internal_log_bat(logger *lg, BAT *b, log_id id, lng offset, lng cnt, int sliced,
 	if (lg->total_cnt == total_cnt)	/* This is the last to be logged part of this bat, we can already reset the total_cnt */
 		lg->total_cnt = 0;
 
+	/* the compressed payload of a bat logged in parts spans all parts */
+	stream *out = lg->wcomp ? lg->wcomp : lg->current->output_log;
+
 	/* if offset is just for the log, but BAT is already sliced, reset offset */
 	if (sliced)
 		offset = 0;
 	if (b->ttype == TYPE_msk) {
 		BATiter bi = bat_iterator(b);
 		if (offset % 32 == 0) {
-			if (!mnstr_writeIntArray(lg->current->output_log, (int *) ((char *) bi.base + offset / 32),
+			if (!mnstr_writeIntArray(out, (int *) ((char *) bi.base + offset / 32),
 			     (size_t) ((nr + 31) / 32)))
 				ok = GDK_FAIL;
 		} else {
@@ -2939,7 +3160,7 @@ internal_log_bat(logger *lg, BAT *b, log_id id, lng offset, lng cnt, int sliced,
 				uint32_t v = 0;
 				for (int j = 0; j < 32 && i + j < nr; j++)
 					v |= (uint32_t) Tmskval(&bi, (BUN) (offset + i + j)) << j;
-				if (!mnstr_writeInt(lg->current->output_log, (int) v)) {
+				if (!mnstr_writeInt(out, (int) v)) {
 					ok = GDK_FAIL;
 					break;
 				}
@@ -2950,26 +3171,30 @@ internal_log_bat(logger *lg, BAT *b, log_id id, lng offset, lng cnt, int sliced,
 		BATiter bi = bat_iterator(b);
 		const void *t = BUNtail(bi, (BUN) offset);
 
-		ok = wt(t, lg->current->output_log, (size_t) nr);
+		ok = wt(t, out, (size_t) nr);
 		bat_iterator_end(&bi);
 	} else if (b->ttype == TYPE_str) {
 		/* efficient string writes */
-		ok = string_writer(lg, b, offset, nr);
+		ok = string_writer(lg, out, b, offset, nr);
 	} else {
 		BATiter bi = bat_iterator(b);
 		BUN end = (BUN) (offset + nr);
 		for (p = (BUN) offset; p < end && ok == GDK_SUCCEED; p++) {
 			const void *t = BUNtail(bi, p);
 
-			ok = wt(t, lg->current->output_log, 1);
+			ok = wt(t, out, 1);
 		}
 		bat_iterator_end(&bi);
 	}
+	if (lg->wcomp && lg->total_cnt == 0 && ok == GDK_SUCCEED)
+		ok = log_close_compressor(lg, true);
 
 	TRC_DEBUG(WAL, "Logged %d " LLFMT " inserts\n", id, nr);
 
   bailout:
 	if (ok != GDK_SUCCEED) {
+		if (lg->wcomp)
+			(void) log_close_compressor(lg, false);
 		ATOMIC_DEC(&lg->current->refcount);
 		const char *err = mnstr_peek_error(lg->current->output_log);
 		TRC_CRITICAL(GDK, "write failed%s%s\n", err ? ": " : "", err ? err : "");
@@ -3149,7 +3374,7 @@ log_delta(logger *lg, BAT *uid, BAT *uval, log_id id)
 		ok = wt(t, lg->current->output_log, (size_t) nr);
 	} else if (uval->ttype == TYPE_str) {
 		/* efficient string writes */
-		ok = string_writer(lg, uval, 0, nr);
+		ok = string_writer(lg, lg->current->output_log, uval, 0, nr);
 	} else {
 		for (p = 0; p < BATcount(uid) && ok == GDK_SUCCEED; p++) {
 			const void *val = BUNtail(vi, p);
@@ -54,6 +54,10 @@ struct logger {
 	lng file_age;           /* log file age */
 	lng max_file_age;       /* default 10 mins */
 	lng max_file_size;      /* default 2 GiB */
+	bte compression;	/* compression method for bulk updates */
+	int compression_level;
+	stream *wcomp;		/* compressing stream of bulk update
+				 * being written */
 
 	// synchronized by combination of store->flush and rotation_lock
 	ulng id;		/* current log output file id */
@@ -0,0 +1,802 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+/*
+ * Run length encoding
+ *
+ * A run length encoded column is represented by two BATs.  The bounds
+ * BAT (of type oid) contains for each run the oid of its first row,
+ * followed by one extra entry with the oid just past the last row, so
+ * run i covers the rows [bounds[i], bounds[i+1]).  The rows covered by
+ * a bounds BAT are consecutive.  The values BAT contains the value of
+ * each run: the value of run i is found at head oid hseqbase(bounds)+i
+ * of the values BAT.  This way a range of runs can be sliced from the
+ * bounds without touching the values.
+ *
+ * The operators below work on the runs.  Only where the result is
+ * inherently per row (the decoded column and the candidate lists
+ * produced by the selections) do they produce output per row.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_calc_private.h"
+
+static bool
+rle_check(BAT *b, BAT *v)
+{
+	if (b->ttype != TYPE_oid || BATcount(b) == 0 ||
+	    b->hseqbase < v->hseqbase ||
+	    b->hseqbase + BATcount(b) - 1 > v->hseqbase + BATcount(v)) {
+		GDKerror("inconsistent run length encoding.\n");
+		return false;
+	}
+	return true;
+}
+
+/* the values of the runs of b, with the head oids of the runs */
+static BAT *
+rle_values(BAT *b, BAT *v)
+{
+	BUN off = b->hseqbase - v->hseqbase;
+
+	return BATslice(v, off, off + BATcount(b) - 1);
+}
+
+/* find the run that contains row o */
+static inline BUN
+rle_find(const oid *bnd, BUN nruns, oid o)
+{
+	BUN lo = 0, hi = nruns;
+
+	while (hi - lo > 1) {
+		BUN mid = (lo + hi) / 2;
+		if (bnd[mid] <= o)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static inline gdk_return
+rle_newrun(BAT *bn, BAT *vn, oid o, const void *v)
+{
+	if (BUNappend(bn, &o, false) != GDK_SUCCEED ||
+	    BUNappend(vn, v, false) != GDK_SUCCEED)
+		return GDK_FAIL;
+	return GDK_SUCCEED;
+}
+
+#define RLE_ENCODE(TYPE)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) bi.base;	\
+		for (BUN p = 0; p < bi.count; p++) {			\
+			if (p > 0 &&					\
+			    (vals[p] == vals[p - 1] ||			\
+			     (is_##TYPE##_nil(vals[p]) && is_##TYPE##_nil(vals[p - 1])))) \
+				continue;				\
+			if (rle_newrun(bn, vn, b->hseqbase + p, &vals[p]) != GDK_SUCCEED) \
+				goto bailout;				\
+		}							\
+	} while (0)
+
+/* Run length encode the column b.  The bounds are returned in
+ * *boundsp and the values of the runs in *valuesp. */
+gdk_return
+BATrleencode(BAT **boundsp, BAT **valuesp, BAT *b)
+{
+	BAT *bn, *vn;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, GDK_FAIL);
+	if (b->ttype == TYPE_void) {
+		GDKerror("cannot run length encode a void column.\n");
+		return GDK_FAIL;
+	}
+	bn = COLnew(0, TYPE_oid, 1024, TRANSIENT);
+	vn = COLnew(0, b->ttype, 1024, TRANSIENT);
+	if (bn == NULL || vn == NULL) {
+		BBPreclaim(bn);
+		BBPreclaim(vn);
+		return GDK_FAIL;
+	}
+
+	BATiter bi = bat_iterator(b);
+	switch (ATOMbasetype(bi.type)) {
+	case TYPE_bte:
+		RLE_ENCODE(bte);
+		break;
+	case TYPE_sht:
+		RLE_ENCODE(sht);
+		break;
+	case TYPE_int:
+		RLE_ENCODE(int);
+		break;
+	case TYPE_lng:
+		RLE_ENCODE(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		RLE_ENCODE(hge);
+		break;
+#endif
+	case TYPE_flt:
+		RLE_ENCODE(flt);
+		break;
+	case TYPE_dbl:
+		RLE_ENCODE(dbl);
+		break;
+	default: {
+		int (*cmp)(const void *, const void *) = ATOMcompare(bi.type);
+		const void *prev = NULL;
+
+		for (BUN p = 0; p < bi.count; p++) {
+			const void *val = BUNtail(bi, p);
+			if (prev && cmp(prev, val) == 0)
+				continue;
+			if (rle_newrun(bn, vn, b->hseqbase + p, val) != GDK_SUCCEED)
+				goto bailout;
+			prev = val;
+		}
+		break;
+	}
+	}
+	oid o = b->hseqbase + bi.count;
+	if (BUNappend(bn, &o, false) != GDK_SUCCEED)
+		goto bailout;
+	bat_iterator_end(&bi);
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT " -> bounds=" ALGOBATFMT
+		  ",values=" ALGOBATFMT " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(bn), ALGOBATPAR(vn),
+		  GDKusec() - t0);
+	*boundsp = bn;
+	*valuesp = vn;
+	return GDK_SUCCEED;
+
+  bailout:
+	bat_iterator_end(&bi);
+	BBPreclaim(bn);
+	BBPreclaim(vn);
+	return GDK_FAIL;
+}
+
+#define RLE_DECODE(TYPE)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) vi.base;	\
+		TYPE *restrict dst = (TYPE *) Tloc(bn, 0);		\
+		for (BUN k = 0; k < nruns; k++) {			\
+			TYPE val = vals[k + off];			\
+			for (oid o = bnd[k]; o < bnd[k + 1]; o++)	\
+				*dst++ = val;				\
+		}							\
+	} while (0)
+
+/* Expand the runs into a column. */
+BAT *
+BATrledecode(BAT *b, BAT *v)
+{
+	BAT *bn = NULL;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, NULL);
+	BATcheck(v, NULL);
+	if (!rle_check(b, v))
+		return NULL;
+
+	BATiter bnds = bat_iterator(b);
+	BATiter vi = bat_iterator(v);
+	const oid *bnd = (const oid *) bnds.base;
+	BUN nruns = bnds.count - 1, off = b->hseqbase - v->hseqbase;
+	BUN cnt = bnd[nruns] - bnd[0];
+
+	switch (ATOMbasetype(vi.type)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		bn = COLnew(bnd[0], v->ttype, cnt, TRANSIENT);
+		if (bn == NULL)
+			break;
+		switch (ATOMbasetype(vi.type)) {
+		case TYPE_bte:
+			RLE_DECODE(bte);
+			break;
+		case TYPE_sht:
+			RLE_DECODE(sht);
+			break;
+		case TYPE_int:
+			RLE_DECODE(int);
+			break;
+		case TYPE_lng:
+			RLE_DECODE(lng);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			RLE_DECODE(hge);
+			break;
+#endif
+		case TYPE_flt:
+			RLE_DECODE(flt);
+			break;
+		default:
+			RLE_DECODE(dbl);
+			break;
+		}
+		BATsetcount(bn, cnt);
+		BATnegateprops(bn);
+		/* sorted runs make a sorted column */
+		bn->tsorted = vi.sorted || nruns <= 1;
+		bn->trevsorted = vi.revsorted || nruns <= 1;
+		bn->tkey = (vi.key && cnt == nruns) || cnt <= 1;
+		bn->tnonil = vi.nonil;
+		break;
+	default: {
+		/* project the run of each row, which shares the vheap
+		 * of the values */
+		BAT *map = COLnew(bnd[0], TYPE_oid, cnt, TRANSIENT);
+		if (map == NULL)
+			break;
+		oid *restrict dst = (oid *) Tloc(map, 0);
+		for (BUN k = 0; k < nruns; k++) {
+			for (oid o = bnd[k]; o < bnd[k + 1]; o++)
+				*dst++ = v->hseqbase + k + off;
+		}
+		BATsetcount(map, cnt);
+		map->tsorted = true;
+		map->trevsorted = nruns <= 1;
+		map->tkey = cnt == nruns;
+		map->tnonil = true;
+		map->tnil = false;
+		bn = BATproject(map, v);
+		BBPreclaim(map);
+		break;
+	}
+	}
+	bat_iterator_end(&vi);
+	bat_iterator_end(&bnds);
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",v=" ALGOBATFMT
+		  " -> " ALGOOPTBATFMT " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(v), ALGOOPTBATPAR(bn),
+		  GDKusec() - t0);
+	return bn;
+}
+
+/* Project the run length encoded column (b, v) on the row oids in l.
+ * The result is again run length encoded, in the head space of l:
+ * consecutive entries of l that fall in the same run form a single
+ * run of the result, so a dense l costs time proportional to the
+ * number of runs it overlaps.  Nil oids in l produce nil values. */
+gdk_return
+BATrleproject(BAT **boundsp, BAT **valuesp, BAT *l, BAT *b, BAT *v)
+{
+	BAT *bn, *vn;
+	BUN cur = BUN_NONE, p = 0;
+	bool nilrun = false;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(l, GDK_FAIL);
+	BATcheck(b, GDK_FAIL);
+	BATcheck(v, GDK_FAIL);
+	if (!rle_check(b, v))
+		return GDK_FAIL;
+
+	bn = COLnew(0, TYPE_oid, 1024, TRANSIENT);
+	vn = COLnew(0, v->ttype, 1024, TRANSIENT);
+	if (bn == NULL || vn == NULL) {
+		BBPreclaim(bn);
+		BBPreclaim(vn);
+		return GDK_FAIL;
+	}
+
+	BATiter bnds = bat_iterator(b);
+	BATiter vi = bat_iterator(v);
+	const oid *bnd = (const oid *) bnds.base;
+	const void *nil = ATOMnilptr(v->ttype);
+	BUN nruns = bnds.count - 1, off = b->hseqbase - v->hseqbase;
+	BUN cnt = BATcount(l);
+
+	if (l->ttype == TYPE_void && is_oid_nil(l->tseqbase)) {
+		/* all nil */
+		if (cnt > 0 && rle_newrun(bn, vn, l->hseqbase, nil) != GDK_SUCCEED)
+			goto bailout;
+	} else if (l->ttype == TYPE_void || l->ttype == TYPE_msk || mask_cand(l)) {
+		struct canditer ci;
+
+		canditer_init(&ci, NULL, l);
+		cnt = ci.ncand;
+		while (p < cnt) {
+			oid o = canditer_next(&ci);
+			if (o < bnd[0] || o >= bnd[nruns])
+				goto outofrange;
+			if (cur == BUN_NONE || o >= bnd[cur + 1] || o < bnd[cur])
+				cur = rle_find(bnd, nruns, o);
+			if (rle_newrun(bn, vn, l->hseqbase + p, BUNtail(vi, cur + off)) != GDK_SUCCEED)
+				goto bailout;
+			if (ci.tpe == cand_dense) {
+				/* skip the rest of the run */
+				BUN n = MIN(bnd[cur + 1] - o, cnt - p);
+				p += n;
+				if (n > 1)
+					canditer_setidx(&ci, p);
+			} else {
+				p++;
+				while (p < cnt) {
+					o = canditer_peek(&ci);
+					if (o < bnd[cur] || o >= bnd[cur + 1])
+						break;
+					(void) canditer_next(&ci);
+					p++;
+				}
+			}
+		}
+	} else if (ATOMtype(l->ttype) != TYPE_oid) {
+		GDKerror("left operand must be of type oid\n");
+		goto bailout;
+	} else {
+		BATiter li = bat_iterator(l);
+		const oid *lv = (const oid *) li.base;
+
+		for (p = 0; p < cnt; p++) {
+			oid o = lv[p];
+			if (is_oid_nil(o)) {
+				if (nilrun)
+					continue;
+				if (rle_newrun(bn, vn, l->hseqbase + p, nil) != GDK_SUCCEED) {
+					bat_iterator_end(&li);
+					goto bailout;
+				}
+				nilrun = true;
+				cur = BUN_NONE;
+				continue;
+			}
+			if (o < bnd[0] || o >= bnd[nruns]) {
+				bat_iterator_end(&li);
+				goto outofrange;
+			}
+			if (!nilrun && cur != BUN_NONE && o >= bnd[cur] && o < bnd[cur + 1])
+				continue;
+			if (cur != BUN_NONE && cur + 1 < nruns && o >= bnd[cur + 1] && o < bnd[cur + 2])
+				cur++;
+			else
+				cur = rle_find(bnd, nruns, o);
+			nilrun = false;
+			if (rle_newrun(bn, vn, l->hseqbase + p, BUNtail(vi, cur + off)) != GDK_SUCCEED) {
+				bat_iterator_end(&li);
+				goto bailout;
+			}
+		}
+		bat_iterator_end(&li);
+	}
+	oid o = l->hseqbase + cnt;
+	if (BUNappend(bn, &o, false) != GDK_SUCCEED)
+		goto bailout;
+	bat_iterator_end(&vi);
+	bat_iterator_end(&bnds);
+
+	TRC_DEBUG(ALGO, "l=" ALGOBATFMT ",b=" ALGOBATFMT ",v=" ALGOBATFMT
+		  " -> bounds=" ALGOBATFMT ",values=" ALGOBATFMT
+		  " (" LLFMT " usec)\n",
+		  ALGOBATPAR(l), ALGOBATPAR(b), ALGOBATPAR(v),
+		  ALGOBATPAR(bn), ALGOBATPAR(vn), GDKusec() - t0);
+	*boundsp = bn;
+	*valuesp = vn;
+	return GDK_SUCCEED;
+
+  outofrange:
+	GDKerror("does not match always\n");
+  bailout:
+	bat_iterator_end(&vi);
+	bat_iterator_end(&bnds);
+	BBPreclaim(bn);
+	BBPreclaim(vn);
+	return GDK_FAIL;
+}
+
+/* Turn the selected runs r into the candidate list of their rows,
+ * restricted to the candidates s. */
+static BAT *
+rle_expand(BAT *b, BAT *r, BAT *s)
+{
+	struct canditer ri, ci;
+	BUN cnt = 0;
+	BAT *bn;
+
+	BATiter bnds = bat_iterator(b);
+	const oid *bnd = (const oid *) bnds.base;
+
+	canditer_init(&ri, NULL, r);
+	for (BUN i = 0; i < ri.ncand; i++) {
+		BUN k = canditer_next(&ri) - b->hseqbase;
+		cnt += bnd[k + 1] - bnd[k];
+	}
+	canditer_reset(&ri);
+	if (s) {
+		canditer_init(&ci, NULL, s);
+		if (ci.ncand < cnt)
+			cnt = ci.ncand;
+	}
+	bn = COLnew(0, TYPE_oid, cnt, TRANSIENT);
+	if (bn == NULL) {
+		bat_iterator_end(&bnds);
+		return NULL;
+	}
+	oid *restrict dst = (oid *) Tloc(bn, 0);
+	for (BUN i = 0; i < ri.ncand; i++) {
+		BUN k = canditer_next(&ri) - b->hseqbase;
+		if (s) {
+			BUN lo = canditer_search(&ci, bnd[k], true);
+			BUN hi = canditer_search(&ci, bnd[k + 1], true);
+			canditer_setidx(&ci, lo);
+			for (BUN j = lo; j < hi; j++)
+				*dst++ = canditer_next(&ci);
+		} else {
+			for (oid o = bnd[k]; o < bnd[k + 1]; o++)
+				*dst++ = o;
+		}
+	}
+	bat_iterator_end(&bnds);
+	BATsetcount(bn, (BUN) (dst - (oid *) Tloc(bn, 0)));
+	bn->tsorted = true;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->tkey = true;
+	bn->tnonil = true;
+	bn->tnil = false;
+	return virtualize(bn);
+}
+
+/* Range select on a run length encoded column, the arguments are as
+ * for BATselect.  The values of the runs are selected, and the
+ * qualifying runs are turned into a candidate list. */
+BAT *
+BATrleselect(BAT *b, BAT *v, BAT *s, const void *tl, const void *th,
+	     bool li, bool hi, bool anti, bool nil_matches)
+{
+	BAT *vs, *r, *bn;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, NULL);
+	BATcheck(v, NULL);
+	if (!rle_check(b, v))
+		return NULL;
+	if ((vs = rle_values(b, v)) == NULL)
+		return NULL;
+	r = BATselect(vs, NULL, tl, th, li, hi, anti, nil_matches);
+	BBPunfix(vs->batCacheid);
+	if (r == NULL)
+		return NULL;
+	bn = rle_expand(b, r, s);
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",v=" ALGOBATFMT ",s=" ALGOOPTBATFMT
+		  ",runs=" ALGOBATFMT " -> " ALGOOPTBATFMT
+		  " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(v), ALGOOPTBATPAR(s),
+		  ALGOBATPAR(r), ALGOOPTBATPAR(bn), GDKusec() - t0);
+	BBPunfix(r->batCacheid);
+	return bn;
+}
+
+BAT *
+BATrlethetaselect(BAT *b, BAT *v, BAT *s, const void *val, const char *op)
+{
+	BAT *vs, *r, *bn;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, NULL);
+	BATcheck(v, NULL);
+	if (!rle_check(b, v))
+		return NULL;
+	if ((vs = rle_values(b, v)) == NULL)
+		return NULL;
+	r = BATthetaselect(vs, NULL, val, op);
+	BBPunfix(vs->batCacheid);
+	if (r == NULL)
+		return NULL;
+	bn = rle_expand(b, r, s);
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",v=" ALGOBATFMT ",s=" ALGOOPTBATFMT
+		  ",op=%s,runs=" ALGOBATFMT " -> " ALGOOPTBATFMT
+		  " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(v), ALGOOPTBATPAR(s), op,
+		  ALGOBATPAR(r), ALGOOPTBATPAR(bn), GDKusec() - t0);
+	BBPunfix(r->batCacheid);
+	return bn;
+}
+
+/* Group a run length encoded column.  The groups are returned per run
+ * (with the head oids of the runs, so (b, *groups) is the run length
+ * encoded group column), the extents are row oids and the histogram
+ * counts rows. */
+gdk_return
+BATrlegroup(BAT **groups, BAT **extents, BAT **histo, BAT *b, BAT *v)
+{
+	BAT *vs, *g = NULL, *e = NULL, *en = NULL, *hn = NULL;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, GDK_FAIL);
+	BATcheck(v, GDK_FAIL);
+	if (!rle_check(b, v))
+		return GDK_FAIL;
+	if ((vs = rle_values(b, v)) == NULL)
+		return GDK_FAIL;
+	gdk_return rc = BATgroup(&g, &e, NULL, vs, NULL, NULL, NULL, NULL);
+	BBPunfix(vs->batCacheid);
+	if (rc != GDK_SUCCEED)
+		return rc;
+
+	BATiter bnds = bat_iterator(b);
+	const oid *bnd = (const oid *) bnds.base;
+	BUN nruns = bnds.count - 1, ngrp = BATcount(e);
+
+	en = COLnew(0, TYPE_oid, ngrp, TRANSIENT);
+	if (histo)
+		hn = COLnew(0, TYPE_lng, ngrp, TRANSIENT);
+	if (en == NULL || (histo && hn == NULL))
+		goto bailout;
+	oid *restrict ext = (oid *) Tloc(en, 0);
+	for (BUN i = 0; i < ngrp; i++)
+		ext[i] = bnd[BUNtoid(e, i) - b->hseqbase];
+	BATsetcount(en, ngrp);
+	BATnegateprops(en);
+	en->tnonil = true;
+	if (hn) {
+		lng *restrict cnts = (lng *) Tloc(hn, 0);
+		memset(cnts, 0, ngrp * sizeof(lng));
+		for (BUN k = 0; k < nruns; k++)
+			cnts[BUNtoid(g, k)] += (lng) (bnd[k + 1] - bnd[k]);
+		BATsetcount(hn, ngrp);
+		BATnegateprops(hn);
+		hn->tnonil = true;
+	}
+	bat_iterator_end(&bnds);
+	BBPunfix(e->batCacheid);
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",v=" ALGOBATFMT
+		  " -> groups=" ALGOBATFMT ",extents=" ALGOBATFMT
+		  " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(v),
+		  ALGOBATPAR(g), ALGOBATPAR(en), GDKusec() - t0);
+	*groups = g;
+	*extents = en;
+	if (histo)
+		*histo = hn;
+	return GDK_SUCCEED;
+
+  bailout:
+	bat_iterator_end(&bnds);
+	BBPreclaim(g);
+	BBPreclaim(e);
+	BBPreclaim(en);
+	BBPreclaim(hn);
+	return GDK_FAIL;
+}
+
+/* The group of run k: g contains the groups per run (in the head space
+ * of the runs), without g there is a single group. */
+static inline gdk_return
+rle_group_of(BAT *b, BAT *g, BUN ngrp, BUN k, oid *gid)
+{
+	if (g == NULL) {
+		*gid = 0;
+		return GDK_SUCCEED;
+	}
+	*gid = BUNtoid(g, b->hseqbase + k - g->hseqbase);
+	if (!is_oid_nil(*gid) && *gid >= ngrp) {
+		GDKerror("group id out of range\n");
+		return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+}
+
+/* Count the (not nil) rows per group; g contains the group of each run
+ * or is NULL for a single group. */
+BAT *
+BATrlecount(BAT *b, BAT *v, BAT *g, BUN ngrp, bool skip_nils)
+{
+	BAT *bn;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, NULL);
+	BATcheck(v, NULL);
+	if (!rle_check(b, v))
+		return NULL;
+	if (g && (g->hseqbase > b->hseqbase ||
+		  g->hseqbase + BATcount(g) < b->hseqbase + BATcount(b) - 1)) {
+		GDKerror("groups do not match the runs\n");
+		return NULL;
+	}
+	if ((bn = COLnew(0, TYPE_lng, ngrp, TRANSIENT)) == NULL)
+		return NULL;
+
+	BATiter bnds = bat_iterator(b);
+	BATiter vi = bat_iterator(v);
+	const oid *bnd = (const oid *) bnds.base;
+	const void *nil = ATOMnilptr(vi.type);
+	int (*cmp)(const void *, const void *) = ATOMcompare(vi.type);
+	BUN nruns = bnds.count - 1, off = b->hseqbase - v->hseqbase;
+	lng *restrict cnts = (lng *) Tloc(bn, 0);
+
+	memset(cnts, 0, ngrp * sizeof(lng));
+	for (BUN k = 0; k < nruns; k++) {
+		oid gid;
+		if (rle_group_of(b, g, ngrp, k, &gid) != GDK_SUCCEED) {
+			bat_iterator_end(&vi);
+			bat_iterator_end(&bnds);
+			BBPreclaim(bn);
+			return NULL;
+		}
+		if (is_oid_nil(gid) ||
+		    (skip_nils && !vi.nonil && cmp(BUNtail(vi, k + off), nil) == 0))
+			continue;
+		cnts[gid] += (lng) (bnd[k + 1] - bnd[k]);
+	}
+	bat_iterator_end(&vi);
+	bat_iterator_end(&bnds);
+	BATsetcount(bn, ngrp);
+	BATnegateprops(bn);
+	bn->tnonil = true;
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",v=" ALGOBATFMT ",g=" ALGOOPTBATFMT
+		  " -> " ALGOBATFMT " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(v), ALGOOPTBATPAR(g),
+		  ALGOBATPAR(bn), GDKusec() - t0);
+	return bn;
+}
+
+#define RLE_SUM(TYPE, MULCHECK, ADDCHECK)				\
+	do {								\
+		TYPE *restrict sums = (TYPE *) Tloc(bn, 0);		\
+		const TYPE *restrict vals = (const TYPE *) Tloc(vc, 0);	\
+		for (BUN k = 0; k < nruns; k++) {			\
+			oid gid;					\
+			TYPE x = vals[k], y;				\
+			if (rle_group_of(b, g, ngrp, k, &gid) != GDK_SUCCEED) \
+				goto failed;				\
+			if (is_oid_nil(gid) || seen[gid] == 2)		\
+				continue;				\
+			if (is_##TYPE##_nil(x)) {			\
+				if (!skip_nils) {			\
+					sums[gid] = TYPE##_nil;		\
+					seen[gid] = 2;			\
+				}					\
+				continue;				\
+			}						\
+			MULCHECK(x, (TYPE) (bnd[k + 1] - bnd[k]), y, GDK_##TYPE##_max, goto overflow); \
+			if (seen[gid]) {				\
+				ADDCHECK(sums[gid], y, TYPE, sums[gid], GDK_##TYPE##_max, goto overflow); \
+			} else {					\
+				sums[gid] = y;				\
+				seen[gid] = 1;				\
+			}						\
+		}							\
+		for (BUN i = 0; i < ngrp; i++) {			\
+			if (seen[i] != 1) {				\
+				sums[i] = TYPE##_nil;			\
+				nils = true;				\
+			}						\
+		}							\
+	} while (0)
+
+#define FLTMUL_CHECK(lft, rgt, dst, max, on_overflow)			\
+	do {								\
+		(dst) = (lft) * (rgt);					\
+		if (isinf(dst))						\
+			on_overflow;					\
+	} while (0)
+
+/* Sum the values of the runs per group, each value weighted with the
+ * length of its run; g contains the group of each run or is NULL for a
+ * single group.  The result type tp is one of lng, hge, flt or dbl. */
+BAT *
+BATrlesum(BAT *b, BAT *v, BAT *g, BUN ngrp, int tp, bool skip_nils)
+{
+	BAT *bn = NULL, *vs, *vc;
+	BATiter bnds;
+	bool nils = false;
+	char *seen = NULL;
+	lng t0 = 0;
+
+	TRC_DEBUG_IF(ALGO) t0 = GDKusec();
+
+	BATcheck(b, NULL);
+	BATcheck(v, NULL);
+	if (!rle_check(b, v))
+		return NULL;
+	if (g && (g->hseqbase > b->hseqbase ||
+		  g->hseqbase + BATcount(g) < b->hseqbase + BATcount(b) - 1)) {
+		GDKerror("groups do not match the runs\n");
+		return NULL;
+	}
+	if ((vs = rle_values(b, v)) == NULL)
+		return NULL;
+	if (vs->ttype != tp) {
+		vc = BATconvert(vs, NULL, tp, 0, 0, 0);
+		BBPunfix(vs->batCacheid);
+		if (vc == NULL)
+			return NULL;
+	} else {
+		vc = vs;
+	}
+	if ((bn = COLnew(0, tp, ngrp, TRANSIENT)) == NULL ||
+	    (seen = GDKzalloc(ngrp)) == NULL)
+		goto bailout;
+
+	bnds = bat_iterator(b);
+	const oid *bnd = (const oid *) bnds.base;
+	BUN nruns = bnds.count - 1;
+
+	switch (tp) {
+	case TYPE_lng:
+		RLE_SUM(lng, LNGMUL_CHECK, ADDI_WITH_CHECK);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		RLE_SUM(hge, HGEMUL_CHECK, ADDI_WITH_CHECK);
+		break;
+#endif
+	case TYPE_flt:
+		RLE_SUM(flt, FLTMUL_CHECK, ADDF_WITH_CHECK);
+		break;
+	case TYPE_dbl:
+		RLE_SUM(dbl, FLTMUL_CHECK, ADDF_WITH_CHECK);
+		break;
+	default:
+		GDKerror("type combination (sum(%s)->%s) not supported.\n",
+			 ATOMname(v->ttype), ATOMname(tp));
+		goto failed;
+	}
+	bat_iterator_end(&bnds);
+	GDKfree(seen);
+	BBPunfix(vc->batCacheid);
+	BATsetcount(bn, ngrp);
+	BATnegateprops(bn);
+	bn->tnil = nils;
+	bn->tnonil = !nils;
+
+	TRC_DEBUG(ALGO, "b=" ALGOBATFMT ",v=" ALGOBATFMT ",g=" ALGOOPTBATFMT
+		  " -> " ALGOBATFMT " (" LLFMT " usec)\n",
+		  ALGOBATPAR(b), ALGOBATPAR(v), ALGOOPTBATPAR(g),
+		  ALGOBATPAR(bn), GDKusec() - t0);
+	return bn;
+
+  overflow:
+	GDKerror("22003!overflow in sum aggregate.\n");
+  failed:
+	bat_iterator_end(&bnds);
+  bailout:
+	GDKfree(seen);
+	BBPunfix(vc->batCacheid);
+	BBPreclaim(bn);
+	return NULL;
+}
@@ -206,13 +206,23 @@ RTREEexists_bid(bat bid)
 	return ret;
 }
 
+/* Sort-tile-recursive packing: the centres of the MBRs are sorted on
+ * x, cut into vertical slices of about sqrt(n / RTREE_STR_NODESIZE)
+ * nodes each, and every slice is sorted on y.  Inserting the MBRs in
+ * that order makes neighbouring MBRs end up in the same nodes, which
+ * gives a tree with far less overlap than inserting them in storage
+ * order. */
+#define RTREE_STR_NODESIZE 64
+
 gdk_return
 BATrtree(BAT *wkb, BAT *mbrb)
 {
 	BAT *pb;
 	BATiter bi;
 	rtree_t *rtree = NULL;
-	struct canditer ci;
+	flt *keys;
+	oid *ids;
+	BUN n = 0, slice, pages, s;
 
 	//Check for a parent BAT of wkb, load if exists
 	if (VIEWtparent(wkb)) {
@@ -235,26 +245,74 @@ BATrtree(BAT *wkb, BAT *mbrb)
 		//First arg are dimensions: we only allow x, y
 		//Second arg are flags: split strategy and nodes-per-page
 		if ((rtree = rtree_new(2, RTREE_DEFAULT)) == NULL) {
+			MT_lock_unset(&pb->batIdxLock);
 			GDKerror("rtree_new failed\n");
 			return GDK_FAIL;
 		}
 		bi = bat_iterator(mbrb);
-		canditer_init(&ci, mbrb,NULL);
+		keys = GDKmalloc(bi.count * sizeof(flt));
+		ids = GDKmalloc(bi.count * sizeof(oid));
+		if (keys == NULL || ids == NULL) {
+			bat_iterator_end(&bi);
+			GDKfree(keys);
+			GDKfree(ids);
+			rtree_destroy(rtree);
+			MT_lock_unset(&pb->batIdxLock);
+			return GDK_FAIL;
+		}
 
-		for (BUN i = 0; i < ci.ncand; i++) {
-			oid p = canditer_next(&ci) - mbrb->hseqbase;
-			const mbr *inMBR = (const mbr *)BUNtail(bi, p);
+		//Nil MBRs never intersect anything, leave them out of the tree
+		for (BUN i = 0; i < bi.count; i++) {
+			const mbr *inMBR = (const mbr *) BUNtloc(bi, i);
+			if (is_flt_nil(inMBR->xmin) || is_flt_nil(inMBR->ymin) ||
+			    is_flt_nil(inMBR->xmax) || is_flt_nil(inMBR->ymax))
+				continue;
+			keys[n] = inMBR->xmin / 2 + inMBR->xmax / 2;
+			ids[n++] = i;
+		}
+		GDKqsort(keys, ids, NULL, n, sizeof(flt), sizeof(oid), TYPE_flt, false, false);
+		pages = (n + RTREE_STR_NODESIZE - 1) / RTREE_STR_NODESIZE;
+		for (s = 1; s * s < pages; s++)
+			;
+		slice = s * RTREE_STR_NODESIZE;
+		for (BUN lo = 0; lo < n; lo += slice) {
+			BUN hi = lo + slice < n ? lo + slice : n;
+			for (BUN i = lo; i < hi; i++) {
+				const mbr *inMBR = (const mbr *) BUNtloc(bi, ids[i]);
+				keys[i] = inMBR->ymin / 2 + inMBR->ymax / 2;
+			}
+			GDKqsort(keys + lo, ids + lo, NULL, hi - lo, sizeof(flt), sizeof(oid), TYPE_flt, false, false);
+		}
+
+		for (BUN i = 0; i < n; i++) {
+			const mbr *inMBR = (const mbr *) BUNtloc(bi, ids[i]);
+			int err;
 
-			rtree_id_t rtree_id = i;
+			rtree_id_t rtree_id = (rtree_id_t) ids[i];
 			rtree_coord_t rect[4];
 			rect[0] = inMBR->xmin;
 			rect[1] = inMBR->ymin;
 			rect[2] = inMBR->xmax;
 			rect[3] = inMBR->ymax;
-			rtree_add_rect(rtree,rtree_id,rect);
+			if ((err = rtree_add_rect(rtree, rtree_id, rect)) != 0) {
+				GDKerror("%s", rtree_strerror(err));
+				bat_iterator_end(&bi);
+				GDKfree(keys);
+				GDKfree(ids);
+				rtree_destroy(rtree);
+				MT_lock_unset(&pb->batIdxLock);
+				return GDK_FAIL;
+			}
 		}
 		bat_iterator_end(&bi);
+		GDKfree(keys);
+		GDKfree(ids);
 		pb->trtree = GDKmalloc(sizeof(struct RTree));
+		if (pb->trtree == NULL) {
+			rtree_destroy(rtree);
+			MT_lock_unset(&pb->batIdxLock);
+			return GDK_FAIL;
+		}
 		*pb->trtree = (struct RTree) {
 			.rtree = rtree,
 			.destroy = false,
@@ -337,6 +395,67 @@ f(rtree_id_t id, void *context)
 	return results_rtree->results_left <= 0;
 }
 
+struct rtree_visit {
+	oid hseqbase;
+	int (*visit)(oid o, void *arg);
+	void *arg;
+};
+
+static int
+visit_id(rtree_id_t id, void *context)
+{
+	struct rtree_visit *v = (struct rtree_visit *) context;
+	return (*v->visit)(v->hseqbase + (oid) id, v->arg);
+}
+
+/* Call visit for the oid of every value of b whose MBR intersects
+ * inMBR, until it returns nonzero.  Unlike RTREEsearch this does not
+ * allocate a result array the size of the BAT, so it can be used to
+ * probe the RTree once for every row of a join.  The oids are those
+ * of the parent BAT, the caller must check them against its own
+ * candidates. */
+gdk_return
+RTREEvisit(BAT *b, const void *inMBRptr, int (*visit)(oid o, void *arg), void *arg)
+{
+	BAT *pb;
+	const mbr *inMBR = inMBRptr;
+	rtree_t *rtree;
+	if (VIEWtparent(b)) {
+		pb = BBP_desc(VIEWtparent(b));
+	} else {
+		pb = b;
+	}
+
+	//Load the RTree if it is only on file, and hold on to it while searching
+	MT_lock_set(&pb->batIdxLock);
+	if (pb->trtree == NULL && BATcheckrtree(pb) != GDK_SUCCEED) {
+		MT_lock_unset(&pb->batIdxLock);
+		return GDK_FAIL;
+	}
+	rtree = pb->trtree->rtree;
+	RTREEincref(pb);
+	MT_lock_unset(&pb->batIdxLock);
+
+	rtree_coord_t rect[4];
+	rect[0] = inMBR->xmin;
+	rect[1] = inMBR->ymin;
+	rect[2] = inMBR->xmax;
+	rect[3] = inMBR->ymax;
+
+	struct rtree_visit v = {
+		.hseqbase = pb->hseqbase,
+		.visit = visit,
+		.arg = arg,
+	};
+	//The result only tells whether visit stopped the search early
+	(void) rtree_search(rtree, (const rtree_coord_t*) rect, visit_id, &v);
+
+	MT_lock_set(&pb->batIdxLock);
+	RTREEdecref(pb);
+	MT_lock_unset(&pb->batIdxLock);
+	return GDK_SUCCEED;
+}
+
 BUN*
 RTREEsearch(BAT *b, const void *inMBRptr, int result_limit)
 {
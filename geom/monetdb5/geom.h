@@ -225,12 +225,16 @@ geom_export str wkbIntersectsSelectNoIndex(bat* outid, const bat *bid , const ba
 geom_export str wkbIntersectsJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti);
 geom_export str wkbIntersectsSelectRTree(bat* outid, const bat *bid , const bat *sid, wkb **wkb_const, bit *anti);
 
-geom_export str wkbDWithinJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, double *distance, bit *nil_matches, lng *estimate, bit *anti);
+geom_export str wkbDWithinJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *d_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti);
 geom_export str wkbDWithinSelectRTree(bat* outid, const bat *bid , const bat *sid, wkb **wkb_const, double *distance, bit *anti);
 
 geom_export str wkbDWithinJoinNoIndex(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, double *distance, bit *nil_matches, lng *estimate, bit *anti);
 geom_export str wkbDWithinSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb **wkb_const, double *distance, bit *anti);
 
+geom_export str wkbKNearest(bit *out, wkb **a, wkb **b, int *k);
+geom_export str wkbKNearestSelect(bat *outid, const bat *bid, const bat *sid, wkb **wkb_const, int *k, bit *anti);
+geom_export str wkbKNearestJoin(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *k_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti);
+
 geom_export str mbrIntersects(bit* out, mbr** mbr1, mbr** mbr2);
 
 geom_export str wkbCollectAggr (wkb **out, const bat *bid);
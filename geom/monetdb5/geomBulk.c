@@ -107,16 +107,209 @@ filterSelectRTree(bat* outid, const bat *bid , const bat *sid, GEOSGeom const_ge
 }
 #endif
 
+/* MBR prefiltering
+ * The predicates without an index work on chunks of GEOM_CHUNK rows: the
+ * geometries of a chunk are converted, their bounding boxes are stored
+ * in one float array per coordinate, and a single pass over those
+ * arrays selects the rows whose box can satisfy the predicate.  Only the
+ * selected rows are tested with GEOS, against a prepared version of the
+ * geometry that is used for every row.  The boxes are rounded outwards
+ * to float, so the box test never drops a row the exact test accepts. */
+#define GEOM_CHUNK 1024
+
+enum mbr_test {
+	MBR_INTERSECTS,		/* the box of a row intersects the box */
+	MBR_INSIDE,		/* the box of a row lies inside the box */
+	MBR_COVERS,		/* the box of a row covers the box */
+};
+
+static inline float
+geomBoxDown(double v)
+{
+	float f = (float) v;
+	return (double) f > v ? nextafterf(f, -INFINITY) : f;
+}
+
+static inline float
+geomBoxUp(double v)
+{
+	float f = (float) v;
+	return (double) f < v ? nextafterf(f, INFINITY) : f;
+}
+
+//Bounding box of a geometry grown by distance; nil and empty geometries get a nil box, which fails every box test
+static void
+geomBox(const GEOSGeometry *geom, double distance, float *xmin, float *ymin, float *xmax, float *ymax)
+{
+	double x1, y1, x2, y2;
+
+	if (geom == NULL ||
+		GEOSGeom_getXMin_r(geoshandle, geom, &x1) != 1 ||
+		GEOSGeom_getYMin_r(geoshandle, geom, &y1) != 1 ||
+		GEOSGeom_getXMax_r(geoshandle, geom, &x2) != 1 ||
+		GEOSGeom_getYMax_r(geoshandle, geom, &y2) != 1) {
+		*xmin = *ymin = *xmax = *ymax = flt_nil;
+		return;
+	}
+	*xmin = geomBoxDown(x1 - distance);
+	*ymin = geomBoxDown(y1 - distance);
+	*xmax = geomBoxUp(x2 + distance);
+	*ymax = geomBoxUp(y2 + distance);
+}
+
+//Select the positions of the boxes that pass the test against box; comparisons with nil are false, so nil boxes never pass
+static BUN
+mbrSelect(enum mbr_test test, const mbr *box, const float *restrict xmin, const float *restrict ymin, const float *restrict xmax, const float *restrict ymax, BUN n, BUN *restrict sel)
+{
+	BUN m = 0;
+
+	switch (test) {
+	case MBR_INTERSECTS:
+		for (BUN i = 0; i < n; i++) {
+			sel[m] = i;
+			m += (xmin[i] <= box->xmax) & (xmax[i] >= box->xmin) & (ymin[i] <= box->ymax) & (ymax[i] >= box->ymin);
+		}
+		break;
+	case MBR_INSIDE:
+		for (BUN i = 0; i < n; i++) {
+			sel[m] = i;
+			m += (xmin[i] >= box->xmin) & (xmax[i] <= box->xmax) & (ymin[i] >= box->ymin) & (ymax[i] <= box->ymax);
+		}
+		break;
+	case MBR_COVERS:
+		for (BUN i = 0; i < n; i++) {
+			sel[m] = i;
+			m += (xmin[i] <= box->xmin) & (xmax[i] >= box->xmax) & (ymin[i] <= box->ymin) & (ymax[i] >= box->ymax);
+		}
+		break;
+	}
+	return m;
+}
+
+/* GEOSPreparedDistanceWithin_r, like GEOSDistanceWithin_r, is part of
+ * GEOS 3.10 (C API 1.16), the version the build requires */
+#if GEOS_CAPI_VERSION_MAJOR < 1 || (GEOS_CAPI_VERSION_MAJOR == 1 && GEOS_CAPI_VERSION_MINOR < 16)
+#error "GEOS 3.10 or later is required"
+#endif
+
+//Prepared predicates, all with the signature of GEOSPreparedDistanceWithin_r
+static char
+geosPreparedContains(GEOSContextHandle_t handle, const GEOSPreparedGeometry *prepared, const GEOSGeometry *geom, double distance)
+{
+	(void) distance;
+	return GEOSPreparedContains_r(handle, prepared, geom);
+}
+
+static char
+geosPreparedWithin(GEOSContextHandle_t handle, const GEOSPreparedGeometry *prepared, const GEOSGeometry *geom, double distance)
+{
+	(void) distance;
+	return GEOSPreparedWithin_r(handle, prepared, geom);
+}
+
+/* A predicate between a constant geometry and the rows of a column:
+ * func(constant, row) is true, where the box of the row passes test
+ * against the box of the constant grown by distance. */
+struct constPred {
+	GEOSGeom geom;
+	const GEOSPreparedGeometry *prepared;
+	mbr box;
+	enum mbr_test test;
+	double distance;
+	char (*func) (GEOSContextHandle_t handle, const GEOSPreparedGeometry *, const GEOSGeometry *, double);
+	const char *name;
+};
+
+static str
+constPredInit(struct constPred *cp, const wkb *wkb_const, double distance, enum mbr_test test, char (*func) (GEOSContextHandle_t handle, const GEOSPreparedGeometry *, const GEOSGeometry *, double), const char *name)
+{
+	*cp = (struct constPred) {
+		.test = test,
+		.distance = distance,
+		.func = func,
+		.name = name,
+	};
+	if ((cp->geom = wkb2geos(wkb_const)) == NULL)
+		throw(MAL, name, SQLSTATE(38000) "Geos operation wkb2geos failed");
+	if ((cp->prepared = GEOSPrepare_r(geoshandle, cp->geom)) == NULL) {
+		GEOSGeom_destroy_r(geoshandle, cp->geom);
+		throw(MAL, name, SQLSTATE(38000) "Geos operation GEOSPrepare failed");
+	}
+	geomBox(cp->geom, distance, &cp->box.xmin, &cp->box.ymin, &cp->box.xmax, &cp->box.ymax);
+	return MAL_SUCCEED;
+}
+
+static void
+constPredDestroy(struct constPred *cp)
+{
+	GEOSPreparedGeom_destroy_r(geoshandle, cp->prepared);
+	GEOSGeom_destroy_r(geoshandle, cp->geom);
+}
+
+//Evaluate the predicate for n <= GEOM_CHUNK rows of a column: res is nil for nil rows, otherwise true or false
+static str
+constPredChunk(struct constPred *cp, BATiter *bi, oid hseqbase, const oid *oids, BUN n, bit *res)
+{
+	GEOSGeom geoms[GEOM_CHUNK];
+	float xmin[GEOM_CHUNK], ymin[GEOM_CHUNK], xmax[GEOM_CHUNK], ymax[GEOM_CHUNK];
+	BUN sel[GEOM_CHUNK], nsel, nconv;
+	int srid = GEOSGetSRID_r(geoshandle, cp->geom);
+	str msg = MAL_SUCCEED;
+
+	assert(n <= GEOM_CHUNK);
+	for (nconv = 0; nconv < n; nconv++) {
+		const wkb *col_wkb = BUNtvar(*bi, oids[nconv] - hseqbase);
+		if (is_wkb_nil(col_wkb)) {
+			geoms[nconv] = NULL;
+			res[nconv] = bit_nil;
+			xmin[nconv] = ymin[nconv] = xmax[nconv] = ymax[nconv] = flt_nil;
+			continue;
+		}
+		if ((geoms[nconv] = wkb2geos(col_wkb)) == NULL) {
+			msg = createException(MAL, cp->name, SQLSTATE(38000) "Geos operation wkb2geos failed");
+			goto bailout;
+		}
+		if (GEOSGetSRID_r(geoshandle, geoms[nconv]) != srid) {
+			nconv++;
+			msg = createException(MAL, cp->name, SQLSTATE(38000) "Geometries of different SRID");
+			goto bailout;
+		}
+		res[nconv] = 0;
+		geomBox(geoms[nconv], 0, &xmin[nconv], &ymin[nconv], &xmax[nconv], &ymax[nconv]);
+	}
+
+	nsel = mbrSelect(cp->test, &cp->box, xmin, ymin, xmax, ymax, n, sel);
+	for (BUN k = 0; k < nsel; k++) {
+		//GEOS function returns 1 on true, 0 on false and 2 on exception
+		char cond = (*cp->func)(geoshandle, cp->prepared, geoms[sel[k]], cp->distance);
+		if (cond == 2) {
+			msg = createException(MAL, cp->name, SQLSTATE(38000) "Geos predicate evaluation failed");
+			break;
+		}
+		res[sel[k]] = cond;
+	}
+
+  bailout:
+	for (BUN i = 0; i < nconv; i++) {
+		if (geoms[i])
+			GEOSGeom_destroy_r(geoshandle, geoms[i]);
+	}
+	return msg;
+}
+
 static str
-filterSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb *wkb_const, double distance, bit anti, char (*func) (GEOSContextHandle_t handle, const GEOSGeometry *, const GEOSGeometry *, double), const char *name)
+filterSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb *wkb_const, double distance, bit anti, char (*func) (GEOSContextHandle_t handle, const GEOSPreparedGeometry *, const GEOSGeometry *, double), const char *name)
 {
 	BAT *out = NULL, *b = NULL, *s = NULL;
 	BATiter b_iter;
 	struct canditer ci;
-	GEOSGeom col_geom, const_geom;
+	struct constPred cp;
+	oid oids[GEOM_CHUNK];
+	bit res[GEOM_CHUNK];
+	str msg = MAL_SUCCEED;
 
-	//WKB constant is NULL
-	if ((const_geom = wkb2geos(wkb_const)) == NULL) {
+	//WKB constant or distance is NULL
+	if (is_wkb_nil(wkb_const) || is_dbl_nil(distance)) {
 		if ((out = BATdense(0, 0, 0)) == NULL)
 			throw(MAL, name, GDK_EXCEPTION);
 		*outid = out->batCacheid;
@@ -132,7 +325,6 @@ filterSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb *wkb_const,
 		throw(MAL, name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 	}
 	canditer_init(&ci, b, s);
-	b_iter = bat_iterator(b);
 
 	//Result BAT
 	if ((out = COLnew(0, ATOMindex("oid"), ci.ncand, TRANSIENT)) == NULL) {
@@ -141,46 +333,39 @@ filterSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb *wkb_const,
 			BBPunfix(s->batCacheid);
 		throw(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 	}
+	if ((msg = constPredInit(&cp, wkb_const, distance, MBR_INTERSECTS, func, name)) != MAL_SUCCEED) {
+		BBPunfix(b->batCacheid);
+		if (s)
+			BBPunfix(s->batCacheid);
+		BBPreclaim(out);
+		return msg;
+	}
 
-	for (BUN i = 0; i < ci.ncand; i++) {
-		BUN cand = canditer_next(&ci);
-		const wkb *col_wkb = BUNtvar(b_iter, cand - b->hseqbase);
-		if ((col_geom = wkb2geos(col_wkb)) == NULL)
-			throw(MAL, name, SQLSTATE(38000) "WKB2Geos operation failed");
-		if (GEOSGetSRID_r(geoshandle, col_geom) != GEOSGetSRID_r(geoshandle, const_geom)) {
-			GEOSGeom_destroy_r(geoshandle, col_geom);
-			GEOSGeom_destroy_r(geoshandle, const_geom);
-			bat_iterator_end(&b_iter);
-			BBPunfix(b->batCacheid);
-			if (s)
-				BBPunfix(s->batCacheid);
-			BBPreclaim(out);
-			throw(MAL, name, SQLSTATE(38000) "Geometries of different SRID");
-		}
-		//GEOS function returns 1 on true, 0 on false and 2 on exception
-		bit cond = ((*func)(geoshandle, col_geom, const_geom, distance) == 1);
-		if (cond != anti) {
-			if (BUNappend(out, (oid*) &cand, false) != GDK_SUCCEED) {
-				if (col_geom)
-					GEOSGeom_destroy_r(geoshandle, col_geom);
-				if (const_geom)
-					GEOSGeom_destroy_r(geoshandle, const_geom);
-				bat_iterator_end(&b_iter);
-				BBPunfix(b->batCacheid);
-				if (s)
-					BBPunfix(s->batCacheid);
-				BBPreclaim(out);
-				throw(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	b_iter = bat_iterator(b);
+	for (BUN i = 0; i < ci.ncand && msg == MAL_SUCCEED; ) {
+		BUN n;
+		for (n = 0; n < GEOM_CHUNK && i < ci.ncand; n++, i++)
+			oids[n] = canditer_next(&ci);
+		if ((msg = constPredChunk(&cp, &b_iter, b->hseqbase, oids, n, res)) != MAL_SUCCEED)
+			break;
+		//Nil rows are never selected, not even by the anti select
+		for (BUN k = 0; k < n; k++) {
+			if (!is_bit_nil(res[k]) && res[k] != anti &&
+				BUNappend(out, &oids[k], false) != GDK_SUCCEED) {
+				msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
 			}
 		}
-		GEOSGeom_destroy_r(geoshandle, col_geom);
 	}
-
-	GEOSGeom_destroy_r(geoshandle, const_geom);
 	bat_iterator_end(&b_iter);
+	constPredDestroy(&cp);
 	BBPunfix(b->batCacheid);
 	if (s)
 		BBPunfix(s->batCacheid);
+	if (msg != MAL_SUCCEED) {
+		BBPreclaim(out);
+		return msg;
+	}
 	*outid = out->batCacheid;
 	BBPkeepref(out);
 	return MAL_SUCCEED;
@@ -208,9 +393,9 @@ wkbIntersectsSelectRTree(bat* outid, const bat *bid , const bat *sid, wkb **wkb_
 		return filterSelectRTree(outid,bid,sid,const_geom,const_mbr,0,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsSelectRTree");
 	}
 	else
-		return filterSelectNoIndex(outid,bid,sid,*wkb_const,0,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
+		return filterSelectNoIndex(outid,bid,sid,*wkb_const,0,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
 #else
-	return filterSelectNoIndex(outid,bid,sid,*wkb_const,0,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
+	return filterSelectNoIndex(outid,bid,sid,*wkb_const,0,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
 #endif
 }
 
@@ -245,43 +430,150 @@ wkbDWithinSelectRTree(bat* outid, const bat *bid , const bat *sid, wkb **wkb_con
 		return filterSelectRTree(outid,bid,sid,const_geom,const_mbr,*distance,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinSelectRTree");
 	}
 	else
-		return filterSelectNoIndex(outid,bid,sid,*wkb_const,*distance,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinSelectNoIndex");
+		return filterSelectNoIndex(outid,bid,sid,*wkb_const,*distance,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbDWithinSelectNoIndex");
 #else
-	return filterSelectNoIndex(outid,bid,sid,*wkb_const,*distance,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinSelectNoIndex");
+	return filterSelectNoIndex(outid,bid,sid,*wkb_const,*distance,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbDWithinSelectNoIndex");
 #endif
 }
 
 str
 wkbIntersectsSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb **wkb_const, bit *anti) {
-	return filterSelectNoIndex(outid,bid,sid,*wkb_const,0,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
+	return filterSelectNoIndex(outid,bid,sid,*wkb_const,0,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
 }
 
 str
 wkbDWithinSelectNoIndex(bat* outid, const bat *bid , const bat *sid, wkb **wkb_const, double *distance, bit *anti) {
-	return filterSelectNoIndex(outid,bid,sid,*wkb_const,*distance,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsSelectNoIndex");
+	return filterSelectNoIndex(outid,bid,sid,*wkb_const,*distance,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbDWithinSelectNoIndex");
+}
+
+/* Nested loop join without an index
+ * The boxes of the right side are packed once.  Every left row is
+ * converted once, its box is tested against all right boxes in one
+ * pass, and only the right rows that pass are tested with GEOS, against
+ * the prepared left geometry.  The right geometries are converted once,
+ * when their boxes are packed.  The join runs in the calling thread;
+ * mitosis splits large joins over the dataflow workers. */
+struct filterJoinState {
+	BAT *l;
+	BATiter l_iter;
+	const oid *r_oids;		/* candidates of the right side */
+	BUN r_cnt;
+	const float *xmin, *ymin, *xmax, *ymax;	/* boxes of the right side */
+	GEOSGeom *r_geoms;		/* right geometries, NULL for nil */
+	BUN *sel;			/* right rows whose box passes */
+	int r_srid;			/* SRID of the right side, if any */
+	bool r_srid_set, r_srid_mixed;
+	double distance;
+	bit anti;
+	char (*func) (GEOSContextHandle_t handle, const GEOSPreparedGeometry *, const GEOSGeometry *, double);
+	const char *name;
+	BAT *lres, *rres;
+};
+
+static str
+filterJoinAppend(struct filterJoinState *st, oid lo, oid ro)
+{
+	if (BUNappend(st->lres, &lo, false) != GDK_SUCCEED ||
+		BUNappend(st->rres, &ro, false) != GDK_SUCCEED)
+		throw(MAL, st->name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	return MAL_SUCCEED;
+}
+
+//Exact test of a left geometry against right row j, preparing the left geometry on first use
+static str
+filterJoinTest(struct filterJoinState *st, GEOSGeom l_geom, const GEOSPreparedGeometry **prepared, BUN j, bool *cond)
+{
+	char res;
+
+	assert(st->r_geoms[j] != NULL);	/* nil boxes never pass */
+	if (*prepared == NULL && (*prepared = GEOSPrepare_r(geoshandle, l_geom)) == NULL)
+		throw(MAL, st->name, SQLSTATE(38000) "Geos operation GEOSPrepare failed");
+	//GEOS function returns 1 on true, 0 on false and 2 on exception
+	if ((res = (*st->func)(geoshandle, *prepared, st->r_geoms[j], st->distance)) == 2)
+		throw(MAL, st->name, SQLSTATE(38000) "Geos predicate evaluation failed");
+	*cond = res == 1;
+	return MAL_SUCCEED;
+}
+
+//Join one left row; nil geometries never satisfy the predicate, not even in an anti join
+static str
+filterJoinRow(struct filterJoinState *st, oid l_oid)
+{
+	const wkb *l_wkb = BUNtvar(st->l_iter, l_oid - st->l->hseqbase);
+	const GEOSPreparedGeometry *prepared = NULL;
+	GEOSGeom l_geom;
+	BUN nsel;
+	mbr box;
+	bool cond;
+	str msg = MAL_SUCCEED;
+
+	if (is_wkb_nil(l_wkb))
+		return MAL_SUCCEED;
+	if ((l_geom = wkb2geos(l_wkb)) == NULL)
+		throw(MAL, st->name, SQLSTATE(38000) "Geos operation wkb2geos failed");
+	if (st->r_srid_set && (st->r_srid_mixed || GEOSGetSRID_r(geoshandle, l_geom) != st->r_srid)) {
+		GEOSGeom_destroy_r(geoshandle, l_geom);
+		throw(MAL, st->name, SQLSTATE(38000) "Geometries of different SRID");
+	}
+	geomBox(l_geom, st->distance, &box.xmin, &box.ymin, &box.xmax, &box.ymax);
+	nsel = mbrSelect(MBR_INTERSECTS, &box, st->xmin, st->ymin, st->xmax, st->ymax, st->r_cnt, st->sel);
+
+	if (!st->anti) {
+		for (BUN k = 0; k < nsel; k++) {
+			if ((msg = filterJoinTest(st, l_geom, &prepared, st->sel[k], &cond)) != MAL_SUCCEED)
+				break;
+			if (cond && (msg = filterJoinAppend(st, l_oid, st->r_oids[st->sel[k]])) != MAL_SUCCEED)
+				break;
+		}
+	} else {
+		//Rows whose box fails the test qualify without an exact test
+		for (BUN j = 0, k = 0; j < st->r_cnt; j++) {
+			if (k < nsel && st->sel[k] == j) {
+				k++;
+				if ((msg = filterJoinTest(st, l_geom, &prepared, j, &cond)) != MAL_SUCCEED)
+					break;
+				if (cond)
+					continue;
+			} else if (st->r_geoms[j] == NULL) {
+				continue;
+			}
+			if ((msg = filterJoinAppend(st, l_oid, st->r_oids[j])) != MAL_SUCCEED)
+				break;
+		}
+	}
+
+	if (prepared)
+		GEOSPreparedGeom_destroy_r(geoshandle, prepared);
+	GEOSGeom_destroy_r(geoshandle, l_geom);
+	return msg;
 }
 
 static str
-filterJoinNoIndex(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, double double_flag, const bat *ls_id, const bat *rs_id, bit nil_matches, lng estimate, bit anti, char (*func) (GEOSContextHandle_t handle, const GEOSGeometry *, const GEOSGeometry *, double), const char *name)
+filterJoinNoIndex(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, double double_flag, const bat *ls_id, const bat *rs_id, lng estimate, bit anti, char (*func) (GEOSContextHandle_t handle, const GEOSPreparedGeometry *, const GEOSGeometry *, double), const char *name)
 {
 	BAT *lres = NULL, *rres = NULL, *l = NULL, *r = NULL, *ls = NULL, *rs = NULL;
 	BUN estimate_safe;
-	BATiter l_iter, r_iter;
 	str msg = MAL_SUCCEED;
 	struct canditer l_ci, r_ci;
-	GEOSGeom l_geom, r_geom;
-	GEOSGeom *l_geoms = NULL, *r_geoms = NULL;
+	struct filterJoinState st = {
+		.distance = double_flag,
+		.anti = anti,
+		.func = func,
+		.name = name,
+	};
+	oid *r_oids = NULL;
+	float *boxes = NULL;
+	BATiter r_iter;
 
 	//get the input BATs
 	if ((l = BATdescriptor(*l_id)) == NULL || (r = BATdescriptor(*r_id)) == NULL) {
 		if (l)
 			BBPunfix(l->batCacheid);
-		if (r)
-			BBPunfix(r->batCacheid);
 		throw(MAL, name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 	}
 	//get the candidate lists
-	if (ls_id && !is_bat_nil(*ls_id) && (ls = BATdescriptor(*ls_id)) == NULL && rs_id && !is_bat_nil(*rs_id) && (rs = BATdescriptor(*rs_id)) == NULL) {
+	if ((ls_id && !is_bat_nil(*ls_id) && (ls = BATdescriptor(*ls_id)) == NULL) ||
+		(rs_id && !is_bat_nil(*rs_id) && (rs = BATdescriptor(*rs_id)) == NULL)) {
 		msg = createException(MAL, name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 		goto free;
 	}
@@ -310,105 +602,80 @@ filterJoinNoIndex(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id,
 		msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto free;
 	}
-
-	//Allocate arrays for reutilizing GEOS type conversion
-	if ((l_geoms = GDKmalloc(l_ci.ncand * sizeof(GEOSGeometry *))) == NULL || (r_geoms = GDKmalloc(r_ci.ncand * sizeof(GEOSGeometry *))) == NULL) {
+	//A nil distance never qualifies
+	if (is_dbl_nil(double_flag) || l_ci.ncand == 0 || r_ci.ncand == 0)
+		goto done;
+
+	st.l = l;
+	st.r_cnt = r_ci.ncand;
+	st.lres = lres;
+	st.rres = rres;
+	if ((r_oids = GDKmalloc(r_ci.ncand * sizeof(oid))) == NULL ||
+		(boxes = GDKmalloc(4 * r_ci.ncand * sizeof(float))) == NULL ||
+		(st.r_geoms = GDKzalloc(r_ci.ncand * sizeof(GEOSGeom))) == NULL ||
+		(st.sel = GDKmalloc(r_ci.ncand * sizeof(BUN))) == NULL) {
 		msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto free;
 	}
+	st.r_oids = r_oids;
+	st.xmin = boxes;
+	st.ymin = boxes + r_ci.ncand;
+	st.xmax = boxes + 2 * r_ci.ncand;
+	st.ymax = boxes + 3 * r_ci.ncand;
 
-	l_iter = bat_iterator(l);
+	st.l_iter = bat_iterator(l);
 	r_iter = bat_iterator(r);
 
-	//Convert wkb to GEOS only once
-	for (BUN i = 0; i < l_ci.ncand; i++) {
-		oid l_oid = canditer_next(&l_ci);
-		l_geoms[i] = wkb2geos((const wkb*) BUNtvar(l_iter, l_oid - l->hseqbase));
-	}
+	//Pack the boxes of the right side
 	for (BUN j = 0; j < r_ci.ncand; j++) {
-		oid r_oid = canditer_next(&r_ci);
-		r_geoms[j] = wkb2geos((const wkb*)BUNtvar(r_iter, r_oid - r->hseqbase));
-	}
-
-	canditer_reset(&l_ci);
-	for (BUN i = 0; i < l_ci.ncand; i++) {
-		oid l_oid = canditer_next(&l_ci);
-		l_geom = l_geoms[i];
-		if (!nil_matches && l_geom == NULL)
-			continue;
-		canditer_reset(&r_ci);
-		for (BUN j = 0; j < r_ci.ncand; j++) {
-			oid r_oid = canditer_next(&r_ci);
-			r_geom = r_geoms[j];
-			//Null handling
-			if (r_geom == NULL) {
-				if (nil_matches && l_geom == NULL) {
-					if (BUNappend(lres, &l_oid, false) != GDK_SUCCEED || BUNappend(rres, &r_oid, false) != GDK_SUCCEED) {
-						msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						bat_iterator_end(&l_iter);
-						bat_iterator_end(&r_iter);
-						goto free;
-					}
-				}
-				else
-					continue;
+		const wkb *r_wkb;
+		GEOSGeom r_geom = NULL;
+
+		r_oids[j] = canditer_next(&r_ci);
+		r_wkb = BUNtvar(r_iter, r_oids[j] - r->hseqbase);
+		if (!is_wkb_nil(r_wkb)) {
+			if ((r_geom = wkb2geos(r_wkb)) == NULL) {
+				msg = createException(MAL, name, SQLSTATE(38000) "Geos operation wkb2geos failed");
+				break;
 			}
-			if (GEOSGetSRID_r(geoshandle, l_geom) != GEOSGetSRID_r(geoshandle, r_geom)) {
-				msg = createException(MAL, name, SQLSTATE(38000) "Geometries of different SRID");
-				bat_iterator_end(&l_iter);
-				bat_iterator_end(&r_iter);
-				goto free;
-			}
-			//Apply the (Geom, Geom, double) -> bit function
-			bit cond = (*func)(geoshandle, l_geom, r_geom, double_flag) == 1;
-			if (cond != anti) {
-				if (BUNappend(lres, &l_oid, false) != GDK_SUCCEED || BUNappend(rres, &r_oid, false) != GDK_SUCCEED) {
-					msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-					bat_iterator_end(&l_iter);
-					bat_iterator_end(&r_iter);
-					goto free;
-				}
+			int srid = GEOSGetSRID_r(geoshandle, r_geom);
+			if (!st.r_srid_set) {
+				st.r_srid = srid;
+				st.r_srid_set = true;
+			} else if (srid != st.r_srid) {
+				st.r_srid_mixed = true;
 			}
 		}
+		geomBox(r_geom, 0, &boxes[j], &boxes[r_ci.ncand + j], &boxes[2 * r_ci.ncand + j], &boxes[3 * r_ci.ncand + j]);
+		//the geometry is kept for the exact tests
+		st.r_geoms[j] = r_geom;
 	}
-	if (l_geoms) {
-		for (BUN i = 0; i < l_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, l_geoms[i]);
-		}
-		GDKfree(l_geoms);
-	}
-	if (r_geoms) {
-		for (BUN i = 0; i < r_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, r_geoms[i]);
-		}
-		GDKfree(r_geoms);
-	}
-	bat_iterator_end(&l_iter);
 	bat_iterator_end(&r_iter);
-	BBPunfix(l->batCacheid);
-	BBPunfix(r->batCacheid);
-	if (ls)
-		BBPunfix(ls->batCacheid);
-	if (rs)
-		BBPunfix(rs->batCacheid);
+
+	for (BUN i = 0; i < l_ci.ncand && msg == MAL_SUCCEED; i++)
+		msg = filterJoinRow(&st, canditer_next(&l_ci));
+	bat_iterator_end(&st.l_iter);
+	if (msg != MAL_SUCCEED)
+		goto free;
+
+  done:
 	*lres_id = lres->batCacheid;
 	BBPkeepref(lres);
+	lres = NULL;
 	*rres_id = rres->batCacheid;
 	BBPkeepref(rres);
-	return MAL_SUCCEED;
-free:
-	if (l_geoms) {
-		for (BUN i = 0; i < l_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, l_geoms[i]);
-		}
-		GDKfree(l_geoms);
-	}
-	if (r_geoms) {
-		for (BUN i = 0; i < r_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, r_geoms[i]);
-		}
-		GDKfree(r_geoms);
-	}
+	rres = NULL;
+  free:
+	if (st.r_geoms) {
+		for (BUN j = 0; j < st.r_cnt; j++) {
+			if (st.r_geoms[j])
+				GEOSGeom_destroy_r(geoshandle, st.r_geoms[j]);
+		}
+		GDKfree(st.r_geoms);
+	}
+	GDKfree(st.sel);
+	GDKfree(r_oids);
+	GDKfree(boxes);
 	BBPunfix(l->batCacheid);
 	BBPunfix(r->batCacheid);
 	if (ls)
@@ -423,15 +690,60 @@ free:
 }
 
 #ifdef HAVE_RTREE
+/* State of an index nested loop join: every row of the probing side
+ * searches the RTree of the indexed side with its MBR, and only the
+ * rows found there are tested with the exact predicate. */
+struct filterJoinRTreeState {
+	struct canditer *ci;		/* candidates of the indexed side */
+	GEOSGeom *geoms;		/* geometries of the indexed side by candidate position */
+	GEOSGeom probe_geom;		/* geometry of the current probing row */
+	oid probe_oid;
+	BAT *ires, *pres;		/* results for the indexed and probing side */
+	double double_flag;
+	char (*func) (GEOSContextHandle_t handle, const GEOSGeometry *, const GEOSGeometry *, double);
+	const char *name;
+	str msg;
+};
+
+static int
+filterJoinRTreeVisit(oid o, void *arg)
+{
+	struct filterJoinRTreeState *st = (struct filterJoinRTreeState *) arg;
+	BUN p = canditer_search(st->ci, o, false);
+	GEOSGeom geom;
+
+	//The RTree covers the whole column, skip rows that are not candidates
+	if (p == BUN_NONE || (geom = st->geoms[p]) == NULL)
+		return 0;
+	if (GEOSGetSRID_r(geoshandle, geom) != GEOSGetSRID_r(geoshandle, st->probe_geom)) {
+		st->msg = createException(MAL, st->name, SQLSTATE(38000) "Geometries of different SRID");
+		return 1;
+	}
+	//Apply the (Geom, Geom, double) -> bit function
+	if ((*st->func)(geoshandle, geom, st->probe_geom, st->double_flag) == 1) {
+		if (BUNappend(st->ires, &o, false) != GDK_SUCCEED || BUNappend(st->pres, &st->probe_oid, false) != GDK_SUCCEED) {
+			st->msg = createException(MAL, st->name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Index nested loop join for predicates that only hold for geometries
+ * whose MBRs are within double_flag of each other.  Only one of the
+ * sides needs an RTree; if both have one, the larger side is probed
+ * through its index.  Nil geometries are not in the RTree and never
+ * satisfy a spatial predicate, so they do not match anything here. */
 static str
-filterJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, double double_flag, const bat *ls_id, const bat *rs_id, bit nil_matches, lng estimate, bit anti, char (*func) (GEOSContextHandle_t handle, const GEOSGeometry *, const GEOSGeometry *, double), const char *name) {
-	BAT *lres = NULL, *rres = NULL, *l = NULL, *r = NULL, *ls = NULL, *rs = NULL, *inner_res = NULL, *outer_res = NULL, *inner_b = NULL;
+filterJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, double double_flag, const bat *ls_id, const bat *rs_id, lng estimate, char (*func) (GEOSContextHandle_t handle, const GEOSGeometry *, const GEOSGeometry *, double), const char *name) {
+	BAT *lres = NULL, *rres = NULL, *l = NULL, *r = NULL, *ls = NULL, *rs = NULL, *inner_b, *outer_b;
 	BUN estimate_safe;
-	BATiter l_iter, r_iter;
+	BATiter inner_iter, outer_iter;
 	str msg = MAL_SUCCEED;
-	struct canditer l_ci, r_ci, outer_ci, inner_ci;
-	GEOSGeom outer_geom, inner_geom;
-	GEOSGeom *l_geoms = NULL, *r_geoms = NULL, *outer_geoms = NULL, *inner_geoms = NULL;
+	struct canditer l_ci, r_ci, *inner_ci, *outer_ci;
+	GEOSGeom *inner_geoms = NULL;
+	struct filterJoinRTreeState st;
+	bool l_index, r_index;
 
 	//get the input BATs
 	if ((l = BATdescriptor(*l_id)) == NULL || (r = BATdescriptor(*r_id)) == NULL) {
@@ -442,7 +754,8 @@ filterJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, do
 		throw(MAL, name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 	}
 	//get the candidate lists
-	if (ls_id && !is_bat_nil(*ls_id) && (ls = BATdescriptor(*ls_id)) == NULL && rs_id && !is_bat_nil(*rs_id) && (rs = BATdescriptor(*rs_id)) == NULL) {
+	if ((ls_id && !is_bat_nil(*ls_id) && (ls = BATdescriptor(*ls_id)) == NULL) ||
+	    (rs_id && !is_bat_nil(*rs_id) && (rs = BATdescriptor(*rs_id)) == NULL)) {
 		msg = createException(MAL, name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 		goto free;
 	}
@@ -472,111 +785,77 @@ filterJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, do
 		goto free;
 	}
 
-	//Allocate arrays for reutilizing GEOS type conversion
-	if ((l_geoms = GDKmalloc(l_ci.ncand * sizeof(GEOSGeometry *))) == NULL || (r_geoms = GDKmalloc(r_ci.ncand * sizeof(GEOSGeometry *))) == NULL) {
-		msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto free;
+	//Probe the side with an RTree, the larger one if both have it
+	l_index = RTREEexists(l);
+	r_index = RTREEexists(r);
+	if (l_index && (!r_index || l_ci.ncand > r_ci.ncand)) {
+		inner_b = l;
+		inner_ci = &l_ci;
+		outer_b = r;
+		outer_ci = &r_ci;
+		st.ires = lres;
+		st.pres = rres;
+	} else {
+		inner_b = r;
+		inner_ci = &r_ci;
+		outer_b = l;
+		outer_ci = &l_ci;
+		st.ires = rres;
+		st.pres = lres;
 	}
 
-	l_iter = bat_iterator(l);
-	r_iter = bat_iterator(r);
-
-	//Convert wkb to GEOS only once
-	for (BUN i = 0; i < l_ci.ncand; i++) {
-		oid l_oid = canditer_next(&l_ci);
-		l_geoms[i] = wkb2geos((const wkb*) BUNtvar(l_iter, l_oid - l->hseqbase));
-	}
-	for (BUN j = 0; j < r_ci.ncand; j++) {
-		oid r_oid = canditer_next(&r_ci);
-		r_geoms[j] = wkb2geos((const wkb*)BUNtvar(r_iter, r_oid - r->hseqbase));
+	//Convert the wkbs of the indexed side to GEOS only once
+	if ((inner_geoms = GDKzalloc(inner_ci->ncand * sizeof(GEOSGeometry *))) == NULL) {
+		msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto free;
 	}
-
-	bat_iterator_end(&l_iter);
-	bat_iterator_end(&r_iter);
-
-	if (l_ci.ncand > r_ci.ncand) {
-		inner_b = l;
-		inner_res = lres;
-		inner_ci = l_ci;
-		inner_geoms = l_geoms;
-		outer_res = rres;
-		outer_ci = r_ci;
-		outer_geoms = r_geoms;
-	}
-	else {
-		inner_b = r;
-		inner_res = rres;
-		inner_ci = r_ci;
-		inner_geoms = r_geoms;
-		outer_res = lres;
-		outer_ci = l_ci;
-		outer_geoms = l_geoms;
-	}
-
-	canditer_reset(&outer_ci);
-	for (BUN i = 0; i < outer_ci.ncand; i++) {
-		oid outer_oid = canditer_next(&outer_ci);
-		outer_geom = outer_geoms[i];
-		if (!nil_matches && outer_geom == NULL)
+	inner_iter = bat_iterator(inner_b);
+	for (BUN i = 0; i < inner_ci->ncand; i++) {
+		oid inner_oid = canditer_next(inner_ci);
+		inner_geoms[i] = wkb2geos((const wkb*) BUNtvar(inner_iter, inner_oid - inner_b->hseqbase));
+	}
+	bat_iterator_end(&inner_iter);
+
+	st.ci = inner_ci;
+	st.geoms = inner_geoms;
+	st.double_flag = double_flag;
+	st.func = func;
+	st.name = name;
+	st.msg = MAL_SUCCEED;
+
+	outer_iter = bat_iterator(outer_b);
+	for (BUN i = 0; i < outer_ci->ncand && st.msg == MAL_SUCCEED; i++) {
+		st.probe_oid = canditer_next(outer_ci);
+		st.probe_geom = wkb2geos((const wkb*) BUNtvar(outer_iter, st.probe_oid - outer_b->hseqbase));
+		if (st.probe_geom == NULL)
 			continue;
 
-		//Calculate the MBR for the constant geometry
-		mbr *outer_mbr = mbrFromGeos(outer_geom);
-		BUN* results_rtree = RTREEsearch(inner_b, outer_mbr, outer_ci.ncand);
-		if (results_rtree == NULL) {
-			msg = createException(MAL, name, "RTreesearch failed, returned NULL candidates");
-			goto free;
-		}
-
-		canditer_reset(&inner_ci);
-		for (BUN j = 0; results_rtree[j] != BUN_NONE && j < inner_ci.ncand; j++) {
-			//oid inner_oid = canditer_next(&inner_ci);
-			oid inner_oid = results_rtree[j];
-			inner_geom = inner_geoms[j - inner_b->hseqbase];
-
-			if (inner_ci.tpe != cand_dense) {
-				//If the original candidate list does not contain the rtree cand, move on to next one
-				if (!canditer_contains(&inner_ci,inner_oid))
-					continue;
-			}
-
-			//Null handling
-			if (inner_geom == NULL) {
-				if (nil_matches && outer_geom == NULL) {
-					if (BUNappend(outer_res, &outer_oid, false) != GDK_SUCCEED || BUNappend(inner_res, &inner_oid, false) != GDK_SUCCEED) {
-						msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						goto free;
-					}
-				}
-				else
-					continue;
-			}
-			if (GEOSGetSRID_r(geoshandle, outer_geom) != GEOSGetSRID_r(geoshandle, inner_geom)) {
-				msg = createException(MAL, name, SQLSTATE(38000) "Geometries of different SRID");
-				goto free;
-			}
-			//Apply the (Geom, Geom, double) -> bit function
-			bit cond = (*func)(geoshandle, inner_geom, outer_geom, double_flag) == 1;
-			if (cond != anti) {
-				if (BUNappend(inner_res, &inner_oid, false) != GDK_SUCCEED || BUNappend(outer_res, &outer_oid, false) != GDK_SUCCEED) {
-					msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-					goto free;
-				}
-			}
+		//Search with the MBR of the probing geometry, grown by the distance
+		mbr *outer_mbr = mbrFromGeos(st.probe_geom);
+		if (outer_mbr == NULL) {
+			GEOSGeom_destroy_r(geoshandle, st.probe_geom);
+			st.msg = createException(MAL, name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			break;
 		}
-	}
-	if (l_geoms) {
-		for (BUN i = 0; i < l_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, l_geoms[i]);
+		if (!is_mbr_nil(outer_mbr)) {
+			outer_mbr->xmin -= double_flag;
+			outer_mbr->ymin -= double_flag;
+			outer_mbr->xmax += double_flag;
+			outer_mbr->ymax += double_flag;
+			if (RTREEvisit(inner_b, outer_mbr, filterJoinRTreeVisit, &st) != GDK_SUCCEED && st.msg == MAL_SUCCEED)
+				st.msg = createException(MAL, name, "RTreesearch failed");
 		}
-		GDKfree(l_geoms);
-	}
-	if (r_geoms) {
-		for (BUN i = 0; i < r_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, r_geoms[i]);
-		}
-		GDKfree(r_geoms);
+		GDKfree(outer_mbr);
+		GEOSGeom_destroy_r(geoshandle, st.probe_geom);
 	}
+	bat_iterator_end(&outer_iter);
+	msg = st.msg;
+	if (msg != MAL_SUCCEED)
+		goto free;
+
+	for (BUN i = 0; i < inner_ci->ncand; i++)
+		GEOSGeom_destroy_r(geoshandle, inner_geoms[i]);
+	GDKfree(inner_geoms);
 	BBPunfix(l->batCacheid);
 	BBPunfix(r->batCacheid);
 	if (ls)
@@ -589,17 +868,10 @@ filterJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, do
 	BBPkeepref(rres);
 	return MAL_SUCCEED;
 free:
-	if (l_geoms) {
-		for (BUN i = 0; i < l_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, l_geoms[i]);
-		}
-		GDKfree(l_geoms);
-	}
-	if (r_geoms) {
-		for (BUN i = 0; i < r_ci.ncand; i++) {
-			GEOSGeom_destroy_r(geoshandle, r_geoms[i]);
-		}
-		GDKfree(r_geoms);
+	if (inner_geoms) {
+		for (BUN i = 0; i < inner_ci->ncand; i++)
+			GEOSGeom_destroy_r(geoshandle, inner_geoms[i]);
+		GDKfree(inner_geoms);
 	}
 	BBPunfix(l->batCacheid);
 	BBPunfix(r->batCacheid);
@@ -617,38 +889,386 @@ free:
 
 str
 wkbIntersectsJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti) {
+	(void) nil_matches;
 #ifdef HAVE_RTREE
-	//If there is an RTree on memory or on file, use the RTree method. Otherwise, use the no index version.
-	if (RTREEexists_bid(*l_id) && RTREEexists_bid(*r_id))
-		return filterJoinRTree(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsJoinRTree");
-	else
-		return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsJoinNoIndex");
-
-#else
-	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsJoinNoIndex");
+	//If either side has an RTree on memory or on file, use the RTree method. Otherwise, use the no index version.
+	if (!*anti && (RTREEexists_bid(*l_id) || RTREEexists_bid(*r_id)))
+		return filterJoinRTree(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*estimate,GEOSDistanceWithin_r,"geom.wkbIntersectsJoinRTree");
 #endif
+	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*estimate,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbIntersectsJoinNoIndex");
 }
 
 str
-wkbDWithinJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, dbl *distance, bit *nil_matches, lng *estimate, bit *anti) {
+wkbDWithinJoinRTree(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *d_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti) {
+	(void) nil_matches;
+	double distance;
+	BAT *d = NULL;
+	//Get the distance BAT and get the double value
+	if ((d = BATdescriptor(*d_id)) == NULL)
+		throw(MAL, "geom.wkbDWithinJoinRTree", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if (BATcount(d) != 1) {
+		BBPunfix(d->batCacheid);
+		throw(MAL, "geom.wkbDWithinJoinRTree", SQLSTATE(42000) "ST_DWithin distance must be a constant in a join");
+	}
+	distance = *((double*) Tloc(d, 0));
+	BBPunfix(d->batCacheid);
 #ifdef HAVE_RTREE
-	if (RTREEexists_bid(*l_id) && RTREEexists_bid(*r_id))
-		return filterJoinRTree(lres_id,rres_id,l_id,r_id,*distance,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinJoinRTree");
-	else
-		return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,*distance,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinJoinNoIndex");
-#else
-	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,*distance,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinJoinNoIndex");
+	if (!*anti && !is_dbl_nil(distance) && (RTREEexists_bid(*l_id) || RTREEexists_bid(*r_id)))
+		return filterJoinRTree(lres_id,rres_id,l_id,r_id,distance,ls_id,rs_id,*estimate,GEOSDistanceWithin_r,"geom.wkbDWithinJoinRTree");
 #endif
+	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,distance,ls_id,rs_id,*estimate,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbDWithinJoinNoIndex");
 }
 
 str
 wkbIntersectsJoinNoIndex(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti) {
-	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbIntersectsJoinNoIndex");
+	(void) nil_matches;
+	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,0,ls_id,rs_id,*estimate,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbIntersectsJoinNoIndex");
 }
 
 str
 wkbDWithinJoinNoIndex(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *ls_id, const bat *rs_id, double *distance, bit *nil_matches, lng *estimate, bit *anti) {
-	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,*distance,ls_id,rs_id,*nil_matches,*estimate,*anti,GEOSDistanceWithin_r,"geom.wkbDWithinJoinNoIndex");
+	(void) nil_matches;
+	return filterJoinNoIndex(lres_id,rres_id,l_id,r_id,*distance,ls_id,rs_id,*estimate,*anti,GEOSPreparedDistanceWithin_r,"geom.wkbDWithinJoinNoIndex");
+}
+
+/* k nearest neighbours
+ * Without an RTree the distance to every candidate is computed.  With
+ * one, the MBR of the probing geometry is grown into a search window
+ * until the window holds k geometries that are not further away than
+ * the distance it was grown by: any geometry closer than that distance
+ * has an MBR intersecting the window, so none can have been missed. */
+struct knnCand {
+	dbl dist;
+	oid o;
+};
+
+static int
+knnCandDistCmp(const void *a, const void *b)
+{
+	const struct knnCand *ca = a, *cb = b;
+	if (ca->dist != cb->dist)
+		return ca->dist < cb->dist ? -1 : 1;
+	return (ca->o > cb->o) - (ca->o < cb->o);
+}
+
+static int
+knnCandOidCmp(const void *a, const void *b)
+{
+	const struct knnCand *ca = a, *cb = b;
+	return (ca->o > cb->o) - (ca->o < cb->o);
+}
+
+struct knnState {
+	BAT *b;
+	BATiter *bi;
+	struct canditer *ci;
+	GEOSGeom *geoms;		/* geometries by candidate position, or NULL to convert from bi */
+	GEOSGeom probe_geom;
+	struct knnCand *cands;		/* room for ci->ncand entries */
+	BUN ncands;
+	const char *name;
+	str msg;
+};
+
+static str
+knnDistance(struct knnState *st, BUN p, oid o, dbl *dist)
+{
+	GEOSGeom geom;
+	str msg = MAL_SUCCEED;
+
+	if (st->geoms)
+		geom = st->geoms[p];
+	else
+		geom = wkb2geos((const wkb*) BUNtvar(*st->bi, o - st->b->hseqbase));
+	if (geom == NULL) {
+		*dist = dbl_nil;
+		return MAL_SUCCEED;
+	}
+	if (GEOSGetSRID_r(geoshandle, geom) != GEOSGetSRID_r(geoshandle, st->probe_geom))
+		msg = createException(MAL, st->name, SQLSTATE(38000) "Geometries of different SRID");
+	else if (!GEOSDistance_r(geoshandle, geom, st->probe_geom, dist))
+		msg = createException(MAL, st->name, SQLSTATE(38000) "Geos operation GEOSDistance failed");
+	if (st->geoms == NULL)
+		GEOSGeom_destroy_r(geoshandle, geom);
+	return msg;
+}
+
+#ifdef HAVE_RTREE
+static int
+knnVisit(oid o, void *arg)
+{
+	struct knnState *st = (struct knnState *) arg;
+	BUN p = canditer_search(st->ci, o, false);
+	dbl dist;
+
+	if (p == BUN_NONE)
+		return 0;
+	if ((st->msg = knnDistance(st, p, o, &dist)) != MAL_SUCCEED)
+		return 1;
+	if (!is_dbl_nil(dist))
+		st->cands[st->ncands++] = (struct knnCand) {.dist = dist, .o = o};
+	return 0;
+}
+#endif
+
+/* Leave the k candidates nearest to st->probe_geom in st->cands, sorted
+ * on oid, and their number in st->ncands.  The RTree of st->b is used
+ * if use_index is set. */
+static str
+knnSearch(struct knnState *st, int k, bool use_index)
+{
+	st->ncands = 0;
+#ifdef HAVE_RTREE
+	if (use_index) {
+		mbr *probe_mbr = mbrFromGeos(st->probe_geom);
+		mbr window;
+		dbl d = 0;
+
+		if (probe_mbr == NULL)
+			throw(MAL, st->name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		if (is_mbr_nil(probe_mbr)) {
+			GDKfree(probe_mbr);
+			return MAL_SUCCEED;
+		}
+		for (;;) {
+			if (d >= GDK_flt_max) {
+				window = (mbr) {.xmin = -GDK_flt_max, .ymin = -GDK_flt_max, .xmax = GDK_flt_max, .ymax = GDK_flt_max};
+			} else {
+				window = (mbr) {
+					.xmin = (float) (probe_mbr->xmin - d),
+					.ymin = (float) (probe_mbr->ymin - d),
+					.xmax = (float) (probe_mbr->xmax + d),
+					.ymax = (float) (probe_mbr->ymax + d),
+				};
+			}
+			st->ncands = 0;
+			if (RTREEvisit(st->b, &window, knnVisit, st) != GDK_SUCCEED) {
+				GDKfree(probe_mbr);
+				if (st->msg == MAL_SUCCEED)
+					st->msg = createException(MAL, st->name, "RTreesearch failed");
+				return st->msg;
+			}
+			if (st->msg != MAL_SUCCEED) {
+				GDKfree(probe_mbr);
+				return st->msg;
+			}
+			qsort(st->cands, st->ncands, sizeof(struct knnCand), knnCandDistCmp);
+			if ((st->ncands >= (BUN) k && st->cands[k - 1].dist <= d) || d >= GDK_flt_max)
+				break;
+			if (st->ncands >= (BUN) k) {
+				//One more search with this window finds everything this close
+				d = st->cands[k - 1].dist;
+			} else if (d > 0) {
+				d *= 2;
+			} else {
+				//Start with the size of the geometry, or a small fraction of its coordinates for points
+				d = probe_mbr->xmax - probe_mbr->xmin;
+				if (probe_mbr->ymax - probe_mbr->ymin > d)
+					d = probe_mbr->ymax - probe_mbr->ymin;
+				if (d == 0) {
+					d = fabs(probe_mbr->xmin) > fabs(probe_mbr->ymin) ? fabs(probe_mbr->xmin) : fabs(probe_mbr->ymin);
+					d = (d > 1 ? d : 1) * 1e-6;
+				}
+			}
+		}
+		GDKfree(probe_mbr);
+	} else
+#else
+	(void) use_index;
+#endif
+	{
+		canditer_reset(st->ci);
+		for (BUN p = 0; p < st->ci->ncand; p++) {
+			oid o = canditer_next(st->ci);
+			dbl dist;
+			str msg;
+
+			if ((msg = knnDistance(st, p, o, &dist)) != MAL_SUCCEED)
+				return msg;
+			if (!is_dbl_nil(dist))
+				st->cands[st->ncands++] = (struct knnCand) {.dist = dist, .o = o};
+		}
+		qsort(st->cands, st->ncands, sizeof(struct knnCand), knnCandDistCmp);
+	}
+	if (st->ncands > (BUN) k)
+		st->ncands = (BUN) k;
+	qsort(st->cands, st->ncands, sizeof(struct knnCand), knnCandOidCmp);
+	return MAL_SUCCEED;
+}
+
+str
+wkbKNearest(bit *out, wkb **a, wkb **b, int *k)
+{
+	(void) a;
+	(void) b;
+	(void) k;
+	*out = bit_nil;
+	throw(MAL, "rtree.KNearest", SQLSTATE(42000) "ST_KNearest can only be used as a filter");
+}
+
+str
+wkbKNearestSelect(bat *outid, const bat *bid, const bat *sid, wkb **wkb_const, int *k, bit *anti)
+{
+	BAT *out = NULL, *b = NULL, *s = NULL;
+	BATiter b_iter;
+	struct canditer ci;
+	struct knnState st = {.name = "geom.wkbKNearestSelect"};
+	str msg = MAL_SUCCEED;
+
+	if (*anti)
+		throw(MAL, st.name, SQLSTATE(0A000) "NOT ST_KNearest is not supported");
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, st.name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if (sid && !is_bat_nil(*sid) && (s = BATdescriptor(*sid)) == NULL) {
+		BBPunfix(b->batCacheid);
+		throw(MAL, st.name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	canditer_init(&ci, b, s);
+	if ((out = COLnew(0, ATOMindex("oid"), is_int_nil(*k) || *k <= 0 ? 0 : (BUN) *k, TRANSIENT)) == NULL) {
+		msg = createException(MAL, st.name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto free;
+	}
+	if (is_int_nil(*k) || *k <= 0 || ci.ncand == 0 || (st.probe_geom = wkb2geos(*wkb_const)) == NULL)
+		goto free;
+	if ((st.cands = GDKmalloc(ci.ncand * sizeof(struct knnCand))) == NULL) {
+		GEOSGeom_destroy_r(geoshandle, st.probe_geom);
+		msg = createException(MAL, st.name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto free;
+	}
+	b_iter = bat_iterator(b);
+	st.b = b;
+	st.bi = &b_iter;
+	st.ci = &ci;
+#ifdef HAVE_RTREE
+	msg = knnSearch(&st, *k, (BUN) *k < ci.ncand && RTREEexists(b));
+#else
+	msg = knnSearch(&st, *k, false);
+#endif
+	bat_iterator_end(&b_iter);
+	GEOSGeom_destroy_r(geoshandle, st.probe_geom);
+	for (BUN i = 0; msg == MAL_SUCCEED && i < st.ncands; i++) {
+		if (BUNappend(out, &st.cands[i].o, false) != GDK_SUCCEED)
+			msg = createException(MAL, st.name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	GDKfree(st.cands);
+free:
+	BBPunfix(b->batCacheid);
+	if (s)
+		BBPunfix(s->batCacheid);
+	if (msg != MAL_SUCCEED) {
+		BBPreclaim(out);
+		return msg;
+	}
+	*outid = out->batCacheid;
+	BBPkeepref(out);
+	return MAL_SUCCEED;
+}
+
+/* Join every geometry of r with the k geometries of l nearest to it */
+str
+wkbKNearestJoin(bat *lres_id, bat *rres_id, const bat *l_id, const bat *r_id, const bat *k_id, const bat *ls_id, const bat *rs_id, bit *nil_matches, lng *estimate, bit *anti)
+{
+	BAT *lres = NULL, *rres = NULL, *l = NULL, *r = NULL, *ls = NULL, *rs = NULL, *kb;
+	BATiter l_iter, r_iter;
+	struct canditer l_ci, r_ci;
+	struct knnState st = {.name = "geom.wkbKNearestJoin"};
+	GEOSGeom *l_geoms = NULL;
+	str msg = MAL_SUCCEED;
+	bool use_index = false;
+	BUN estimate_safe;
+	int k;
+
+	(void) nil_matches;
+	if (*anti)
+		throw(MAL, st.name, SQLSTATE(0A000) "NOT ST_KNearest is not supported");
+	if ((kb = BATdescriptor(*k_id)) == NULL)
+		throw(MAL, st.name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if (BATcount(kb) != 1) {
+		BBPunfix(kb->batCacheid);
+		throw(MAL, st.name, SQLSTATE(42000) "ST_KNearest k must be a constant in a join");
+	}
+	k = *((int*) Tloc(kb, 0));
+	BBPunfix(kb->batCacheid);
+	if ((l = BATdescriptor(*l_id)) == NULL || (r = BATdescriptor(*r_id)) == NULL) {
+		if (l)
+			BBPunfix(l->batCacheid);
+		throw(MAL, st.name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if ((ls_id && !is_bat_nil(*ls_id) && (ls = BATdescriptor(*ls_id)) == NULL) ||
+	    (rs_id && !is_bat_nil(*rs_id) && (rs = BATdescriptor(*rs_id)) == NULL)) {
+		msg = createException(MAL, st.name, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+		goto free;
+	}
+	canditer_init(&l_ci, l, ls);
+	canditer_init(&r_ci, r, rs);
+
+	if (is_lng_nil(*estimate) || *estimate <= 0 || *estimate > (lng) BUN_MAX)
+		estimate_safe = is_int_nil(k) || k <= 0 ? 0 : r_ci.ncand * (BUN) k;
+	else
+		estimate_safe = (BUN) *estimate;
+	if ((lres = COLnew(0, ATOMindex("oid"), estimate_safe, TRANSIENT)) == NULL ||
+	    (rres = COLnew(0, ATOMindex("oid"), estimate_safe, TRANSIENT)) == NULL) {
+		msg = createException(MAL, st.name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto free;
+	}
+	if (is_int_nil(k) || k <= 0 || l_ci.ncand == 0)
+		goto free;
+
+	//Convert the wkbs of the searched side to GEOS only once
+	if ((l_geoms = GDKzalloc(l_ci.ncand * sizeof(GEOSGeometry *))) == NULL ||
+	    (st.cands = GDKmalloc(l_ci.ncand * sizeof(struct knnCand))) == NULL) {
+		msg = createException(MAL, st.name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto free;
+	}
+	l_iter = bat_iterator(l);
+	for (BUN i = 0; i < l_ci.ncand; i++) {
+		oid l_oid = canditer_next(&l_ci);
+		l_geoms[i] = wkb2geos((const wkb*) BUNtvar(l_iter, l_oid - l->hseqbase));
+	}
+	bat_iterator_end(&l_iter);
+	st.b = l;
+	st.ci = &l_ci;
+	st.geoms = l_geoms;
+#ifdef HAVE_RTREE
+	use_index = (BUN) k < l_ci.ncand && RTREEexists(l);
+#endif
+
+	r_iter = bat_iterator(r);
+	for (BUN j = 0; j < r_ci.ncand && msg == MAL_SUCCEED; j++) {
+		oid r_oid = canditer_next(&r_ci);
+		if ((st.probe_geom = wkb2geos((const wkb*) BUNtvar(r_iter, r_oid - r->hseqbase))) == NULL)
+			continue;
+		msg = knnSearch(&st, k, use_index);
+		GEOSGeom_destroy_r(geoshandle, st.probe_geom);
+		for (BUN i = 0; msg == MAL_SUCCEED && i < st.ncands; i++) {
+			if (BUNappend(lres, &st.cands[i].o, false) != GDK_SUCCEED || BUNappend(rres, &r_oid, false) != GDK_SUCCEED)
+				msg = createException(MAL, st.name, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		}
+	}
+	bat_iterator_end(&r_iter);
+free:
+	if (l_geoms) {
+		for (BUN i = 0; i < l_ci.ncand; i++)
+			GEOSGeom_destroy_r(geoshandle, l_geoms[i]);
+		GDKfree(l_geoms);
+	}
+	GDKfree(st.cands);
+	BBPunfix(l->batCacheid);
+	BBPunfix(r->batCacheid);
+	if (ls)
+		BBPunfix(ls->batCacheid);
+	if (rs)
+		BBPunfix(rs->batCacheid);
+	if (msg != MAL_SUCCEED) {
+		BBPreclaim(lres);
+		BBPreclaim(rres);
+		return msg;
+	}
+	*lres_id = lres->batCacheid;
+	BBPkeepref(lres);
+	*rres_id = rres->batCacheid;
+	BBPkeepref(rres);
+	return MAL_SUCCEED;
 }
 
 //MBR bulk function
@@ -1768,101 +2388,80 @@ wkbContains_bat(bat *outBAT_id, bat *aBAT_id, bat *bBAT_id)
 	return ret;
 }
 
-str
-wkbContains_geom_bat(bat *outBAT_id, wkb **geomWKB, bat *inBAT_id)
+/* batgeom.Contains with one constant argument.  The constant is
+ * converted and prepared once; a contains b requires the box of b to
+ * lie inside the box of a, and is then tested as "constant contains row"
+ * or as "constant within row". */
+static str
+wkbContains_const(bat *outBAT_id, bat *inBAT_id, wkb *geomWKB, bool const_first)
 {
 	BAT *outBAT = NULL, *inBAT = NULL;
 	BATiter inBAT_iter;
-	BUN p = 0, q = 0;
+	struct constPred cp;
+	oid oids[GEOM_CHUNK];
+	bit *res;
+	bool nils = false;
+	str msg = MAL_SUCCEED;
+	BUN cnt;
 
 	//get the descriptor of the BAT
 	if ((inBAT = BATdescriptor(*inBAT_id)) == NULL) {
 		throw(MAL, "batgeom.Contains", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 	}
+	cnt = BATcount(inBAT);
 
 	//create a new BAT for the output
-	if ((outBAT = COLnew(inBAT->hseqbase, ATOMindex("bit"), BATcount(inBAT), TRANSIENT)) == NULL) {
+	if ((outBAT = COLnew(inBAT->hseqbase, ATOMindex("bit"), cnt, TRANSIENT)) == NULL) {
 		BBPunfix(inBAT->batCacheid);
 		throw(MAL, "batgeom.Contains", SQLSTATE(HY013) MAL_MALLOC_FAIL);
 	}
+	res = (bit *) Tloc(outBAT, 0);
 
-	//iterator over the BATs
-	inBAT_iter = bat_iterator(inBAT);
-	BATloop(inBAT, p, q) {
-		str err = NULL;
-		bit outBIT;
-
-		wkb *inWKB = (wkb *) BUNtvar(inBAT_iter, p);
-
-		if ((err = wkbContains(&outBIT, geomWKB, &inWKB)) != MAL_SUCCEED) {
-			bat_iterator_end(&inBAT_iter);
-			BBPunfix(inBAT->batCacheid);
-			BBPunfix(outBAT->batCacheid);
-			return err;
-		}
-		if (BUNappend(outBAT, &outBIT, false) != GDK_SUCCEED) {
-			bat_iterator_end(&inBAT_iter);
-			BBPunfix(inBAT->batCacheid);
-			BBPunfix(outBAT->batCacheid);
-			throw(MAL, "batgeom.Contains", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	if (is_wkb_nil(geomWKB)) {
+		for (BUN i = 0; i < cnt; i++)
+			res[i] = bit_nil;
+		nils = cnt > 0;
+	} else if ((msg = constPredInit(&cp, geomWKB, 0, const_first ? MBR_INSIDE : MBR_COVERS, const_first ? geosPreparedContains : geosPreparedWithin, "batgeom.Contains")) == MAL_SUCCEED) {
+		inBAT_iter = bat_iterator(inBAT);
+		for (BUN i = 0; i < cnt; i += GEOM_CHUNK) {
+			BUN n = cnt - i < GEOM_CHUNK ? cnt - i : GEOM_CHUNK;
+			for (BUN k = 0; k < n; k++)
+				oids[k] = inBAT->hseqbase + i + k;
+			if ((msg = constPredChunk(&cp, &inBAT_iter, inBAT->hseqbase, oids, n, res + i)) != MAL_SUCCEED)
+				break;
+			for (BUN k = 0; k < n; k++)
+				nils |= is_bit_nil(res[i + k]);
 		}
+		bat_iterator_end(&inBAT_iter);
+		constPredDestroy(&cp);
 	}
-	bat_iterator_end(&inBAT_iter);
 
 	BBPunfix(inBAT->batCacheid);
+	if (msg != MAL_SUCCEED) {
+		BBPreclaim(outBAT);
+		return msg;
+	}
+	BATsetcount(outBAT, cnt);
+	outBAT->tnil = nils;
+	outBAT->tnonil = !nils;
+	outBAT->tsorted = outBAT->trevsorted = cnt <= 1;
+	outBAT->tkey = cnt <= 1;
 	*outBAT_id = outBAT->batCacheid;
 	BBPkeepref(outBAT);
 
 	return MAL_SUCCEED;
+}
 
+str
+wkbContains_geom_bat(bat *outBAT_id, wkb **geomWKB, bat *inBAT_id)
+{
+	return wkbContains_const(outBAT_id, inBAT_id, *geomWKB, true);
 }
 
 str
 wkbContains_bat_geom(bat *outBAT_id, bat *inBAT_id, wkb **geomWKB)
 {
-	BAT *outBAT = NULL, *inBAT = NULL;
-	BATiter inBAT_iter;
-	BUN p = 0, q = 0;
-
-	//get the descriptor of the BAT
-	if ((inBAT = BATdescriptor(*inBAT_id)) == NULL) {
-		throw(MAL, "batgeom.Contains", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
-	}
-
-	//create a new BAT for the output
-	if ((outBAT = COLnew(inBAT->hseqbase, ATOMindex("bit"), BATcount(inBAT), TRANSIENT)) == NULL) {
-		BBPunfix(inBAT->batCacheid);
-		throw(MAL, "batgeom.Contains", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-	}
-
-	//iterator over the BATs
-	inBAT_iter = bat_iterator(inBAT);
-	BATloop(inBAT, p, q) {
-		str err = NULL;
-		bit outBIT;
-
-		wkb *inWKB = (wkb *) BUNtvar(inBAT_iter, p);
-
-		if ((err = wkbContains(&outBIT, &inWKB, geomWKB)) != MAL_SUCCEED) {
-			bat_iterator_end(&inBAT_iter);
-			BBPunfix(inBAT->batCacheid);
-			BBPunfix(outBAT->batCacheid);
-			return err;
-		}
-		if (BUNappend(outBAT, &outBIT, false) != GDK_SUCCEED) {
-			bat_iterator_end(&inBAT_iter);
-			BBPunfix(inBAT->batCacheid);
-			BBPunfix(outBAT->batCacheid);
-			throw(MAL, "batgeom.Contains", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		}
-	}
-	bat_iterator_end(&inBAT_iter);
-
-	BBPunfix(inBAT->batCacheid);
-	*outBAT_id = outBAT->batCacheid;
-	BBPkeepref(outBAT);
-
-	return MAL_SUCCEED;
+	return wkbContains_const(outBAT_id, inBAT_id, *geomWKB, false);
 }
 
 
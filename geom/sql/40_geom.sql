@@ -32,6 +32,8 @@ CREATE FILTER FUNCTION ST_DWithin(geom1 Geometry, geom2 Geometry, distance doubl
 GRANT EXECUTE ON FILTER ST_DWithin(Geometry, Geometry, double) TO PUBLIC;
 CREATE FILTER FUNCTION ST_DWithin_NoIndex(geom1 Geometry, geom2 Geometry, distance double) EXTERNAL NAME geom."DWithin_noindex";
 GRANT EXECUTE ON FILTER ST_DWithin_NoIndex(Geometry, Geometry, double) TO PUBLIC;
+CREATE FILTER FUNCTION ST_KNearest(geom1 Geometry, geom2 Geometry, k integer) EXTERNAL NAME rtree."KNearest";
+GRANT EXECUTE ON FILTER ST_KNearest(Geometry, Geometry, integer) TO PUBLIC;
 
 -------------------------------------------------------------------------
 ------------------------- Old Geom functions ----------------------------
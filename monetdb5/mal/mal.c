@@ -37,6 +37,7 @@ lng MALdebug;
 #include "mal_private.h"
 #include "mal_internal.h"
 #include "mal_runtime.h"
+#include "mal_recycle.h"
 #include "mal_resource.h"
 #include "mal_atom.h"
 #include "mutils.h"
@@ -141,6 +142,7 @@ mal_reset(void)
 	mal_linker_reset();
 	mal_resource_reset();
 	mal_runtime_reset();
+	mal_recycle_reset();
 	mal_module_reset();
 	mal_atom_reset();
 
@@ -151,7 +151,8 @@ typedef struct INSTR {
 		inlineProp:1,			/* inline property */
 		unsafeProp:1,			/* unsafe property */
 		gc:1,					/* garbage control flags */
-		typeresolved:1;			/* true if type is resolved */
+		typeresolved:1,			/* true if type is resolved */
+		recycle:2;				/* role in the lineage of recycled results */
 	int jump;					/* controlflow program counter */
 	int pc;						/* location in MAL plan for profiler */
 	MALfcn fcn;					/* resolved function address */
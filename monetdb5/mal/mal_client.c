@@ -278,9 +278,13 @@ MCinitClientRecord(Client c, oid user, bstream *fin, stream *fout)
 	c->error_row = c->error_fld = c->error_msg = c->error_input = NULL;
 	c->sqlprofiler = 0;
 	c->blocksize = BLOCK;
+	c->compression = BS_COMPRESSION_NONE;
+	c->compressionlevel = 0;
 	c->protocol = PROTOCOL_9;
 
 	c->filetrans = false;
+	c->sock = -1;
+	c->parked = false;
 	c->handshake_options = NULL;
 	c->query = NULL;
 
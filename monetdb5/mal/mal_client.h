@@ -146,6 +146,12 @@ typedef struct CLIENT {
 	 */
 	MT_Sema s;					/* sema to (de)activate thread */
 	const char *mythread;
+	/*
+	 * Between requests a network session may give up its thread, see
+	 * MSparkClient.
+	 */
+	int sock;					/* socket of a network session, or -1 */
+	bool parked;				/* waiting for input without a thread */
 	str errbuf;					/* location of GDK exceptions */
 	struct CLIENT *father;
 	/*
@@ -176,6 +182,8 @@ typedef struct CLIENT {
 	BAT *error_input;
 
 	size_t blocksize;
+	bs_compression compression;	/* of the large blocks */
+	int compressionlevel;
 	protocol_version protocol;
 	bool filetrans;				/* whether the client can read files for us */
 	char *handshake_options;
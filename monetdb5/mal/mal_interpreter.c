@@ -16,6 +16,7 @@
  */
 #include "monetdb_config.h"
 #include "mal_runtime.h"
+#include "mal_recycle.h"
 #include "mal_interpreter.h"
 #include "mal_resource.h"
 #include "mal_listing.h"
@@ -500,8 +501,9 @@ runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 	int garbages[16], *garbage;
 	int stkpc = 0;
 	RuntimeProfileRecord runtimeProfile, runtimeProfileFunction;
-	lng lastcheck = 0;
+	lng lastcheck = 0, rstart = 0;
 	bool startedProfileQueue = false;
+	struct recycled *rentry = NULL;
 #define CHECKINTERVAL 1000		/* how often do we check for client disconnect */
 	runtimeProfile.ticks = runtimeProfileFunction.ticks = 0;
 
@@ -664,6 +666,13 @@ runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 			}
 		}
 
+		/* take the results from the recycle cache if they are there */
+		if (pci->recycle == RECYCLE_CACHE
+			&& RECYCLEentry(cntxt, mb, stk, pci, &rentry))
+			goto recycled;
+		if (rentry)
+			rstart = GDKusec();
+
 		switch (pci->token) {
 		case ASSIGNsymbol:
 			/* Assignment command
@@ -871,7 +880,12 @@ runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 			continue;
 		}
 		}
+		if (rentry) {
+			RECYCLEexit(stk, pci, rentry, ret == MAL_SUCCEED, GDKusec() - rstart);
+			rentry = NULL;
+		}
 
+	  recycled:
 		/* monitoring information should reflect the input arguments,
 		   which may be removed by garbage collection  */
 		/* BEWARE, the SQL engine or MAL function could zap the block, leaving garbage behind in pci */
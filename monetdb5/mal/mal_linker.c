@@ -529,7 +529,7 @@ MSP_locate_sqlscript(const char *filename, bit recurse)
 int
 malLibraryEnabled(const char *name)
 {
-	if (strcmp(name, "pyapi3") == 0) {
+	if (strcmp(name, "pyapi3") == 0 || strcmp(name, "pyapi3map") == 0) {
 		const char *val = GDKgetenv("embedded_py");
 		return val && (strcmp(val, "3") == 0 ||
 					   strcasecmp(val, "true") == 0 ||
@@ -538,7 +538,7 @@ malLibraryEnabled(const char *name)
 		const char *val = GDKgetenv("embedded_r");
 		return val && (strcasecmp(val, "true") == 0 ||
 					   strcasecmp(val, "yes") == 0);
-	} else if (strcmp(name, "capi") == 0) {
+	} else if (strcmp(name, "capi") == 0 || strcmp(name, "capimap") == 0) {
 		const char *val = GDKgetenv("embedded_c");
 		return val && (strcasecmp(val, "true") == 0 ||
 					   strcasecmp(val, "yes") == 0);
@@ -559,11 +559,11 @@ malLibraryEnabled(const char *name)
 char *
 malLibraryHowToEnable(const char *name)
 {
-	if (strcmp(name, "pyapi3") == 0) {
+	if (strcmp(name, "pyapi3") == 0 || strcmp(name, "pyapi3map") == 0) {
 		HOW_TO_ENABLE_ERROR("Python 3", "embedded_py=3");
 	} else if (strcmp(name, "rapi") == 0) {
 		HOW_TO_ENABLE_ERROR("R", "embedded_r=true");
-	} else if (strcmp(name, "capi") == 0) {
+	} else if (strcmp(name, "capi") == 0 || strcmp(name, "capimap") == 0) {
 		HOW_TO_ENABLE_ERROR("C/C++", "embedded_c=true");
 	}
 	return "";
@@ -424,12 +424,11 @@ fmtRemark(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, str t, int flg, str base,
 			GDKfree(arg1);
 			GDKfree(arg2);
 		}
-	} else if (pci->argc == 1) {
-		if (getFunctionId(pci)) {
-			if (!copystring(&t, getFunctionId(pci), &len))
-				return base;
-		}
-	} else if (getVar(mb, getArg(pci, 0))->value.val.sval &&
+	} else if (pci->argc == 1 && getFunctionId(pci)) {
+		if (!copystring(&t, getFunctionId(pci), &len))
+			return base;
+	} else if (getVar(mb, getArg(pci, 0))->value.vtype == TYPE_str &&
+			   getVar(mb, getArg(pci, 0))->value.val.sval &&
 			   getVar(mb, getArg(pci, 0))->value.len > 0 &&
 			   !copystring(&t, getVar(mb, getArg(pci, 0))->value.val.sval,
 						   &len))
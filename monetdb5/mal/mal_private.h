@@ -30,6 +30,13 @@ bool MCshutdowninprogress(void)
 	__attribute__((__visibility__("hidden")));
 str defaultScenario(Client c)	/* used in src/mal/mal_session.c */
 	__attribute__((__visibility__("hidden")));
+
+/* mal_recycle.c */
+struct recycled;
+bool RECYCLEentry(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, struct recycled **entry)
+	__attribute__((__visibility__("hidden")));
+void RECYCLEexit(MalStkPtr stk, InstrPtr pci, struct recycled *entry, bool success, lng usec)
+	__attribute__((__visibility__("hidden")));
 #endif
 
 str malAtomDefinition(const char *name,int tpe)
@@ -75,6 +82,9 @@ void mal_namespace_reset(void)
 void mal_resource_reset(void)
 	__attribute__((__visibility__("hidden")));
 
+void mal_recycle_reset(void)
+	__attribute__((__visibility__("hidden")));
+
 void mal_runtime_reset(void)
 	__attribute__((__visibility__("hidden")));
 
@@ -859,8 +859,14 @@ initTrace(Client cntxt)
 	cntxt->profstmt = TRACEcreate(TYPE_str);
 	cntxt->profevents = TRACEcreate(TYPE_str);
 	if (cntxt->profticks == NULL || cntxt->profstmt == NULL
-		|| cntxt->profevents == NULL)
+		|| cntxt->profevents == NULL) {
 		_cleanupProfiler(cntxt);
+	} else {
+		/* the session may continue on another thread */
+		BBPdisown(cntxt->profticks->batCacheid);
+		BBPdisown(cntxt->profstmt->batCacheid);
+		BBPdisown(cntxt->profevents->batCacheid);
+	}
 	MT_lock_unset(&mal_profileLock);
 }
 
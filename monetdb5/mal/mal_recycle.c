@@ -0,0 +1,528 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+/*
+ * The recycler keeps the results of expensive instructions around for
+ * reuse by later queries.  A result is identified by its lineage: the
+ * operation, the values of the scalar arguments and, recursively, the
+ * lineage of the BAT arguments down to the instructions which bind the
+ * persistent data.  The recycler optimizer marks the instructions which
+ * take part in a lineage.  The versions of the bound data are provided by
+ * the SQL layer, an entry is dropped as soon as a newer version of one of
+ * its tables shows up.
+ *
+ * Recycling is off unless the recycler optimizer is added to the pipeline
+ * and recycle_memory is set.  Only results which took some time to compute
+ * are admitted and the cache is bounded by recycle_memory.  When full, the
+ * entries with the least benefit, i.e. the time saved by the entry per
+ * byte kept, are evicted first.  The entries are chained in a hash table
+ * on their key.
+ *
+ * A kept BAT is moved to the SYSTRANS farm, so that its memory is no
+ * longer charged to the query which happened to compute it, and made read
+ * only.  A hit shares the kept BAT with the query instead of copying it.
+ */
+#include "monetdb_config.h"
+#include "mal_recycle.h"
+#include "mal_interpreter.h"
+#include "mal_runtime.h"
+#include "mal_private.h"
+
+#define RECYCLE_MINCOST	1000	/* usec, cheaper instructions are recomputed */
+#define RECYCLE_MAXKEY	(64 * 1024)
+#define RECYCLE_MAXSRC	16
+#define RECYCLE_BUCKETS	1024	/* power of two */
+
+typedef struct recyclesrc {
+	int id;						/* table of the bound data */
+	ulng version;				/* version of its content */
+} recyclesrc;
+
+typedef struct recycled {
+	struct recycled *next;
+	char *key;					/* lineage of the result */
+	BUN hash;
+	int nsrc;
+	recyclesrc src[RECYCLE_MAXSRC];
+	int retc;
+	ValRecord *res;				/* the kept results */
+	lng cost;					/* time to compute the results (usec) */
+	lng size;					/* bytes kept */
+	lng hits;
+	lng used;					/* tick of the last use */
+} recycled;
+
+static MT_Lock recycleLock = MT_LOCK_INITIALIZER(recycleLock);
+static recycled *recycleHash[RECYCLE_BUCKETS];
+static lng recycleSize, recycleTick;
+static RecycleSource recycleSource;
+
+lng
+RECYCLEcapacity(void)
+{
+	int mb;
+
+	if (recycleSource == NULL)
+		return 0;
+	mb = GDKgetenv_int("recycle_memory", 0);
+	if (mb <= 0)
+		return 0;
+	return (lng) mb << 20;
+}
+
+/* a kept BAT is not accounted to the query releasing it */
+static void
+recycle_release(bat bid)
+{
+	QryCtx *qc = MT_thread_get_qry_ctx();
+
+	MT_thread_set_qry_ctx(NULL);
+	BBPrelease(bid);
+	MT_thread_set_qry_ctx(qc);
+}
+
+/*
+ * Hand a result over to the cache.  A BAT owning its heaps is kept as is,
+ * its heaps are moved to the SYSTRANS farm like the SQL storage does with
+ * its transient BATs.  A view is copied into the SYSTRANS farm.
+ */
+static bat
+recycle_keep(bat bid)
+{
+	QryCtx *qc = MT_thread_get_qry_ctx();
+	BAT *b, *bn;
+	bool owned;
+
+	if ((b = BATdescriptor(bid)) == NULL)
+		return bat_nil;
+	MT_lock_set(&b->theaplock);
+	owned = b->theap->parentid == b->batCacheid
+		&& (b->tvheap == NULL || b->tvheap->parentid == b->batCacheid);
+	if (owned) {
+		if (b->theap->farmid == TRANSIENT) {
+			if (qc)
+				ATOMIC_SUB(&qc->datasize, b->theap->size);
+			b->theap->farmid = SYSTRANS;
+		}
+		if (b->tvheap && b->tvheap->farmid == TRANSIENT) {
+			if (qc)
+				ATOMIC_SUB(&qc->datasize, b->tvheap->size);
+			b->tvheap->farmid = SYSTRANS;
+		}
+		b->batRole = SYSTRANS;
+	}
+	MT_lock_unset(&b->theaplock);
+	if (!owned) {
+		MT_thread_set_qry_ctx(NULL);
+		bn = COLcopy(b, b->ttype, true, SYSTRANS);
+		MT_thread_set_qry_ctx(qc);
+		BBPunfix(b->batCacheid);
+		if ((b = bn) == NULL)
+			return bat_nil;
+	}
+	if ((b = BATsetaccess(b, BAT_READ)) == NULL)
+		return bat_nil;
+	bid = b->batCacheid;
+	if (owned) {
+		BBPretain(bid);
+		BBPunfix(bid);
+	} else {
+		BBPkeepref(b);
+	}
+	return bid;
+}
+
+static void
+recycle_destroy(recycled *r)
+{
+	if (r->res) {
+		for (int i = 0; i < r->retc; i++) {
+			if (r->res[i].bat) {
+				if (!is_bat_nil(r->res[i].val.bval))
+					recycle_release(r->res[i].val.bval);
+			} else
+				VALclear(&r->res[i]);
+		}
+		GDKfree(r->res);
+	}
+	GDKfree(r->key);
+	GDKfree(r);
+}
+
+static void
+recycle_destroy_list(recycled *r)
+{
+	for (recycled *n; r; r = n) {
+		n = r->next;
+		recycle_destroy(r);
+	}
+}
+
+/* drop all entries, e.g. when the meaning of the versions changes */
+void
+RECYCLEsetsource(RecycleSource f)
+{
+	recycled *r = NULL, *e, *n;
+
+	MT_lock_set(&recycleLock);
+	recycleSource = f;
+	for (int i = 0; i < RECYCLE_BUCKETS; i++) {
+		for (e = recycleHash[i]; e; e = n) {
+			n = e->next;
+			e->next = r;
+			r = e;
+		}
+		recycleHash[i] = NULL;
+	}
+	recycleSize = 0;
+	MT_lock_unset(&recycleLock);
+	recycle_destroy_list(r);
+}
+
+void
+mal_recycle_reset(void)
+{
+	RECYCLEsetsource(NULL);
+}
+
+/*
+ * The lineage of an instruction is printed into a key, e.g.
+ * algebra.thetaselect:...(( sql.bind:...(...)@id:version )0, ...)
+ */
+typedef struct lineage {
+	Client cntxt;
+	MalBlkPtr mb;
+	MalStkPtr stk;
+	recycled *r;
+	size_t len, size;
+	bool ok;
+} lineage;
+
+static void
+key_add(lineage *l, const char *s, size_t len)
+{
+	recycled *r = l->r;
+
+	if (!l->ok)
+		return;
+	if (l->len + len >= l->size) {
+		size_t size = MAX(l->size * 2, l->len + len + 1);
+		char *key;
+
+		if (size > RECYCLE_MAXKEY || (key = GDKrealloc(r->key, size)) == NULL) {
+			l->ok = false;
+			return;
+		}
+		r->key = key;
+		l->size = size;
+	}
+	memcpy(r->key + l->len, s, len);
+	l->len += len;
+	r->key[l->len] = 0;
+}
+
+static void
+key_int(lineage *l, char tag, lng v)
+{
+	char buf[32];
+	int len = snprintf(buf, sizeof(buf), "%c" LLFMT, tag, v);
+
+	key_add(l, buf, len);
+}
+
+static void
+key_value(lineage *l, ValPtr v)
+{
+	char *s = VALformat(v);
+
+	if (s == NULL) {
+		l->ok = false;
+		return;
+	}
+	key_int(l, 't', v->vtype);
+	key_int(l, ':', (lng) strlen(s));
+	key_add(l, ":", 1);
+	key_add(l, s, strlen(s));
+	GDKfree(s);
+}
+
+static void key_instruction(lineage *l, InstrPtr p);
+
+static void
+key_argument(lineage *l, InstrPtr p, int i)
+{
+	MalBlkPtr mb = l->mb;
+	int a = getArg(p, i), pc;
+	InstrPtr q;
+
+	if (!isaBatType(getArgType(mb, p, i)) || isVarConstant(mb, a)) {
+		key_value(l, &l->stk->stk[a]);
+		return;
+	}
+	/* a BAT is identified by the lineage of the instruction producing it */
+	pc = getVarDeclared(mb, a);
+	if (pc <= 0 || pc >= mb->stop
+		|| (q = getInstrPtr(mb, pc))->recycle == RECYCLE_NONE) {
+		l->ok = false;
+		return;
+	}
+	for (int r = 0; r < q->retc; r++) {
+		if (getArg(q, r) == a) {
+			key_add(l, "(", 1);
+			key_instruction(l, q);
+			key_int(l, ')', r);
+			return;
+		}
+	}
+	l->ok = false;
+}
+
+static void
+key_instruction(lineage *l, InstrPtr p)
+{
+	recycled *r = l->r;
+
+	key_add(l, getModuleId(p), strlen(getModuleId(p)));
+	key_add(l, ".", 1);
+	key_add(l, getFunctionId(p), strlen(getFunctionId(p)));
+	for (int i = 0; i < p->retc; i++)
+		key_int(l, ':', getArgType(l->mb, p, i));
+	key_add(l, "(", 1);
+	for (int i = p->retc; l->ok && i < p->argc; i++) {
+		key_argument(l, p, i);
+		key_add(l, ",", 1);
+	}
+	key_add(l, ")", 1);
+	if (l->ok && p->recycle == RECYCLE_SOURCE) {
+		int id, k;
+		ulng version;
+
+		if (!recycleSource || !recycleSource(l->cntxt, l->stk, p, &id, &version)) {
+			l->ok = false;
+			return;
+		}
+		key_int(l, '@', id);
+		key_int(l, ':', (lng) version);
+		for (k = 0; k < r->nsrc; k++)
+			if (r->src[k].id == id)
+				break;
+		if (k == r->nsrc) {
+			if (k == RECYCLE_MAXSRC) {
+				l->ok = false;
+				return;
+			}
+			r->src[r->nsrc++] = (recyclesrc) {.id = id,.version = version };
+		}
+	}
+}
+
+static inline bool
+recycle_stale(const recycled *e, const recycled *r)
+{
+	for (int i = 0; i < e->nsrc; i++)
+		for (int j = 0; j < r->nsrc; j++)
+			if (e->src[i].id == r->src[j].id
+				&& e->src[i].version < r->src[j].version)
+				return true;
+	return false;
+}
+
+/*
+ * Look for the results of the instruction in the cache.  On a hit they
+ * are put on the stack.  Otherwise, *entry is set when the results may
+ * be kept, to be passed on to RECYCLEexit.
+ */
+bool
+RECYCLEentry(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
+			 recycled **entry)
+{
+	recycled *r, *e, **ep, *garbage = NULL;
+	lineage l;
+	bool hit = false, complete = true;
+
+	*entry = NULL;
+	if (RECYCLEcapacity() <= 0)
+		return false;
+	if ((r = GDKzalloc(sizeof(recycled))) == NULL)
+		return false;
+	l = (lineage) {.cntxt = cntxt,.mb = mb,.stk = stk,.r = r,.ok = true };
+	key_instruction(&l, pci);
+	if (!l.ok || r->nsrc == 0) {
+		recycle_destroy(r);
+		return false;
+	}
+	r->hash = strHash(r->key);
+	r->retc = pci->retc;
+	if ((r->res = GDKzalloc(pci->retc * sizeof(ValRecord))) == NULL) {
+		recycle_destroy(r);
+		return false;
+	}
+
+	MT_lock_set(&recycleLock);
+	for (ep = &recycleHash[r->hash & (RECYCLE_BUCKETS - 1)]; (e = *ep) != NULL;) {
+		if (recycle_stale(e, r)) {
+			/* the data changed since */
+			*ep = e->next;
+			recycleSize -= e->size;
+			e->next = garbage;
+			garbage = e;
+			continue;
+		}
+		if (!hit && e->hash == r->hash && strcmp(e->key, r->key) == 0) {
+			/* share the kept results with the query */
+			for (int i = 0; i < pci->retc; i++) {
+				if (VALcopy(&r->res[i], &e->res[i]) == NULL)
+					complete = false;
+				else if (r->res[i].bat)
+					BBPretain(r->res[i].val.bval);
+			}
+			e->hits++;
+			e->used = ++recycleTick;
+			hit = true;
+		}
+		ep = &e->next;
+	}
+	MT_lock_unset(&recycleLock);
+	recycle_destroy_list(garbage);
+	if (hit) {
+		int i;
+
+		for (i = 0; complete && i < pci->retc; i++) {
+			ValPtr v = &stk->stk[getArg(pci, i)];
+
+			if (!r->res[i].bat) {
+				if (VALcopy(v, &r->res[i]) == NULL)
+					break;
+			} else if (is_bat_nil(r->res[i].val.bval)) {
+				break;
+			} else {
+				/* the reference retained above moves to the stack */
+				*v = r->res[i];
+				r->res[i].val.bval = bat_nil;
+			}
+		}
+		if (!complete || i < pci->retc) {
+			/* compute it after all */
+			hit = false;
+			while (i-- > 0) {
+				ValPtr v = &stk->stk[getArg(pci, i)];
+
+				if (v->bat)
+					BBPrelease(v->val.bval);
+				else
+					VALclear(v);
+				*v = (ValRecord) {.vtype = TYPE_void };
+			}
+		}
+		recycle_destroy(r);
+		if (!hit)
+			return false;
+	} else {
+		*entry = r;
+	}
+	return hit;
+}
+
+/* the benefit of keeping an entry */
+static inline dbl
+recycle_benefit(const recycled *e)
+{
+	return (dbl) e->cost * (e->hits + 1) / (e->size + 1);
+}
+
+/*
+ * Decide whether the freshly computed results are kept.  The cache makes
+ * room by evicting entries with less benefit than the new one.
+ */
+void
+RECYCLEexit(MalStkPtr stk, InstrPtr pci, recycled *r, bool success, lng usec)
+{
+	lng capacity = RECYCLEcapacity();
+	recycled *e, **ep, **victim, *garbage = NULL;
+
+	if (!success || usec < RECYCLE_MINCOST || capacity <= 0)
+		goto bailout;
+	r->cost = usec;
+	for (int i = 0; i < pci->retc; i++) {
+		ValPtr v = &stk->stk[getArg(pci, i)];
+		BAT *b;
+
+		if (!v->bat) {
+			r->size += sizeof(ValRecord) + (ATOMextern(v->vtype) ? (lng) ATOMlen(v->vtype, VALptr(v)) : 0);
+			continue;
+		}
+		/* the bound persistent data itself may change in place */
+		if (is_bat_nil(v->val.bval)
+			|| (b = BATdescriptor(v->val.bval)) == NULL)
+			goto bailout;
+		r->size += getBatSpace(b);
+		bool persistent = !b->batTransient;
+		BBPunfix(b->batCacheid);
+		if (persistent)
+			goto bailout;
+	}
+	if (r->size > capacity / 4)
+		goto bailout;
+	for (int i = 0; i < pci->retc; i++) {
+		ValPtr v = &stk->stk[getArg(pci, i)];
+
+		if (v->bat) {
+			r->res[i] = *v;
+			r->res[i].val.bval = recycle_keep(v->val.bval);
+			if (is_bat_nil(r->res[i].val.bval))
+				goto bailout;
+		} else if (VALcopy(&r->res[i], v) == NULL) {
+			goto bailout;
+		}
+	}
+
+	MT_lock_set(&recycleLock);
+	for (e = recycleHash[r->hash & (RECYCLE_BUCKETS - 1)]; e; e = e->next) {
+		if (e->hash == r->hash && strcmp(e->key, r->key) == 0) {
+			/* computed concurrently */
+			MT_lock_unset(&recycleLock);
+			goto bailout;
+		}
+	}
+	while (recycleSize + r->size > capacity) {
+		victim = NULL;
+		for (int i = 0; i < RECYCLE_BUCKETS; i++) {
+			for (ep = &recycleHash[i]; (e = *ep) != NULL; ep = &e->next) {
+				if (victim == NULL
+					|| recycle_benefit(e) < recycle_benefit(*victim)
+					|| (recycle_benefit(e) == recycle_benefit(*victim)
+						&& e->used < (*victim)->used))
+					victim = ep;
+			}
+		}
+		if (victim == NULL || recycle_benefit(*victim) > recycle_benefit(r))
+			break;
+		e = *victim;
+		*victim = e->next;
+		recycleSize -= e->size;
+		e->next = garbage;
+		garbage = e;
+	}
+	if (recycleSize + r->size <= capacity) {
+		ep = &recycleHash[r->hash & (RECYCLE_BUCKETS - 1)];
+		r->used = ++recycleTick;
+		r->next = *ep;
+		*ep = r;
+		recycleSize += r->size;
+		r = NULL;
+	}
+	MT_lock_unset(&recycleLock);
+	recycle_destroy_list(garbage);
+  bailout:
+	if (r)
+		recycle_destroy(r);
+}
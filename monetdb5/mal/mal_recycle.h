@@ -0,0 +1,34 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+#ifndef _MAL_RECYCLE_H
+#define _MAL_RECYCLE_H
+
+#include "mal.h"
+#include "mal_client.h"
+
+/* Instruction marks set by the recycler optimizer */
+#define RECYCLE_NONE	0
+#define RECYCLE_SOURCE	1		/* binds persistent data */
+#define RECYCLE_PURE	2		/* result only depends on the arguments */
+#define RECYCLE_CACHE	3		/* pure, and its result is worth keeping */
+
+/* Identify the data bound by a source instruction with the id of the
+ * table and the version of its content seen by the client.  Returns false
+ * when the data can not be shared with other queries. */
+typedef bool (*RecycleSource)(Client cntxt, MalStkPtr stk, InstrPtr pci,
+							  int *id, ulng *version);
+
+mal_export void RECYCLEsetsource(RecycleSource f);
+mal_export lng RECYCLEcapacity(void);
+
+#endif /* _MAL_RECYCLE_H */
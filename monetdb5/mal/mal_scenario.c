@@ -280,10 +280,12 @@ static str
 runScenarioBody(Client c)
 {
 	MT_thread_setworking("engine");
-	while (c->mode > FINISHCLIENT && !GDKexiting()) {
+	while (c->mode > FINISHCLIENT && !c->parked && !GDKexiting()) {
 		c->engine(c);
 		assert(c->curprg->def->errors == NULL);
 	}
+	if (c->parked)
+		return MAL_SUCCEED;
 	if (!GDKexiting() && GDKerrbuf && GDKerrbuf[0])
 		mnstr_printf(c->fdout, "!GDKerror: %s\n", GDKerrbuf);
 	return c->exitClient(c);
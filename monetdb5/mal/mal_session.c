@@ -166,6 +166,7 @@ is_exiting(void *data)
 }
 
 static str MSserveClient(Client cntxt);
+static void MSrunClient(Client c, bool own);
 
 
 static inline void
@@ -187,7 +188,7 @@ cleanUpScheduleClient(Client c, str *command, str *err)
 
 void
 MSscheduleClient(str command, str peer, str challenge, bstream *fin, stream *fout,
-				 protocol_version protocol, size_t blocksize)
+				 protocol_version protocol, size_t blocksize, int sock)
 {
 	char *user = command, *algo = NULL, *passwd = NULL, *lang = NULL,
 		*handshake_opts = NULL;
@@ -304,6 +305,7 @@ MSscheduleClient(str command, str peer, str challenge, bstream *fin, stream *fou
 			return;
 		}
 		c->filetrans = filetrans;
+		c->sock = sock;
 		c->handshake_options = handshake_opts ? strdup(handshake_opts) : NULL;
 		/* move this back !! */
 		if (c->usermodule == 0) {
@@ -516,23 +518,95 @@ MSserveClient(Client c)
 	if (msg) {
 		MCcloseClient(c);
 		return msg;
-	} else {
-		do {
-			do {
-				MT_thread_setworking("running scenario");
-				msg = runScenario(c);
-				freeException(msg);
-				if (c->mode == FINISHCLIENT)
-					break;
-				resetScenario(c);
-			} while (c->scenario && !GDKexiting());
-		} while (c->scenario && c->mode != FINISHCLIENT && !GDKexiting());
 	}
+	MSrunClient(c, true);
+	return MAL_SUCCEED;
+}
+
+/*
+ * Sessions of network clients need not keep a thread while they wait
+ * for their next request.  The network layer registers a function which
+ * takes over such a parked session, and resumes it with MSresumeClient
+ * on one of its own threads once input arrives, and a function which
+ * tells whether it can take a session at all.  BATs which outlive a
+ * request must therefore not be owned by the thread which created them,
+ * see BBPdisown.
+ */
+static park_client parkClient, canParkClient;
+
+void
+MSsetParkClient(park_client park, park_client canpark)
+{
+	canParkClient = canpark;
+	parkClient = park;
+}
+
+/* Called by the scenario reader when it is about to wait for the next
+ * request.  If it returns true, the reader should return without
+ * reading, after which the thread leaves the session. */
+bool
+MSparkClient(Client c)
+{
+	if (parkClient == NULL || c->sock < 0 || c->bak != NULL
+		|| c->mode <= FINISHCLIENT || GDKexiting() || !canParkClient(c))
+		return false;
+	c->parked = true;
+	return true;
+}
+
+/* Continue a parked session in the current thread, which was started
+ * for it (own) */
+void
+MSresumeClient(Client c, bool own)
+{
+	assert(c->parked);
+	c->parked = false;
+	c->mythread = MT_thread_getname();
+	GDKsetbuf(c->errbuf);
+	MT_thread_set_qry_ctx(&c->qryctx);
+	MSrunClient(c, own);
+}
+
+/*
+ * Run the scenarios of the client until it finishes, or until the
+ * session is parked.  A thread which was started for this client only
+ * (own) is about to exit when the client finishes.
+ */
+static void
+MSrunClient(Client c, bool own)
+{
+	str msg;
+
+	do {
+		do {
+			MT_thread_setworking("running scenario");
+			msg = runScenario(c);
+			freeException(msg);
+			if (c->parked) {
+				/* the thread state moves along with the session */
+				MT_thread_setworking("parking session");
+				GDKsetbuf(NULL);
+				MT_thread_set_qry_ctx(NULL);
+				if (parkClient(c))
+					return;		/* the session may already run elsewhere */
+				/* keep serving it from this thread */
+				c->parked = false;
+				c->sock = -1;
+				GDKsetbuf(c->errbuf);
+				MT_thread_set_qry_ctx(&c->qryctx);
+				continue;
+			}
+			if (c->mode == FINISHCLIENT)
+				break;
+			resetScenario(c);
+		} while (c->scenario && !GDKexiting());
+	} while (c->scenario && c->mode != FINISHCLIENT && !GDKexiting());
 	MT_thread_setworking("exiting");
 	/* pre announce our exiting: cleaning up may take a while and we
 	 * don't want to get killed during that time for fear of
 	 * deadlocks */
-	MT_exiting_thread();
+	if (own)
+		MT_exiting_thread();
 	/*
 	 * At this stage we should clean out the MAL block
 	 */
@@ -552,7 +626,6 @@ MSserveClient(Client c)
 	 */
 
 	MCcloseClient(c);
-	return MAL_SUCCEED;
 }
 
 /*
@@ -21,7 +21,14 @@ mal_export str malBootstrap(char *modules[], bool embedded,
 mal_export str MSinitClientPrg(Client cntxt, const char *mod, const char *nme);
 mal_export void MSscheduleClient(str command, str peer, str challenge, bstream *fin,
 								 stream *fout, protocol_version protocol,
-								 size_t blocksize);
+								 size_t blocksize, int sock);
+
+/* hand a session waiting for input to the network layer, if it can
+ * take it */
+typedef bool (*park_client)(Client c);
+mal_export void MSsetParkClient(park_client park, park_client canpark);
+mal_export bool MSparkClient(Client c);
+mal_export void MSresumeClient(Client c, bool own);
 
 mal_export str MALinitClient(Client c);
 mal_export str MALexitClient(Client c);
@@ -79,6 +79,9 @@
 #ifdef HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 #ifdef HAVE_SOCKLEN_T
 #define SOCKLEN socklen_t
@@ -160,6 +163,7 @@ generateChallenge(str buf, int min, int max)
 struct challengedata {
 	stream *in;
 	stream *out;
+	SOCKET sock;
 	struct sockaddr_storage peer;
 	socklen_t peerlen;
 	char challenge[13];
@@ -178,6 +182,11 @@ doChallenge(void *data)
 
 	stream *fdin = chdata->in;
 	stream *fdout = chdata->out;
+#ifdef HAVE_SYS_EPOLL_H
+	int sock = chdata->sock == INVALID_SOCKET ? -1 : (int) chdata->sock;
+#else
+	int sock = -1;
+#endif
 	bstream *bs;
 	ssize_t len = 0;
 	protocol_version protocol = PROTOCOL_9;
@@ -223,16 +232,17 @@ doChallenge(void *data)
 	}
 
 	/* Send the challenge over the block stream
-	 * We can do binary transfers, and we can interrupt queries using
-	 * out-of-band messages */
-	mnstr_printf(fdout, "%s:mserver:9:%s:%s:%s:sql=%d:BINARY=1:OOBINTR=1:CLIENTINFO:",
+	 * We can do binary transfers, we can interrupt queries using
+	 * out-of-band messages, and we offer these compression methods */
+	mnstr_printf(fdout, "%s:mserver:9:%s:%s:%s:sql=%d:BINARY=1:OOBINTR=1:CLIENTINFO:COMPRESSION=%s:",
 				 challenge, mcrypt_getHashAlgorithms(),
 #ifdef WORDS_BIGENDIAN
 				 "BIG",
 #else
 				 "LIT",
 #endif
-				 MONETDB5_PASSWDHASH, MAPI_HANDSHAKE_OPTIONS_LEVEL);
+				 MONETDB5_PASSWDHASH, MAPI_HANDSHAKE_OPTIONS_LEVEL,
+				 block_stream_compressions());
 	mnstr_flush(fdout, MNSTR_FLUSH_DATA);
 	/* get response */
 	if ((len = mnstr_read_block(fdin, buf, 1, BLOCK)) < 0) {
@@ -255,9 +265,105 @@ doChallenge(void *data)
 		return;
 	}
 	bs->eof = true;
-	MSscheduleClient(buf, peer, challenge, bs, fdout, protocol, buflen);
+	MSscheduleClient(buf, peer, challenge, bs, fdout, protocol, buflen, sock);
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * Sessions waiting for their next request are parked in an epoll set,
+ * instead of each keeping a thread blocked on its socket.  A fixed pool
+ * of session workers waits for sockets to become ready, and each worker
+ * runs the session it picked up until it waits for input again.  Ready
+ * sessions queue in the epoll set while all workers are busy, so the
+ * number of threads neither follows the number of connected clients nor
+ * the number of active sessions.  A session only parks while a worker
+ * is idle, otherwise it keeps its thread until its next request: a
+ * request may wait for another session, e.g. through a remote table on
+ * this same server, and must not leave that session without a worker.
+ */
+static int session_epoll = -1;
+static ATOMIC_TYPE nsessionworkers = ATOMIC_VAR_INIT(0);
+static ATOMIC_TYPE nidleworkers = ATOMIC_VAR_INIT(0);
+
+static bool
+SERVERparkSession(Client c)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN | EPOLLPRI | EPOLLRDHUP | EPOLLONESHOT,
+		.data.ptr = c,
+	};
+
+	if (ATOMIC_GET(&nsessionworkers) == 0 || GDKexiting())
+		return false;
+	/* the socket is added to the set when it is parked the first time,
+	 * and removed by the kernel when it is closed */
+	if (epoll_ctl(session_epoll, EPOLL_CTL_MOD, c->sock, &ev) == 0)
+		return true;
+	return errno == ENOENT
+		&& epoll_ctl(session_epoll, EPOLL_CTL_ADD, c->sock, &ev) == 0;
+}
+
+static bool
+SERVERcanParkSession(Client c)
+{
+	(void) c;
+	return ATOMIC_GET(&nidleworkers) > 0;
+}
+
+static void
+SERVERsessionWorker(void *dummy)
+{
+	struct epoll_event ev;
+	int n;
+
+	(void) dummy;
+	while (!GDKexiting()) {
+		MT_thread_setworking("waiting for requests");
+		ATOMIC_INC(&nidleworkers);
+		n = epoll_wait(session_epoll, &ev, 1, 100);
+		ATOMIC_DEC(&nidleworkers);
+		/* the events are one shot, so a session is resumed only once */
+		if (n == 1 && !GDKexiting())
+			MSresumeClient(ev.data.ptr, false);
+	}
+	/* the last worker finishes the sessions which are still parked */
+	if (ATOMIC_DEC(&nsessionworkers) == 0) {
+		for (Client c = mal_clients; c < mal_clients + MAL_MAXCLIENTS; c++)
+			if (c->parked)
+				MSresumeClient(c, false);
+	}
+}
+
+static str
+SERVERstartSessionWorkers(void)
+{
+	int n = GDKgetenv_int("mapi_session_workers", GDKnr_threads);
+	MT_Id tid;
+
+	if (n <= 0 || session_epoll != -1)
+		return MAL_SUCCEED;
+	if ((session_epoll = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+		session_epoll = -1;
+		throw(MAL, "mal_mapi.listen",
+			  OPERATION_FAILED ": creating epoll set failed: %s",
+			  GDKstrerror(errno, (char[128]) { 0 }, 128));
+	}
+	for (int i = 0; i < n; i++) {
+		ATOMIC_INC(&nsessionworkers);
+		if (MT_create_thread(&tid, SERVERsessionWorker, NULL,
+							 MT_THR_DETACHED, "sessionXXXX") < 0) {
+			ATOMIC_DEC(&nsessionworkers);
+			break;
+		}
+	}
+	if (ATOMIC_GET(&nsessionworkers) == 0)
+		throw(MAL, "mal_mapi.listen",
+			  OPERATION_FAILED ": starting session workers failed");
+	MSsetParkClient(SERVERparkSession, SERVERcanParkSession);
+	return MAL_SUCCEED;
+}
+#endif
+
 static ATOMIC_TYPE nlistener = ATOMIC_VAR_INIT(0);	/* nr of listeners */
 static ATOMIC_TYPE serveractive = ATOMIC_VAR_INIT(0);
 static ATOMIC_TYPE serverexiting = ATOMIC_VAR_INIT(0);	/* listeners should exit */
@@ -456,6 +562,7 @@ SERVERlistenThread(SOCKET *Sock)
 			TRC_ERROR(MAL_SERVER, MAL_MALLOC_FAIL "\n");
 			continue;
 		}
+		data->sock = msgsock;
 		data->peerlen = sizeof(data->peer);
 		if (getpeername(msgsock, (struct sockaddr*)&data->peer, &data->peerlen) < 0)
 			data->peer.ss_family = AF_UNSPEC;
@@ -897,6 +1004,13 @@ SERVERlisten(int port, const char *usockfile, int maxusers)
 		throw(MAL, "mal_mapi.listen",
 			  OPERATION_FAILED ": starting thread failed");
 	}
+#ifdef HAVE_SYS_EPOLL_H
+	/* without session workers every client keeps its own thread */
+	if ((buf = SERVERstartSessionWorkers()) != MAL_SUCCEED) {
+		TRC_ERROR(MAL_SERVER, "%s\n", buf);
+		freeException(buf);
+	}
+#endif
 
 	TRC_DEBUG(MAL_SERVER, "Ready to accept connections on: %s:%d\n", host,
 			  port);
@@ -1018,6 +1132,7 @@ SERVERclient(void *res, const Stream *In, const Stream *Out)
 	data = GDKmalloc(sizeof(*data));
 	if (data == NULL)
 		throw(MAL, "mapi.SERVERclient", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	data->sock = INVALID_SOCKET;
 	data->in = block_stream(*In);
 	data->out = block_stream(*Out);
 	if (data->in == NULL || data->out == NULL) {
@@ -94,6 +94,8 @@ typedef struct _connection {
 	Mapi mconn;					/* the Mapi handle for the connection */
 	unsigned char type;			/* binary profile of the connection target */
 	bool int128;				/* has int128 support */
+	MapiHdl pending;			/* reply of a remote.send not read yet */
+	Client owner;				/* client of the last remote.send on it */
 	size_t nextid;				/* id counter */
 	struct _connection *next;	/* the next connection in the list */
 } *connection;
@@ -313,6 +315,11 @@ RMTconnectScen(str *ret,
 		}
 	} else if (c->type == localtype) {
 		c->int128 = int128;
+	} else if (c->type == (localtype | RMTT_HGE)) {
+		/* remote has hge, we don't: binary columns can still be
+		 * exchanged as long as no hge column is involved, the type
+		 * numbers are shifted in RMTinternalcopyfrom */
+		c->int128 = true;
 	}
 	MT_lock_unset(&mal_remoteLock);
 
@@ -345,6 +352,21 @@ RMTconnect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
  * system, it only needs to exist for the client (i.e. it was once
  * created).
  */
+/* close connection c, which is no longer in the list */
+static void
+RMTclose(connection c)
+{
+	MT_lock_set(&c->lock);	/* shared connection */
+	if (c->pending)
+		mapi_close_handle(c->pending);
+	mapi_disconnect(c->mconn);
+	mapi_destroy(c->mconn);
+	MT_lock_unset(&c->lock);
+	MT_lock_destroy(&c->lock);
+	GDKfree(c->name);
+	GDKfree(c);
+}
+
 str
 RMTdisconnect(void *ret, const char *const *conn)
 {
@@ -371,15 +393,8 @@ RMTdisconnect(void *ret, const char *const *conn)
 			} else {
 				t->next = c->next;
 			}
-
-			MT_lock_set(&c->lock);	/* shared connection */
-			mapi_disconnect(c->mconn);
-			mapi_destroy(c->mconn);
-			MT_lock_unset(&c->lock);
-			MT_lock_destroy(&c->lock);
-			GDKfree(c->name);
-			GDKfree(c);
 			MT_lock_unset(&mal_remoteLock);
+			RMTclose(c);
 			return MAL_SUCCEED;
 		}
 		t = c;
@@ -390,6 +405,43 @@ RMTdisconnect(void *ret, const char *const *conn)
 	throw(MAL, "remote.disconnect", "no such connection: %s", *conn);
 }
 
+/**
+ * Disconnects the connections on which client cntxt started a
+ * remote.send.  The receive stub of a remote plan disconnects them
+ * after collecting the results, but when the query fails in between
+ * they would be left open on both sides.
+ */
+void
+RMTdisconnectClient(Client cntxt)
+{
+	connection c, t = NULL, done = NULL;
+
+	MT_lock_set(&mal_remoteLock);
+	c = conns;
+	while (c != NULL) {
+		connection n = c->next;
+		if (c->owner == cntxt) {
+			if (t == NULL)
+				conns = n;
+			else
+				t->next = n;
+			c->next = done;
+			done = c;
+		} else {
+			t = c;
+		}
+		c = n;
+	}
+	MT_lock_unset(&mal_remoteLock);
+
+	while (done != NULL) {
+		c = done;
+		done = c->next;
+		TRC_INFO(MAL_REMOTE, "Closing abandoned connection %s\n", c->name);
+		RMTclose(c);
+	}
+}
+
 /**
  * Helper function to return a connection matching a given string, or an
  * error if it does not exist.  Since this function is internal, it
@@ -499,6 +551,37 @@ RMTquery(MapiHdl *ret, const char *func, Mapi conn, const char *query)
 	return (MAL_SUCCEED);
 }
 
+/**
+ * Helper function to collect the reply of a function invocation issued
+ * with send over the given connection.  Any later request on the
+ * connection first waits for this reply, and reports its error.
+ * NOTE: this function assumes a lock for conn is set
+ */
+static str
+RMTwait(connection c, const char *func)
+{
+	MapiHdl mhdl = c->pending;
+	str err = MAL_SUCCEED;
+
+	if (mhdl == NULL)
+		return MAL_SUCCEED;
+	c->pending = NULL;
+	if (mapi_read_response(mhdl) != MOK && mapi_result_error(mhdl) == NULL) {
+		err = createException(IO, func, "an error occurred on connection: %s",
+							  mapi_error_str(c->mconn));
+	} else if (mapi_result_error(mhdl) != NULL) {
+		err = createException(getExceptionType(mapi_result_error(mhdl)),
+							  func,
+							  "(mapi:monetdb://%s@%s/%s) %s",
+							  mapi_get_user(c->mconn),
+							  mapi_get_host(c->mconn),
+							  mapi_get_dbname(c->mconn),
+							  getExceptionMessage(mapi_result_error(mhdl)));
+	}
+	mapi_close_handle(mhdl);
+	return err;
+}
+
 static str
 RMTprelude(void)
 {
@@ -710,7 +793,12 @@ RMTinternalcopyfrom(BAT **ret, char *hdr, stream *in, bool must_flush, bool cint
 	if (int128 && !cint128 && bb.Ttype >= TYPE_hge)
 		bb.Ttype++;
 #else
-	(void) cint128;
+	if (cint128 && bb.Ttype > TYPE_lng) {
+		if (bb.Ttype == TYPE_lng + 1)
+			throw(MAL, "remote.bincopyfrom",
+				  "remote column of type hge not supported");
+		bb.Ttype--;
+	}
 #endif
 
 	b = COLnew2(bb.Hseqbase, bb.Ttype, bb.size, TRANSIENT,
@@ -816,7 +904,7 @@ RMTget(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	}
 	GDKfree(rt);
 
-	if (isaBatType(rtype) && (localtype == 0177 || (localtype != c->type && localtype != (c->type | RMTT_HGE)))) {
+	if (isaBatType(rtype) && (localtype == 0177 || (localtype | RMTT_HGE) != (c->type | RMTT_HGE))) {
 		int t;
 		size_t s;
 		ptr r;
@@ -830,7 +918,8 @@ RMTget(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		/* this call should be a single transaction over the channel */
 		MT_lock_set(&c->lock);
 
-		if ((tmp = RMTquery(&mhdl, "remote.get", c->mconn, qbuf))
+		if ((tmp = RMTwait(c, "remote.get")) != MAL_SUCCEED ||
+			(tmp = RMTquery(&mhdl, "remote.get", c->mconn, qbuf))
 			!= MAL_SUCCEED) {
 			TRC_ERROR(MAL_REMOTE, "Remote get: %s\n%s\n", qbuf, tmp);
 			MT_lock_unset(&c->lock);
@@ -893,6 +982,11 @@ RMTget(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		/* this call should be a single transaction over the channel */
 		MT_lock_set(&c->lock);
 
+		if ((tmp = RMTwait(c, "remote.get")) != MAL_SUCCEED) {
+			MT_lock_unset(&c->lock);
+			return tmp;
+		}
+
 		/* bypass Mapi from this point to efficiently write all data to
 		 * the server */
 		sout = mapi_get_to(c->mconn);
@@ -995,6 +1089,11 @@ RMTput(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	/* this call should be a single transaction over the channel */
 	MT_lock_set(&c->lock);
 
+	if ((tmp = RMTwait(c, "remote.put")) != MAL_SUCCEED) {
+		MT_lock_unset(&c->lock);
+		return tmp;
+	}
+
 	/* get a free, typed identifier for the remote host */
 	tmp = RMTgetId(ident, sizeof(ident), mb, pci, 2);
 	if (tmp != MAL_SUCCEED) {
@@ -1177,6 +1276,11 @@ RMTregisterInternal(Client cntxt, char **fcn_id, const char *conn,
 	/* this call should be a single transaction over the channel */
 	MT_lock_set(&c->lock);
 
+	if ((tmp = RMTwait(c, "remote.register")) != MAL_SUCCEED) {
+		MT_lock_unset(&c->lock);
+		return tmp;
+	}
+
 	/* get a free, typed identifier for the remote host */
 	char ident[512];
 	tmp = RMTgetId(ident, sizeof(ident), sym->def, getInstrPtr(sym->def, 0), 0);
@@ -1277,9 +1381,12 @@ RMTregister(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
  * site, and returns the handle which stores the return value of the
  * remotely executed function.  This return value can be retrieved using
  * a get call. It handles multiple return arguments.
+ * send does the same, but returns as soon as the invocation is on its
+ * way, so many remote sites can work at the same time.  The reply is
+ * collected, and its error raised, by the next call on the connection.
  */
 static str
-RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+RMTexecute(Client cntxt, MalStkPtr stk, InstrPtr pci, const char *fcn, bool send)
 {
 	str conn, mod, func, tmp;
 	int i;
@@ -1288,13 +1395,11 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	char *qbuf;
 	MapiHdl mhdl;
 
-	(void) cntxt;
-	(void) mb;
 	bool no_return_arguments = 0;
 
 	columnar_result_callback *rcb = NULL;
 	ValRecord *v = &(stk)->stk[(pci)->argv[4]];
-	if (pci->retc == 1 && (pci->argc >= 4) && (v->vtype == TYPE_ptr)) {
+	if (!send && pci->retc == 1 && (pci->argc >= 4) && (v->vtype == TYPE_ptr)) {
 		rcb = (columnar_result_callback *) v->val.pval;
 	}
 
@@ -1302,7 +1407,7 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		if (stk->stk[pci->argv[i]].vtype == TYPE_str) {
 			tmp = *getArgReference_str(stk, pci, i);
 			if (tmp == NULL || strcmp(tmp, (str) str_nil) == 0)
-				throw(ILLARG, "remote.exec", ILLEGAL_ARGUMENT
+				throw(ILLARG, fcn, ILLEGAL_ARGUMENT
 					  ": return value %d is NULL or nil", i);
 		} else
 			no_return_arguments = 1;
@@ -1310,26 +1415,26 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 
 	conn = *getArgReference_str(stk, pci, i++);
 	if (conn == NULL || strcmp(conn, (str) str_nil) == 0)
-		throw(ILLARG, "remote.exec",
+		throw(ILLARG, fcn,
 			  ILLEGAL_ARGUMENT ": connection name is NULL or nil");
 	mod = *getArgReference_str(stk, pci, i++);
 	if (mod == NULL || strcmp(mod, (str) str_nil) == 0)
-		throw(ILLARG, "remote.exec",
+		throw(ILLARG, fcn,
 			  ILLEGAL_ARGUMENT ": module name is NULL or nil");
 	func = *getArgReference_str(stk, pci, i++);
 	if (func == NULL || strcmp(func, (str) str_nil) == 0)
-		throw(ILLARG, "remote.exec",
+		throw(ILLARG, fcn,
 			  ILLEGAL_ARGUMENT ": function name is NULL or nil");
 
 	/* lookup conn */
-	rethrow("remote.exec", tmp, RMTfindconn(&c, conn));
+	rethrow(fcn, tmp, RMTfindconn(&c, conn));
 
 	/* this call should be a single transaction over the channel */
 	MT_lock_set(&c->lock);
 
 	if (!no_return_arguments && pci->argc - pci->retc < 3) {	/* conn, mod, func, ... */
 		MT_lock_unset(&c->lock);
-		throw(MAL, "remote.exec",
+		throw(MAL, fcn,
 			  ILLEGAL_ARGUMENT " MAL instruction misses arguments");
 	}
 
@@ -1353,7 +1458,7 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	buflen = len + 1;
 	if ((qbuf = GDKmalloc(buflen)) == NULL) {
 		MT_lock_unset(&c->lock);
-		throw(MAL, "remote.exec", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		throw(MAL, fcn, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 	}
 
 	len = 0;
@@ -1389,7 +1494,27 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	/* finish end execute the invocation string */
 	len += snprintf(&qbuf[len], buflen - len, ");");
 	TRC_DEBUG(MAL_REMOTE, "Remote exec: %s - %s\n", c->name, qbuf);
-	tmp = RMTquery(&mhdl, "remote.exec", c->mconn, qbuf);
+	if ((tmp = RMTwait(c, fcn)) != MAL_SUCCEED) {
+		GDKfree(qbuf);
+		MT_lock_unset(&c->lock);
+		return tmp;
+	}
+	if (send) {
+		c->pending = mapi_send(c->mconn, qbuf);
+		GDKfree(qbuf);
+		if (c->pending == NULL || mapi_error(c->mconn) != MOK) {
+			tmp = createException(IO, fcn, "an error occurred on connection: %s",
+								  mapi_error_str(c->mconn));
+			if (c->pending)
+				mapi_close_handle(c->pending);
+			c->pending = NULL;
+		} else {
+			c->owner = cntxt;
+		}
+		MT_lock_unset(&c->lock);
+		return tmp;
+	}
+	tmp = RMTquery(&mhdl, fcn, c->mconn, qbuf);
 	GDKfree(qbuf);
 
 	/* Temporary hack:
@@ -1401,7 +1526,7 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		columnar_result *results = GDKzalloc(sizeof(columnar_result) * fields);
 
 		if (!results) {
-			tmp = createException(MAL, "remote.exec",
+			tmp = createException(MAL, fcn,
 								  SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		} else {
 			int i = 0;
@@ -1449,6 +1574,20 @@ RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return tmp;
 }
 
+static str
+RMTexec(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void) mb;
+	return RMTexecute(cntxt, stk, pci, "remote.exec", false);
+}
+
+static str
+RMTsend(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void) mb;
+	return RMTexecute(cntxt, stk, pci, "remote.send", true);
+}
+
 /**
  * batload is a helper function to make transferring a BAT with RMTput
  * more efficient.  It works by creating a BAT, and loading it with the
@@ -1708,6 +1847,8 @@ mel_func remote_init_funcs[] = {
  pattern("remote", "exec", RMTexec, false, "remotely executes <mod>.<func> using the argument list of remote objects and returns the handle to its result", args(1,5, vararg("",str),arg("conn",str),arg("mod",str),arg("func",str),vararg("",str))),
  pattern("remote", "exec", RMTexec, false, "remotely executes <mod>.<func> using the argument list of remote objects and applying function pointer rcb as callback to handle any results.", args(0,5, arg("conn",str),arg("mod",str),arg("func",str),arg("rcb",ptr), vararg("",str))),
  pattern("remote", "exec", RMTexec, false, "remotely executes <mod>.<func> using the argument list of remote objects and ignoring results.", args(0,4, arg("conn",str),arg("mod",str),arg("func",str), vararg("",str))),
+ pattern("remote", "send", RMTsend, false, "starts the remote execution of <mod>.<func> and returns the handle to its result without waiting for it", args(1,4, vararg("",str),arg("conn",str),arg("mod",str),arg("func",str))),
+ pattern("remote", "send", RMTsend, false, "starts the remote execution of <mod>.<func> using the argument list of remote objects and returns the handle to its result without waiting for it", args(1,5, vararg("",str),arg("conn",str),arg("mod",str),arg("func",str),vararg("",str))),
  command("remote", "isalive", RMTisalive, false, "check if conn is still valid and connected", args(1,2, arg("",int),arg("conn",str))),
  pattern("remote", "batload", RMTbatload, false, "create a BAT of the given type and size, and load values from the input stream", args(1,3, batargany("",1),argany("tt",1),arg("size",int))),
  pattern("remote", "batbincopy", RMTbincopyto, false, "dump BAT b in binary form to the stream", args(1,2, arg("",void),batargany("b",0))),
@@ -14,6 +14,7 @@
 #define _REMOTE_DEF
 
 #include "mal.h"
+#include "mal_client.h"
 
 typedef struct {
 	bat id;
@@ -30,5 +31,6 @@ typedef struct {
 } columnar_result_callback;
 
 mal_export str RMTdisconnect(void *ret, const char *const *conn);
+mal_export void RMTdisconnectClient(Client cntxt);
 
 #endif /* _REMOTE_DEF */
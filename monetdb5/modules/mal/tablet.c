@@ -276,12 +276,13 @@ output_line(char **buf, size_t *len, char **localbuf, size_t *locallen,
 	return 0;
 }
 
+/* Append the row at position pos (relative to the format positions) to
+ * the buffer, without writing it out. */
 static inline int
-output_line_dense(char **buf, size_t *len, char **localbuf, size_t *locallen,
-				  Column *fmt, stream *fd, BUN nr_attrs)
+format_line_dense(char **buf, size_t *len, size_t *fill, char **localbuf,
+				  size_t *locallen, Column *fmt, BUN nr_attrs, BUN pos)
 {
 	BUN i;
-	ssize_t fill = 0;
 
 	for (i = 0; i < nr_attrs; i++) {
 		Column *f = fmt + i;
@@ -289,7 +290,7 @@ output_line_dense(char **buf, size_t *len, char **localbuf, size_t *locallen,
 		ssize_t l;
 
 		if (f->c) {
-			p = BUNtail(f->ci, f->p);
+			p = BUNtail(f->ci, f->p + pos);
 
 			if (!p || ATOMcmp(f->adt, ATOMnilptr(f->adt), p) == 0) {
 				p = f->nullstr;
@@ -300,23 +301,33 @@ output_line_dense(char **buf, size_t *len, char **localbuf, size_t *locallen,
 					return -1;
 				p = *localbuf;
 			}
-			if (fill + l + f->seplen >= (ssize_t) * len) {
+			if (*fill + l + f->seplen >= *len) {
 				/* extend the buffer */
 				char *nbuf;
-				nbuf = GDKrealloc(*buf, fill + l + f->seplen + BUFSIZ);
+				nbuf = GDKrealloc(*buf, *fill + l + f->seplen + BUFSIZ);
 				if (nbuf == NULL)
 					return -1;	/* *buf freed by caller */
 				*buf = nbuf;
-				*len = fill + l + f->seplen + BUFSIZ;
+				*len = *fill + l + f->seplen + BUFSIZ;
 			}
-			strncpy(*buf + fill, p, l);
-			fill += l;
-			f->p++;
+			strncpy(*buf + *fill, p, l);
+			*fill += l;
 		}
-		strncpy(*buf + fill, f->sep, f->seplen);
-		fill += f->seplen;
+		strncpy(*buf + *fill, f->sep, f->seplen);
+		*fill += f->seplen;
 	}
-	if (fd && mnstr_write(fd, *buf, 1, fill) != fill)
+	return 0;
+}
+
+static inline int
+output_line_dense(char **buf, size_t *len, char **localbuf, size_t *locallen,
+				  Column *fmt, stream *fd, BUN nr_attrs, BUN pos)
+{
+	size_t fill = 0;
+
+	if (format_line_dense(buf, len, &fill, localbuf, locallen, fmt, nr_attrs, pos) < 0)
+		return -1;
+	if (fd && mnstr_write(fd, *buf, 1, fill) != (ssize_t) fill)
 		return TABLET_error(fd);
 	return 0;
 }
@@ -446,7 +457,7 @@ output_file_dense(Tablet *as, stream *fd, bstream *in)
 			res = -5;			/* "Query aborted" */
 			break;
 		}
-		if ((res = output_line_dense(&buf, &len, &localbuf, &locallen, as->format, fd, as->nr_attrs)) < 0) {
+		if ((res = output_line_dense(&buf, &len, &localbuf, &locallen, as->format, fd, as->nr_attrs, i)) < 0) {
 			break;
 		}
 	}
@@ -455,6 +466,181 @@ output_file_dense(Tablet *as, stream *fd, bstream *in)
 	return res;
 }
 
+/*
+ * Large dense exports are formatted in parallel.  The rows are cut in
+ * ranges of OUTPUT_RANGE rows, which a set of workers, started once per
+ * export, take in turn and convert into the buffer of a slot in a ring,
+ * using the same conversion functions as output_line_dense.  The caller
+ * meanwhile writes the formatted ranges to the stream in row order, so
+ * the output is identical to the sequential one.  A slot is reused for
+ * a later range once it has been written.
+ */
+#define OUTPUT_RANGE 16384
+
+struct output_range {
+	BUN first, nr;				/* rows relative to the format positions */
+	char *buf, *localbuf;
+	size_t len, locallen, fill;
+	bool formatted;				/* ready to be written */
+};
+
+struct output_jobs {
+	Tablet *as;
+	struct output_range *slots;
+	BUN nslots;
+	BUN nranges;
+	ATOMIC_TYPE next;			/* next range to format */
+	/* protected by the lock */
+	BUN written;				/* ranges written so far */
+	bool failed;
+	MT_Lock lock;
+	MT_Cond formatted;			/* the writer waits for a range */
+	MT_Cond drained;			/* the workers wait for a free slot */
+};
+
+static void
+output_format_worker(void *arg)
+{
+	struct output_jobs *jobs = arg;
+	Tablet *as = jobs->as;
+
+	MT_thread_setworking("formatting rows");
+	for (;;) {
+		BUN n = (BUN) ATOMIC_INC(&jobs->next) - 1;
+		bool ok = true;
+
+		if (n >= jobs->nranges)
+			break;
+		struct output_range *r = &jobs->slots[n % jobs->nslots];
+
+		MT_lock_set(&jobs->lock);
+		while (n >= jobs->written + jobs->nslots && !jobs->failed)
+			MT_cond_wait(&jobs->drained, &jobs->lock);
+		ok = !jobs->failed;
+		MT_lock_unset(&jobs->lock);
+		if (!ok)
+			break;
+
+		r->first = n * OUTPUT_RANGE;
+		r->nr = as->nr - r->first < OUTPUT_RANGE ? as->nr - r->first : OUTPUT_RANGE;
+		r->fill = 0;
+		for (BUN i = r->first; ok && i < r->first + r->nr; i++)
+			ok = format_line_dense(&r->buf, &r->len, &r->fill, &r->localbuf,
+								   &r->locallen, as->format, as->nr_attrs,
+								   i) >= 0;
+
+		MT_lock_set(&jobs->lock);
+		if (ok) {
+			r->formatted = true;
+		} else {
+			jobs->failed = true;
+			MT_cond_broadcast(&jobs->drained);
+		}
+		MT_cond_signal(&jobs->formatted);
+		MT_lock_unset(&jobs->lock);
+		if (!ok)
+			break;
+	}
+}
+
+static int
+output_file_parallel(Tablet *as, stream *fd, bstream *in, int nthreads)
+{
+	struct output_jobs jobs = {
+		.as = as,
+		.nslots = 2 * (BUN) nthreads,
+		.nranges = (as->nr + OUTPUT_RANGE - 1) / OUTPUT_RANGE,
+		.next = ATOMIC_VAR_INIT(0),
+	};
+	MT_Id *tids;
+	int i, nstarted = 0, res = 0;
+
+	jobs.slots = GDKzalloc(jobs.nslots * sizeof(struct output_range));
+	tids = GDKmalloc(nthreads * sizeof(MT_Id));
+	if (jobs.slots == NULL || tids == NULL) {
+		GDKfree(jobs.slots);
+		GDKfree(tids);
+		return -1;
+	}
+	for (BUN j = 0; j < jobs.nslots; j++) {
+		jobs.slots[j].len = jobs.slots[j].locallen = BUFSIZ;
+		jobs.slots[j].buf = GDKmalloc(BUFSIZ);
+		jobs.slots[j].localbuf = GDKmalloc(BUFSIZ);
+		if (jobs.slots[j].buf == NULL || jobs.slots[j].localbuf == NULL) {
+			res = -1;
+			goto bailout;
+		}
+	}
+	MT_lock_init(&jobs.lock, "output_jobs");
+	MT_cond_init(&jobs.formatted);
+	MT_cond_init(&jobs.drained);
+
+	/* if we cannot get (all) threads, we just do with fewer */
+	for (i = 0; i < nthreads; i++) {
+		char name[MT_NAME_LEN];
+		snprintf(name, sizeof(name), "output%d", i);
+		if (MT_create_thread(&tids[i], output_format_worker, &jobs, MT_THR_JOINABLE, name) < 0) {
+			GDKclrerr();
+			break;
+		}
+		nstarted++;
+	}
+
+	if (nstarted == 0) {
+		res = output_file_dense(as, fd, in);
+	} else {
+		TRC_INFO(MAL_SERVER, "Formatting " BUNFMT " rows with %d threads\n", as->nr, nstarted);
+		for (BUN n = 0; n < jobs.nranges; n++) {
+			struct output_range *r = &jobs.slots[n % jobs.nslots];
+			bool failed;
+
+			if (bstream_getoob(in)) {
+				res = -5;			/* "Query aborted" */
+				break;
+			}
+			MT_lock_set(&jobs.lock);
+			while (!r->formatted && !jobs.failed)
+				MT_cond_wait(&jobs.formatted, &jobs.lock);
+			failed = jobs.failed;
+			MT_lock_unset(&jobs.lock);
+			if (failed) {
+				res = -1;
+				break;
+			}
+			if (mnstr_write(fd, r->buf, 1, r->fill) != (ssize_t) r->fill) {
+				res = TABLET_error(fd);
+				break;
+			}
+			MT_lock_set(&jobs.lock);
+			r->formatted = false;
+			jobs.written++;
+			MT_cond_broadcast(&jobs.drained);
+			MT_lock_unset(&jobs.lock);
+		}
+		if (res < 0) {
+			/* stop the workers */
+			MT_lock_set(&jobs.lock);
+			jobs.failed = true;
+			MT_cond_broadcast(&jobs.drained);
+			MT_lock_unset(&jobs.lock);
+		}
+		for (i = 0; i < nstarted; i++)
+			MT_join_thread(tids[i]);
+	}
+	MT_cond_destroy(&jobs.drained);
+	MT_cond_destroy(&jobs.formatted);
+	MT_lock_destroy(&jobs.lock);
+
+  bailout:
+	for (BUN j = 0; j < jobs.nslots; j++) {
+		GDKfree(jobs.slots[j].buf);
+		GDKfree(jobs.slots[j].localbuf);
+	}
+	GDKfree(jobs.slots);
+	GDKfree(tids);
+	return res;
+}
+
 static int
 output_file_ordered(Tablet *as, BAT *order, stream *fd, bstream *in)
 {
@@ -503,8 +689,15 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s, bstream *in)
 
 	base = check_BATs(as);
 	if (!order || !is_oid_nil(base)) {
-		if (!order || order->hseqbase == base)
-			ret = output_file_dense(as, s, in);
+		if (!order || order->hseqbase == base) {
+			int nthreads = GDKgetenv_int("tablet_threads", GDKnr_threads);
+			if ((BUN) nthreads > as->nr / OUTPUT_RANGE)
+				nthreads = (int) (as->nr / OUTPUT_RANGE);
+			if (s != NULL && nthreads > 1)
+				ret = output_file_parallel(as, s, in, nthreads);
+			else
+				ret = output_file_dense(as, s, in);
+		}
 		else
 			ret = output_file_ordered(as, order, s, in);
 	} else {
@@ -1553,6 +1746,12 @@ create_rejects_table(Client cntxt)
 			BBPreclaim(cntxt->error_msg);
 			BBPreclaim(cntxt->error_input);
 			cntxt->error_row = cntxt->error_fld = cntxt->error_msg = cntxt->error_input = NULL;
+		} else {
+			/* the session may continue on another thread */
+			BBPdisown(cntxt->error_row->batCacheid);
+			BBPdisown(cntxt->error_fld->batCacheid);
+			BBPdisown(cntxt->error_msg->batCacheid);
+			BBPdisown(cntxt->error_input->batCacheid);
 		}
 	}
 	MT_lock_unset(&mal_contextLock);
@@ -32,6 +32,14 @@ allConstExcept(MalBlkPtr mb, InstrPtr p, int except)
 	return true;
 }
 
+/* offsets type which can hold the values of n dictionaries, whose
+ * largest offsets type is tt */
+static inline int
+merged_offset_type(int tt, int n)
+{
+	return tt == TYPE_bte ? (n <= 256 ? TYPE_sht : TYPE_int) : tt == TYPE_sht && n < 32768 ? TYPE_int : TYPE_void;
+}
+
 str
 OPTdictImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -291,6 +299,144 @@ OPTdictImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 					old[i] = NULL;
 					done = true;
 					break;
+				} else if (j == p->retc && getModuleId(p) == algebraRef
+						   && (getFunctionId(p) == sortRef
+							   || getFunctionId(p) == firstnRef)) {
+					/* sort/firstn(col, ...) with col = dict.decompress(o,u)
+					 * k = dict.sortkey(o, u)
+					 * firstn(k, ...) | (s, ord[, grp]) = sort(k, ...); v1 = projection(ord, o)
+					 * equal values have equal keys, so the groups stay the same */
+					int tpe = getBatType(getVarType(mb, varisdict[k]));
+					tpe = tpe == TYPE_bte ? TYPE_sht : TYPE_int;
+					InstrPtr r = newInstructionArgs(mb, dictRef, putName("sortkey"), 3);
+					InstrPtr s = getFunctionId(p) == sortRef ? newInstructionArgs(mb, algebraRef, sortRef, p->argc + 1) : copyInstruction(p);
+					if (r == NULL || s == NULL) {
+						freeInstruction(r);
+						freeInstruction(s);
+						msg = createException(MAL, "optimizer.dict",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, 0) = newTmpVariable(mb, newBatType(tpe));
+					r = pushArgument(mb, r, varisdict[k]);
+					r = pushArgument(mb, r, vardictvalue[k]);
+					pushInstruction(mb, r);
+
+					if (getFunctionId(p) == firstnRef) {
+						getArg(s, j) = getArg(r, 0);
+						pushInstruction(mb, s);
+					} else {
+						/* the sorted column is the projection of the offsets on the order */
+						int ord = p->retc >= 2 ? getArg(p, 1) : newTmpVariable(mb, newBatType(TYPE_oid));
+						getArg(s, 0) = newTmpVariable(mb, newBatType(tpe));
+						s = pushReturn(mb, s, ord);
+						if (p->retc == 3)
+							s = pushReturn(mb, s, getArg(p, 2));
+						s = pushArgument(mb, s, getArg(r, 0));
+						for (int a = j + 1; a < p->argc; a++)
+							s = pushArgument(mb, s, getArg(p, a));
+						pushInstruction(mb, s);
+
+						InstrPtr t = newInstructionArgs(mb, algebraRef, projectionRef, 3);
+						if (t == NULL) {
+							msg = createException(MAL, "optimizer.dict",
+												  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+							break;
+						}
+						int l = getArg(p, 0);
+						getArg(t, 0) = newTmpVariable(mb, getVarType(mb, varisdict[k]));
+						t = pushArgument(mb, t, ord);
+						t = pushArgument(mb, t, varisdict[k]);
+						pushInstruction(mb, t);
+						varisdict[l] = getArg(t, 0);
+						vardictvalue[l] = vardictvalue[k];
+						dictunique[l] = dictunique[k];
+					}
+					freeInstruction(p);
+					old[i] = NULL;
+					done = true;
+					break;
+				} else if (j == 1 && p->argc == 3 && getModuleId(p) == matRef
+						   && getFunctionId(p) == packIncrementRef
+						   && (getArgType(mb, p, 2) == TYPE_int
+							   || (varisdict[getArg(p, 2)]
+								   && vardictvalue[k] == vardictvalue[getArg(p, 2)]))) {
+					/* packIncrement(col, n) | packIncrement(col1, col2) with col = dict.decompress(o,u)
+					 * (and col2 using the same dictionary)
+					 * v1 = packIncrement(o, n) | v1 = packIncrement(o1, o2) */
+					InstrPtr r = copyInstruction(p);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.dict",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					int l = getArg(p, 0);
+					getArg(r, 0) = newTmpVariable(mb, getVarType(mb, varisdict[k]));
+					getArg(r, 1) = varisdict[k];
+					if (getArgType(mb, p, 2) != TYPE_int)
+						getArg(r, 2) = varisdict[getArg(p, 2)];
+					varisdict[l] = getArg(r, 0);
+					vardictvalue[l] = vardictvalue[k];
+					dictunique[l] = dictunique[k];
+					pushInstruction(mb, r);
+					freeInstruction(p);
+					old[i] = NULL;
+					done = true;
+					break;
+				} else if (j == 1 && p->argc == 3 && getModuleId(p) == matRef
+						   && getFunctionId(p) == packIncrementRef
+						   && varisdict[getArg(p, 2)]
+						   && merged_offset_type(MAX(getBatType(getVarType(mb, varisdict[k])),
+													 getBatType(getVarType(mb, varisdict[getArg(p, 2)]))), 2) != TYPE_void) {
+					/* packIncrement(col1, col2) with col1 = dict.decompress(o1,u1), col2 = dict.decompress(o2,u2)
+					 * (v1, u) = dict.merge(o1, u1, o2, u2)
+					 * the increments of the same pack that follow are merged
+					 * in the same pass, ie
+					 * (vn, u) = dict.merge(o1, u1, o2, u2, ..., on, un) */
+					int last = i, n = 2;
+					int tt = MAX(getBatType(getVarType(mb, varisdict[k])),
+								 getBatType(getVarType(mb, varisdict[getArg(p, 2)])));
+					while (last + 1 < limit && old[last + 1]
+						   && getModuleId(old[last + 1]) == matRef
+						   && getFunctionId(old[last + 1]) == packIncrementRef
+						   && old[last + 1]->argc == 3
+						   && getArg(old[last + 1], 1) == getArg(old[last], 0)
+						   && varisdict[getArg(old[last + 1], 2)]
+						   && merged_offset_type(MAX(tt, getBatType(getVarType(mb, varisdict[getArg(old[last + 1], 2)]))), n + 1) != TYPE_void) {
+						last++;
+						n++;
+						tt = MAX(tt, getBatType(getVarType(mb, varisdict[getArg(old[last], 2)])));
+					}
+					int tpe = merged_offset_type(tt, n);
+					InstrPtr r = newInstructionArgs(mb, dictRef, putName("merge"), 2 + 2 * n);
+					if (r == NULL) {
+						msg = createException(MAL, "optimizer.dict",
+											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+						break;
+					}
+					getArg(r, 0) = newTmpVariable(mb, newBatType(tpe));
+					r = pushReturn(mb, r, newTmpVariable(mb, getVarType(mb, vardictvalue[k])));
+					r = pushArgument(mb, r, varisdict[k]);
+					r = pushArgument(mb, r, vardictvalue[k]);
+					for (int q = i; q <= last; q++) {
+						int m = getArg(old[q], 2);
+						r = pushArgument(mb, r, varisdict[m]);
+						r = pushArgument(mb, r, vardictvalue[m]);
+					}
+					pushInstruction(mb, r);
+					for (; i < last; i++) {
+						freeInstruction(p);
+						old[i] = NULL;
+						p = old[i + 1];
+					}
+					int l = getArg(p, 0);
+					varisdict[l] = getArg(r, 0);
+					vardictvalue[l] = getArg(r, 1);
+					dictunique[l] = 1;
+					freeInstruction(p);
+					old[i] = NULL;
+					done = true;
+					break;
 				} else if ((isMapOp(p) || isMap2Op(p))
 						   && allConstExcept(mb, p, j)) {
 					/* batcalc.-(1, col) with col = dict.decompress(o,u)
@@ -40,6 +40,7 @@
 #include "opt_remap.h"
 #include "opt_remoteQueries.h"
 #include "opt_reorder.h"
+#include "opt_rle.h"
 #include "opt_fastpath.h"
 #include "optimizer_private.h"
 #include "mal_interpreter.h"
@@ -77,6 +78,7 @@ OPTminimalfastImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 	optcall(true, OPTdeadcodeImplementation);
 	optcall(true, OPTforImplementation);
 	optcall(true, OPTdictImplementation);
+	optcall(true, OPTrleImplementation);
 	optcall(multiplex, OPTmultiplexImplementation);
 	optcall(generator, OPTgeneratorImplementation);
 	optcall(profilerStatus, OPTprofilerImplementation);
@@ -118,6 +120,7 @@ OPTdefaultfastImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 	optcall(true, OPTaliasesImplementation);
 	optcall(true, OPTforImplementation);
 	optcall(true, OPTdictImplementation);
+	optcall(true, OPTrleImplementation);
 	optcall(true, OPTmitosisImplementation);
 	optcall(true, OPTmergetableImplementation);
 	optcall(true, OPTaliasesImplementation);
@@ -13,17 +13,6 @@
 #include "monetdb_config.h"
 #include "opt_for.h"
 
-#if 0
-static InstrPtr
-ReplaceWithNil(MalBlkPtr mb, InstrPtr p, int pos)
-{
-	p = pushNilBat(mb, p);	/* push at end */
-	getArg(p, pos) = getArg(p, p->argc - 1);
-	p->argc--;
-	return p;
-}
-#endif
-
 static bool
 allConstExcept(MalBlkPtr mb, InstrPtr p, int except)
 {
@@ -153,67 +142,47 @@ OPTforImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 					freeInstruction(p);
 					done = 1;
 					break;
-				} else if (getFunctionId(p) == thetaselectRef) {
-					/* pos = thetaselect(col, cand, l, ...) with col = for.decompress(o, minval)
-					 * l = calc.-(l, minval);
-					 * nl = calc.bte(l);
-					 * or
-					 * nl = calc.sht(l);
-					 * pos = select(o, cand, nl,  ...) */
-
-					InstrPtr q = newInstructionArgs(mb, calcRef, minusRef, 3);
-					if (q == NULL) {
-						msg = createException(MAL, "optimizer.for",
-											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						break;
-					}
-					int tpe = getVarType(mb, getArg(p, 3));
-					getArg(q, 0) = newTmpVariable(mb, tpe);
-					q = pushArgument(mb, q, getArg(p, 3));
-					q = pushArgument(mb, q, varforvalue[k]);
-					pushInstruction(mb, q);
-
-					InstrPtr r;
-					tpe = getBatType(getVarType(mb, varisfor[k]));
-					if (tpe == TYPE_bte)
-						r = newInstructionArgs(mb, calcRef, putName("bte"), 2);
-					else
-						r = newInstructionArgs(mb, calcRef, putName("sht"), 2);
+				} else if (getModuleId(p) == algebraRef
+						   && getFunctionId(p) == thetaselectRef
+						   && j == 1 && p->argc == 5
+						   && getArgType(mb, p, 3) == TYPE_lng
+						   && getVarType(mb, varforvalue[k]) == TYPE_lng) {
+					/* pos = thetaselect(col, cand, v, op) with col = for.decompress(o, minval)
+					 * pos = for.thetaselect(o, cand, minval, v, op) */
+					InstrPtr r = newInstructionArgs(mb, forRef, thetaselectRef, 6);
 					if (r == NULL) {
 						msg = createException(MAL, "optimizer.for",
 											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
 						break;
 					}
-					getArg(r, 0) = newTmpVariable(mb, tpe);
-					r = pushArgument(mb, r, getArg(q, 0));
+					getArg(r, 0) = getArg(p, 0);
+					r = pushArgument(mb, r, varisfor[k]);
+					r = pushArgument(mb, r, getArg(p, 2));	/* cand */
+					r = pushArgument(mb, r, varforvalue[k]);
+					r = pushArgument(mb, r, getArg(p, 3));	/* val */
+					r = pushArgument(mb, r, getArg(p, 4));	/* op */
 					pushInstruction(mb, r);
-
-					q = copyInstruction(p);
-					if (q == NULL) {
-						msg = createException(MAL, "optimizer.for",
-											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						break;
-					}
-					getArg(q, j) = varisfor[k];
-					getArg(q, 3) = getArg(r, 0);
-					pushInstruction(mb, q);
 					freeInstruction(p);
 					done = 1;
 					break;
-#if 0
-				} else if (getFunctionId(p) == selectRef && p->argc == 9) {
-					/* select (c, s, l, h, li, hi, anti, unknown ) */
-					InstrPtr r = newInstructionArgs(mb, dictRef, selectRef, 10);
+				} else if (getModuleId(p) == algebraRef
+						   && getFunctionId(p) == selectRef
+						   && j == 1 && p->argc == 9
+						   && getArgType(mb, p, 3) == TYPE_lng
+						   && getArgType(mb, p, 4) == TYPE_lng
+						   && getVarType(mb, varforvalue[k]) == TYPE_lng) {
+					/* pos = select(col, cand, l, h, li, hi, anti, unknown) with col = for.decompress(o, minval)
+					 * pos = for.select(o, cand, minval, l, h, li, hi, anti, unknown) */
+					InstrPtr r = newInstructionArgs(mb, forRef, selectRef, 10);
 					if (r == NULL) {
 						msg = createException(MAL, "optimizer.for",
 											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
 						break;
 					}
-
 					getArg(r, 0) = getArg(p, 0);
-					r = pushArgument(mb, r, varisdict[k]);
+					r = pushArgument(mb, r, varisfor[k]);
 					r = pushArgument(mb, r, getArg(p, 2));	/* cand */
-					r = pushArgument(mb, r, vardictvalue[k]);
+					r = pushArgument(mb, r, varforvalue[k]);
 					r = pushArgument(mb, r, getArg(p, 3));	/* l */
 					r = pushArgument(mb, r, getArg(p, 4));	/* h */
 					r = pushArgument(mb, r, getArg(p, 5));	/* li */
@@ -224,54 +193,6 @@ OPTforImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 					freeInstruction(p);
 					done = 1;
 					break;
-				} else if (isSelect(p)) {
-					/* pos = select(col, cand, l, h, ...) with col = dict.decompress(o,u)
-					 * tp = select(u, nil, l, h, ...)
-					 * tp2 = batcalc.bte/sht/int(tp)
-					 * pos = intersect(o, tp2, cand, nil) */
-
-					int cand = getArg(p, j + 1);
-					InstrPtr r = copyInstruction(p);
-					if (r == NULL) {
-						msg = createException(MAL, "optimizer.for",
-											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						break;
-					}
-					getArg(r, j) = vardictvalue[k];
-					if (cand)
-						r = ReplaceWithNil(mb, r, j + 1);	/* no candidate list */
-					pushInstruction(mb, r);
-
-					int tpe = getVarType(mb, varisdict[k]);
-					InstrPtr s = newInstructionArgs(mb, dictRef, putName("convert"), 3);
-					if (s == NULL) {
-						msg = createException(MAL, "optimizer.for",
-											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						break;
-					}
-					getArg(s, 0) = newTmpVariable(mb, tpe);
-					s = pushArgument(mb, s, getArg(r, 0));
-					pushInstruction(mb, s);
-
-					InstrPtr t = newInstructionArgs(mb, algebraRef, intersectRef, 9);
-					if (t == NULL) {
-						msg = createException(MAL, "optimizer.for",
-											  SQLSTATE(HY013) MAL_MALLOC_FAIL);
-						break;
-					}
-					getArg(t, 0) = getArg(p, 0);
-					t = pushArgument(mb, t, varisdict[k]);
-					t = pushArgument(mb, t, getArg(s, 0));
-					t = pushArgument(mb, t, cand);
-					t = pushNilBat(mb, t);
-					t = pushBit(mb, t, TRUE);	/* nil matches */
-					t = pushBit(mb, t, TRUE);	/* max_one */
-					t = pushNil(mb, t, TYPE_lng);	/* estimate */
-					pushInstruction(mb, t);
-					freeInstruction(p);
-					done = 1;
-					break;
-#endif
 				} else if ((isMapOp(p) || isMap2Op(p))
 						   && (getFunctionId(p) == plusRef
 							   || getFunctionId(p) == minusRef) && p->argc > 2
@@ -13,10 +13,129 @@
 /*
  * This simple module unrolls the mat.pack into an incremental sequence.
  * This could speedup parallel processing and releases resources faster.
+ *
+ * A COPY INTO export of packed partitions does not need the packed
+ * result at all.  It is turned into a pipeline which writes each
+ * partition as soon as it is available, and releases it thereafter.
+ * This applies when the packs are only used by the export and the count
+ * of its rows, i.e. when there is no global sort or aggregate on top.
  */
 #include "monetdb_config.h"
 #include "opt_matpack.h"
 
+#define EXPORT_COLS 13			/* first column argument of sql.export_table */
+
+/* Find the export whose columns all come from packs of the same number
+ * of partitions.  Returns its index in the plan, or -1. */
+static int
+export_packs(MalBlkPtr mb, InstrPtr *def, int *uses, int *cnt)
+{
+	int i, j, e = -1;
+	InstrPtr p, q;
+
+	*cnt = -1;
+	for (i = 1; i < mb->stop; i++) {
+		p = getInstrPtr(mb, i);
+		for (j = 0; j < p->retc; j++)
+			def[getArg(p, j)] = p;
+		for (j = p->retc; j < p->argc; j++)
+			uses[getArg(p, j)]++;
+		if (getModuleId(p) == sqlRef && getFunctionId(p) == export_tableRef
+			&& p->retc == 1 && p->argc > EXPORT_COLS && e < 0)
+			e = i;
+	}
+	if (e < 0)
+		return -1;
+	p = getInstrPtr(mb, e);
+	/* the header of COPY INTO STDOUT holds the row count */
+	if (!isVarConstant(mb, getArg(p, 1))
+		|| strcmp(getVarConstant(mb, getArg(p, 1)).val.sval, "stdout") == 0)
+		return -1;
+	for (j = EXPORT_COLS; j < p->argc; j++) {
+		q = def[getArg(p, j)];
+		if (q == NULL || getModuleId(q) != matRef || getFunctionId(q) != packRef
+			|| q->retc != 1 || !isaBatType(getArgType(mb, q, 1))
+			|| q->argc != def[getArg(p, EXPORT_COLS)]->argc)
+			return -1;
+		uses[getArg(p, j)]--;
+	}
+	/* besides the export, the packs may only be counted, once */
+	for (i = e + 1; i < mb->stop; i++) {
+		q = getInstrPtr(mb, i);
+		if (getModuleId(q) == aggrRef && getFunctionId(q) == countRef
+			&& q->retc == 1 && q->argc == 2 && *cnt < 0) {
+			for (j = EXPORT_COLS; j < p->argc; j++)
+				if (getArg(p, j) == getArg(q, 1))
+					break;
+			if (j < p->argc) {
+				uses[getArg(q, 1)]--;
+				*cnt = i;
+			}
+		}
+	}
+	for (j = EXPORT_COLS; j < p->argc; j++)
+		if (uses[getArg(p, j)] != 0)
+			return -1;
+	return e;
+}
+
+/* The first column of the export which comes from pack p, or -1 */
+static int
+export_col(InstrPtr e, InstrPtr *def, InstrPtr p)
+{
+	for (int j = EXPORT_COLS; j < e->argc; j++)
+		if (def[getArg(e, j)] == p)
+			return j;
+	return -1;
+}
+
+/* Replace the export by a chain which writes one partition at a time */
+static str
+export_pipeline(Client cntxt, MalBlkPtr mb, InstrPtr e, InstrPtr *def, InstrPtr cnt)
+{
+	InstrPtr q, pack = def[getArg(e, EXPORT_COLS)];
+	int i, j, res, n;
+
+	q = newInstructionArgs(mb, sqlRef, export_startRef, e->argc + 1);
+	if (q == NULL)
+		goto bailout;
+	getArg(q, 0) = res = newTmpVariable(mb, TYPE_int);
+	q = pushReturn(mb, q, n = newTmpVariable(mb, TYPE_lng));
+	for (j = 1; j < EXPORT_COLS; j++)
+		q = pushArgument(mb, q, getArg(e, j));
+	for (j = EXPORT_COLS; j < e->argc; j++)
+		q = pushArgument(mb, q, getArg(def[getArg(e, j)], 1));
+	pushInstruction(mb, q);
+	typeChecker(cntxt->usermodule, mb, q, mb->stop - 1, TRUE);
+
+	for (i = 2; i < pack->argc; i++) {
+		q = newInstructionArgs(mb, sqlRef, export_partRef, e->argc - EXPORT_COLS + 3);
+		if (q == NULL)
+			goto bailout;
+		getArg(q, 0) = newTmpVariable(mb, TYPE_lng);
+		q = pushArgument(mb, q, res);
+		q = pushArgument(mb, q, n);
+		for (j = EXPORT_COLS; j < e->argc; j++)
+			q = pushArgument(mb, q, getArg(def[getArg(e, j)], i));
+		n = getArg(q, 0);
+		pushInstruction(mb, q);
+		typeChecker(cntxt->usermodule, mb, q, mb->stop - 1, TRUE);
+	}
+
+	q = newInstructionArgs(mb, sqlRef, export_doneRef, 4);
+	if (q == NULL)
+		goto bailout;
+	getArg(q, 0) = getArg(e, 0);
+	q = pushReturn(mb, q, cnt ? getArg(cnt, 0) : newTmpVariable(mb, TYPE_lng));
+	q = pushArgument(mb, q, res);
+	q = pushArgument(mb, q, n);
+	pushInstruction(mb, q);
+	typeChecker(cntxt->usermodule, mb, q, mb->stop - 1, TRUE);
+	return MAL_SUCCEED;
+  bailout:
+	throw(MAL, "optimizer.matpack", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+}
+
 str
 OPTmatpackImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 						 InstrPtr pci)
@@ -24,7 +143,8 @@ OPTmatpackImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 	int v, i, j, limit, slimit;
 	InstrPtr p, q;
 	int actions = 0;
-	InstrPtr *old = NULL;
+	InstrPtr *old = NULL, *def = NULL, e = NULL, cnt = NULL;
+	int *uses = NULL, epc, cntpc;
 	str msg = MAL_SUCCEED;
 
 	if (isOptimizerUsed(mb, pci, mergetableRef) <= 0) {
@@ -41,14 +161,50 @@ OPTmatpackImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 	if (i == mb->stop)
 		goto wrapup;
 
+	def = GDKzalloc(mb->vtop * sizeof(InstrPtr));
+	uses = GDKzalloc(mb->vtop * sizeof(int));
+	if (def == NULL || uses == NULL) {
+		GDKfree(def);
+		GDKfree(uses);
+		throw(MAL, "optimizer.matpack", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	if ((epc = export_packs(mb, def, uses, &cntpc)) > 0) {
+		e = getInstrPtr(mb, epc);
+		cnt = cntpc > 0 ? getInstrPtr(mb, cntpc) : NULL;
+	}
+
 	old = mb->stmt;
 	limit = mb->stop;
 	slimit = mb->ssize;
-	if (newMalBlkStmt(mb, mb->stop) < 0)
+	if (newMalBlkStmt(mb, mb->stop) < 0) {
+		GDKfree(def);
+		GDKfree(uses);
 		throw(MAL, "optimizer.matpack", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
 
 	for (i = 0; mb->errors == NULL && i < limit; i++) {
 		p = old[i];
+		if (p == e) {
+			if ((msg = export_pipeline(cntxt, mb, e, def, cnt)) != MAL_SUCCEED)
+				break;
+			for (j = EXPORT_COLS; j < e->argc; j++)
+				if (export_col(e, def, def[getArg(e, j)]) == j)
+					freeInstruction(def[getArg(e, j)]);
+			freeInstruction(e);
+			old[i] = NULL;
+			actions++;
+			continue;
+		}
+		/* the packs are replaced by the export pipeline */
+		if (e && i < epc && export_col(e, def, p) > 0) {
+			old[i] = NULL;
+			continue;
+		}
+		if (p == cnt) {
+			freeInstruction(cnt);
+			old[i] = NULL;
+			continue;
+		}
 		if (getModuleId(p) == matRef && getFunctionId(p) == packRef
 			&& isaBatType(getArgType(mb, p, 1))) {
 			q = newInstruction(0, matRef, packIncrementRef);
@@ -102,6 +258,8 @@ OPTmatpackImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 		if (old[i])
 			pushInstruction(mb, old[i]);
 	GDKfree(old);
+	GDKfree(def);
+	GDKfree(uses);
 
 	/* Defense line against incorrect plans */
 	if (msg == MAL_SUCCEED && actions > 0) {
@@ -2365,6 +2365,10 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 		if (isSample(p)) {
 			bailout = 1;
 		}
+		if (isKNearest(p)) {
+			TRC_INFO(MAL_OPTIMIZER, "Mergetable bailout k nearest\n");
+			bailout = 1;
+		}
 		/*
 		   if (isTopn(p))
 		   topn_res = getArg(p, 0);
@@ -2810,9 +2814,9 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 			continue;
 		}
 
-		/* handle dict select */
+		/* handle dict and rle select */
 		if ((match == 1 || match == bats - 1) && p->retc == 1 && isSelect(p)
-			&& getModuleId(p) == dictRef) {
+			&& (getModuleId(p) == dictRef || getModuleId(p) == rleRef)) {
 			if (mat_apply(mb, p, &ml, match)) {
 				msg = createException(MAL, "optimizer.mergetable",
 									  SQLSTATE(HY013) MAL_MALLOC_FAIL);
@@ -53,6 +53,7 @@ static struct pipeline {
 		 "deadcode",
 		 "for",
 		 "dict",
+		 "rle",
 		 "multiplex",
 		 "generator",
 		 "profiler",
@@ -87,6 +88,7 @@ static struct pipeline {
 		 "aliases",
 		 "for",
 		 "dict",
+		 "rle",
 		 "mitosis",
 		 "mergetable",
 		 "aliases",
@@ -183,6 +185,7 @@ static struct pipeline {
 		 "aliases",
 		 "for",
 		 "dict",
+		 "rle",
 		 "mergetable",
 		 "aliases",
 		 "constants",
@@ -113,6 +113,9 @@ const char *evalRef;
 const char *execRef;
 const char *export_bin_columnRef;
 const char *exportOperationRef;
+const char *export_doneRef;
+const char *export_partRef;
+const char *export_startRef;
 const char *export_tableRef;
 const char *fetchRef;
 const char *findRef;
@@ -222,6 +225,7 @@ const char *resultSetRef;
 const char *revoke_functionRef;
 const char *revokeRef;
 const char *revoke_rolesRef;
+const char *rleRef;
 const char *row_numberRef;
 const char *rpcRef;
 const char *rsColumnRef;
@@ -230,6 +234,7 @@ const char *sampleRef;
 const char *selectNotNilRef;
 const char *selectRef;
 const char *semaRef;
+const char *sendRef;
 const char *semijoinRef;
 const char *seriesRef;
 const char *setAccessRef;
@@ -375,6 +380,9 @@ optimizerInit(void)
 	execRef = putName("exec");
 	export_bin_columnRef = "export_bin_column";
 	exportOperationRef = putName("exportOperation");
+	export_doneRef = putName("export_done");
+	export_partRef = putName("export_part");
+	export_startRef = putName("export_start");
 	export_tableRef = putName("export_table");
 	fetchRef = putName("fetch");
 	findRef = putName("find");
@@ -484,6 +492,7 @@ optimizerInit(void)
 	revoke_functionRef = putName("revoke_function");
 	revokeRef = putName("revoke");
 	revoke_rolesRef = putName("revoke_roles");
+	rleRef = putName("rle");
 	row_numberRef = putName("row_number");
 	rpcRef = putName("rpc");
 	rsColumnRef = putName("rsColumn");
@@ -492,6 +501,7 @@ optimizerInit(void)
 	selectNotNilRef = putName("selectNotNil");
 	selectRef = putName("select");
 	semaRef = putName("sema");
+	sendRef = putName("send");
 	semijoinRef = putName("semijoin");
 	seriesRef = putName("series");
 	setAccessRef = putName("setAccess");
@@ -110,6 +110,9 @@ mal_export const char *evalRef;
 mal_export const char *execRef;
 mal_export const char *export_bin_columnRef;
 mal_export const char *exportOperationRef;
+mal_export const char *export_doneRef;
+mal_export const char *export_partRef;
+mal_export const char *export_startRef;
 mal_export const char *export_tableRef;
 mal_export const char *fetchRef;
 mal_export const char *findRef;
@@ -220,6 +223,7 @@ mal_export const char *resultSetRef;
 mal_export const char *revoke_functionRef;
 mal_export const char *revokeRef;
 mal_export const char *revoke_rolesRef;
+mal_export const char *rleRef;
 mal_export const char *row_numberRef;
 mal_export const char *rpcRef;
 mal_export const char *rsColumnRef;
@@ -228,6 +232,7 @@ mal_export const char *sampleRef;
 mal_export const char *selectNotNilRef;
 mal_export const char *selectRef;
 mal_export const char *semaRef;
+mal_export const char *sendRef;
 mal_export const char *semijoinRef;
 mal_export const char *seriesRef;
 mal_export const char *setAccessRef;
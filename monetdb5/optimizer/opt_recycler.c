@@ -0,0 +1,164 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+/*
+ * The recycler optimizer marks the instructions whose results can be
+ * taken from the recycle cache (see mal_recycle.c).  Their lineage must
+ * consist of reads of persistent data and side effect free operations,
+ * and the results may not be modified in place by later instructions.
+ */
+#include "monetdb_config.h"
+#include "opt_recycler.h"
+
+/* instructions which bind persistent data */
+static inline bool
+recycle_source(MalBlkPtr mb, InstrPtr p)
+{
+	int access;
+
+	if (getModuleId(p) != sqlRef)
+		return false;
+	if (getFunctionId(p) == tidRef)
+		return p->retc == 1 && (p->argc == 4 || p->argc == 6);
+	if (getFunctionId(p) != bindRef
+		|| (p->argc != p->retc + 5 && p->argc != p->retc + 7)
+		|| !isVarConstant(mb, getArg(p, p->retc + 4))
+		|| getArgType(mb, p, p->retc + 4) != TYPE_int)
+		return false;
+	/* read only access of a column, or of its committed updates */
+	access = getVarConstant(mb, getArg(p, p->retc + 4)).val.ival;
+	return (access == 0 && p->retc == 1) || (access == 2 && p->retc == 2);
+}
+
+/* operations whose result only depends on their arguments */
+static inline bool
+recycle_pure(InstrPtr p)
+{
+	const char *mod = getModuleId(p);
+
+	if (getFunctionId(p) == compressRef)
+		return false;
+	if (mod == matRef)
+		return getFunctionId(p) == packRef;
+	/* merging the committed updates, as found in prepared plans */
+	if (mod == sqlRef)
+		return getFunctionId(p) == deltaRef || getFunctionId(p) == subdeltaRef
+			|| getFunctionId(p) == projectdeltaRef;
+	return mod == algebraRef || mod == groupRef || mod == aggrRef
+		|| mod == batcalcRef || mod == calcRef || mod == batstrRef
+		|| mod == strRef || mod == batmtimeRef || mod == mtimeRef
+		|| mod == dictRef || mod == forRef || mod == rleRef;
+}
+
+/* the pure operations worth caching */
+static inline bool
+recycle_expensive(InstrPtr p)
+{
+	const char *mod = getModuleId(p), *fcn = getFunctionId(p);
+
+	if (mod == algebraRef || mod == dictRef || mod == forRef || mod == rleRef) {
+		if (fcn == selectRef || fcn == thetaselectRef || fcn == likeselectRef
+			|| fcn == selectNotNilRef)
+			return true;
+		if (mod == algebraRef
+			&& (fcn == joinRef || fcn == leftjoinRef || fcn == outerjoinRef
+				|| fcn == semijoinRef || fcn == thetajoinRef
+				|| fcn == bandjoinRef || fcn == rangejoinRef
+				|| fcn == markjoinRef || fcn == differenceRef
+				|| fcn == intersectRef))
+			return true;
+	}
+	if (mod == groupRef || mod == rleRef)
+		return fcn == groupRef || fcn == groupdoneRef || fcn == subgroupRef
+			|| fcn == subgroupdoneRef;
+	if (mod == aggrRef || mod == rleRef)
+		return fcn == subsumRef || fcn == subcountRef || fcn == subminRef
+			|| fcn == submaxRef || fcn == subavgRef || fcn == subprodRef
+			|| fcn == sumRef || fcn == countRef || fcn == minRef
+			|| fcn == maxRef || fcn == avgRef;
+	return false;
+}
+
+str
+OPTrecyclerImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
+						  InstrPtr pci)
+{
+	int i, j, actions = 0;
+	int *assigned = NULL;
+	bool *stable = NULL, *inplace = NULL;
+	InstrPtr p;
+
+	(void) cntxt;
+	(void) stk;					/* to fool compilers */
+
+	if (mb->inlineProp || RECYCLEcapacity() <= 0)
+		goto wrapup;
+
+	assigned = GDKzalloc(mb->vtop * sizeof(int));
+	stable = GDKzalloc(mb->vtop * sizeof(bool));
+	inplace = GDKzalloc(mb->vtop * sizeof(bool));
+	if (assigned == NULL || stable == NULL || inplace == NULL)
+		goto wrapup;
+
+	/* the lineage is found through the single assignment of a variable,
+	 * and BATs passed to the bat module may be changed in place */
+	for (i = 1; i < mb->stop; i++) {
+		p = getInstrPtr(mb, i);
+		for (j = 0; j < p->retc; j++)
+			assigned[getArg(p, j)]++;
+		if (getModuleId(p) == batRef
+			|| (getModuleId(p) == matRef && getFunctionId(p) == packIncrementRef))
+			for (j = p->retc; j < p->argc; j++)
+				inplace[getArg(p, j)] = true;
+	}
+
+	for (i = 1; i < mb->stop; i++) {
+		bool ok = true, keep;
+
+		p = getInstrPtr(mb, i);
+		p->recycle = RECYCLE_NONE;
+		if (p->barrier || (p->token != PATcall && p->token != CMDcall)
+			|| getModuleId(p) == NULL || getFunctionId(p) == NULL)
+			continue;
+		for (j = 0; ok && j < p->retc; j++)
+			ok = assigned[getArg(p, j)] == 1;
+		if (!ok)
+			continue;
+		if (recycle_source(mb, p)) {
+			p->recycle = RECYCLE_SOURCE;
+		} else if (recycle_pure(p)) {
+			for (j = p->retc; ok && j < p->argc; j++)
+				ok = !isaBatType(getArgType(mb, p, j))
+					|| isVarConstant(mb, getArg(p, j)) || stable[getArg(p, j)];
+			if (!ok)
+				continue;
+			keep = recycle_expensive(p);
+			for (j = 0; keep && j < p->retc; j++)
+				keep = !inplace[getArg(p, j)];
+			p->recycle = keep ? RECYCLE_CACHE : RECYCLE_PURE;
+			actions += keep;
+		} else {
+			continue;
+		}
+		for (j = 0; j < p->retc; j++)
+			stable[getArg(p, j)] = true;
+	}
+
+	/* keep actions taken as a fake argument */
+  wrapup:
+	(void) pushInt(mb, pci, actions);
+
+	GDKfree(assigned);
+	GDKfree(stable);
+	GDKfree(inplace);
+	return MAL_SUCCEED;
+}
@@ -0,0 +1,255 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+#include "monetdb_config.h"
+#include "opt_rle.h"
+
+/* the sums computed directly on the runs */
+static inline bool
+rle_sumtype(int tpe)
+{
+	return tpe == TYPE_lng ||
+#ifdef HAVE_HGE
+		tpe == TYPE_hge ||
+#endif
+		tpe == TYPE_flt || tpe == TYPE_dbl;
+}
+
+str
+OPTrleImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, j, k, limit, slimit;
+	InstrPtr p = NULL, *old = NULL;
+	int actions = 0;
+	int *varisrle = NULL, *varrlevalue = NULL;
+	str msg = MAL_SUCCEED;
+
+	(void) cntxt;
+	(void) stk;					/* to fool compilers */
+
+	if (mb->inlineProp)
+		goto wrapup;
+
+	/* a run length encoded variable is kept as the pair (bounds, values) */
+	varisrle = GDKzalloc(2 * mb->vtop * sizeof(int));
+	varrlevalue = GDKzalloc(2 * mb->vtop * sizeof(int));
+	if (varisrle == NULL || varrlevalue == NULL)
+		goto wrapup;
+
+	limit = mb->stop;
+	slimit = mb->ssize;
+	old = mb->stmt;
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		GDKfree(varisrle);
+		GDKfree(varrlevalue);
+		throw(MAL, "optimizer.rle", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	for (i = 0; mb->errors == NULL && i < limit; i++) {
+		p = old[i];
+		if (p == NULL)
+			continue;			/* left behind by others? */
+		if (p->retc == 1 && p->argc == 3 && getModuleId(p) == rleRef
+			&& getFunctionId(p) == decompressRef) {
+			/* remember we have encountered a rle decompress function */
+			k = getArg(p, 0);
+			varisrle[k] = getArg(p, 1);
+			varrlevalue[k] = getArg(p, 2);
+			freeInstruction(p);
+			old[i] = NULL;
+			continue;
+		}
+		bool done = false;
+		for (j = p->retc; j < p->argc; j++) {
+			k = getArg(p, j);
+			if (!varisrle[k])
+				continue;
+			if (j == 2 && p->argc == 3 && getModuleId(p) == algebraRef
+				&& getFunctionId(p) == projectionRef) {
+				/* projection(cand, col) with col = rle.decompress(b,v)
+				 * (b1, v1) = rle.project(cand, b, v) */
+				InstrPtr r = newInstructionArgs(mb, rleRef, projectRef, 5);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.rle",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				int l = getArg(p, 0);
+				getArg(r, 0) = newTmpVariable(mb, newBatType(TYPE_oid));
+				r = pushReturn(mb, r, newTmpVariable(mb, getVarType(mb, varrlevalue[k])));
+				r = pushArgument(mb, r, getArg(p, 1));
+				r = pushArgument(mb, r, varisrle[k]);
+				r = pushArgument(mb, r, varrlevalue[k]);
+				varisrle[l] = getArg(r, 0);
+				varrlevalue[l] = getArg(r, 1);
+				pushInstruction(mb, r);
+				freeInstruction(p);
+				old[i] = NULL;
+				done = true;
+				break;
+			} else if (p->argc == 2 && p->retc == 1
+					   && p->barrier == ASSIGNsymbol) {
+				/* a = b */
+				int l = getArg(p, 0);
+				varisrle[l] = varisrle[k];
+				varrlevalue[l] = varrlevalue[k];
+				freeInstruction(p);
+				old[i] = NULL;
+				done = true;
+				break;
+			} else if (j == 1 && getModuleId(p) == algebraRef
+					   && ((getFunctionId(p) == selectRef && p->argc == 9)
+						   || (getFunctionId(p) == thetaselectRef && p->argc == 5))) {
+				/* select(col, cand, l, h, li, hi, anti, unknown) | thetaselect(col, cand, val, op)
+				 * with col = rle.decompress(b,v)
+				 * rle.select(b, v, cand, l, h, ...) | rle.thetaselect(b, v, cand, val, op) */
+				InstrPtr r = newInstructionArgs(mb, rleRef, getFunctionId(p), p->argc + 1);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.rle",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, 0) = getArg(p, 0);
+				r = pushArgument(mb, r, varisrle[k]);
+				r = pushArgument(mb, r, varrlevalue[k]);
+				for (int a = 2; a < p->argc; a++)
+					r = pushArgument(mb, r, getArg(p, a));
+				pushInstruction(mb, r);
+				freeInstruction(p);
+				old[i] = NULL;
+				done = true;
+				break;
+			} else if (j == p->retc && p->argc == p->retc + 1
+					   && (p->retc == 2 || p->retc == 3)
+					   && getModuleId(p) == groupRef
+					   && (getFunctionId(p) == groupRef
+						   || getFunctionId(p) == groupdoneRef)) {
+				/* (g, e[, h]) = group.group[done](col) with col = rle.decompress(b,v)
+				 * (g1, e[, h]) = rle.group(b, v)
+				 * the groups are run length encoded as well: g = (b, g1) */
+				InstrPtr r = newInstructionArgs(mb, rleRef, groupRef, p->retc + 2);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.rle",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				int g = getArg(p, 0);
+				getArg(r, 0) = newTmpVariable(mb, newBatType(TYPE_oid));
+				for (int a = 1; a < p->retc; a++)
+					r = pushReturn(mb, r, getArg(p, a));
+				r = pushArgument(mb, r, varisrle[k]);
+				r = pushArgument(mb, r, varrlevalue[k]);
+				varisrle[g] = varisrle[k];
+				varrlevalue[g] = getArg(r, 0);
+				pushInstruction(mb, r);
+				freeInstruction(p);
+				old[i] = NULL;
+				done = true;
+				break;
+			} else if (j == 1 && p->retc == 1 && p->argc == 5
+					   && getModuleId(p) == aggrRef
+					   && (getFunctionId(p) == subcountRef
+						   || (getFunctionId(p) == subsumRef
+							   && rle_sumtype(getBatType(getArgType(mb, p, 0)))))
+					   && varisrle[getArg(p, 2)] == varisrle[k]) {
+				/* subcount/subsum(col, grp, ext, skip_nils) with col = rle.decompress(b,v)
+				 * and grp = rle.decompress(b,g), i.e. the same runs
+				 * rle.subcount/subsum(b, v, g, ext, skip_nils) */
+				InstrPtr r = newInstructionArgs(mb, rleRef, getFunctionId(p), 6);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.rle",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, 0) = getArg(p, 0);
+				r = pushArgument(mb, r, varisrle[k]);
+				r = pushArgument(mb, r, varrlevalue[k]);
+				r = pushArgument(mb, r, varrlevalue[getArg(p, 2)]);
+				r = pushArgument(mb, r, getArg(p, 3));
+				r = pushArgument(mb, r, getArg(p, 4));
+				pushInstruction(mb, r);
+				freeInstruction(p);
+				old[i] = NULL;
+				done = true;
+				break;
+			} else if (j == 1 && p->retc == 1 && getModuleId(p) == aggrRef
+					   && ((getFunctionId(p) == sumRef && p->argc == 2
+							&& rle_sumtype(getArgType(mb, p, 0)))
+						   || (getFunctionId(p) == countRef
+							   && (p->argc == 2
+								   || (p->argc == 3 && getArgType(mb, p, 2) == TYPE_bit))))) {
+				/* sum/count(col[, ignorenil]) with col = rle.decompress(b,v)
+				 * rle.sum/count(b, v[, ignorenil]) */
+				InstrPtr r = newInstructionArgs(mb, rleRef, getFunctionId(p), p->argc + 1);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.rle",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, 0) = getArg(p, 0);
+				r = pushArgument(mb, r, varisrle[k]);
+				r = pushArgument(mb, r, varrlevalue[k]);
+				if (p->argc == 3)
+					r = pushArgument(mb, r, getArg(p, 2));
+				pushInstruction(mb, r);
+				freeInstruction(p);
+				old[i] = NULL;
+				done = true;
+				break;
+			} else {
+				/* need to decompress */
+				int tpe = getArgType(mb, p, j);
+				InstrPtr r = newInstructionArgs(mb, rleRef, decompressRef, 3);
+				if (r == NULL) {
+					msg = createException(MAL, "optimizer.rle",
+										  SQLSTATE(HY013) MAL_MALLOC_FAIL);
+					break;
+				}
+				getArg(r, 0) = newTmpVariable(mb, tpe);
+				r = pushArgument(mb, r, varisrle[k]);
+				r = pushArgument(mb, r, varrlevalue[k]);
+				pushInstruction(mb, r);
+
+				getArg(p, j) = getArg(r, 0);
+				actions++;
+			}
+		}
+		if (msg)
+			break;
+		if (done)
+			actions++;
+		else {
+			pushInstruction(mb, p);
+			old[i] = NULL;
+		}
+	}
+
+	for (; i < slimit; i++)
+		if (old[i])
+			freeInstruction(old[i]);
+	/* Defense line against incorrect plans */
+	if (msg == MAL_SUCCEED && actions > 0) {
+		msg = chkTypes(cntxt->usermodule, mb, FALSE);
+		if (!msg)
+			msg = chkFlow(mb);
+		if (!msg)
+			msg = chkDeclarations(mb);
+	}
+	/* keep all actions taken as a post block comment */
+  wrapup:
+	/* keep actions taken as a fake argument */
+	(void) pushInt(mb, pci, actions);
+
+	GDKfree(old);
+	GDKfree(varisrle);
+	GDKfree(varrlevalue);
+	return msg;
+}
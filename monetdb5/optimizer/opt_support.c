@@ -348,6 +348,12 @@ hasSideEffects(MalBlkPtr mb, InstrPtr p, int strict)
 			return FALSE;
 		if (getFunctionId(p) == importColumnRef)
 			return FALSE;
+		/* the partitions of a pipelined export are ordered by their
+		 * row counts, so they may be written from a dataflow block */
+		if (getFunctionId(p) == export_startRef)
+			return FALSE;
+		if (getFunctionId(p) == export_partRef)
+			return FALSE;
 		return TRUE;
 	}
 	if (getModuleId(p) == mapiRef) {
@@ -507,6 +513,16 @@ isSample(InstrPtr p)
 	return (getModuleId(p) == sampleRef && getFunctionId(p) == subuniformRef);
 }
 
+/* the k nearest are chosen over all input, not per partition */
+int
+isKNearest(InstrPtr p)
+{
+	const char *func = getFunctionId(p);
+
+	return (getModuleId(p) == rtreeRef && func
+			&& strncmp(func, "KNearest", 8) == 0);
+}
+
 inline int
 isOrderby(InstrPtr p)
 {
@@ -47,6 +47,7 @@ extern int isLikeOp(InstrPtr q);
 extern int isTopn(InstrPtr q);
 extern int isSlice(InstrPtr q);
 extern int isSample(InstrPtr q);
+extern int isKNearest(InstrPtr q);
 extern int isOrderby(InstrPtr q);
 extern int isSelect(InstrPtr q);
 extern int isSubJoin(InstrPtr q);
@@ -52,6 +52,8 @@
 #include "opt_remap.h"
 #include "opt_remoteQueries.h"
 #include "opt_reorder.h"
+#include "opt_recycler.h"
+#include "opt_rle.h"
 #include "opt_fastpath.h"
 #include "optimizer_private.h"
 
@@ -88,10 +90,12 @@ static struct {
 	{"projectionpath", &OPTprojectionpathImplementation, 0, 0},
 	{"pushselect", &OPTpushselectImplementation, 0, 0},
 	{"querylog", &OPTquerylogImplementation, 0, 0},
+	{"recycler", &OPTrecyclerImplementation, 0, 0},
 	{"reduce", &OPTreduceImplementation, 0, 0},
 	{"remap", &OPTremapImplementation, 0, 0},
 	{"remoteQueries", &OPTremoteQueriesImplementation, 0, 0},
 	{"reorder", &OPTreorderImplementation, 0, 0},
+	{"rle", &OPTrleImplementation, 0, 0},
 	{0, 0, 0, 0}
 };
 
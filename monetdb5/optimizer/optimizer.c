@@ -129,6 +129,8 @@ static mel_func optimizer_init_funcs[] = {
 	optwrapper_pattern("strimps", "Use strimps index if appropriate"),
 	optwrapper_pattern("for", "Push for decompress down"),
 	optwrapper_pattern("dict", "Push dict decompress down"),
+	optwrapper_pattern("rle", "Push rle decompress down"),
+	optwrapper_pattern("recycler", "Mark instructions whose results may be recycled"),
 	{.imp = NULL}
 };
 
@@ -25,6 +25,7 @@
 
 #include "gdk_time.h"
 #include "mutils.h"
+#include "mcrypt.h"
 
 #include <setjmp.h>
 #include <signal.h>
@@ -347,6 +348,7 @@ static const char debug_flag[] = "capi_use_debug";
 #endif
 static const char cc_flag[] = "capi_cc";
 static const char cpp_flag[] = "capi_cpp";
+static const char cudf_cache_dir[] = "capi_cache";
 
 static const char cflags_pragma[] = "#pragma CFLAGS ";
 static const char ldflags_pragma[] = "#pragma LDFLAGS ";
@@ -424,49 +426,39 @@ bailout:
 	return msg;
 }
 
-static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
-					bool grouped)
+/* Generate the source of a C UDF with the given inputs and outputs, then
+ * compile and link it into a shared library and load the function from it.
+ * Compiled libraries are kept in the capi_cache directory of the database, so
+ * after a restart, or when another session or an earlier CREATE FUNCTION
+ * already compiled the same source, the library is loaded without compiling. */
+static str
+CUDFcompile(const char *funcname, bool use_cpp, char *exprStr,
+			size_t input_count, str *input_names, const int *input_types,
+			bool add_aggr_group, size_t output_count, str *output_names,
+			const int *output_types, void **dll_handle, jitted_function *function)
 {
-	sql_func *sqlfun = NULL;
-	bit use_cpp = *getArgReference_bit(stk, pci, pci->retc + 1);
-	str exprStr = *getArgReference_str(stk, pci, pci->retc + 2);
-
-	const int ARG_OFFSET = 3;
-
 	size_t i = 0, j = 0;
-	char argbuf[64];
 	char buf[8192];
 	char *fname = NULL;
 	char *oname = NULL;
 	char *libname = NULL;
+	char *cachedirpath = NULL;
+	char *cachename = NULL;
+	char *source = NULL;
+	char *source_hash = NULL;
+	long source_size;
+	struct stat st;
 	char error_buf[BUFSIZ];
 	char total_error_buf[8192];
 	size_t error_buffer_position = 0;
-	str *args = NULL;
-	str *output_names = NULL;
 	char *msg = MAL_SUCCEED;
-	node *argnode;
-	int seengrp = 0;
 	FILE *f = NULL;
 	void *handle = NULL;
 	jitted_function func = NULL;
-	int ret, limit_argc = 0;
 
 	FILE *compiler = NULL;
 	int compiler_return_code;
 
-	void **inputs = NULL;
-	size_t input_count = 0;
-	void **outputs = NULL;
-	size_t output_count = 0;
-	BAT **input_bats = NULL;
-	mprotected_region *regions = NULL, *region_iter = NULL;
-
-	lng initial_output_count = -1;
-
-	struct sigaction sa = (struct sigaction) {.sa_flags = 0}, oldsa, oldsb;
-	sigset_t signal_set;
-
 #ifdef NDEBUG
 	bool debug_build =
 		GDKgetenv_istrue(debug_flag) || GDKgetenv_isyes(debug_flag);
@@ -476,7 +468,6 @@ static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 	char* extra_cflags = NULL;
 	char* extra_ldflags = NULL;
 
-
 	const char *compilation_flags = debug_build ? "-g -O0" : "-O2";
 	const char *c_compiler =
 		use_cpp ? (GDKgetenv(cpp_flag) ? GDKgetenv(cpp_flag)
@@ -484,6 +475,460 @@ static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 				: (GDKgetenv(cc_flag) ? GDKgetenv(cc_flag) : JIT_COMPILER_NAME);
 
 	const char struct_prefix[] = "struct cudf_data_struct_";
+	const char *tpe = NULL;
+
+	// first generate the names	of the files
+	// we place the temporary files in the DELDIR directory
+	// because this will be removed again upon server startup
+	const int RANDOM_NAME_SIZE = 32;
+	const char prefix[] = TEMPDIR_NAME DIR_SEP_STR;
+	size_t prefix_size = strlen(prefix);
+	char *deldirpath;
+
+	memcpy(buf, prefix, sizeof(char) * strlen(prefix));
+	// generate a random 32-character name for the temporary files
+	for (i = prefix_size; i < prefix_size + RANDOM_NAME_SIZE; i++) {
+		buf[i] = valid_path_characters[rand() %
+									   (sizeof(valid_path_characters) - 1)];
+	}
+	buf[i] = '\0';
+	fname = GDKfilepath(0, BATDIR, buf, "c");
+	if (fname == NULL) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	oname = GDKstrdup(fname);
+	if (oname == NULL) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	oname[strlen(oname) - 1] = 'o';
+
+	memmove(buf + strlen(SO_PREFIX) + prefix_size, buf + prefix_size,
+			i + 1 - prefix_size);
+	memcpy(buf + prefix_size, SO_PREFIX, sizeof(char) * strlen(SO_PREFIX));
+	libname =
+		GDKfilepath(0, BATDIR, buf, SO_EXT[0] == '.' ? &SO_EXT[1] : SO_EXT);
+	if (libname == NULL) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+
+	// if DELDIR directory does not exist, create it
+	deldirpath = GDKfilepath(0, NULL, TEMPDIR, NULL);
+	if (deldirpath == NULL) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	if (MT_mkdir(deldirpath) < 0 && errno != EEXIST) {
+		msg = createException(MAL, "cudf.eval",
+							  "cannot create directory %s\n", deldirpath);
+		goto wrapup;
+	}
+	GDKfree(deldirpath);
+
+	// now generate the source file
+	f = MT_fopen(fname, "w+");
+	if (!f) {
+		msg = createException(MAL, "cudf.eval",
+							  "Failed to open file for JIT compilation: %s",
+							  GDKstrerror(errno, (char[128]){0}, 128));
+		errno = 0;
+		goto wrapup;
+	}
+
+	// include some standard C headers first
+	ATTEMPT_TO_WRITE_TO_FILE(f, "#include <stdio.h>\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "#include <stdlib.h>\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "#include <string.h>\n");
+	// we include "cheader.h", but not directly to avoid having to deal with
+	// headers, etc...
+	// Instead it is embedded in a string (loaded from "cheader.text.h")
+	// this file contains the structures used for input/output arguments
+	ATTEMPT_TO_WRITE_TO_FILE(f, cheader_header_text);
+	// some monetdb-style typedefs to make it easier
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef int8_t bte;\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef int16_t sht;\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef int64_t lng;\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef float flt;\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef double dbl;\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef char* str;\n");
+	ATTEMPT_TO_WRITE_TO_FILE(f, "typedef size_t oid;\n");
+	// now we search exprStr for any preprocessor directives (#)
+	// we move these to the top of the file
+	// this allows the user to normally #include files
+	{
+		int preprocessor_start = 0;
+		bool is_preprocessor_directive = false;
+		bool new_line = false;
+		for (i = 0; i < strlen(exprStr); i++) {
+			if (exprStr[i] == '\n') {
+				if (is_preprocessor_directive) {
+					// the previous line was a preprocessor directive
+					// first check if it is one of our special preprocessor directives
+					if (i - preprocessor_start >= strlen(cflags_pragma) &&
+						memcmp(exprStr + preprocessor_start, cflags_pragma, strlen(cflags_pragma)) == 0) {
+						size_t cflags_characters = (i - preprocessor_start) - strlen(cflags_pragma);
+						if (cflags_characters > 0 && !extra_cflags) {
+							extra_cflags = GDKzalloc(cflags_characters + 1);
+							if (extra_cflags) {
+								memcpy(extra_cflags, exprStr + preprocessor_start + strlen(cflags_pragma), cflags_characters);
+							}
+						}
+					} else if (i - preprocessor_start >= strlen(ldflags_pragma) &&
+						memcmp(exprStr + preprocessor_start, ldflags_pragma, strlen(ldflags_pragma)) == 0) {
+						size_t ldflags_characters = (i - preprocessor_start) - strlen(ldflags_pragma);
+						if (ldflags_characters > 0 && !extra_ldflags) {
+							extra_ldflags = GDKzalloc(ldflags_characters + 1);
+							if (extra_ldflags) {
+								memcpy(extra_ldflags, exprStr + preprocessor_start + strlen(ldflags_pragma), ldflags_characters);
+							}
+						}
+					} else {
+						// regular preprocessor directive: write it to the file
+						ATTEMPT_TO_WRITE_DATA_TO_FILE(f, exprStr +
+															 preprocessor_start,
+													  i - preprocessor_start);
+						ATTEMPT_TO_WRITE_TO_FILE(f, "\n");
+					}
+					// now overwrite the preprocessor directive in the
+					// expression string with spaces
+					for (j = preprocessor_start; j < i; j++) {
+						exprStr[j] = ' ';
+					}
+				}
+				is_preprocessor_directive = false;
+				new_line = true;
+			} else if (exprStr[i] == ' ' || exprStr[i] == '\t') {
+				// skip any spaces
+				continue;
+			} else if (new_line) {
+				if (exprStr[i] == '#') {
+					preprocessor_start = i;
+					is_preprocessor_directive = true;
+				}
+				new_line = false;
+			}
+		}
+	}
+
+	// create the actual function
+	if (use_cpp) {
+		// avoid name wrangling if we are compiling C++ code
+		ATTEMPT_TO_WRITE_TO_FILE(f, "\nextern \"C\"");
+	}
+	ATTEMPT_TO_WRITE_TO_FILE(f, "\nchar* ");
+	ATTEMPT_TO_WRITE_TO_FILE(f, funcname);
+	ATTEMPT_TO_WRITE_TO_FILE(f, "(void** __inputs, void** __outputs, "
+								"malloc_function_ptr malloc, free_function_ptr free) {\n");
+
+	// now we convert the input arguments from void** to the proper
+	// input/output
+	// of the function
+	// first convert the input
+	for (i = 0; i < input_count; i++) {
+		tpe = GetTypeName(input_types[i]);
+		assert(tpe);
+		if (tpe) {
+			snprintf(buf, sizeof(buf),
+					 "\t%s%s %s = *((%s%s*)__inputs[%zu]);\n", struct_prefix,
+					 tpe, input_names[i], struct_prefix, tpe, i);
+			ATTEMPT_TO_WRITE_TO_FILE(f, buf);
+		}
+	}
+	if (add_aggr_group) {
+		// manually add "aggr_group" for non-grouped aggregates
+		tpe = GetTypeName(TYPE_oid);
+		assert(tpe);
+		if (tpe) {
+			snprintf(buf, sizeof(buf),
+					 "\t%s%s %s = *((%s%s*)__inputs[%zu]);\n", struct_prefix,
+					 tpe, "aggr_group", struct_prefix, tpe, input_count);
+			ATTEMPT_TO_WRITE_TO_FILE(f, buf);
+		}
+	}
+	// output types
+	for (i = 0; i < output_count; i++) {
+		tpe = GetTypeName(output_types[i]);
+		assert(tpe);
+		if (tpe) {
+			snprintf(buf, sizeof(buf),
+					 "\t%s%s* %s = ((%s%s*)__outputs[%zu]);\n", struct_prefix,
+					 tpe, output_names[i], struct_prefix, tpe, i);
+			ATTEMPT_TO_WRITE_TO_FILE(f, buf);
+		}
+	}
+
+	ATTEMPT_TO_WRITE_TO_FILE(f, "\n");
+	// write the actual user defined code into the file
+	ATTEMPT_TO_WRITE_TO_FILE(f, exprStr);
+
+	ATTEMPT_TO_WRITE_TO_FILE(f, "\nreturn 0;\n}\n");
+
+	// the compiled UDF cache in the dbfarm is keyed on a hash of the
+	// generated source, the compiler invocation and the server version,
+	// so a library found there can be loaded instead of compiling again
+	snprintf(buf, sizeof(buf), "\n%s %s %s\n%s\n%s %s", c_compiler,
+			 extra_cflags ? extra_cflags : "", compilation_flags,
+			 extra_ldflags ? extra_ldflags : "", MONETDB_VERSION,
+			 mercurial_revision());
+	if (fflush(f) != 0 || (source_size = ftell(f)) < 0) {
+		errno = 0;
+		msg = createException(MAL, "cudf.eval", "Write error.");
+		goto wrapup;
+	}
+	source = GDKmalloc((size_t) source_size + strlen(buf) + 1);
+	if (!source) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	rewind(f);
+	if (fread(source, 1, (size_t) source_size, f) != (size_t) source_size) {
+		errno = 0;
+		msg = createException(MAL, "cudf.eval", "Read error.");
+		goto wrapup;
+	}
+	fclose(f);
+	f = NULL;
+	strcpy(source + source_size, buf);
+	source_hash = mcrypt_SHA256Sum(source, (size_t) source_size + strlen(buf));
+	if (!source_hash) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	cachedirpath = GDKfilepath(0, NULL, cudf_cache_dir, NULL);
+	if (cachedirpath == NULL) {
+		msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	if (MT_mkdir(cachedirpath) < 0 && errno != EEXIST) {
+		// without a cache directory we just compile every time
+		errno = 0;
+	} else {
+		snprintf(buf, sizeof(buf), "%s%s", SO_PREFIX, source_hash);
+		cachename = GDKfilepath(0, cudf_cache_dir, buf,
+								SO_EXT[0] == '.' ? &SO_EXT[1] : SO_EXT);
+		if (cachename == NULL) {
+			msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+			goto wrapup;
+		}
+		if (MT_stat(cachename, &st) == 0)
+			handle = dlopen(cachename, RTLD_LAZY);
+	}
+	errno = 0;
+	if (handle)
+		goto load;
+
+	// now it's time to try to compile the code
+	// we use popen to capture any error output
+	snprintf(buf, sizeof(buf), "%s %s -c -fPIC %s %s -o %s 2>&1 >/dev/null",
+			 c_compiler, extra_cflags ? extra_cflags : "", compilation_flags, fname, oname);
+	GDKfree(fname);
+	fname = NULL;
+	compiler = popen(buf, "r");
+	if (!compiler) {
+		msg = createException(MAL, "cudf.eval", "Failed popen");
+		goto wrapup;
+	}
+	// read the error stream into the error buffer until the compiler is
+	// done
+	while (fgets(error_buf, sizeof(error_buf), compiler)) {
+		size_t error_size = strlen(error_buf);
+		snprintf(total_error_buf + error_buffer_position,
+				 sizeof(total_error_buf) - error_buffer_position, "%s",
+				 error_buf);
+		error_buffer_position += error_size;
+		if (error_buffer_position >= sizeof(total_error_buf)) break;
+	}
+
+	compiler_return_code = pclose(compiler);
+	compiler = NULL;
+
+	if (compiler_return_code != 0) {
+		// failure in compiling the code
+		// report the failure to the user
+		msg = createException(MAL, "cudf.eval",
+							  "Failed to compile C UDF:\n%s",
+							  total_error_buf);
+		goto wrapup;
+	}
+
+	error_buffer_position = 0;
+	error_buf[0] = '\0';
+
+	snprintf(buf, sizeof(buf), "%s %s %s -shared -o %s 2>&1 >/dev/null", c_compiler,
+		extra_ldflags ? extra_ldflags : "", oname, libname);
+	GDKfree(oname);
+	oname = NULL;
+	compiler = popen(buf, "r");
+	if (!compiler) {
+		msg = createException(MAL, "cudf.eval", "Failed popen");
+		goto wrapup;
+	}
+	while (fgets(error_buf, sizeof(error_buf), compiler)) {
+		size_t error_size = strlen(error_buf);
+		snprintf(total_error_buf + error_buffer_position,
+				 sizeof(total_error_buf) - error_buffer_position, "%s",
+				 error_buf);
+		error_buffer_position += error_size;
+		if (error_buffer_position >= sizeof(total_error_buf)) break;
+	}
+
+	compiler_return_code = pclose(compiler);
+	compiler = NULL;
+
+	if (compiler_return_code != 0) {
+		// failure in compiler
+		msg = createException(MAL, "cudf.eval", "Failed to link C UDF.\n%s",
+							  total_error_buf);
+		goto wrapup;
+	}
+
+	// keep the library in the cache, loading it from there if it got in
+	if (cachename && MT_rename(libname, cachename) == 0) {
+		GDKfree(libname);
+		libname = cachename;
+		cachename = NULL;
+	}
+	handle = dlopen(libname, RTLD_LAZY);
+	GDKfree(libname);
+	libname = NULL;
+	if (!handle) {
+		msg = createException(MAL, "cudf.eval",
+							  "Failed to open shared library: %s.",
+							  dlerror());
+		goto wrapup;
+	}
+load:
+	func = (jitted_function)dlsym(handle, funcname);
+	if (!func) {
+		msg = createException(MAL, "cudf.eval",
+							  "Failed to load function from library: %s.",
+							  dlerror());
+		goto wrapup;
+	}
+
+	*dll_handle = handle;
+	*function = func;
+	handle = NULL;
+
+wrapup:
+	GDKfree(fname);
+	GDKfree(oname);
+	GDKfree(libname);
+	GDKfree(cachedirpath);
+	GDKfree(cachename);
+	GDKfree(source);
+	free(source_hash);
+	if (f) {
+		fclose(f);
+	}
+	if (handle) {
+		dlclose(handle);
+	}
+	if (compiler) {
+		pclose(compiler);
+	}
+	if (extra_cflags) {
+		GDKfree(extra_cflags);
+	}
+	if (extra_ldflags) {
+		GDKfree(extra_ldflags);
+	}
+	return msg;
+}
+
+/* Compile a C UDF when it is created, so that CREATE FUNCTION reports
+ * compilation errors and the first call finds the library in the cache. */
+static str
+CUDFprepare(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	sql_func *sqlfun = *(sql_func **)getArgReference_ptr(stk, pci, pci->retc);
+	size_t input_count = list_length(sqlfun->ops);
+	size_t output_count = list_length(sqlfun->res);
+	size_t i = 0;
+	str *names = NULL;
+	int *types = NULL;
+	char *exprStr = NULL;
+	void *handle = NULL;
+	jitted_function func = NULL;
+	char *msg = MAL_SUCCEED;
+
+	(void)cntxt;
+	(void)mb;
+
+	// the argument names of vararg functions are only known when called
+	if (sqlfun->vararg || !sqlfun->query)
+		return MAL_SUCCEED;
+	names = GDKmalloc(sizeof(str) * (input_count + output_count + 1));
+	types = GDKmalloc(sizeof(int) * (input_count + output_count + 1));
+	exprStr = GDKstrdup(sqlfun->query);
+	if (!names || !types || !exprStr) {
+		msg = createException(MAL, "cudf.prepare", MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	for (node *n = sqlfun->ops ? sqlfun->ops->h : NULL; n; n = n->next, i++) {
+		sql_arg *a = n->data;
+
+		names[i] = a->name;
+		types[i] = a->type.type->localtype;
+		if (!names[i] || !GetTypeName(types[i]))
+			goto wrapup; // leave it to the first call
+	}
+	for (node *n = sqlfun->res ? sqlfun->res->h : NULL; n; n = n->next, i++) {
+		sql_arg *a = n->data;
+
+		names[i] = a->name;
+		types[i] = a->type.type->localtype;
+		if (!names[i] || !GetTypeName(types[i]))
+			goto wrapup;
+	}
+	msg = CUDFcompile(sqlfun->base.name, sqlfun->lang == FUNC_LANG_CPP,
+					  exprStr, input_count, names, types,
+					  sqlfun->type == F_AGGR, output_count,
+					  names + input_count, types + input_count, &handle,
+					  &func);
+	if (handle)
+		dlclose(handle);
+wrapup:
+	GDKfree(names);
+	GDKfree(types);
+	GDKfree(exprStr);
+	return msg;
+}
+
+static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
+					bool grouped)
+{
+	sql_func *sqlfun = NULL;
+	bit use_cpp = *getArgReference_bit(stk, pci, pci->retc + 1);
+	str exprStr = *getArgReference_str(stk, pci, pci->retc + 2);
+
+	const int ARG_OFFSET = 3;
+
+	size_t i = 0, j = 0;
+	char argbuf[64];
+	str *args = NULL;
+	str *output_names = NULL;
+	char *msg = MAL_SUCCEED;
+	node *argnode;
+	int seengrp = 0;
+	void *handle = NULL;
+	jitted_function func = NULL;
+	int ret, limit_argc = 0;
+
+	void **inputs = NULL;
+	size_t input_count = 0;
+	void **outputs = NULL;
+	size_t output_count = 0;
+	BAT **input_bats = NULL;
+	mprotected_region *regions = NULL, *region_iter = NULL;
+
+	lng initial_output_count = -1;
+
+	struct sigaction sa = (struct sigaction) {.sa_flags = 0}, oldsa, oldsb;
+	sigset_t signal_set;
+
 	const char *funcname;
 
 	BUN expression_hash = 0, funcname_hash = 0;
@@ -494,7 +939,6 @@ static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 
 	size_t index = 0;
 	int bat_type = 0;
-	const char* tpe = NULL;
 
 	size_t extra_inputs = 0;
 
@@ -671,284 +1115,24 @@ static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 		// function was not found in the cache
 		// we have to compile it
 
-		// first generate the names	of the files
-		// we place the temporary files in the DELDIR directory
-		// because this will be removed again upon server startup
-		const int RANDOM_NAME_SIZE = 32;
-		const char prefix[] = TEMPDIR_NAME DIR_SEP_STR;
-		size_t prefix_size = strlen(prefix);
-		char *deldirpath;
-
-		memcpy(buf, prefix, sizeof(char) * strlen(prefix));
-		// generate a random 32-character name for the temporary files
-		for (i = prefix_size; i < prefix_size + RANDOM_NAME_SIZE; i++) {
-			buf[i] = valid_path_characters[rand() %
-										   (sizeof(valid_path_characters) - 1)];
-		}
-		buf[i] = '\0';
-		fname = GDKfilepath(0, BATDIR, buf, "c");
-		if (fname == NULL) {
+		int *types = GDKmalloc(sizeof(int) * (input_count + output_count + 1));
+		if (!types) {
 			msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
 			goto wrapup;
 		}
-		oname = GDKstrdup(fname);
-		if (oname == NULL) {
-			msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
-			goto wrapup;
+		for (i = 0; i < input_count; i++) {
+			bat_type = getArgType(mb, pci, i + pci->retc + ARG_OFFSET);
+			types[i] = isaBatType(bat_type) ? getBatType(bat_type) : bat_type;
 		}
-		oname[strlen(oname) - 1] = 'o';
-
-		memmove(buf + strlen(SO_PREFIX) + prefix_size, buf + prefix_size,
-				i + 1 - prefix_size);
-		memcpy(buf + prefix_size, SO_PREFIX, sizeof(char) * strlen(SO_PREFIX));
-		libname =
-			GDKfilepath(0, BATDIR, buf, SO_EXT[0] == '.' ? &SO_EXT[1] : SO_EXT);
-		if (libname == NULL) {
-			msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
-			goto wrapup;
-		}
-
-		// if DELDIR directory does not exist, create it
-		deldirpath = GDKfilepath(0, NULL, TEMPDIR, NULL);
-		if (deldirpath == NULL) {
-			msg = createException(MAL, "cudf.eval", MAL_MALLOC_FAIL);
+		for (i = 0; i < output_count; i++)
+			types[input_count + i] = getBatType(getArgType(mb, pci, i));
+		msg = CUDFcompile(funcname, use_cpp, exprStr, input_count,
+						  args + pci->retc + ARG_OFFSET, types,
+						  non_grouped_aggregate, output_count, output_names,
+						  types + input_count, &handle, &func);
+		GDKfree(types);
+		if (msg)
 			goto wrapup;
-		}
-		if (MT_mkdir(deldirpath) < 0 && errno != EEXIST) {
-			msg = createException(MAL, "cudf.eval",
-								  "cannot create directory %s\n", deldirpath);
-			goto wrapup;
-		}
-		GDKfree(deldirpath);
-
-		// now generate the source file
-		f = MT_fopen(fname, "w+");
-		if (!f) {
-			msg = createException(MAL, "cudf.eval",
-								  "Failed to open file for JIT compilation: %s",
-								  GDKstrerror(errno, (char[128]){0}, 128));
-			errno = 0;
-			goto wrapup;
-		}
-
-		// include some standard C headers first
-		ATTEMPT_TO_WRITE_TO_FILE(f, "#include <stdio.h>\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "#include <stdlib.h>\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "#include <string.h>\n");
-		// we include "cheader.h", but not directly to avoid having to deal with
-		// headers, etc...
-		// Instead it is embedded in a string (loaded from "cheader.text.h")
-		// this file contains the structures used for input/output arguments
-		ATTEMPT_TO_WRITE_TO_FILE(f, cheader_header_text);
-		// some monetdb-style typedefs to make it easier
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef int8_t bte;\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef int16_t sht;\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef int64_t lng;\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef float flt;\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef double dbl;\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef char* str;\n");
-		ATTEMPT_TO_WRITE_TO_FILE(f, "typedef size_t oid;\n");
-		// now we search exprStr for any preprocessor directives (#)
-		// we move these to the top of the file
-		// this allows the user to normally #include files
-		{
-			int preprocessor_start = 0;
-			bool is_preprocessor_directive = false;
-			bool new_line = false;
-			for (i = 0; i < strlen(exprStr); i++) {
-				if (exprStr[i] == '\n') {
-					if (is_preprocessor_directive) {
-						// the previous line was a preprocessor directive
-						// first check if it is one of our special preprocessor directives
-						if (i - preprocessor_start >= strlen(cflags_pragma) &&
-							memcmp(exprStr + preprocessor_start, cflags_pragma, strlen(cflags_pragma)) == 0) {
-							size_t cflags_characters = (i - preprocessor_start) - strlen(cflags_pragma);
-							if (cflags_characters > 0 && !extra_cflags) {
-								extra_cflags = GDKzalloc(cflags_characters + 1);
-								if (extra_cflags) {
-									memcpy(extra_cflags, exprStr + preprocessor_start + strlen(cflags_pragma), cflags_characters);
-								}
-							}
-						} else if (i - preprocessor_start >= strlen(ldflags_pragma) &&
-							memcmp(exprStr + preprocessor_start, ldflags_pragma, strlen(ldflags_pragma)) == 0) {
-							size_t ldflags_characters = (i - preprocessor_start) - strlen(ldflags_pragma);
-							if (ldflags_characters > 0 && !extra_ldflags) {
-								extra_ldflags = GDKzalloc(ldflags_characters + 1);
-								if (extra_ldflags) {
-									memcpy(extra_ldflags, exprStr + preprocessor_start + strlen(ldflags_pragma), ldflags_characters);
-								}
-							}
-						} else {
-							// regular preprocessor directive: write it to the file
-							ATTEMPT_TO_WRITE_DATA_TO_FILE(f, exprStr +
-																 preprocessor_start,
-														  i - preprocessor_start);
-							ATTEMPT_TO_WRITE_TO_FILE(f, "\n");
-						}
-						// now overwrite the preprocessor directive in the
-						// expression string with spaces
-						for (j = preprocessor_start; j < i; j++) {
-							exprStr[j] = ' ';
-						}
-					}
-					is_preprocessor_directive = false;
-					new_line = true;
-				} else if (exprStr[i] == ' ' || exprStr[i] == '\t') {
-					// skip any spaces
-					continue;
-				} else if (new_line) {
-					if (exprStr[i] == '#') {
-						preprocessor_start = i;
-						is_preprocessor_directive = true;
-					}
-					new_line = false;
-				}
-			}
-		}
-
-		// create the actual function
-		if (use_cpp) {
-			// avoid name wrangling if we are compiling C++ code
-			ATTEMPT_TO_WRITE_TO_FILE(f, "\nextern \"C\"");
-		}
-		ATTEMPT_TO_WRITE_TO_FILE(f, "\nchar* ");
-		ATTEMPT_TO_WRITE_TO_FILE(f, funcname);
-		ATTEMPT_TO_WRITE_TO_FILE(f, "(void** __inputs, void** __outputs, "
-									"malloc_function_ptr malloc, free_function_ptr free) {\n");
-
-		// now we convert the input arguments from void** to the proper
-		// input/output
-		// of the function
-		// first convert the input
-		for (i = pci->retc + ARG_OFFSET; i < (size_t)limit_argc; i++) {
-			bat_type = !isaBatType(getArgType(mb, pci, i))
-							   ? getArgType(mb, pci, i)
-							   : getBatType(getArgType(mb, pci, i));
-			tpe = GetTypeName(bat_type);
-			assert(tpe);
-			if (tpe) {
-				snprintf(buf, sizeof(buf),
-						 "\t%s%s %s = *((%s%s*)__inputs[%zu]);\n", struct_prefix,
-						 tpe, args[i], struct_prefix, tpe,
-						 i - (pci->retc + ARG_OFFSET));
-				ATTEMPT_TO_WRITE_TO_FILE(f, buf);
-			}
-		}
-		if (non_grouped_aggregate) {
-			// manually add "aggr_group" for non-grouped aggregates
-			bat_type = TYPE_oid;
-			tpe = GetTypeName(bat_type);
-			assert(tpe);
-			if (tpe) {
-				snprintf(buf, sizeof(buf),
-						 "\t%s%s %s = *((%s%s*)__inputs[%zu]);\n", struct_prefix,
-						 tpe, "aggr_group", struct_prefix, tpe, input_count);
-				ATTEMPT_TO_WRITE_TO_FILE(f, buf);
-			}
-		}
-		// output types
-		for (i = 0; i < (size_t)pci->retc; i++) {
-			bat_type = getBatType(getArgType(mb, pci, i));
-			tpe = GetTypeName(bat_type);
-			assert(tpe);
-			if (tpe) {
-				snprintf(buf, sizeof(buf),
-						 "\t%s%s* %s = ((%s%s*)__outputs[%zu]);\n", struct_prefix,
-						 tpe, output_names[i], struct_prefix, tpe, i);
-				ATTEMPT_TO_WRITE_TO_FILE(f, buf);
-			}
-		}
-
-		ATTEMPT_TO_WRITE_TO_FILE(f, "\n");
-		// write the actual user defined code into the file
-		ATTEMPT_TO_WRITE_TO_FILE(f, exprStr);
-
-		ATTEMPT_TO_WRITE_TO_FILE(f, "\nreturn 0;\n}\n");
-
-		fclose(f);
-		f = NULL;
-
-		// now it's time to try to compile the code
-		// we use popen to capture any error output
-		snprintf(buf, sizeof(buf), "%s %s -c -fPIC %s %s -o %s 2>&1 >/dev/null",
-				 c_compiler, extra_cflags ? extra_cflags : "", compilation_flags, fname, oname);
-		GDKfree(fname);
-		fname = NULL;
-		compiler = popen(buf, "r");
-		if (!compiler) {
-			msg = createException(MAL, "cudf.eval", "Failed popen");
-			goto wrapup;
-		}
-		// read the error stream into the error buffer until the compiler is
-		// done
-		while (fgets(error_buf, sizeof(error_buf), compiler)) {
-			size_t error_size = strlen(error_buf);
-			snprintf(total_error_buf + error_buffer_position,
-					 sizeof(total_error_buf) - error_buffer_position, "%s",
-					 error_buf);
-			error_buffer_position += error_size;
-			if (error_buffer_position >= sizeof(total_error_buf)) break;
-		}
-
-		compiler_return_code = pclose(compiler);
-		compiler = NULL;
-
-		if (compiler_return_code != 0) {
-			// failure in compiling the code
-			// report the failure to the user
-			msg = createException(MAL, "cudf.eval",
-								  "Failed to compile C UDF:\n%s",
-								  total_error_buf);
-			goto wrapup;
-		}
-
-		error_buffer_position = 0;
-		error_buf[0] = '\0';
-
-		snprintf(buf, sizeof(buf), "%s %s %s -shared -o %s 2>&1 >/dev/null", c_compiler,
-			extra_ldflags ? extra_ldflags : "", oname, libname);
-		GDKfree(oname);
-		oname = NULL;
-		compiler = popen(buf, "r");
-		if (!compiler) {
-			msg = createException(MAL, "cudf.eval", "Failed popen");
-			goto wrapup;
-		}
-		while (fgets(error_buf, sizeof(error_buf), compiler)) {
-			size_t error_size = strlen(error_buf);
-			snprintf(total_error_buf + error_buffer_position,
-					 sizeof(total_error_buf) - error_buffer_position, "%s",
-					 error_buf);
-			error_buffer_position += error_size;
-			if (error_buffer_position >= sizeof(total_error_buf)) break;
-		}
-
-		compiler_return_code = pclose(compiler);
-		compiler = NULL;
-
-		if (compiler_return_code != 0) {
-			// failure in compiler
-			msg = createException(MAL, "cudf.eval", "Failed to link C UDF.\n%s",
-								  total_error_buf);
-			goto wrapup;
-		}
-
-		handle = dlopen(libname, RTLD_LAZY);
-		GDKfree(libname);
-		libname = NULL;
-		if (!handle) {
-			msg = createException(MAL, "cudf.eval",
-								  "Failed to open shared library: %s.",
-								  dlerror());
-			goto wrapup;
-		}
-		func = (jitted_function)dlsym(handle, funcname);
-		if (!func) {
-			msg = createException(MAL, "cudf.eval",
-								  "Failed to load function from library: %s.",
-								  dlerror());
-			goto wrapup;
-		}
 		// now that we have compiled this function
 		// store it in our function cache
 		{
@@ -1598,9 +1782,6 @@ static str CUDFeval(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci,
 wrapup:
 	// cleanup
 	// remove the signal handler, if any was set
-	GDKfree(fname);
-	GDKfree(oname);
-	GDKfree(libname);
 	MT_tls_set(capi_tls_key, NULL);
 	if (option_enable_mprotect) {
 		if (sa.sa_sigaction) {
@@ -1710,24 +1891,10 @@ wrapup:
 	if (function_parameters) {
 		GDKfree(function_parameters);
 	}
-	// close the file handle
-	if (f) {
-		fclose(f);
-	}
 	// close the dll
 	if (handle) {
 		dlclose(handle);
 	}
-	// close the compiler stream
-	if (compiler) {
-		pclose(compiler);
-	}
-	if (extra_cflags) {
-		GDKfree(extra_cflags);
-	}
-	if (extra_ldflags) {
-		GDKfree(extra_ldflags);
-	}
 	return msg;
 }
 
@@ -2011,7 +2178,12 @@ static mel_func capi_init_funcs[] = {
  pattern("capi", "eval", CUDFevalStd, false, "Execute a simple CUDF script value", args(1,5, varargany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str),varargany("arg",0))),
  pattern("capi", "subeval_aggr", CUDFevalAggr, false, "grouped aggregates through CUDF", args(1,5, varargany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str),varargany("arg",0))),
  pattern("capi", "eval_aggr", CUDFevalAggr, false, "grouped aggregates through CUDF", args(1,5, varargany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str),varargany("arg",0))),
+ pattern("capi", "prepare", CUDFprepare, true, "Compile a CUDF script when its function is created", args(0,1, arg("fptr",ptr))),
  pattern("batcapi", "eval", CUDFevalStd, false, "Execute a simple CUDF script value", args(1,5, varargany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str),varargany("arg",0))),
+ pattern("capimap", "eval", CUDFevalStd, false, "Execute a simple CUDF script returning a single value, safe to run in parallel", args(1,4, argany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str))),
+ pattern("capimap", "eval", CUDFevalStd, false, "Execute a simple CUDF script value, safe to run in parallel", args(1,5, varargany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str),varargany("arg",0))),
+ pattern("capimap", "prepare", CUDFprepare, true, "Compile a CUDF script when its function is created", args(0,1, arg("fptr",ptr))),
+ pattern("batcapimap", "eval", CUDFevalStd, false, "Execute a simple CUDF script value per partition", args(1,5, varargany("",0),arg("fptr",ptr),arg("cpp",bit),arg("expr",str),varargany("arg",0))),
  { .imp=NULL }
 };
 #include "mal_import.h"
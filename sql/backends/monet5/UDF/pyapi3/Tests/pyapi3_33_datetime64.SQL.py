@@ -0,0 +1,37 @@
+import os, tempfile
+
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+from MonetDBtesting.sqltest import SQLTestCase
+
+# With embedded_py_datetime64 temporal arguments arrive as datetime64 and
+# timedelta64 arrays, NULL becomes NaT.  The option is read at startup, so
+# this test needs a server of its own.
+
+with tempfile.TemporaryDirectory() as farm_dir:
+    os.mkdir(os.path.join(farm_dir, 'db1'))
+
+    with process.server(args=['--set', 'embedded_py=3', '--set', 'embedded_py_datetime64=true'],
+                        mapiport='0', dbname='db1', dbfarm=os.path.join(farm_dir, 'db1'),
+                        stdin=process.PIPE, stdout=process.PIPE, stderr=process.PIPE) as s:
+        with SQLTestCase() as mdb:
+            mdb.connect(database='db1', port=s.dbport, username="monetdb", password="monetdb")
+            mdb.execute("CREATE TABLE pyapi33 (d DATE, t TIME(6), ts TIMESTAMP);").assertSucceeded()
+            mdb.execute("INSERT INTO pyapi33 VALUES ('2020-02-29', '01:00:00.000001', '2020-02-29 01:02:03.5'), (NULL, NULL, NULL), ('1969-12-31', '23:59:59.999999', '1900-01-01 00:00:00');").assertSucceeded()
+            mdb.execute("""CREATE FUNCTION pyapi33_dtypes(d DATE, t TIME(6), ts TIMESTAMP) RETURNS STRING LANGUAGE PYTHON {
+	return ' '.join([str(d.dtype), str(t.dtype), str(ts.dtype)])
+};""").assertSucceeded()
+            mdb.execute("SELECT pyapi33_dtypes(d, t, ts) FROM pyapi33;").assertSucceeded().assertDataResultMatch([('datetime64[D] timedelta64[us] datetime64[us]',)])
+            mdb.execute("""CREATE FUNCTION pyapi33_args(d DATE, t TIME(6), ts TIMESTAMP) RETURNS TABLE(d DATE, t TIME(6), ts TIMESTAMP) LANGUAGE PYTHON {
+	return {'d': d + numpy.timedelta64(1, 'D'), 't': t - numpy.timedelta64(1, 'us'), 'ts': ts + numpy.timedelta64(1, 's')}
+};""").assertSucceeded()
+            mdb.execute("SELECT CAST(d AS STRING), CAST(t AS STRING), CAST(ts AS STRING) FROM pyapi33_args((SELECT d, t, ts FROM pyapi33));").assertSucceeded().assertDataResultMatch([
+                ('2020-03-01', '01:00:00.000000', '2020-02-29 01:02:04.500000'),
+                (None, None, None),
+                ('1970-01-01', '23:59:59.999998', '1900-01-01 00:00:01.000000')])
+            mdb.execute("DROP FUNCTION pyapi33_args;").assertSucceeded()
+            mdb.execute("DROP FUNCTION pyapi33_dtypes;").assertSucceeded()
+            mdb.execute("DROP TABLE pyapi33;").assertSucceeded()
+        s.communicate()
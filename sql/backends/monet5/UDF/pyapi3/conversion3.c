@@ -174,6 +174,72 @@ wrapup:
 	return NULL;
 }
 
+// With the embedded_py_datetime64 option set, date, time and timestamp
+// columns are passed as datetime64[D], timedelta64[us] and datetime64[us]
+// arrays (the Arrow date32/time64/timestamp layout, widened to 64 bits)
+// instead of arrays of Python datetime objects
+static bool numpy_datetime64 = false;
+static PyArray_Descr *date_descr = NULL;
+static PyArray_Descr *daytime_descr = NULL;
+static PyArray_Descr *timestamp_descr = NULL;
+
+static PyObject *
+PyTemporalArray_FromBAT(BAT *b, int type, size_t t_start, size_t t_end)
+{
+	npy_intp elements[1] = {t_end - t_start};
+	PyArray_Descr *descr;
+	PyObject *vararray;
+	npy_int64 *data;
+	BATiter bi;
+	size_t j;
+
+	switch (type) {
+		case TYPE_date:
+			descr = date_descr;
+			break;
+		case TYPE_daytime:
+			descr = daytime_descr;
+			break;
+		default:
+			descr = timestamp_descr;
+			break;
+	}
+	// PyArray_NewFromDescr steals the reference
+	Py_INCREF(descr);
+	vararray = PyArray_NewFromDescr(&PyArray_Type, descr, 1, elements, NULL, NULL, 0, NULL);
+	if (vararray == NULL)
+		return NULL;
+	data = (npy_int64 *)PyArray_DATA((PyArrayObject *)vararray);
+
+	// a single pass rebasing the values on the Unix epoch, no Python
+	// objects are created
+	bi = bat_iterator(b);
+	switch (type) {
+		case TYPE_date: {
+			const date *vals = (const date *)bi.base;
+			const date epoch = date_create(1970, 1, 1);
+			for (j = t_start; j < t_end; j++)
+				data[j - t_start] = is_date_nil(vals[j]) ? NPY_DATETIME_NAT : date_diff(vals[j], epoch);
+			break;
+		}
+		case TYPE_daytime: {
+			// a daytime already is the number of microseconds since midnight
+			const daytime *vals = (const daytime *)bi.base;
+			for (j = t_start; j < t_end; j++)
+				data[j - t_start] = is_daytime_nil(vals[j]) ? NPY_DATETIME_NAT : vals[j];
+			break;
+		}
+		default: {
+			const timestamp *vals = (const timestamp *)bi.base;
+			for (j = t_start; j < t_end; j++)
+				data[j - t_start] = is_timestamp_nil(vals[j]) ? NPY_DATETIME_NAT : timestamp_diff(vals[j], unixepoch);
+			break;
+		}
+	}
+	bat_iterator_end(&bi);
+	return vararray;
+}
+
 PyObject *
 PyArrayObject_FromBAT(PyInput *inp, size_t t_start, size_t t_end, char **return_message, bool copy)
 {
@@ -233,6 +299,10 @@ PyArrayObject_FromBAT(PyInput *inp, size_t t_start, size_t t_end, char **return_
 			}
 		}
 		bat_iterator_end(&li);
+	} else if (numpy_datetime64 &&
+			   (inp->bat_type == TYPE_date || inp->bat_type == TYPE_daytime ||
+				inp->bat_type == TYPE_timestamp)) {
+		vararray = PyTemporalArray_FromBAT(b, inp->bat_type, t_start, t_end);
 	} else {
 		switch (inp->bat_type) {
 			case TYPE_void:
@@ -806,6 +876,25 @@ PyObject_GetReturnValues(PyObject *obj, PyReturn *ret)
 			SQLSTATE(PY000) "Could not create a Numpy array from the return type.\n");
 		goto wrapup;
 	}
+	// datetime64 and timedelta64 arrays of any unit are brought to
+	// microseconds, so the conversion to a BAT only has to rebase the values
+	if (PyArray_TYPE((PyArrayObject *)ret->numpy_array) == NPY_DATETIME ||
+		PyArray_TYPE((PyArrayObject *)ret->numpy_array) == NPY_TIMEDELTA) {
+		PyArray_Descr *descr = PyArray_TYPE((PyArrayObject *)ret->numpy_array) == NPY_DATETIME ? timestamp_descr : daytime_descr;
+		PyObject *usec;
+
+		// PyArray_CastToType steals the reference
+		Py_INCREF(descr);
+		usec = PyArray_CastToType((PyArrayObject *)ret->numpy_array, descr, 0);
+		Py_DECREF(ret->numpy_array);
+		ret->numpy_array = usec;
+		if (ret->numpy_array == NULL) {
+			msg = createException(
+				MAL, "pyapi3.eval",
+				SQLSTATE(PY000) "Could not convert the returned datetime64 array to microseconds.\n");
+			goto wrapup;
+		}
+	}
 
 	ret->result_type = PyArray_DESCR((PyArrayObject *)ret->numpy_array)->type_num; // We read the result type from the resulting array
 	ret->memory_size = PyDataType_ELSIZE(PyArray_DESCR((PyArrayObject *)ret->numpy_array));
@@ -912,6 +1001,69 @@ wrapup:
 	return false;
 }
 
+// Convert a datetime64[us] or timedelta64[us] array (see
+// PyObject_GetReturnValues) to a date, daytime or timestamp BAT
+static BAT *
+PyTemporalArray_ConvertToBAT(PyReturn *ret, int bat_type, size_t index_offset, oid seqbase, char **return_message)
+{
+	const npy_int64 *data = (const npy_int64 *)ret->array_data + index_offset * ret->count;
+	const bool *mask = ret->mask_data ? ret->mask_data + index_offset * ret->count : NULL;
+	bool nils = false;
+	BAT *b;
+	size_t iu;
+
+	if (ret->multidimensional) {
+		*return_message = createException(MAL, "pyapi3.eval",
+										  SQLSTATE(PY000) "Multidimensional %s arrays are not supported, return a list of arrays instead.",
+										  PyType_Format(ret->result_type));
+		return NULL;
+	}
+	if ((ret->result_type == NPY_TIMEDELTA) != (bat_type == TYPE_daytime)) {
+		*return_message = createException(MAL, "pyapi3.eval",
+										  SQLSTATE(PY000) "Could not convert a %s array to %s.",
+										  PyType_Format(ret->result_type), BatType_Format(bat_type));
+		return NULL;
+	}
+	b = COLnew(seqbase, bat_type, (BUN)ret->count, TRANSIENT);
+	if (b == NULL) {
+		*return_message = createException(MAL, "pyapi3.eval", GDK_EXCEPTION);
+		return NULL;
+	}
+	switch (bat_type) {
+		case TYPE_date: {
+			date *vals = (date *)Tloc(b, 0);
+			for (iu = 0; iu < ret->count; iu++) {
+				vals[iu] = (mask && mask[iu]) || data[iu] == NPY_DATETIME_NAT ? date_nil : timestamp_date(timestamp_fromusec(data[iu]));
+				nils |= is_date_nil(vals[iu]);
+			}
+			break;
+		}
+		case TYPE_daytime: {
+			daytime *vals = (daytime *)Tloc(b, 0);
+			for (iu = 0; iu < ret->count; iu++) {
+				vals[iu] = (mask && mask[iu]) || data[iu] == NPY_DATETIME_NAT ? daytime_nil : daytime_add_usec(daytime_create(0, 0, 0, 0), data[iu]);
+				nils |= is_daytime_nil(vals[iu]);
+			}
+			break;
+		}
+		default: {
+			timestamp *vals = (timestamp *)Tloc(b, 0);
+			for (iu = 0; iu < ret->count; iu++) {
+				vals[iu] = (mask && mask[iu]) || data[iu] == NPY_DATETIME_NAT ? timestamp_nil : timestamp_fromusec(data[iu]);
+				nils |= is_timestamp_nil(vals[iu]);
+			}
+			break;
+		}
+	}
+	BATsetcount(b, (BUN)ret->count);
+	b->tnil = nils;
+	b->tnonil = !nils;
+	b->tkey = false;
+	b->tsorted = false;
+	b->trevsorted = false;
+	return b;
+}
+
 BAT *
 PyObject_ConvertToBAT(PyReturn *ret, sql_subtype *type, int bat_type, int i, oid seqbase, char **return_message, bool copy)
 {
@@ -1057,6 +1209,12 @@ PyObject_ConvertToBAT(PyReturn *ret, sql_subtype *type, int bat_type, int i, oid
 		}
 
 		BATsetcount(b, (BUN)ret->count);
+	} else if ((ret->result_type == NPY_DATETIME || ret->result_type == NPY_TIMEDELTA) &&
+			   (bat_type == TYPE_date || bat_type == TYPE_daytime ||
+				bat_type == TYPE_timestamp)) {
+		b = PyTemporalArray_ConvertToBAT(ret, bat_type, index_offset, seqbase, &msg);
+		if (b == NULL)
+			goto wrapup;
 	} else {
 		switch (bat_type) {
 			case TYPE_void:
@@ -1349,12 +1507,40 @@ bit IsStandardBATType(int type)
 	}
 }
 
-static void conversion_import_array(void) { _import_array(); }
+static int conversion_import_array(void) { return _import_array(); }
+
+static PyArray_Descr *conversion_descr(const char *spec)
+{
+	PyObject *str = PyUnicode_FromString(spec);
+	PyArray_Descr *descr = NULL;
+
+	if (str != NULL) {
+		if (!PyArray_DescrConverter(str, &descr))
+			descr = NULL;
+		Py_DECREF(str);
+	}
+	return descr;
+}
 
 str _conversion_init(void)
 {
 	str msg = MAL_SUCCEED;
-	conversion_import_array();
+
+	/* without NumPy the descriptors cannot be built */
+	if (conversion_import_array() < 0 || PyErr_Occurred()) {
+		PyErr_Clear();
+		return createException(MAL, "pyapi3.eval",
+							   SQLSTATE(PY000) "Failed to import the NumPy C API.");
+	}
+	date_descr = conversion_descr("M8[D]");
+	daytime_descr = conversion_descr("m8[us]");
+	timestamp_descr = conversion_descr("M8[us]");
+	if (date_descr == NULL || daytime_descr == NULL || timestamp_descr == NULL) {
+		PyErr_Clear();
+		msg = createException(MAL, "pyapi3.eval",
+							  SQLSTATE(PY000) "Failed to create the datetime64 types.");
+	}
+	numpy_datetime64 = GDKgetenv_istrue("embedded_py_datetime64");
 
 	return msg;
 }
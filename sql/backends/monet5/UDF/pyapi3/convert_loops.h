@@ -467,6 +467,8 @@ convert_and_append(BAT* b, const char* text, bool force) {
 					continue;                                                  \
 				obj = *((PyObject **)&data[(index_offset * ret->count + iu) *  \
 										   ret->memory_size]);                 \
+				if (PyUnicode_CheckExact(obj))                                 \
+					continue; /* appended from its own UTF-8 buffer */         \
 				size = pyobject_get_size(obj);                                 \
 				if (size > utf8_size)                                          \
 					utf8_size = size;                                          \
@@ -485,6 +487,24 @@ convert_and_append(BAT* b, const char* text, bool force) {
 											  SQLSTATE(PY000) "BUNappend failed.\n");          \
 						goto wrapup;                                           \
 					}                                                          \
+				} else if (PyUnicode_CheckExact(*((PyObject **)&data[          \
+							   (index_offset * ret->count + iu) *              \
+							   ret->memory_size]))) {                          \
+					/* str objects cache their UTF-8 encoding, append it       \
+					 * without copying it to the intermediate buffer */        \
+					const char *utf8 = PyUnicode_AsUTF8AndSize(*((PyObject **)&data[ \
+						(index_offset * ret->count + iu) * ret->memory_size]), NULL); \
+					if (utf8 == NULL) {                                        \
+						PyErr_Clear();                                         \
+						msg = createException(MAL, "pyapi3.eval",              \
+											  SQLSTATE(PY000) "Invalid string encoding used.\n"); \
+						goto wrapup;                                           \
+					}                                                          \
+					if (convert_and_append(b, utf8, false) != GDK_SUCCEED) {   \
+						msg = createException(MAL, "pyapi3.eval",              \
+											  SQLSTATE(PY000) "BUNappend failed.\n");          \
+						goto wrapup;                                           \
+					}                                                          \
 				} else {                                                       \
 					/* we try to handle as many types as possible */           \
 					msg = pyobject_to_str(								\
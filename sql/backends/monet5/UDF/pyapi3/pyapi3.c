@@ -916,6 +916,10 @@ static mel_func pyapi3_init_funcs[] = {
  pattern("batpyapi3", "eval_aggr", PYAPI3PyAPIevalAggr, true, "grouped aggregates through Python", args(1,4, varargany("",0),arg("fptr",ptr),arg("expr",str),varargany("arg",0))),
  pattern("batpyapi3", "eval_loader", PYAPI3PyAPIevalLoader, true, "loader functions through Python", args(1,3, varargany("",0),arg("fptr",ptr),arg("expr",str))),
  pattern("batpyapi3", "eval_loader", PYAPI3PyAPIevalLoader, true, "loader functions through Python", args(1,4, varargany("",0),arg("fptr",ptr),arg("expr",str),varargany("arg",0))),
+ pattern("pyapi3map", "eval", PYAPI3PyAPIevalStd, false, "Execute a simple Python script returning a single value, safe to run in parallel", args(1,3, argany("",1),arg("fptr",ptr),arg("expr",str))),
+ pattern("pyapi3map", "eval", PYAPI3PyAPIevalStd, false, "Execute a simple Python script value, safe to run in parallel", args(1,4, varargany("",0),arg("fptr",ptr),arg("expr",str),varargany("arg",0))),
+ pattern("batpyapi3map", "eval", PYAPI3PyAPIevalStd, false, "Execute a simple Python script value per partition", args(1,4, batvarargany("",0),arg("fptr", ptr), arg("expr",str),varargany("arg",0))),
+ pattern("batpyapi3map", "eval", PYAPI3PyAPIevalStd, false, "Execute a simple Python script value per partition", args(1,4, batargany("",1),arg("card", lng), arg("fptr",ptr),arg("expr",str))),
  pattern("pyapi3", "prelude", PyAPI3prelude, false, "", noargs),
  command("pyapi3", "epilogue", PyAPI3epilogue, false, "", noargs),
  { .imp=NULL }
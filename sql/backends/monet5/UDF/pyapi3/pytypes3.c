@@ -139,6 +139,10 @@ char *BatType_Format(int type)
 			return "OID";
 		case TYPE_date:
 			return "DATE";
+		case TYPE_daytime:
+			return "TIME";
+		case TYPE_timestamp:
+			return "TIMESTAMP";
 #ifdef HAVE_HGE
 		case TYPE_hge:
 			return "HUGEINT";
@@ -293,7 +297,8 @@ bool PyType_IsPyScalar(PyObject *object)
 			PyFloat_Check(object) || PyUnicode_Check(object) ||
 			PyBool_Check(object) || PyByteArray_Check(object) ||
 			PyBytes_Check(object) || PyDate_Check(object) ||
-			PyTime_Check(object) || PyDateTime_Check(object));
+			PyTime_Check(object) || PyDateTime_Check(object) ||
+			PyDelta_Check(object));
 }
 
 void _pytypes_init(void) { _import_array(); }
@@ -250,48 +250,12 @@ DICTcompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 }
 
 str
-DICTcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+DICTcompress_column(sql_trans *tr, sql_column *c, bool ordered)
 {
-	(void)mb;
-	/* always assume one result */
 	str msg = MAL_SUCCEED;
-	const char *sname = *getArgReference_str(stk, pci, 1);
-	const char *tname = *getArgReference_str(stk, pci, 2);
-	const char *cname = *getArgReference_str(stk, pci, 3);
-	const bit ordered = (pci->argc > 4)?*getArgReference_bit(stk, pci, 4):FALSE;
-	backend *be = NULL;
-	sql_trans *tr = NULL;
-
-	if (!sname || !tname || !cname)
-		throw(SQL, "dict.compress", SQLSTATE(3F000) "dict compress: invalid column name");
-	if (strNil(sname))
-		throw(SQL, "dict.compress", SQLSTATE(42000) "Schema name cannot be NULL");
-	if (strNil(tname))
-		throw(SQL, "dict.compress", SQLSTATE(42000) "Table name cannot be NULL");
-	if (strNil(cname))
-		throw(SQL, "dict.compress", SQLSTATE(42000) "Column name cannot be NULL");
-	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
-		return msg;
-	tr = be->mvc->session->tr;
 
-	sql_schema *s = find_sql_schema(tr, sname);
-	if (!s)
-		throw(SQL, "dict.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
-	sql_table *t = find_sql_table(tr, s, tname);
-	if (!t)
-		throw(SQL, "dict.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
-	if (!isTable(t))
-		throw(SQL, "dict.compress", SQLSTATE(42000) "%s '%s' is not persistent",
-			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
-	if (isTempTable(t))
-		throw(SQL, "dict.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
-	if (t->system)
-		throw(SQL, "dict.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
-	sql_column *c = find_sql_column(t, cname);
-	if (!c)
-		throw(SQL, "dict.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
 	if (c->storage_type)
-		throw(SQL, "dict.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", sname, tname, cname);
+		throw(SQL, "dict.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", c->t->s->base.name, c->t->base.name, c->base.name);
 
 	sqlstore *store = tr->store;
 	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o, *u;
@@ -333,6 +297,50 @@ DICTcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return msg;
 }
 
+str
+DICTcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)mb;
+	/* always assume one result */
+	str msg = MAL_SUCCEED;
+	const char *sname = *getArgReference_str(stk, pci, 1);
+	const char *tname = *getArgReference_str(stk, pci, 2);
+	const char *cname = *getArgReference_str(stk, pci, 3);
+	const bit ordered = (pci->argc > 4)?*getArgReference_bit(stk, pci, 4):FALSE;
+	backend *be = NULL;
+	sql_trans *tr = NULL;
+
+	if (!sname || !tname || !cname)
+		throw(SQL, "dict.compress", SQLSTATE(3F000) "dict compress: invalid column name");
+	if (strNil(sname))
+		throw(SQL, "dict.compress", SQLSTATE(42000) "Schema name cannot be NULL");
+	if (strNil(tname))
+		throw(SQL, "dict.compress", SQLSTATE(42000) "Table name cannot be NULL");
+	if (strNil(cname))
+		throw(SQL, "dict.compress", SQLSTATE(42000) "Column name cannot be NULL");
+	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
+		return msg;
+	tr = be->mvc->session->tr;
+
+	sql_schema *s = find_sql_schema(tr, sname);
+	if (!s)
+		throw(SQL, "dict.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
+	sql_table *t = find_sql_table(tr, s, tname);
+	if (!t)
+		throw(SQL, "dict.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
+	if (!isTable(t))
+		throw(SQL, "dict.compress", SQLSTATE(42000) "%s '%s' is not persistent",
+			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (isTempTable(t))
+		throw(SQL, "dict.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
+	if (t->system)
+		throw(SQL, "dict.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
+	sql_column *c = find_sql_column(t, cname);
+	if (!c)
+		throw(SQL, "dict.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
+	return DICTcompress_column(tr, c, ordered);
+}
+
 #define decompress_loop(TPE) \
 	do { \
 		TPE *up = Tloc(u, 0); \
@@ -586,9 +594,12 @@ DICTrenumber_intern( BAT *o, BAT *lc, BAT *rc, BUN offcnt)
 	BUN cnt = oi.count;
 
 	if (!lc->tsorted) {
-		BAT *nlc = NULL, *nrc = NULL;
-		int ret = BATsort(&nlc, &nrc, NULL, lc, NULL, NULL, false, false, false);
+		BAT *nlc = NULL, *ord = NULL, *nrc = NULL;
+		int ret = BATsort(&nlc, &ord, NULL, lc, NULL, NULL, false, false, false);
 
+		if (ret == GDK_SUCCEED)
+			nrc = BATproject(ord, rc);
+		bat_destroy(ord);
 		if (ret != GDK_SUCCEED || !nlc || !nrc) {
 			bat_iterator_end(&oi);
 			bat_destroy(nlc);
@@ -612,11 +623,12 @@ DICTrenumber_intern( BAT *o, BAT *lc, BAT *rc, BUN offcnt)
 
 		/* create map with holes filled in */
 		oid *restrict op = Tloc(nrc, 0);
-		unsigned char *lp = Tloc(lc, 0);
+		const oid *lp = Tloc(lc, 0);
+		BUN lcnt = BATcount(lc);
 		if (BATtvoid(rc)) {
 			oid seq = rc->tseqbase, j = 0;
 			for(BUN i = 0; i<offcnt; i++) {
-				if (lp[j] > i) {
+				if (j >= lcnt || lp[j] > i) {
 					op[i] = offcnt;
 				} else {
 					op[i] = seq + j;
@@ -626,7 +638,7 @@ DICTrenumber_intern( BAT *o, BAT *lc, BAT *rc, BUN offcnt)
 		} else {
 			oid *ip = Tloc(rc, 0);
 			for(BUN i = 0, j = 0; i<offcnt; i++) {
-				if (lp[j] > i) {
+				if (j >= lcnt || lp[j] > i) {
 					op[i] = offcnt;
 				} else {
 					op[i] = ip[j++];
@@ -639,6 +651,18 @@ DICTrenumber_intern( BAT *o, BAT *lc, BAT *rc, BUN offcnt)
 		if (orc != rc)
 			bat_destroy(rc);
 		rc = nrc;
+	} else if (BATtvoid(rc)) {
+		/* the map is looked up by position */
+		BAT *nrc = COLcopy(rc, TYPE_oid, true, TRANSIENT);
+		if (orc != rc)
+			bat_destroy(rc);
+		rc = nrc;
+		if (!rc) {
+			bat_iterator_end(&oi);
+			if (lc != olc)
+				bat_destroy(lc);
+			return no;
+		}
 	}
 
 	no = COLnew(o->hseqbase, oi.type, cnt, TRANSIENT);
@@ -675,7 +699,7 @@ DICTrenumber_intern( BAT *o, BAT *lc, BAT *rc, BUN offcnt)
 	} else if (oi.type == TYPE_int) {
 		int *op = Tloc(no, 0);
 		oid *c = Tloc(rc, 0);
-		unsigned short *ip = (unsigned short *) oi.base;
+		unsigned int *ip = (unsigned int *) oi.base;
 
 		for(BUN i = 0; i<cnt; i++) {
 			op[i] = (int) ((BUN)ip[i]==offcnt?offcnt:c[ip[i]]);
@@ -1059,7 +1083,7 @@ DICTenlarge(BAT *offsets, BUN cnt, BUN sz, int type, role_t role)
 		n = COLnew(offsets->hseqbase, TYPE_int, sz, role);
 		if (!n)
 			return NULL;
-		if (offsets->ttype == TYPE_sht) {
+		if (offsets->ttype == TYPE_bte) {
 			unsigned char *o = Tloc(offsets, 0);
 			unsigned int *no = Tloc(n, 0);
 			for(BUN i = 0; i<cnt; i++) {
@@ -1170,6 +1194,208 @@ DICTrenumber(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return MAL_SUCCEED;
 }
 
+/* renumber the offsets o of dictionary v into the offsets of dictionary nv,
+ * which should hold all values of v, using an offset type tt */
+static BAT *
+DICTmerge_offsets(BAT *o, BAT *v, BAT *nv, int tt)
+{
+	BAT *m0 = NULL, *m1 = NULL, *e = o, *n = NULL;
+
+	if (BATjoin(&m0, &m1, v, nv, NULL, NULL, true, BATcount(v)) != GDK_SUCCEED)
+		return NULL;
+	if (o->ttype != tt) {
+		if ((e = DICTenlarge(o, BATcount(o), BATcount(o), tt, TRANSIENT)) == NULL) {
+			bat_destroy(m0);
+			bat_destroy(m1);
+			return NULL;
+		}
+		BATsetcount(e, BATcount(o));
+	}
+	n = DICTrenumber_intern(e, m0, m1, BATcount(v));
+	if (e != o)
+		bat_destroy(e);
+	bat_destroy(m0);
+	bat_destroy(m1);
+	return n;
+}
+
+/* merge dictionary compressed (sub)columns into one with a new (sorted)
+ * dictionary, ie the union of the columns stays compressed.  All inputs
+ * are merged at once, the offsets of each input are renumbered only once
+ * (o, v) = dict.merge(o1, v1, o2, v2, ...) */
+str
+DICTmerge(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	bat *RO = getArgReference_bat(stk, pci, 0);
+	bat *RV = getArgReference_bat(stk, pci, 1);
+	int tt = getBatType(getArgType(mb, pci, 0));
+	int n = (pci->argc - pci->retc) / 2;
+	BAT **ov = NULL, *a = NULL, *u = NULL, *uv = NULL, *nv = NULL, *no = NULL, *nr = NULL;
+	BUN cnt = 0;
+	str msg = MAL_SUCCEED;
+
+	if (n < 2 || (pci->argc - pci->retc) % 2 != 0)
+		throw(SQL, "dict.merge", ILLEGAL_ARGUMENT);
+	assert(tt == TYPE_bte || tt == TYPE_sht || tt == TYPE_int);
+	if ((ov = GDKzalloc(sizeof(BAT *) * 2 * n)) == NULL)
+		throw(SQL, "dict.merge", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	for (int i = 0; i < 2 * n; i++) {
+		if ((ov[i] = BATdescriptor(*getArgReference_bat(stk, pci, pci->retc + i))) == NULL) {
+			msg = createException(SQL, "dict.merge", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+			goto bailout;
+		}
+		if (i % 2 == 0)
+			cnt += BATcount(ov[i]);
+	}
+
+	/* the new dictionary holds the distinct values of all inputs, sorted */
+	if ((a = COLcopy(ov[1], ov[1]->ttype, true, TRANSIENT)) == NULL) {
+		msg = createException(SQL, "dict.merge", GDK_EXCEPTION);
+		goto bailout;
+	}
+	for (int i = 1; i < n; i++) {
+		if (BATappend(a, ov[2 * i + 1], NULL, false) != GDK_SUCCEED) {
+			msg = createException(SQL, "dict.merge", GDK_EXCEPTION);
+			goto bailout;
+		}
+	}
+	if ((u = BATunique(a, NULL)) == NULL ||
+		(uv = BATproject(u, a)) == NULL ||
+		BATsort(&nv, NULL, NULL, uv, NULL, NULL, false, false, false) != GDK_SUCCEED) {
+		msg = createException(SQL, "dict.merge", GDK_EXCEPTION);
+		goto bailout;
+	}
+	nv->tkey = true;
+	if ((tt == TYPE_bte && BATcount(nv) > 256) || (tt == TYPE_sht && BATcount(nv) > 65536)) {
+		msg = createException(SQL, "dict.merge", SQLSTATE(3F000) "dict merge: too many values");
+		goto bailout;
+	}
+	if ((no = COLnew(0, tt, cnt, TRANSIENT)) == NULL) {
+		msg = createException(SQL, "dict.merge", GDK_EXCEPTION);
+		goto bailout;
+	}
+	for (int i = 0; i < n; i++) {
+		if ((nr = DICTmerge_offsets(ov[2 * i], ov[2 * i + 1], nv, tt)) == NULL ||
+			BATappend(no, nr, NULL, false) != GDK_SUCCEED) {
+			msg = createException(SQL, "dict.merge", GDK_EXCEPTION);
+			goto bailout;
+		}
+		bat_destroy(nr);
+		nr = NULL;
+	}
+	BATnegateprops(no);
+	*RO = no->batCacheid;
+	BBPkeepref(no);
+	no = NULL;
+	*RV = nv->batCacheid;
+	BBPkeepref(nv);
+	nv = NULL;
+  bailout:
+	bat_destroy(a);
+	bat_destroy(u);
+	bat_destroy(uv);
+	bat_destroy(nv);
+	bat_destroy(no);
+	bat_destroy(nr);
+	for (int i = 0; i < 2 * n; i++)
+		bat_destroy(ov[i]);
+	GDKfree(ov);
+	return msg;
+}
+
+#define SORTKEY(OT, RT)												\
+	do {															\
+		const OT *restrict ip = (const OT *) oi.base;				\
+		RT *restrict rp = Tloc(r, 0);								\
+		for (BUN i = 0; i < oi.count; i++) {						\
+			int k = rank[ip[i]];									\
+			if (is_int_nil(k)) {									\
+				rp[i] = RT##_nil;									\
+				havenil = true;										\
+			} else {												\
+				rp[i] = (RT) k;										\
+			}														\
+		}															\
+	} while (0)
+
+/* order preserving codes for a dictionary compressed (sub)column: the rank
+ * of the value in the sorted dictionary, nil stays nil.  The codes are of a
+ * wider type than the offsets, hence they compare correctly as signed
+ * values and sorting on them orders the column without decompressing it
+ * r = dict.sortkey(o, v) */
+str
+DICTsortkey(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	bat *R = getArgReference_bat(stk, pci, 0);
+	bat O = *getArgReference_bat(stk, pci, 1);
+	bat V = *getArgReference_bat(stk, pci, 2);
+	int tt = getBatType(getArgType(mb, pci, 0));
+	BAT *s = NULL, *ord = NULL, *grp = NULL, *r = NULL;
+	int *rank = NULL;
+	bool havenil = false;
+
+	BAT *o = BATdescriptor(O);
+	BAT *v = BATdescriptor(V);
+	if (!o || !v) {
+		bat_destroy(o);
+		bat_destroy(v);
+		throw(SQL, "dict.sortkey", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	assert(tt == TYPE_sht || tt == TYPE_int);
+	BUN vcnt = BATcount(v);
+	if (BATsort(&s, &ord, &grp, v, NULL, NULL, false, false, false) != GDK_SUCCEED) {
+		bat_destroy(o);
+		bat_destroy(v);
+		throw(SQL, "dict.sortkey", GDK_EXCEPTION);
+	}
+	if ((rank = GDKmalloc(sizeof(int) * (vcnt + 1))) == NULL ||
+		(r = COLnew(o->hseqbase, tt, BATcount(o), TRANSIENT)) == NULL) {
+		GDKfree(rank);
+		bat_destroy(s);
+		bat_destroy(ord);
+		bat_destroy(grp);
+		bat_destroy(o);
+		bat_destroy(v);
+		throw(SQL, "dict.sortkey", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	/* equal values get the same rank (the group id in sorted order) */
+	BATiter si = bat_iterator(s);
+	const void *nil = ATOMnilptr(si.type);
+	int (*cmp)(const void *, const void *) = ATOMcompare(si.type);
+	/* the extra entry only keeps the allocation non-empty */
+	rank[vcnt] = int_nil;
+	for (BUN i = 0; i < vcnt; i++) {
+		oid p = BUNtoid(ord, i) - v->hseqbase;
+		rank[p] = cmp(BUNtail(si, i), nil) == 0 ? int_nil : (int) BUNtoid(grp, i);
+	}
+	bat_iterator_end(&si);
+	bat_destroy(s);
+	bat_destroy(ord);
+	bat_destroy(grp);
+
+	BATiter oi = bat_iterator(o);
+	if (oi.type == TYPE_bte) {
+		SORTKEY(unsigned char, sht);
+	} else if (oi.type == TYPE_sht) {
+		SORTKEY(unsigned short, int);
+	} else {
+		SORTKEY(unsigned int, int);
+	}
+	BATsetcount(r, oi.count);
+	bat_iterator_end(&oi);
+	GDKfree(rank);
+	BATnegateprops(r);
+	r->tnil = havenil;
+	r->tnonil = !havenil;
+	bat_destroy(o);
+	bat_destroy(v);
+	*R = r->batCacheid;
+	BBPkeepref(r);
+	return MAL_SUCCEED;
+}
+
 /* for each val in vals compute its offset in dict (return via noffsets),
  * any missing value in dict will be added to the dict.
  * Possible side-effects:
@@ -27,5 +27,9 @@ extern str DICTjoin(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str DICTthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str DICTselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str DICTrenumber(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DICTmerge(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str DICTsortkey(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+extern str DICTcompress_column(sql_trans *tr, sql_column *c, bool ordered);
 
 #endif /* _DICT_H */
@@ -199,49 +199,14 @@ FORcompress_intern(char **comp_min_val, BAT **r, BAT *b)
 }
 
 str
-FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+FORcompress_column(sql_trans *tr, sql_column *c)
 {
-	(void)mb;
-	/* always assume one result */
 	str msg = MAL_SUCCEED;
-	const char *sname = *getArgReference_str(stk, pci, 1);
-	const char *tname = *getArgReference_str(stk, pci, 2);
-	const char *cname = *getArgReference_str(stk, pci, 3);
-	backend *be = NULL;
-	sql_trans *tr = NULL;
 
-	if (!sname || !tname || !cname)
-		throw(SQL, "for.compress", SQLSTATE(3F000) "for compress: invalid column name");
-	if (strNil(sname))
-		throw(SQL, "for.compress", SQLSTATE(42000) "Schema name cannot be NULL");
-	if (strNil(tname))
-		throw(SQL, "for.compress", SQLSTATE(42000) "Table name cannot be NULL");
-	if (strNil(cname))
-		throw(SQL, "for.compress", SQLSTATE(42000) "Column name cannot be NULL");
-	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
-		return msg;
-	tr = be->mvc->session->tr;
-
-	sql_schema *s = find_sql_schema(tr, sname);
-	if (!s)
-		throw(SQL, "for.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
-	sql_table *t = find_sql_table(tr, s, tname);
-	if (!t)
-		throw(SQL, "for.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
-	if (!isTable(t))
-		throw(SQL, "for.compress", SQLSTATE(42000) "%s '%s' is not persistent",
-			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
-	if (isTempTable(t))
-		throw(SQL, "for.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
-	if (t->system)
-		throw(SQL, "for.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
-	sql_column *c = find_sql_column(t, cname);
-	if (!c)
-		throw(SQL, "for.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
 	if (c->null)
 		throw(SQL, "for.compress", SQLSTATE(3F000) "for compress: for 'for' compression column's cannot have NULL's");
 	if (c->storage_type)
-		throw(SQL, "for.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", sname, tname, cname);
+		throw(SQL, "for.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", c->t->s->base.name, c->t->base.name, c->base.name);
 
 	sqlstore *store = tr->store;
 	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *o = NULL;
@@ -284,6 +249,230 @@ FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return msg;
 }
 
+str
+FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)mb;
+	/* always assume one result */
+	str msg = MAL_SUCCEED;
+	const char *sname = *getArgReference_str(stk, pci, 1);
+	const char *tname = *getArgReference_str(stk, pci, 2);
+	const char *cname = *getArgReference_str(stk, pci, 3);
+	backend *be = NULL;
+	sql_trans *tr = NULL;
+
+	if (!sname || !tname || !cname)
+		throw(SQL, "for.compress", SQLSTATE(3F000) "for compress: invalid column name");
+	if (strNil(sname))
+		throw(SQL, "for.compress", SQLSTATE(42000) "Schema name cannot be NULL");
+	if (strNil(tname))
+		throw(SQL, "for.compress", SQLSTATE(42000) "Table name cannot be NULL");
+	if (strNil(cname))
+		throw(SQL, "for.compress", SQLSTATE(42000) "Column name cannot be NULL");
+	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
+		return msg;
+	tr = be->mvc->session->tr;
+
+	sql_schema *s = find_sql_schema(tr, sname);
+	if (!s)
+		throw(SQL, "for.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
+	sql_table *t = find_sql_table(tr, s, tname);
+	if (!t)
+		throw(SQL, "for.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
+	if (!isTable(t))
+		throw(SQL, "for.compress", SQLSTATE(42000) "%s '%s' is not persistent",
+			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (isTempTable(t))
+		throw(SQL, "for.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
+	if (t->system)
+		throw(SQL, "for.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
+	sql_column *c = find_sql_column(t, cname);
+	if (!c)
+		throw(SQL, "for.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
+	return FORcompress_column(tr, c);
+}
+
+/* Select on the offsets of a for compressed column.  The bounds are
+ * translated into the offset domain; bounds outside of the range of
+ * the offsets are either dropped (they exclude nothing) or turn the
+ * selection into an empty (or, with anti, a full) one. */
+static BAT *
+FORselect_(BAT *lo, BAT *lc, lng minval, lng l, lng h, bool li, bool hi, bool anti)
+{
+	lng maxoff = lo->ttype == TYPE_bte ? GDK_bte_max : GDK_sht_max;
+	bool lnil = is_lng_nil(l), hnil = is_lng_nil(h);
+	bte bl, bh;
+	sht sl, sh;
+	const void *lp, *hp;
+
+	if (!lnil || !hnil) {
+		/* the offsets are in the range [0, maxoff] */
+		bool lout = !lnil && l > minval && (ulng) l - (ulng) minval > (ulng) maxoff;
+		bool hout = !hnil && h < minval;
+		bool lfree = lnil || l < minval;
+		bool hfree = hnil || (h > minval && (ulng) h - (ulng) minval > (ulng) maxoff);
+
+		if (lout || hout) {
+			if (!anti)
+				return BATdense(0, 0, 0);
+			lnil = hnil = true;
+			li = hi = anti = false;
+		} else if (lfree && hfree) {
+			if (anti)
+				return BATdense(0, 0, 0);
+			lnil = hnil = true;
+			li = hi = false;
+		} else {
+			if (lfree) {
+				lnil = true;
+				li = false;
+			} else {
+				l -= minval;
+			}
+			if (hfree) {
+				hnil = true;
+				hi = false;
+			} else {
+				h -= minval;
+			}
+		}
+	}
+	if (lo->ttype == TYPE_bte) {
+		bl = lnil ? bte_nil : (bte) l;
+		bh = hnil ? bte_nil : (bte) h;
+		lp = &bl;
+		hp = &bh;
+	} else {
+		sl = lnil ? sht_nil : (sht) l;
+		sh = hnil ? sht_nil : (sht) h;
+		lp = &sl;
+		hp = &sh;
+	}
+	return BATselect(lo, lc, lp, hp, li, hi, anti, false);
+}
+
+str
+FORselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *R0 = getArgReference_bat(stk, pci, 0);
+	bat LO = *getArgReference_bat(stk, pci, 1);
+	bat LC = *getArgReference_bat(stk, pci, 2);
+	lng minval = *getArgReference_lng(stk, pci, 3);
+	lng l = *getArgReference_lng(stk, pci, 4);
+	lng h = *getArgReference_lng(stk, pci, 5);
+	bit li = *getArgReference_bit(stk, pci, 6);
+	bit hi = *getArgReference_bit(stk, pci, 7);
+	bit anti = *getArgReference_bit(stk, pci, 8);
+	bit unknown = *getArgReference_bit(stk, pci, 9);
+	bool none = false;
+
+	if ((li != 0 && li != 1) ||
+		(hi != 0 && hi != 1) ||
+		(anti != 0 && anti != 1)) {
+		throw(MAL, "for.select", ILLEGAL_ARGUMENT);
+	}
+
+	BAT *lc = NULL, *bn = NULL;
+	BAT *lo = BATdescriptor(LO);
+	if (!is_bat_nil(LC))
+		lc = BATdescriptor(LC);
+	if (!lo || (!is_bat_nil(LC) && !lc)) {
+		bat_destroy(lo);
+		bat_destroy(lc);
+		throw(SQL, "for.select", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	if (lo->ttype != TYPE_bte && lo->ttype != TYPE_sht) {
+		bat_destroy(lo);
+		bat_destroy(lc);
+		throw(SQL, "for.select", SQLSTATE(3F000) "for select: invalid type");
+	}
+
+	/* same nil handling as algebra.select */
+	if (!anti && unknown) {
+		if (li && is_lng_nil(l)) {
+			l = h;
+			li = 0;
+		}
+		if (hi && is_lng_nil(h)) {
+			h = l;
+			hi = 0;
+		}
+		if (l == h && is_lng_nil(h)) /* ugh sql nil != nil */
+			anti = 1;
+	} else if (!unknown && li && hi && is_lng_nil(l) && is_lng_nil(h)) {
+		/* equi-select for NIL, there are no nils in a for
+		 * compressed column */
+		none = !anti;
+		li = hi = anti = 0;
+	}
+	bn = none ? BATdense(0, 0, 0) : FORselect_(lo, lc, minval, l, h, li, hi, anti);
+	bat_destroy(lo);
+	bat_destroy(lc);
+	if (!bn)
+		throw(SQL, "for.select", GDK_EXCEPTION);
+	*R0 = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+str
+FORthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *R0 = getArgReference_bat(stk, pci, 0);
+	bat LO = *getArgReference_bat(stk, pci, 1);
+	bat LC = *getArgReference_bat(stk, pci, 2);
+	lng minval = *getArgReference_lng(stk, pci, 3);
+	lng v = *getArgReference_lng(stk, pci, 4);
+	const char *op = *getArgReference_str(stk, pci, 5);
+	lng l = lng_nil, h = lng_nil;
+	bool li = false, hi = false, anti = false;
+
+	if (op[0] == '=' || (op[0] == '!' && op[1] == '=')) {
+		l = h = v;
+		li = hi = true;
+		anti = op[0] == '!';
+	} else if (op[0] == '<') {
+		h = v;
+		hi = op[1] == '=';
+	} else if (op[0] == '>') {
+		l = v;
+		li = op[1] == '=';
+	} else {
+		throw(MAL, "for.thetaselect", ILLEGAL_ARGUMENT);
+	}
+
+	BAT *lc = NULL, *bn = NULL;
+	BAT *lo = BATdescriptor(LO);
+	if (!is_bat_nil(LC))
+		lc = BATdescriptor(LC);
+	if (!lo || (!is_bat_nil(LC) && !lc)) {
+		bat_destroy(lo);
+		bat_destroy(lc);
+		throw(SQL, "for.thetaselect", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	if (lo->ttype != TYPE_bte && lo->ttype != TYPE_sht) {
+		bat_destroy(lo);
+		bat_destroy(lc);
+		throw(SQL, "for.thetaselect", SQLSTATE(3F000) "for thetaselect: invalid type");
+	}
+
+	if (is_lng_nil(v)) /* corner case, if v is NULL nothing matches */
+		bn = BATdense(0, 0, 0);
+	else
+		bn = FORselect_(lo, lc, minval, l, h, li, hi, anti);
+	bat_destroy(lo);
+	bat_destroy(lc);
+	if (!bn)
+		throw(SQL, "for.thetaselect", GDK_EXCEPTION);
+	*R0 = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
 int
 FORprepare4append(BAT **noffsets, BAT *b, lng minval, int tt)
 {
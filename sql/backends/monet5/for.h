@@ -18,5 +18,9 @@
 //extern BAT *FORdecompress_(BAT *o, lng minval, int type, role_t role);
 extern str FORcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str FORdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str FORselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str FORthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+extern str FORcompress_column(sql_trans *tr, sql_column *c);
 
 #endif /* _FOR_H */
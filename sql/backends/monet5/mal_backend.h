@@ -60,9 +60,14 @@ typedef struct backend {
 		 console:1,
 		 silent:1; /* on some occasions we don't want to output the result set or the number of affected rows */
 	cq 	*q;		/* pointer to the cached query */
+	qp	*plan;	/* pinned shared plan of the current query */
 
 	int result_id;
 	res_table *results;
+	stream *export;		/* channel of a pipelined COPY INTO export */
+	int export_id;		/* and its result table */
+	bool export_onclient;
+	char *export_file;	/* file on the server, removed if the export fails */
 	lng last_id;
 	lng rowcnt;
 	subbackend *subbackend;
@@ -1983,7 +1983,13 @@ stmt_col(backend *be, sql_column *c, stmt *del, int part)
 {
 	stmt *sc = stmt_bat(be, c, RDONLY, part);
 
-	if (isTable(c->t) && c->t->access != TABLE_READONLY &&
+	if (c->storage_type && c->storage_type[0] == 'R') {
+		/* run length encoded columns are expanded on change, hence
+		 * have no pending updates */
+		sc = stmt_rle(be, sc, stmt_bat(be, c, RD_EXT, part));
+		if (del)
+			sc = stmt_project(be, del, sc);
+	} else if (isTable(c->t) && c->t->access != TABLE_READONLY &&
 	   (!isNew(c) || !isNew(c->t) /* alter */) &&
 	   (c->t->persistence == SQL_PERSIST || c->t->s) /*&& !c->t->commit_action*/) {
 		stmt *u = stmt_bat(be, c, RD_UPD_ID, part);
@@ -4582,7 +4588,10 @@ rel2bin_select(backend *be, sql_rel *rel, list *refs)
 			assert(sql->session->status == -10); /* Stack overflow errors shouldn't terminate the server */
 			return NULL;
 		}
-		if (s->nrcols == 0){
+		if (s->nrcols == 0 && sel && find_prop(e->p, PROP_GUARD)) {
+			/* a partition guard keeps all candidates or none */
+			sel = stmt_guard(be, sel, s);
+		} else if (s->nrcols == 0){
 			if (!predicate && sub && !list_empty(sub->op4.lval))
 				predicate = stmt_const(be, bin_find_smallest_column(be, sub), stmt_bool(be, 1));
 			else if (!predicate)
@@ -0,0 +1,488 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+/*
+ * Run length encoded columns.  A compressed column is stored as a
+ * bounds bat, holding the first row of each run followed by the end of
+ * the last run, and a values bat with the value of each run (see
+ * gdk_rle.c).  The rle optimizer keeps the pair of bats together in the
+ * plan and calls the operators below, which work on the runs.
+ */
+#include "monetdb_config.h"
+#include "sql.h"
+#include "mal.h"
+#include "mal_client.h"
+
+#include "rle.h"
+
+static sql_column *
+get_newcolumn(sql_trans *tr, sql_column *c)
+{
+	sql_table *t = find_sql_table_id(tr, c->t->s, c->t->base.id);
+	if (t)
+		return find_sql_column(t, c->base.name);
+	return NULL;
+}
+
+str
+RLEcompress_column(sql_trans *tr, sql_column *c)
+{
+	str msg = MAL_SUCCEED;
+
+	if (c->storage_type)
+		throw(SQL, "rle.compress", SQLSTATE(3F000) "column '%s.%s.%s' already compressed", c->t->s->base.name, c->t->base.name, c->base.name);
+	/* runs are not appended to, the table must not take inserts */
+	if (c->t->access != TABLE_READONLY)
+		throw(SQL, "rle.compress", SQLSTATE(42000) "column '%s.%s.%s' is not in a read only table", c->t->s->base.name, c->t->base.name, c->base.name);
+
+	sqlstore *store = tr->store;
+	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *ui = NULL, *uv = NULL, *o, *u;
+	if (b == NULL)
+		throw(SQL, "rle.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+	if (store->storage_api.bind_updates(tr, c, &ui, &uv) != LOG_OK) {
+		bat_destroy(b);
+		throw(SQL, "rle.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+	}
+	if (BATcount(ui)) {
+		/* the runs are made of the column with its pending updates */
+		BAT *n = COLcopy(b, b->ttype, true, TRANSIENT);
+		if (n && BATreplace(n, ui, uv, true) != GDK_SUCCEED)
+			BBPreclaim(n);
+		bat_destroy(b);
+		b = n;
+	}
+	bat_destroy(ui);
+	bat_destroy(uv);
+	if (b == NULL)
+		throw(SQL, "rle.compress", GDK_EXCEPTION);
+
+	gdk_return rc = BATrleencode(&o, &u, b);
+	bat_destroy(b);
+	if (rc != GDK_SUCCEED)
+		throw(SQL, "rle.compress", GDK_EXCEPTION);
+	/* the runs become part of the column storage */
+	BAT *po = COLcopy(o, o->ttype, true, PERSISTENT);
+	BAT *pu = COLcopy(u, u->ttype, true, PERSISTENT);
+	bat_destroy(o);
+	bat_destroy(u);
+	if (po == NULL || pu == NULL) {
+		bat_destroy(po);
+		bat_destroy(pu);
+		throw(SQL, "rle.compress", GDK_EXCEPTION);
+	}
+	o = po;
+	u = pu;
+
+	switch (sql_trans_alter_storage(tr, c, "RLE")) {
+		case -1:
+			msg = createException(SQL, "rle.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			break;
+		case -2:
+		case -3:
+			msg = createException(SQL, "rle.compress", SQLSTATE(42000) "transaction conflict detected");
+			break;
+		default:
+			break;
+	}
+	if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
+		msg = createException(SQL, "rle.compress", SQLSTATE(HY013) "alter_storage failed");
+	if (msg == MAL_SUCCEED) {
+		switch (store->storage_api.col_compress(tr, c, ST_RLE, o, u)) {
+			case -1:
+				msg = createException(SQL, "rle.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
+			case -2:
+			case -3:
+				msg = createException(SQL, "rle.compress", SQLSTATE(42000) "transaction conflict detected");
+				break;
+			default:
+				break;
+		}
+	}
+	bat_destroy(u);
+	bat_destroy(o);
+	return msg;
+}
+
+/* expand a run length encoded column once, when its table is made
+ * writable again */
+str
+RLEexpand_column(sql_trans *tr, sql_column *c)
+{
+	str msg = MAL_SUCCEED;
+	sqlstore *store = tr->store;
+	BAT *b = store->storage_api.bind_col(tr, c, RDONLY), *v = NULL, *n = NULL;
+
+	if (b == NULL || (v = store->storage_api.bind_col(tr, c, RD_EXT)) == NULL) {
+		bat_destroy(b);
+		throw(SQL, "rle.expand", SQLSTATE(HY005) "Cannot access column descriptor");
+	}
+	if ((n = BATrledecode(b, v)) != NULL) {
+		BAT *p = COLcopy(n, n->ttype, true, PERSISTENT);
+		bat_destroy(n);
+		n = p;
+	}
+	bat_destroy(b);
+	bat_destroy(v);
+	if (n == NULL)
+		throw(SQL, "rle.expand", GDK_EXCEPTION);
+
+	switch (sql_trans_alter_storage(tr, c, NULL)) {
+		case -1:
+			msg = createException(SQL, "rle.expand", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			break;
+		case -2:
+		case -3:
+			msg = createException(SQL, "rle.expand", SQLSTATE(42000) "transaction conflict detected");
+			break;
+		default:
+			break;
+	}
+	if (msg == MAL_SUCCEED && !(c = get_newcolumn(tr, c)))
+		msg = createException(SQL, "rle.expand", SQLSTATE(HY013) "alter_storage failed");
+	if (msg == MAL_SUCCEED) {
+		switch (store->storage_api.col_compress(tr, c, ST_DEFAULT, n, NULL)) {
+			case -1:
+				msg = createException(SQL, "rle.expand", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+				break;
+			case -2:
+			case -3:
+				msg = createException(SQL, "rle.expand", SQLSTATE(42000) "transaction conflict detected");
+				break;
+			default:
+				break;
+		}
+	}
+	bat_destroy(n);
+	return msg;
+}
+
+str
+RLEcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)mb;
+	str msg = MAL_SUCCEED;
+	const char *sname = *getArgReference_str(stk, pci, 1);
+	const char *tname = *getArgReference_str(stk, pci, 2);
+	const char *cname = *getArgReference_str(stk, pci, 3);
+	backend *be = NULL;
+	sql_trans *tr = NULL;
+
+	if (!sname || !tname || !cname)
+		throw(SQL, "rle.compress", SQLSTATE(3F000) "rle compress: invalid column name");
+	if (strNil(sname))
+		throw(SQL, "rle.compress", SQLSTATE(42000) "Schema name cannot be NULL");
+	if (strNil(tname))
+		throw(SQL, "rle.compress", SQLSTATE(42000) "Table name cannot be NULL");
+	if (strNil(cname))
+		throw(SQL, "rle.compress", SQLSTATE(42000) "Column name cannot be NULL");
+	if ((msg = getBackendContext(cntxt, &be)) != MAL_SUCCEED)
+		return msg;
+	tr = be->mvc->session->tr;
+
+	sql_schema *s = find_sql_schema(tr, sname);
+	if (!s)
+		throw(SQL, "rle.compress", SQLSTATE(3F000) "schema '%s' unknown", sname);
+	sql_table *t = find_sql_table(tr, s, tname);
+	if (!t)
+		throw(SQL, "rle.compress", SQLSTATE(3F000) "table '%s.%s' unknown", sname, tname);
+	if (!isTable(t) || isUnloggedTable(t))
+		throw(SQL, "rle.compress", SQLSTATE(42000) "%s '%s' is not persistent",
+			  TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (isTempTable(t))
+		throw(SQL, "rle.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
+	if (t->system)
+		throw(SQL, "rle.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
+	sql_column *c = find_sql_column(t, cname);
+	if (!c)
+		throw(SQL, "rle.compress", SQLSTATE(3F000) "column '%s.%s.%s' unknown", sname, tname, cname);
+	return RLEcompress_column(tr, c);
+}
+
+/* fix the bounds and values of a run length encoded (sub)column */
+static str
+rle_descriptors(const char *fcn, BAT **b, BAT **v, bat B, bat V)
+{
+	*b = BATdescriptor(B);
+	*v = BATdescriptor(V);
+	if (*b == NULL || *v == NULL) {
+		bat_destroy(*b);
+		bat_destroy(*v);
+		throw(SQL, fcn, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+RLEdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *r = getArgReference_bat(stk, pci, 0);
+	BAT *b, *v, *bn;
+	str msg;
+
+	if ((msg = rle_descriptors("rle.decompress", &b, &v, *getArgReference_bat(stk, pci, 1), *getArgReference_bat(stk, pci, 2))) != MAL_SUCCEED)
+		return msg;
+	bn = BATrledecode(b, v);
+	bat_destroy(b);
+	bat_destroy(v);
+	if (bn == NULL)
+		throw(SQL, "rle.decompress", GDK_EXCEPTION);
+	*r = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+str
+RLEproject(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *R0 = getArgReference_bat(stk, pci, 0);
+	bat *R1 = getArgReference_bat(stk, pci, 1);
+	BAT *l, *b, *v, *bn, *vn;
+	str msg;
+
+	if ((l = BATdescriptor(*getArgReference_bat(stk, pci, 2))) == NULL)
+		throw(SQL, "rle.project", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if ((msg = rle_descriptors("rle.project", &b, &v, *getArgReference_bat(stk, pci, 3), *getArgReference_bat(stk, pci, 4))) != MAL_SUCCEED) {
+		bat_destroy(l);
+		return msg;
+	}
+	gdk_return rc = BATrleproject(&bn, &vn, l, b, v);
+	bat_destroy(l);
+	bat_destroy(b);
+	bat_destroy(v);
+	if (rc != GDK_SUCCEED)
+		throw(SQL, "rle.project", GDK_EXCEPTION);
+	*R0 = bn->batCacheid;
+	BBPkeepref(bn);
+	*R1 = vn->batCacheid;
+	BBPkeepref(vn);
+	return MAL_SUCCEED;
+}
+
+str
+RLEselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *R0 = getArgReference_bat(stk, pci, 0);
+	bat C = *getArgReference_bat(stk, pci, 3);
+	const void *l = getArgReference(stk, pci, 4);
+	const void *h = getArgReference(stk, pci, 5);
+	bit li = *getArgReference_bit(stk, pci, 6);
+	bit hi = *getArgReference_bit(stk, pci, 7);
+	bit anti = *getArgReference_bit(stk, pci, 8);
+	bit unknown = *getArgReference_bit(stk, pci, 9);
+	BAT *b, *v, *c = NULL, *bn;
+	str msg;
+
+	if ((li != 0 && li != 1) ||
+		(hi != 0 && hi != 1) ||
+		(anti != 0 && anti != 1)) {
+		throw(MAL, "rle.select", ILLEGAL_ARGUMENT);
+	}
+	if ((msg = rle_descriptors("rle.select", &b, &v, *getArgReference_bat(stk, pci, 1), *getArgReference_bat(stk, pci, 2))) != MAL_SUCCEED)
+		return msg;
+	if (!is_bat_nil(C) && (c = BATdescriptor(C)) == NULL) {
+		bat_destroy(b);
+		bat_destroy(v);
+		throw(SQL, "rle.select", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	int tpe = v->ttype;
+	if (ATOMextern(tpe)) {
+		l = *(ptr*)l;
+		h = *(ptr*)h;
+	}
+
+	/* same nil handling as algebra.select */
+	const void *nilptr = ATOMnilptr(tpe);
+	if (!anti && unknown) {
+		if (li && ATOMcmp(tpe, l, nilptr) == 0) {
+			l = h;
+			li = 0;
+		}
+		if (hi && ATOMcmp(tpe, h, nilptr) == 0) {
+			h = l;
+			hi = 0;
+		}
+		if (ATOMcmp(tpe, l, h) == 0 && ATOMcmp(tpe, h, nilptr) == 0) /* ugh sql nil != nil */
+			anti = 1;
+	} else if (!unknown) {
+		if (li && hi && ATOMcmp(tpe, l, nilptr) == 0 && ATOMcmp(tpe, h, nilptr) == 0)
+			h = NULL; /* special case: equi-select for NIL */
+	}
+	bn = BATrleselect(b, v, c, l, h, li, hi, anti, false);
+	bat_destroy(b);
+	bat_destroy(v);
+	bat_destroy(c);
+	if (bn == NULL)
+		throw(SQL, "rle.select", GDK_EXCEPTION);
+	*R0 = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+str
+RLEthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *R0 = getArgReference_bat(stk, pci, 0);
+	bat C = *getArgReference_bat(stk, pci, 3);
+	const void *val = getArgReference(stk, pci, 4);
+	const char *op = *getArgReference_str(stk, pci, 5);
+	BAT *b, *v, *c = NULL, *bn;
+	str msg;
+
+	if ((msg = rle_descriptors("rle.thetaselect", &b, &v, *getArgReference_bat(stk, pci, 1), *getArgReference_bat(stk, pci, 2))) != MAL_SUCCEED)
+		return msg;
+	if (!is_bat_nil(C) && (c = BATdescriptor(C)) == NULL) {
+		bat_destroy(b);
+		bat_destroy(v);
+		throw(SQL, "rle.thetaselect", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if (ATOMextern(v->ttype))
+		val = *(ptr*)val;
+	bn = BATrlethetaselect(b, v, c, val, op);
+	bat_destroy(b);
+	bat_destroy(v);
+	bat_destroy(c);
+	if (bn == NULL)
+		throw(SQL, "rle.thetaselect", GDK_EXCEPTION);
+	*R0 = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+str
+RLEgroup(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	bat *G = getArgReference_bat(stk, pci, 0);
+	bat *E = getArgReference_bat(stk, pci, 1);
+	bat *H = pci->retc == 3 ? getArgReference_bat(stk, pci, 2) : NULL;
+	BAT *b, *v, *g, *e, *h = NULL;
+	str msg;
+
+	if ((msg = rle_descriptors("rle.group", &b, &v, *getArgReference_bat(stk, pci, pci->retc), *getArgReference_bat(stk, pci, pci->retc + 1))) != MAL_SUCCEED)
+		return msg;
+	gdk_return rc = BATrlegroup(&g, &e, H ? &h : NULL, b, v);
+	bat_destroy(b);
+	bat_destroy(v);
+	if (rc != GDK_SUCCEED)
+		throw(SQL, "rle.group", GDK_EXCEPTION);
+	*G = g->batCacheid;
+	BBPkeepref(g);
+	*E = e->batCacheid;
+	BBPkeepref(e);
+	if (H) {
+		*H = h->batCacheid;
+		BBPkeepref(h);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+RLEcount(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	(void)mb;
+	lng *res = getArgReference_lng(stk, pci, 0);
+	bit ignorenil = pci->argc > 3 ? *getArgReference_bit(stk, pci, 3) : FALSE;
+	BAT *b, *v, *bn;
+	str msg;
+
+	if ((msg = rle_descriptors("rle.count", &b, &v, *getArgReference_bat(stk, pci, 1), *getArgReference_bat(stk, pci, 2))) != MAL_SUCCEED)
+		return msg;
+	bn = BATrlecount(b, v, NULL, 1, ignorenil);
+	bat_destroy(b);
+	bat_destroy(v);
+	if (bn == NULL)
+		throw(SQL, "rle.count", GDK_EXCEPTION);
+	*res = *(lng *) Tloc(bn, 0);
+	bat_destroy(bn);
+	return MAL_SUCCEED;
+}
+
+str
+RLEsum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	ValPtr res = &stk->stk[getArg(pci, 0)];
+	int tp = getArgType(mb, pci, 0);
+	BAT *b, *v, *bn;
+	str msg;
+
+	if ((msg = rle_descriptors("rle.sum", &b, &v, *getArgReference_bat(stk, pci, 1), *getArgReference_bat(stk, pci, 2))) != MAL_SUCCEED)
+		return msg;
+	bn = BATrlesum(b, v, NULL, 1, tp, true);
+	bat_destroy(b);
+	bat_destroy(v);
+	if (bn == NULL)
+		throw(SQL, "rle.sum", GDK_EXCEPTION);
+	if (VALinit(res, tp, Tloc(bn, 0)) == NULL) {
+		bat_destroy(bn);
+		throw(SQL, "rle.sum", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	bat_destroy(bn);
+	return MAL_SUCCEED;
+}
+
+/* (B, V) is the aggregated column, (B, G) the run length encoded
+ * groups with extents E */
+static str
+rle_subaggr(const char *fcn, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, bool sum)
+{
+	bat *R0 = getArgReference_bat(stk, pci, 0);
+	bit skip_nils = *getArgReference_bit(stk, pci, 5);
+	BAT *b, *v, *g, *e, *bn;
+	str msg;
+
+	if ((msg = rle_descriptors(fcn, &b, &v, *getArgReference_bat(stk, pci, 1), *getArgReference_bat(stk, pci, 2))) != MAL_SUCCEED)
+		return msg;
+	if ((msg = rle_descriptors(fcn, &g, &e, *getArgReference_bat(stk, pci, 3), *getArgReference_bat(stk, pci, 4))) != MAL_SUCCEED) {
+		bat_destroy(b);
+		bat_destroy(v);
+		return msg;
+	}
+	if (sum)
+		bn = BATrlesum(b, v, g, BATcount(e), getBatType(getArgType(mb, pci, 0)), skip_nils);
+	else
+		bn = BATrlecount(b, v, g, BATcount(e), skip_nils);
+	bat_destroy(b);
+	bat_destroy(v);
+	bat_destroy(g);
+	bat_destroy(e);
+	if (bn == NULL)
+		throw(SQL, fcn, GDK_EXCEPTION);
+	*R0 = bn->batCacheid;
+	BBPkeepref(bn);
+	return MAL_SUCCEED;
+}
+
+str
+RLEsubcount(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return rle_subaggr("rle.subcount", mb, stk, pci, false);
+}
+
+str
+RLEsubsum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return rle_subaggr("rle.subsum", mb, stk, pci, true);
+}
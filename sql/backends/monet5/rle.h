@@ -0,0 +1,32 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+#ifndef _RLE_H
+#define _RLE_H
+
+#include "sql.h"
+
+extern str RLEcompress_col(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEdecompress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEproject(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEthetaselect(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEgroup(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEcount(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEsum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEsubcount(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern str RLEsubsum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+extern str RLEcompress_column(sql_trans *tr, sql_column *c);
+extern str RLEexpand_column(sql_trans *tr, sql_column *c);
+
+#endif /* _RLE_H */
@@ -42,10 +42,12 @@
 #include "bat5.h"
 #include "opt_pipes.h"
 #include "clients.h"
+#include "remote.h"
 #include "mal_instruction.h"
 #include "mal_resource.h"
 #include "mal_authorize.h"
 #include "gdk_cand.h"
+#include "mutils.h"
 
 static inline void
 BBPnreclaim(int nargs, ...)
@@ -174,10 +176,41 @@ sql_symbol2relation(backend *be, symbol *sym)
  * should be garbage collected. For successful actions we have to finish
  * the transaction as well, e.g. commit or rollback.
  */
+static str export_close(backend *be, stream *s, int onclient);
+
+/* End a pipelined COPY INTO export, also when the query failed half
+ * way.  The partitions written so far are then removed again, at least
+ * from a file on the server. */
+static str
+export_finish(backend *be, bool failed)
+{
+	str msg = MAL_SUCCEED;
+	res_table *t;
+
+	if (be->export) {
+		msg = export_close(be, be->export, be->export_onclient);
+		be->export = NULL;
+		if (failed && be->export_file && MT_remove(be->export_file) < 0 && errno != ENOENT)
+			TRC_ERROR(SQL_EXECUTION, "Removing partial export %s failed: %s\n",
+					  be->export_file, GDKstrerror(errno, (char[128]){0}, 128));
+		GDKfree(be->export_file);
+		be->export_file = NULL;
+		if ((t = res_tables_find(be->results, be->export_id)) != NULL)
+			be->results = res_tables_remove(be->results, t);
+	}
+	return msg;
+}
+
 int
 sqlcleanup(backend *be, int err)
 {
+	/* an export still in progress was cut short */
+	freeException(export_finish(be, true));
 	sql_destroy_params(be->mvc);
+	if (be->plan) {
+		qc_plan_release(be->plan);
+		be->plan = NULL;
+	}
 
 	/* some statements dynamically disable caching */
 	be->mvc->sym = NULL;
@@ -190,8 +223,12 @@ sqlcleanup(backend *be, int err)
 		be->mvc->session->status = -err;
 	if (err <0)
 		be->mvc->session->status = err;
+	/* remote members started by a failed query are not collected */
+	if (err)
+		RMTdisconnectClient(be->client);
 	be->mvc->label = 0;
 	be->mvc->nid = 1;
+	be->mvc->skipped = NULL;
 	be->no_mitosis = 0;
 	scanner_query_processed(&(be->mvc->scanner));
 	return err;
@@ -2441,6 +2478,28 @@ SQLtid(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return msg;
 }
 
+/* the recycler identifies the data read by sql.bind and sql.tid with the
+ * table and the version of its content seen by the transaction */
+bool
+SQLrecycleSource(Client cntxt, MalStkPtr stk, InstrPtr pci, int *id, ulng *version)
+{
+	backend *be = cntxt->sqlcontext;
+	mvc *m;
+	sql_schema *s;
+	sql_table *t;
+
+	if (be == NULL || (m = be->mvc) == NULL || !m->session->tr->active)
+		return false;
+	if ((s = mvc_bind_schema(m, *getArgReference_str(stk, pci, pci->retc + 1))) == NULL ||
+		(t = mvc_bind_table(m, s, *getArgReference_str(stk, pci, pci->retc + 2))) == NULL)
+		return false;
+	sqlstore *store = m->store;
+	if (!store->storage_api.tab_version(m->session->tr, t, version))
+		return false;
+	*id = t->base.id;
+	return true;
+}
+
 /* unsafe pattern resultSet(tbl:bat[:str], attr:bat[:str], tpe:bat[:str], len:bat[:int],scale:bat[:int], cols:bat[:any]...) :int */
 /* New result set rendering infrastructure */
 
@@ -2529,63 +2588,27 @@ mvc_result_set_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return msg;
 }
 
-/* Copy the result set into a CSV file */
-str
-mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+/* Describe the columns of a new result table for a COPY INTO export,
+ * from the meta data BATs and the columns starting at argument meta */
+static str
+export_result_table(backend *be, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, int meta, int *res_id)
 {
-	int *res_id =getArgReference_int(stk,pci,0);
-	const char *filename = *getArgReference_str(stk,pci,1);
-	const char *format = *getArgReference_str(stk,pci,2);
-	const char *tsep = *getArgReference_str(stk, pci, 3);
-	const char *rsep = *getArgReference_str(stk, pci, 4);
-	const char *ssep = *getArgReference_str(stk, pci, 5);
-	const char *ns = *getArgReference_str(stk, pci, 6);
-	int onclient = *getArgReference_int(stk, pci, 7);
-
-	bat tblId= *getArgReference_bat(stk, pci,8);
-	bat atrId= *getArgReference_bat(stk, pci,9);
-	bat tpeId= *getArgReference_bat(stk, pci,10);
-	bat lenId= *getArgReference_bat(stk, pci,11);
-	bat scaleId= *getArgReference_bat(stk, pci,12);
-	stream *s = NULL;
+	bat tblId= *getArgReference_bat(stk, pci, meta);
+	bat atrId= *getArgReference_bat(stk, pci, meta + 1);
+	bat tpeId= *getArgReference_bat(stk, pci, meta + 2);
+	bat lenId= *getArgReference_bat(stk, pci, meta + 3);
+	bat scaleId= *getArgReference_bat(stk, pci, meta + 4);
 	bat bid;
-	int i, res, ok;
+	int i;
 	const char *tblname, *colname, *tpename;
 	str msg= MAL_SUCCEED;
 	int *digits, *scaledigits;
 	oid o = 0;
 	BATiter itertbl,iteratr,itertpe,iterdig,iterscl;
-	backend *be;
-	mvc *m = NULL;
 	BAT *b = NULL, *tbl = NULL, *atr = NULL, *tpe = NULL,*len = NULL,*scale = NULL;
-	res_table *t = NULL;
-	bool tostdout;
-	char buf[80];
-	ssize_t sz;
-
-	(void) format;
-
-	if ((msg = getBackendContext(cntxt, &be)) != NULL)
-		return msg;
-	m = be->mvc;
-
-	if (onclient && !cntxt->filetrans) {
-		msg = createException(SQL, "sql.resultSet", SQLSTATE(42000) "Cannot transfer files to client");
-		goto wrapup_result_set1;
-	}
-
-	bid = *getArgReference_bat(stk,pci,13);
-	res = *res_id = mvc_result_table(be, mb->tag, pci->argc - (pci->retc + 12), Q_TABLE);
-	t = be->results;
-	if (res < 0) {
-		msg = createException(SQL, "sql.resultSet", SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto wrapup_result_set1;
-	}
 
-	t->tsep = tsep;
-	t->rsep = rsep;
-	t->ssep = ssep;
-	t->ns = ns;
+	if ((*res_id = mvc_result_table(be, mb->tag, pci->argc - (meta + 5), Q_TABLE)) < 0)
+		throw(SQL, "sql.resultSet", SQLSTATE(HY013) MAL_MALLOC_FAIL);
 
 	tbl = BATdescriptor(tblId);
 	atr = BATdescriptor(atrId);
@@ -2593,7 +2616,7 @@ mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	len = BATdescriptor(lenId);
 	scale = BATdescriptor(scaleId);
 	if( tbl == NULL || atr == NULL || tpe == NULL || len == NULL || scale == NULL)
-		goto wrapup_result_set1;
+		goto wrapup_result_table;
 	/* mimic the old rsColumn approach; */
 	itertbl = bat_iterator(tbl);
 	iteratr = bat_iterator(atr);
@@ -2603,7 +2626,7 @@ mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	digits = (int*) iterdig.base;
 	scaledigits = (int*) iterscl.base;
 
-	for( i = 13; msg == MAL_SUCCEED && i< pci->argc; i++, o++){
+	for( i = meta + 5; msg == MAL_SUCCEED && i< pci->argc; i++, o++){
 		bid = *getArgReference_bat(stk,pci,i);
 		tblname = BUNtvar(itertbl,o);
 		colname = BUNtvar(iteratr,o);
@@ -2621,47 +2644,64 @@ mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	bat_iterator_end(&itertpe);
 	bat_iterator_end(&iterdig);
 	bat_iterator_end(&iterscl);
-	if ( msg )
-		goto wrapup_result_set1;
+  wrapup_result_table:
+	if( tbl) BBPunfix(tblId);
+	if( atr) BBPunfix(atrId);
+	if( tpe) BBPunfix(tpeId);
+	if( len) BBPunfix(lenId);
+	if( scale) BBPunfix(scaleId);
+	return msg;
+}
 
-	/* now select the file channel */
-	if ((tostdout = strcmp(filename,"stdout") == 0)) {
-		s = cntxt->fdout;
-	} else if (!onclient) {
+/* Open the channel of a COPY INTO export, a file on either the server
+ * or the client */
+static str
+export_open(backend *be, const char *filename, int onclient, stream **sp)
+{
+	mvc *m = be->mvc;
+	stream *s;
+	char buf[80];
+
+	if (!onclient) {
 		if ((s = open_wastream(filename)) == NULL || mnstr_errnr(s) != MNSTR_NO__ERROR) {
-			msg=  createException(IO, "streams.open", SQLSTATE(42000) "%s", mnstr_peek_error(NULL));
+			str msg = createException(IO, "streams.open", SQLSTATE(42000) "%s", mnstr_peek_error(NULL));
 			close_stream(s);
-			goto wrapup_result_set1;
+			return msg;
 		}
 		be->output_format = OFMT_CSV;
 	} else {
 		while (!m->scanner.rs->eof) {
-			if (bstream_next(m->scanner.rs) < 0) {
-				msg = createException(IO, "streams.open", "interrupted");
-				goto wrapup_result_set1;
-			}
+			if (bstream_next(m->scanner.rs) < 0)
+				throw(IO, "streams.open", "interrupted");
 		}
 		s = m->scanner.ws;
 		mnstr_write(s, PROMPT3, sizeof(PROMPT3) - 1, 1);
 		mnstr_printf(s, "w %s\n", filename);
 		mnstr_flush(s, MNSTR_FLUSH_DATA);
-		if ((sz = mnstr_readline(m->scanner.rs->s, buf, sizeof(buf))) > 1) {
+		if (mnstr_readline(m->scanner.rs->s, buf, sizeof(buf)) > 1) {
 			/* non-empty line indicates failure on client */
-			msg = createException(IO, "streams.open", "%s", buf);
+			str msg = createException(IO, "streams.open", "%s", buf);
 			/* discard until client flushes */
 			while (mnstr_read(m->scanner.rs->s, buf, 1, sizeof(buf)) > 0) {
 				/* ignore remainder of error message */
 			}
-			goto wrapup_result_set1;
+			return msg;
 		}
 	}
-	if ((ok = mvc_export_result(cntxt->sqlcontext, s, res, tostdout, cntxt->qryctx.starttime, mb->optimize)) < 0) {
-		msg = createException(SQL, "sql.resultSet", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(cntxt->sqlcontext, s, ok));
-		if (!onclient && !tostdout)
-			close_stream(s);
-		if (ok != -5)
-			goto wrapup_result_set1;
-	}
+	*sp = s;
+	return MAL_SUCCEED;
+}
+
+/* Close the channel of a COPY INTO export, the client then tells
+ * whether it managed to write the file */
+static str
+export_close(backend *be, stream *s, int onclient)
+{
+	mvc *m = be->mvc;
+	str msg = MAL_SUCCEED;
+	char buf[80];
+	ssize_t sz;
+
 	if (onclient) {
 		mnstr_flush(s, MNSTR_FLUSH_DATA);
 		if ((sz = mnstr_readline(m->scanner.rs->s, buf, sizeof(buf))) > 1) {
@@ -2669,18 +2709,181 @@ mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		}
 		while (sz > 0)
 			sz = mnstr_readline(m->scanner.rs->s, buf, sizeof(buf));
-	} else if (!tostdout) {
+	} else {
 		close_stream(s);
 	}
+	return msg;
+}
+
+/* Copy the result set into a CSV file */
+str
+mvc_export_table_wrap( Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int *res_id =getArgReference_int(stk,pci,0);
+	const char *filename = *getArgReference_str(stk,pci,1);
+	const char *format = *getArgReference_str(stk,pci,2);
+	const char *tsep = *getArgReference_str(stk, pci, 3);
+	const char *rsep = *getArgReference_str(stk, pci, 4);
+	const char *ssep = *getArgReference_str(stk, pci, 5);
+	const char *ns = *getArgReference_str(stk, pci, 6);
+	int onclient = *getArgReference_int(stk, pci, 7);
+	stream *s = NULL;
+	int ok;
+	str msg= MAL_SUCCEED;
+	backend *be;
+	res_table *t = NULL;
+	bool tostdout;
+
+	(void) format;
+
+	if ((msg = getBackendContext(cntxt, &be)) != NULL)
+		return msg;
+
+	if (onclient && !cntxt->filetrans) {
+		msg = createException(SQL, "sql.resultSet", SQLSTATE(42000) "Cannot transfer files to client");
+		goto wrapup_result_set1;
+	}
+
+	if ((msg = export_result_table(be, mb, stk, pci, 8, res_id)) != MAL_SUCCEED)
+		goto wrapup_result_set1;
+	t = be->results;
+	t->tsep = tsep;
+	t->rsep = rsep;
+	t->ssep = ssep;
+	t->ns = ns;
+
+	/* now select the file channel */
+	if ((tostdout = strcmp(filename,"stdout") == 0)) {
+		s = cntxt->fdout;
+	} else if ((msg = export_open(be, filename, onclient, &s)) != MAL_SUCCEED) {
+		goto wrapup_result_set1;
+	}
+	if ((ok = mvc_export_result(cntxt->sqlcontext, s, *res_id, tostdout, cntxt->qryctx.starttime, mb->optimize)) < 0)
+		msg = createException(SQL, "sql.resultSet", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(cntxt->sqlcontext, s, ok));
+	if (!tostdout) {
+		str err = export_close(be, s, onclient);
+
+		if (msg)
+			freeException(err);
+		else
+			msg = err;
+	}
   wrapup_result_set1:
 	cntxt->qryctx.starttime = 0;
 	cntxt->qryctx.endtime = 0;
 	mb->optimize = 0;
-	if( tbl) BBPunfix(tblId);
-	if( atr) BBPunfix(atrId);
-	if( tpe) BBPunfix(tpeId);
-	if( len) BBPunfix(lenId);
-	if( scale) BBPunfix(scaleId);
+	return msg;
+}
+
+/*
+ * A COPY INTO export of a partitioned result writes the partitions as
+ * soon as they are available, rather than packing them first (see the
+ * matpack optimizer).  The running row count passed from one call to
+ * the next keeps the partitions in order.
+ */
+static str
+mvc_export_start_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int *res_id = getArgReference_int(stk, pci, 0);
+	lng *cnt = getArgReference_lng(stk, pci, 1);
+	const char *filename = *getArgReference_str(stk, pci, 2);
+	const char *tsep = *getArgReference_str(stk, pci, 4);
+	const char *rsep = *getArgReference_str(stk, pci, 5);
+	const char *ssep = *getArgReference_str(stk, pci, 6);
+	const char *ns = *getArgReference_str(stk, pci, 7);
+	int onclient = *getArgReference_int(stk, pci, 8);
+	int ok;
+	str msg;
+	backend *be;
+	res_table *t;
+
+	if ((msg = getBackendContext(cntxt, &be)) != NULL)
+		return msg;
+	if (be->export)
+		throw(SQL, "sql.export_start", SQLSTATE(42000) "Export already in progress");
+	if (onclient && !cntxt->filetrans)
+		throw(SQL, "sql.export_start", SQLSTATE(42000) "Cannot transfer files to client");
+
+	if ((msg = export_result_table(be, mb, stk, pci, 9, res_id)) != MAL_SUCCEED)
+		return msg;
+	t = be->results;
+	t->tsep = tsep;
+	t->rsep = rsep;
+	t->ssep = ssep;
+	t->ns = ns;
+	if ((msg = export_open(be, filename, onclient, &be->export)) != MAL_SUCCEED) {
+		be->export = NULL;
+		be->results = res_tables_remove(be->results, t);
+		return msg;
+	}
+	be->export_id = *res_id;
+	be->export_onclient = onclient != 0;
+	if (!onclient && (be->export_file = GDKstrdup(filename)) == NULL)
+		throw(SQL, "sql.export_start", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+
+	/* the first partition came with the column descriptions */
+	if ((ok = mvc_export_partition(be, be->export, *res_id, NULL)) < 0)
+		throw(SQL, "sql.export_start", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(be, be->export, ok));
+	*cnt = (lng) t->nr_rows;
+	return MAL_SUCCEED;
+}
+
+static str
+mvc_export_part_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	lng *cnt = getArgReference_lng(stk, pci, 0);
+	int res_id = *getArgReference_int(stk, pci, 1);
+	lng prev = *getArgReference_lng(stk, pci, 2);
+	int i, ncols = pci->argc - 3, ok = 0;
+	BAT **cols;
+	str msg;
+	backend *be;
+
+	(void) mb;
+	if ((msg = getBackendContext(cntxt, &be)) != NULL)
+		return msg;
+	if (be->export == NULL || be->export_id != res_id)
+		throw(SQL, "sql.export_part", SQLSTATE(42000) "No export in progress");
+	if ((cols = GDKzalloc(ncols * sizeof(BAT *))) == NULL)
+		throw(SQL, "sql.export_part", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	for (i = 0; i < ncols; i++) {
+		if ((cols[i] = BATdescriptor(*getArgReference_bat(stk, pci, i + 3))) == NULL) {
+			msg = createException(SQL, "sql.export_part", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+			break;
+		}
+	}
+	if (msg == MAL_SUCCEED) {
+		if (bstream_getoob(cntxt->fdin))
+			msg = createException(SQL, "sql.export_part", SQLSTATE(HY000) "Query aborted");
+		else if ((ok = mvc_export_partition(be, be->export, res_id, cols)) < 0)
+			msg = createException(SQL, "sql.export_part", SQLSTATE(45000) "Result set construction failed: %s", mvc_export_error(be, be->export, ok));
+		else
+			*cnt = prev + (lng) BATcount(cols[0]);
+	}
+	for (i = 0; i < ncols; i++)
+		BBPreclaim(cols[i]);
+	GDKfree(cols);
+	return msg;
+}
+
+static str
+mvc_export_done_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int *res_id = getArgReference_int(stk, pci, 0);
+	lng *cnt = getArgReference_lng(stk, pci, 1);
+	str msg;
+	backend *be;
+
+	if ((msg = getBackendContext(cntxt, &be)) != NULL)
+		return msg;
+	if (be->export == NULL || be->export_id != *getArgReference_int(stk, pci, 2))
+		throw(SQL, "sql.export_done", SQLSTATE(42000) "No export in progress");
+	*res_id = be->export_id;
+	*cnt = *getArgReference_lng(stk, pci, 3);
+	msg = export_finish(be, false);
+	cntxt->qryctx.starttime = 0;
+	cntxt->qryctx.endtime = 0;
+	mb->optimize = 0;
 	return msg;
 }
 
@@ -3888,7 +4091,10 @@ sql_rowid(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	if( b == NULL)
 		throw(SQL,"calc.rowid", SQLSTATE(HY005) "Cannot access column descriptor");
 	/* UGH (move into storage backends!!) */
-	*rid = BATcount(b);
+	if (c->storage_type && c->storage_type[0] == 'R') /* b holds the runs */
+		*rid = (oid) store->storage_api.count_col(m->session->tr, c, RDONLY);
+	else
+		*rid = BATcount(b);
 	return MAL_SUCCEED;
 }
 
@@ -5442,6 +5648,8 @@ SQLstr_stop_vacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 #include "sql_transaction.h"
 #include "for.h"
 #include "dict.h"
+#include "rle.h"
+#include "sql_compress.h"
 #include "mel.h"
 
 
@@ -5655,6 +5863,9 @@ static mel_func sql_init_funcs[] = {
  pattern("sql", "resultSet", mvc_table_result_wrap, true, "Prepare a table result set for the client in default CSV format", args(1,7, arg("",int),batarg("tbl",str),batarg("attr",str),batarg("tpe",str),batarg("len",int),batarg("scale",int),batvarargany("cols",0))),
  pattern("sql", "export_table", mvc_export_row_wrap, true, "Prepare a table result set for the COPY INTO stream", args(1,14, arg("",int),arg("fname",str),arg("fmt",str),arg("colsep",str),arg("recsep",str),arg("qout",str),arg("nullrep",str),arg("onclient",int),batarg("tbl",str),batarg("attr",str),batarg("tpe",str),batarg("len",int),batarg("scale",int),varargany("cols",0))),
  pattern("sql", "export_table", mvc_export_table_wrap, true, "Prepare a table result set for the COPY INTO stream", args(1,14, arg("",int),arg("fname",str),arg("fmt",str),arg("colsep",str),arg("recsep",str),arg("qout",str),arg("nullrep",str),arg("onclient",int),batarg("tbl",str),batarg("attr",str),batarg("tpe",str),batarg("len",int),batarg("scale",int),batvarargany("cols",0))),
+ pattern("sql", "export_start", mvc_export_start_wrap, false, "Start a COPY INTO export with the first partition of the result", args(2,15, arg("",int),arg("",lng),arg("fname",str),arg("fmt",str),arg("colsep",str),arg("recsep",str),arg("qout",str),arg("nullrep",str),arg("onclient",int),batarg("tbl",str),batarg("attr",str),batarg("tpe",str),batarg("len",int),batarg("scale",int),batvarargany("cols",0))),
+ pattern("sql", "export_part", mvc_export_part_wrap, false, "Export the next partition of the result, after the rows counted so far", args(1,4, arg("",lng),arg("res_id",int),arg("cnt",lng),batvarargany("cols",0))),
+ pattern("sql", "export_done", mvc_export_done_wrap, true, "Finish a COPY INTO export, returning its result id and row count", args(2,4, arg("",int),arg("",lng),arg("res_id",int),arg("cnt",lng))),
  pattern("sql", "exportHead", mvc_export_head_wrap, true, "Export a result (in order) to stream s", args(1,3, arg("",void),arg("s",streams),arg("res_id",int))),
  pattern("sql", "exportResult", mvc_export_result_wrap, true, "Export a result (in order) to stream s", args(1,3, arg("",void),arg("s",streams),arg("res_id",int))),
  pattern("sql", "exportChunk", mvc_export_chunk_wrap, true, "Export a chunk of the result set (in order) to stream s", args(1,3, arg("",void),arg("s",streams),arg("res_id",int))),
@@ -5712,6 +5923,10 @@ static mel_func sql_init_funcs[] = {
  pattern("sql", "copy_rejects", COPYrejects, false, "", args(4,4, batarg("rowid",lng),batarg("fldid",int),batarg("msg",str),batarg("inp",str))),
  pattern("sql", "copy_rejects_clear", COPYrejects_clear, true, "", noargs),
  pattern("for", "compress", FORcompress_col, false, "compress a sql column", args(0, 3, arg("schema", str), arg("table", str), arg("column", str))),
+ pattern("for", "select", FORselect, false, "value - range select on a for compressed column", args(1, 10, batarg("r0", oid), batargany("lo", 0), batarg("lc", oid), arg("minval", lng), arg("l", lng), arg("h", lng), arg("li", bit), arg("hi", bit), arg("anti", bit), arg("unknown", bit))),
+ pattern("for", "thetaselect", FORthetaselect, false, "thetaselect on a for compressed column", args(1, 6, batarg("r0", oid), batargany("lo", 0), batarg("lc", oid), arg("minval", lng), arg("val", lng), arg("op", str))),
+ pattern("sql", "compress", sql_compress, false, "compress the columns of a table with the most suitable encoding", args(0, 2, arg("schema", str), arg("table", str))),
+ pattern("sql", "compress", sql_compress, false, "compress a column with the most suitable encoding", args(0, 3, arg("schema", str), arg("table", str), arg("column", str))),
  pattern("for", "decompress", FORdecompress, false, "decompress a for compressed (sub)column", args(1, 3, batargany("", 1), batargany("o", 0), argany("minval", 1))),
  pattern("dict", "compress", DICTcompress, false, "dict compress a bat", args(2, 3, batargany("o", 0), batargany("v", 1), batargany("b", 1))),
  pattern("dict", "compress", DICTcompress_col, false, "compress a sql column", args(0, 3, arg("schema", str), arg("table", str), arg("column", str))),
@@ -5721,7 +5936,31 @@ static mel_func sql_init_funcs[] = {
  pattern("dict", "join", DICTjoin, false, "join 2 dictionaries", args(2, 10, batarg("r0", oid), batarg("r1", oid), batargany("lo", 0), batargany("lv", 1), batargany("ro", 0), batargany("rv", 1), batarg("lc", oid), batarg("rc", oid), arg("nil_matches",bit), arg("estimate",lng))),
  pattern("dict", "thetaselect", DICTthetaselect, false, "thetaselect on a dictionary", args(1, 6, batarg("r0", oid), batargany("lo", 0), batarg("lc", oid), batargany("lv", 1), argany("val",1), arg("op", str))),
  pattern("dict", "renumber", DICTrenumber, false, "renumber offsets", args(1, 3, batargany("n", 1), batargany("o", 1), batargany("r", 1))),
+ pattern("dict", "merge", DICTmerge, false, "merge dictionary compressed (sub)columns, given as pairs of offsets and values, into one with a new dictionary", args(2, 3, batargany("o", 0), batargany("v", 0), batvarargany("ov", 0))),
+ pattern("dict", "sortkey", DICTsortkey, false, "order preserving codes for a dictionary compressed (sub)column", args(1, 3, batargany("r", 2), batargany("o", 0), batargany("v", 1))),
  pattern("dict", "select", DICTselect, false, "value - range select on a dictionary", args(1, 10, batarg("r0", oid), batargany("lo", 0), batarg("lc", oid), batargany("lv", 1), argany("l", 1), argany("h", 1), arg("li", bit), arg("hi", bit), arg("anti", bit),  arg("unknown", bit))),
+ pattern("rle", "compress", RLEcompress_col, false, "run length encode a sql column", args(0, 3, arg("schema", str), arg("table", str), arg("column", str))),
+ pattern("rle", "decompress", RLEdecompress, false, "expand the runs of a run length encoded (sub)column", args(1, 3, batargany("", 1), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "project", RLEproject, false, "project a run length encoded column, the result is run length encoded", args(2, 5, batarg("rb", oid), batargany("rv", 1), batarg("l", oid), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "select", RLEselect, false, "value - range select on a run length encoded column", args(1, 10, batarg("r0", oid), batarg("b", oid), batargany("v", 1), batarg("c", oid), argany("l", 1), argany("h", 1), arg("li", bit), arg("hi", bit), arg("anti", bit), arg("unknown", bit))),
+ pattern("rle", "thetaselect", RLEthetaselect, false, "thetaselect on a run length encoded column", args(1, 6, batarg("r0", oid), batarg("b", oid), batargany("v", 1), batarg("c", oid), argany("val", 1), arg("op", str))),
+ pattern("rle", "group", RLEgroup, false, "group a run length encoded column, the groups are returned per run", args(2, 4, batarg("groups", oid), batarg("extents", oid), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "group", RLEgroup, false, "group a run length encoded column, the groups are returned per run", args(3, 5, batarg("groups", oid), batarg("extents", oid), batarg("histo", lng), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "count", RLEcount, false, "count the rows of a run length encoded column", args(1, 3, arg("", lng), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "count", RLEcount, false, "count the rows of a run length encoded column", args(1, 4, arg("", lng), batarg("b", oid), batargany("v", 1), arg("ignorenil", bit))),
+ pattern("rle", "sum", RLEsum, false, "sum a run length encoded column", args(1, 3, arg("", lng), batarg("b", oid), batargany("v", 1))),
+#ifdef HAVE_HGE
+ pattern("rle", "sum", RLEsum, false, "sum a run length encoded column", args(1, 3, arg("", hge), batarg("b", oid), batargany("v", 1))),
+#endif
+ pattern("rle", "sum", RLEsum, false, "sum a run length encoded column", args(1, 3, arg("", flt), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "sum", RLEsum, false, "sum a run length encoded column", args(1, 3, arg("", dbl), batarg("b", oid), batargany("v", 1))),
+ pattern("rle", "subcount", RLEsubcount, false, "grouped count of a run length encoded column, with the groups per run", args(1, 6, batarg("", lng), batarg("b", oid), batargany("v", 1), batarg("g", oid), batarg("e", oid), arg("skip_nils", bit))),
+ pattern("rle", "subsum", RLEsubsum, false, "grouped sum of a run length encoded column, with the groups per run", args(1, 6, batarg("", lng), batarg("b", oid), batargany("v", 1), batarg("g", oid), batarg("e", oid), arg("skip_nils", bit))),
+#ifdef HAVE_HGE
+ pattern("rle", "subsum", RLEsubsum, false, "grouped sum of a run length encoded column, with the groups per run", args(1, 6, batarg("", hge), batarg("b", oid), batargany("v", 1), batarg("g", oid), batarg("e", oid), arg("skip_nils", bit))),
+#endif
+ pattern("rle", "subsum", RLEsubsum, false, "grouped sum of a run length encoded column, with the groups per run", args(1, 6, batarg("", flt), batarg("b", oid), batargany("v", 1), batarg("g", oid), batarg("e", oid), arg("skip_nils", bit))),
+ pattern("rle", "subsum", RLEsubsum, false, "grouped sum of a run length encoded column, with the groups per run", args(1, 6, batarg("", dbl), batarg("b", oid), batargany("v", 1), batarg("g", oid), batarg("e", oid), arg("skip_nils", bit))),
  command("calc", "dec_round", bte_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,3, arg("",bte),arg("v",bte),arg("r",bte))),
  pattern("batcalc", "dec_round", bte_bat_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,3, batarg("",bte),batarg("v",bte),arg("r",bte))),
  pattern("batcalc", "dec_round", bte_bat_dec_round_wrap, false, "round off the value v to nearests multiple of r", args(1,4, batarg("",bte),batarg("v",bte),arg("r",bte),batarg("s",oid))),
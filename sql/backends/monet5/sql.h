@@ -76,6 +76,7 @@ extern str mvc_bind_idxbat_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, Instr
 extern str mvc_clear_table_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str mvc_delete_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 extern str SQLtid(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+extern bool SQLrecycleSource(Client cntxt, MalStkPtr stk, InstrPtr pci, int *id, ulng *version);
 extern str DELTAbat(bat *result, const bat *col, const bat *uid, const bat *uval);
 extern str DELTAsub(bat *result, const bat *col, const bat *cid, const bat *uid, const bat *uval);
 extern str DELTAproject(bat *result, const bat *select, const bat *col, const bat *uid, const bat *uval);
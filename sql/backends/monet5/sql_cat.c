@@ -37,6 +37,7 @@
 #include "rel_dump.h"
 #include "orderidx.h"
 #include "sql_user.h"
+#include "rle.h"
 
 #define initcontext()													\
 	if ((msg = getSQLContext(cntxt, mb, &sql, NULL)) != NULL)			\
@@ -530,6 +531,8 @@ alter_table_set_access(mvc *sql, char *sname, char *tname, int access)
 	if (!isTable(t))
 		throw(SQL,"sql.alter_table_set_access",SQLSTATE(42000) "ALTER TABLE: access changes on %sS not supported", TABLE_TYPE_DESCRIPTION(t->type, t->properties));
 	if (t->access != access) {
+		bool was_readonly = t->access == TABLE_READONLY;
+
 		if (access && table_has_updates(sql->session->tr, t))
 			throw(SQL,"sql.alter_table_set_access",SQLSTATE(40000) "ALTER TABLE: set READ or INSERT ONLY not possible with outstanding updates (wait until updates are flushed)\n");
 
@@ -542,6 +545,18 @@ alter_table_set_access(mvc *sql, char *sname, char *tname, int access)
 			default:
 				break;
 		}
+		/* run length encoded columns only exist in read only tables,
+		 * expand them once before the table takes inserts again */
+		if (was_readonly && (t = mvc_bind_table(sql, s, tname))) {
+			for (node *n = ol_first_node(t->columns); n; n = n->next) {
+				sql_column *c = n->data;
+				str msg;
+
+				if (c->storage_type && strcmp(c->storage_type, "RLE") == 0 &&
+					(msg = RLEexpand_column(sql->session->tr, c)) != MAL_SUCCEED)
+					return msg;
+			}
+		}
 	}
 	return MAL_SUCCEED;
 }
@@ -0,0 +1,204 @@
+/*
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 2024 MonetDB Foundation;
+ * Copyright August 2008 - 2023 MonetDB B.V.;
+ * Copyright 1997 - July 2008 CWI.
+ */
+
+/*
+ * Automatic selection of the lightweight column compression.  The
+ * content of a column is analyzed and the cheapest of the available
+ * encodings (frame of reference, dictionary or run length) is applied,
+ * but only when it shrinks the column substantially.
+ */
+#include "monetdb_config.h"
+#include "mal_backend.h"
+#include "sql_scenario.h"
+#include "sql_mvc.h"
+#include "sql_compress.h"
+#include "dict.h"
+#include "for.h"
+#include "rle.h"
+
+typedef enum compress_kind {
+	COMPRESS_NONE,
+	COMPRESS_FOR,
+	COMPRESS_DICT,
+	COMPRESS_RLE
+} compress_kind;
+
+/* dictionaries with more values need int offsets, which hardly save
+ * anything */
+#define COMPRESS_MAX_DICT 65536
+
+static str
+compress_analyze(sql_trans *tr, sql_column *c, compress_kind *kind)
+{
+	sqlstore *store = tr->store;
+	BAT *b, *u;
+	BUN cnt, ucnt;
+	size_t cur, best;
+
+	*kind = COMPRESS_NONE;
+	if (c->storage_type)
+		return MAL_SUCCEED;
+	if (!(b = store->storage_api.bind_col(tr, c, RDONLY)))
+		throw(SQL, "sql.compress", SQLSTATE(HY005) "Cannot access column descriptor");
+	cnt = BATcount(b);
+	if (cnt == 0 || b->twidth == 1) {
+		bat_destroy(b);
+		return MAL_SUCCEED;
+	}
+	cur = best = (size_t) cnt * b->twidth;
+
+	/* frame of reference: not null lng columns with a small value spread */
+	if (!c->null && b->ttype == TYPE_lng) {
+		lng mn, mx;
+
+		if (BATmin(b, &mn) == NULL || BATmax(b, &mx) == NULL) {
+			bat_destroy(b);
+			throw(SQL, "sql.compress", GDK_EXCEPTION);
+		}
+		/* the spread of a lng column may not fit in a lng */
+		ulng spread = (ulng) mx - (ulng) mn;
+		if (!is_lng_nil(mn) && !is_lng_nil(mx) &&
+			spread <= GDK_sht_max) {
+			size_t sz = (size_t) cnt * (spread < GDK_bte_max/2 ? 1 : 2);
+			if (sz < best) {
+				best = sz;
+				*kind = COMPRESS_FOR;
+			}
+		}
+	}
+
+	/* dictionary: few distinct values; first a cheap estimate to skip
+	 * columns that clearly have too many */
+	if (!b->tkey && BATguess_uniques(b, NULL) < 2 * COMPRESS_MAX_DICT) {
+		if (!(u = BATunique(b, NULL))) {
+			bat_destroy(b);
+			throw(SQL, "sql.compress", GDK_EXCEPTION);
+		}
+		ucnt = BATcount(u);
+		bat_destroy(u);
+		if (ucnt < COMPRESS_MAX_DICT) {
+			size_t sz = (size_t) cnt * (ucnt < 256 ? 1 : 2) + (size_t) ucnt * b->twidth;
+			if (sz < best) {
+				best = sz;
+				*kind = COMPRESS_DICT;
+			}
+		}
+	}
+
+	/* run length: sorted or clustered columns with few runs, only in
+	 * tables that do not take inserts */
+	if (!b->tkey && c->t->access == TABLE_READONLY) {
+		BAT *bnd, *val;
+
+		if (BATrleencode(&bnd, &val, b) != GDK_SUCCEED) {
+			bat_destroy(b);
+			throw(SQL, "sql.compress", GDK_EXCEPTION);
+		}
+		size_t sz = BATcount(val) * (sizeof(oid) + b->twidth);
+		bat_destroy(bnd);
+		bat_destroy(val);
+		if (sz < best) {
+			best = sz;
+			*kind = COMPRESS_RLE;
+		}
+	}
+	bat_destroy(b);
+
+	/* only worth it when at least a quarter of the space is saved */
+	if (best > cur / 4 * 3)
+		*kind = COMPRESS_NONE;
+	return MAL_SUCCEED;
+}
+
+static str
+compress_column(sql_trans *tr, sql_schema *s, sqlid tid, const char *cname)
+{
+	compress_kind kind;
+	sql_table *t = find_sql_table_id(tr, s, tid);
+	sql_column *c = t ? find_sql_column(t, cname) : NULL;
+	str msg;
+
+	if (!c)
+		throw(SQL, "sql.compress", SQLSTATE(42S22) "Unknown column %s.%s", t ? t->base.name : "", cname);
+	if ((msg = compress_analyze(tr, c, &kind)) != MAL_SUCCEED)
+		return msg;
+	switch (kind) {
+	case COMPRESS_FOR:
+		return FORcompress_column(tr, c);
+	case COMPRESS_DICT:
+		/* keep the dictionary ordered, that allows range selects on
+		 * the offsets */
+		return DICTcompress_column(tr, c, true);
+	case COMPRESS_RLE:
+		return RLEcompress_column(tr, c);
+	default:
+		return MAL_SUCCEED;
+	}
+}
+
+str
+sql_compress(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	mvc *m = NULL;
+	str msg = getSQLContext(cntxt, mb, &m, NULL);
+	const char *sch, *tbl, *col = NULL;
+	sql_schema *s;
+	sql_table *t;
+
+	if (msg != MAL_SUCCEED || (msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+
+	sch = *getArgReference_str(stk, pci, 1);
+	tbl = *getArgReference_str(stk, pci, 2);
+	if (pci->argc > 3)
+		col = *getArgReference_str(stk, pci, 3);
+	if (strNil(sch))
+		throw(SQL, "sql.compress", SQLSTATE(42000) "Schema name cannot be NULL");
+	if (strNil(tbl))
+		throw(SQL, "sql.compress", SQLSTATE(42000) "Table name cannot be NULL");
+	if (col && strNil(col))
+		throw(SQL, "sql.compress", SQLSTATE(42000) "Column name cannot be NULL");
+
+	if (!(s = mvc_bind_schema(m, sch)))
+		throw(SQL, "sql.compress", SQLSTATE(3F000) "Unknown schema %s", sch);
+	if (!mvc_schema_privs(m, s))
+		throw(SQL, "sql.compress", SQLSTATE(42000) "Access denied for %s to schema '%s'", get_string_global_var(m, "current_user"), s->base.name);
+	if (!(t = mvc_bind_table(m, s, tbl)))
+		throw(SQL, "sql.compress", SQLSTATE(42S02) "Unknown table %s.%s", sch, tbl);
+	if (!isTable(t))
+		throw(SQL, "sql.compress", SQLSTATE(42000) "%s '%s' is not persistent", TABLE_TYPE_DESCRIPTION(t->type, t->properties), t->base.name);
+	if (isTempTable(t))
+		throw(SQL, "sql.compress", SQLSTATE(42000) "columns from temporary tables cannot be compressed");
+	if (t->system)
+		throw(SQL, "sql.compress", SQLSTATE(42000) "columns from system tables cannot be compressed");
+
+	sql_trans *tr = m->session->tr;
+	sqlid tid = t->base.id;
+	if (col) {
+		if (!mvc_bind_column(m, t, col))
+			throw(SQL, "sql.compress", SQLSTATE(42S22) "Unknown column %s.%s.%s", sch, tbl, col);
+		return compress_column(tr, s, tid, col);
+	}
+	/* compressing a column creates a new version of the table, hence
+	 * lookup the column by name in the latest one */
+	list *names = sa_list(m->sa);
+	if (!names)
+		throw(SQL, "sql.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	for (node *n = ol_first_node(t->columns); n; n = n->next) {
+		sql_column *c = n->data;
+		if (!list_append(names, c->base.name))
+			throw(SQL, "sql.compress", SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	}
+	for (node *n = names->h; n && msg == MAL_SUCCEED; n = n->next)
+		msg = compress_column(tr, s, tid, n->data);
+	return msg;
+}
@@ -317,6 +317,134 @@ _create_relational_function(mvc *m, const char *mod, const char *name, sql_rel *
 }
 
 
+/* end the remote transaction and close the connection */
+static int
+_create_relational_remote_end(mvc *m, MalBlkPtr curBlk, int q)
+{
+	InstrPtr p, o;
+
+	/* remote.exec(q, "sql", "deregister"); */
+	p = newInstruction(curBlk, remoteRef, execRef);
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	p = pushArgument(curBlk, p, q);
+	p = pushStr(curBlk, p, sqlRef);
+	p = pushStr(curBlk, p, deregisterRef);
+	getArg(p, 0) = -1;
+
+	o = newFcnCall(curBlk, remoteRef, putRef);
+	if (o == NULL) {
+		freeInstruction(p);
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	o = pushArgument(curBlk, o, q);
+	o = pushInt(curBlk, o, TYPE_int);
+	pushInstruction(curBlk, o);
+	p = pushReturn(curBlk, p, getArg(o, 0));
+	pushInstruction(curBlk, p);
+
+	/* remote.disconnect(q); */
+	p = newStmt(curBlk, remoteRef, disconnectRef);
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	p = pushArgument(curBlk, p, q);
+	pushInstruction(curBlk, p);
+	return 0;
+}
+
+/* return (v1, ..., vn) := (v1, ..., vn) */
+static int
+_create_relational_remote_return(mvc *m, MalBlkPtr curBlk, int *vars, int nr)
+{
+	InstrPtr p = newInstructionArgs(curBlk, NULL, NULL, 2 * nr);
+	int i;
+
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	p->barrier= RETURNsymbol;
+	p->retc = p->argc = 0;
+	for (i = 0; i < nr; i++)
+		p = pushArgument(curBlk, p, vars[i]);
+	p->retc = p->argc;
+	/* assignment of return */
+	for (i = 0; i < nr; i++)
+		p = pushArgument(curBlk, p, vars[i]);
+	pushInstruction(curBlk, p);
+	return 0;
+}
+
+/* on any exception close the remote transaction and raise it again */
+static int
+_create_relational_remote_catch(mvc *m, MalBlkPtr curBlk, int q)
+{
+	InstrPtr p;
+
+	/* catch exceptions */
+	p = newCatchStmt(curBlk, "ANYexception");
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	pushInstruction(curBlk, p);
+	p = newExitStmt(curBlk, "ANYexception");
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	pushInstruction(curBlk, p);
+
+	if (_create_relational_remote_end(m, curBlk, q) < 0)
+		return -1;
+
+	/* the connection may not start (eg bad credentials),
+		so calling 'disconnect' on the catch block may throw another exception, add another catch */
+	p = newCatchStmt(curBlk, "ANYexception");
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	pushInstruction(curBlk, p);
+	p = newExitStmt(curBlk, "ANYexception");
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	pushInstruction(curBlk, p);
+
+	/* throw the exception back */
+	p = newRaiseStmt(curBlk, "RemoteException");
+	if (p == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		return -1;
+	}
+	p = pushStr(curBlk, p, "Exception occurred in the remote server, please check the log there");
+	pushInstruction(curBlk, p);
+	return 0;
+}
+
+/* The remote execution is split in two stubs.  The send stub connects,
+ * ships the plan and its arguments and starts the execution, returning
+ * the connection and the remote handles of the results without waiting
+ * for them.  The receive stub collects the results and ends the remote
+ * transaction.  All remote members of a query are so working at the
+ * same time, while the plan waits for the first one to finish. */
+char *
+relational_remote_send_name(allocator *sa, const char *name)
+{
+	char *sname = sa_strdup(sa, name);
+
+	if (sname)
+		sname[0] = 's';
+	return sname;
+}
+
 /* stub and remote function */
 static int
 _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_rel *rel, sql_rel *rel2, stmt *call, prop *prp)
@@ -328,7 +456,7 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 	sqlid table_id = tu->id;
 	assert(table_id);
 	node *n;
-	int i, q, v, res = -1, added_to_cache = 0, *lret, *rret;
+	int i, q, v, nres, res = -1, added_to_cache = 0, *lret, *rret;
 	size_t len = 1024, nr, pwlen = 0;
 	char *lname = NULL, *rel_str, *buf = NULL, *mal_session_uuid, *err = NULL, *pwhash = NULL;
 	str username = NULL, password = NULL, msg = NULL;
@@ -349,7 +477,7 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
 	}
-	rret = SA_NEW_ARRAY(m->sa, int, list_length(r->exps));
+	rret = SA_NEW_ARRAY(m->sa, int, list_length(r->exps) + 1);
 	if (rret == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
@@ -366,7 +494,11 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
 	}
-	curInstr = relational_func_create_result_part2(curBlk, curInstr, rel2);
+	/* returns the connection and the remote handles of the results */
+	nres = list_length(rel2->exps);
+	curInstr->argc = curInstr->retc = 0;
+	for (i = 0; i <= nres; i++)
+		curInstr = pushReturn(curBlk, curInstr, newTmpVariable(curBlk, TYPE_str));
 	if( curInstr == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
@@ -392,7 +524,7 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 		}
 	}
 
-	/* declare return variables */
+	/* declare result variables, their types go along with the remote handles */
 	if (!list_empty(r->exps)) {
 		for (i = 0, n = r->exps->h; n; n = n->next, i++) {
 			sql_exp *e = n->data;
@@ -688,8 +820,8 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 	} else if (err)
 		free(err);
 
-	/* (x1, x2, ..., xn) := remote.exec(q, "mod", "fcn"); */
-	p = newInstructionArgs(curBlk, remoteRef, execRef, list_length(r->exps) + curInstr->argc - curInstr->retc + 4);
+	/* (x1, x2, ..., xn) := remote.send(q, "mod", "fcn"); */
+	p = newInstructionArgs(curBlk, remoteRef, sendRef, list_length(r->exps) + curInstr->argc - curInstr->retc + 4);
 	if (p == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
@@ -713,7 +845,7 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 			pushInstruction(curBlk, o);
 			v = getArg(o, 0);
 			p = pushReturn(curBlk, p, v);
-			rret[i] = v;
+			rret[i + 1] = v;
 		}
 	}
 
@@ -733,146 +865,108 @@ _create_relational_remote_body(mvc *m, const char *mod, const char *name, sql_re
 	}
 	pushInstruction(curBlk, p);
 
-	/* return results */
-	for (i = 0; i < curInstr->retc; i++) {
-		/* y1 := remote.get(q, x1); */
-		p = newFcnCall(curBlk, remoteRef, getRef);
-		if (p == NULL) {
-			sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-			goto cleanup;
-		}
-		p = pushArgument(curBlk, p, q);
-		p = pushArgument(curBlk, p, rret[i]);
-		pushInstruction(curBlk, p);
-		getArg(p, 0) = lret[i];
-	}
-
-	/* end remote transaction */
-	p = newInstruction(curBlk, remoteRef, execRef);
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	/* return (q, x1, ..., xn) */
+	rret[0] = q;
+	if (_create_relational_remote_return(m, curBlk, rret, nres + 1) < 0 ||
+		_create_relational_remote_catch(m, curBlk, q) < 0)
 		goto cleanup;
-	}
-	p = pushArgument(curBlk, p, q);
-	p = pushStr(curBlk, p, sqlRef);
-	p = pushStr(curBlk, p, deregisterRef);
-	getArg(p, 0) = -1;
 
-	o = newFcnCall(curBlk, remoteRef, putRef);
-	if (o == NULL) {
-		freeInstruction(p);
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
-	}
-	o = pushArgument(curBlk, o, q);
-	o = pushInt(curBlk, o, TYPE_int);
-	pushInstruction(curBlk, o);
-	p = pushReturn(curBlk, p, getArg(o, 0));
-	pushInstruction(curBlk, p);
+	pushEndInstruction(curBlk);
 
-	/* remote.disconnect(q); */
-	p = newStmt(curBlk, remoteRef, disconnectRef);
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
-	}
-	p = pushArgument(curBlk, p, q);
-	pushInstruction(curBlk, p);
+	/* SQL function definitions meant for inlineing should not be optimized before */
+	//for now no inline of the remote function, this gives garbage collection problems
+	//curBlk->inlineProp = 1;
 
-	p = newInstructionArgs(curBlk, NULL, NULL, 2 * curInstr->retc);
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
+	SQLaddQueryToCache(c);
+	added_to_cache = 1;
+	// (str) chkProgram(c->usermodule, c->curprg->def);
+	if (!c->curprg->def->errors)
+		c->curprg->def->errors = SQLoptimizeFunction(c, c->curprg->def);
+	if (c->curprg->def->errors) {
+		sql_error(m, 10, SQLSTATE(42000) "Internal error while compiling statement: %s", c->curprg->def->errors);
+	} else {
+		res = 0;
 	}
-	p->barrier= RETURNsymbol;
-	p->retc = p->argc = 0;
-	for (i = 0; i < curInstr->retc; i++)
-		p = pushArgument(curBlk, p, lret[i]);
-	p->retc = p->argc;
-	/* assignment of return */
-	for (i = 0; i < curInstr->retc; i++)
-		p = pushArgument(curBlk, p, lret[i]);
-	pushInstruction(curBlk, p);
 
-	/* catch exceptions */
-	p = newCatchStmt(curBlk, "ANYexception");
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
-	}
-	pushInstruction(curBlk, p);
-	p = newExitStmt(curBlk, "ANYexception");
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
+cleanup:
+	if (res < 0 && c->curprg) {
+		if (!added_to_cache) /* on error, remove generated symbol from cache */
+			freeSymbol(c->curprg);
+		else
+			SQLremoveQueryFromCache(c);
 	}
-	pushInstruction(curBlk, p);
+	return res;
+}
 
-	/* end remote transaction */
-	p = newInstruction(curBlk, remoteRef, execRef);
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
-	}
-	p = pushArgument(curBlk, p, q);
-	p = pushStr(curBlk, p, sqlRef);
-	p = pushStr(curBlk, p, deregisterRef);
-	getArg(p, 0) = -1;
+/* receive stub */
+static int
+_create_relational_remote_recv(mvc *m, sql_rel *rel2)
+{
+	Client c = MCgetClient(m->clientid);
+	MalBlkPtr curBlk = c->curprg->def;
+	InstrPtr curInstr = getInstrPtr(curBlk, 0), p;
+	int i, q, nres = list_length(rel2->exps), res = -1, added_to_cache = 0, *lret, *rret;
+	node *n;
 
-	o = newFcnCall(curBlk, remoteRef, putRef);
-	if (o == NULL) {
-		freeInstruction(p);
+	lret = SA_NEW_ARRAY(m->sa, int, nres);
+	rret = SA_NEW_ARRAY(m->sa, int, nres);
+	if (lret == NULL || rret == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
 	}
-	o = pushArgument(curBlk, o, q);
-	o = pushInt(curBlk, o, TYPE_int);
-	pushInstruction(curBlk, o);
-	p = pushReturn(curBlk, p, getArg(o, 0));
-	pushInstruction(curBlk, p);
 
-	/* remote.disconnect(q); */
-	p = newStmt(curBlk, remoteRef, disconnectRef);
-	if (p == NULL) {
+	curInstr = relational_func_create_result_part2(curBlk, curInstr, rel2);
+	if( curInstr == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto cleanup;
 	}
-	p = pushArgument(curBlk, p, q);
-	pushInstruction(curBlk, p);
+	/* the connection and the remote handles of the results, as returned by the send stub */
+	q = newTmpVariable(curBlk, TYPE_str);
+	curInstr = pushArgument(curBlk, curInstr, q);
+	for (i = 0; i < nres; i++) {
+		rret[i] = newTmpVariable(curBlk, TYPE_str);
+		curInstr = pushArgument(curBlk, curInstr, rret[i]);
+	}
 
-	/* the connection may not start (eg bad credentials),
-		so calling 'disconnect' on the catch block may throw another exception, add another catch */
-	p = newCatchStmt(curBlk, "ANYexception");
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
+	/* declare return variables */
+	for (i = 0, n = rel2->exps->h; n; n = n->next, i++) {
+		sql_exp *e = n->data;
+		int type = newBatType(exp_subtype(e)->type->localtype);
+
+		p = newFcnCall(curBlk, batRef, newRef);
+		if (p == NULL) {
+			sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			goto cleanup;
+		}
+		p = pushType(curBlk, p, getBatType(type));
+		setArgType(curBlk, p, 0, type);
+		lret[i] = getArg(p, 0);
+		pushInstruction(curBlk, p);
 	}
-	pushInstruction(curBlk, p);
-	p = newExitStmt(curBlk, "ANYexception");
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
-		goto cleanup;
+
+	/* return results, the first get waits for the remote execution to finish */
+	for (i = 0; i < nres; i++) {
+		/* y1 := remote.get(q, x1); */
+		p = newFcnCall(curBlk, remoteRef, getRef);
+		if (p == NULL) {
+			sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			goto cleanup;
+		}
+		p = pushArgument(curBlk, p, q);
+		p = pushArgument(curBlk, p, rret[i]);
+		pushInstruction(curBlk, p);
+		getArg(p, 0) = lret[i];
 	}
-	pushInstruction(curBlk, p);
 
-	/* throw the exception back */
-	p = newRaiseStmt(curBlk, "RemoteException");
-	if (p == NULL) {
-		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+	if (_create_relational_remote_end(m, curBlk, q) < 0 ||
+		_create_relational_remote_return(m, curBlk, lret, nres) < 0 ||
+		_create_relational_remote_catch(m, curBlk, q) < 0)
 		goto cleanup;
-	}
-	p = pushStr(curBlk, p, "Exception occurred in the remote server, please check the log there");
-	pushInstruction(curBlk, p);
 
 	pushEndInstruction(curBlk);
 
-	/* SQL function definitions meant for inlineing should not be optimized before */
-	//for now no inline of the remote function, this gives garbage collection problems
-	//curBlk->inlineProp = 1;
-
 	SQLaddQueryToCache(c);
 	added_to_cache = 1;
-	// (str) chkProgram(c->usermodule, c->curprg->def);
 	if (!c->curprg->def->errors)
 		c->curprg->def->errors = SQLoptimizeFunction(c, c->curprg->def);
 	if (c->curprg->def->errors) {
@@ -916,13 +1010,14 @@ _create_relational_remote(mvc *m, const char *mod, const char *name, sql_rel *re
 		goto bailout;
 	}
 
-	/* create stub */
-	int nargs;
-	sql_rel *rel2 = relational_func_create_result_part1(m, rel, &nargs);
+	/* create send stub */
+	int nargs, nres;
+	sql_rel *rel2 = relational_func_create_result_part1(m, rel, &nres);
+	const char *sname = relational_remote_send_name(m->sa, name);
+	nargs = nres + 1;
 	if (call && call->type == st_list)
 		nargs += list_length(call->op4.lval);
-	c->curprg = newFunctionArgs(putName(mod), putName(name), FUNCTIONsymbol, nargs);
-	if (c->curprg == NULL) {
+	if (sname == NULL || (c->curprg = newFunctionArgs(putName(mod), putName(sname), FUNCTIONsymbol, nargs)) == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto bailout;
 	} else if (eb_savepoint(&m->sa->eb)) {
@@ -932,6 +1027,18 @@ _create_relational_remote(mvc *m, const char *mod, const char *name, sql_rel *re
 	} else if (_create_relational_remote_body(m, mod, name, rel, rel2, call, prp) < 0) {
 		goto bailout;
 	}
+
+	/* create receive stub */
+	if ((c->curprg = newFunctionArgs(putName(mod), putName(name), FUNCTIONsymbol, 2 * nres + 1)) == NULL) {
+		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+		goto bailout;
+	} else if (eb_savepoint(&m->sa->eb)) {
+		sql_error(m, 10, "%s", m->sa->eb.msg);
+		freeSymbol(c->curprg);
+		goto bailout;
+	} else if (_create_relational_remote_recv(m, rel2) < 0) {
+		goto bailout;
+	}
 	sa_reset(m->ta);
 	c->curprg = symbackup;
 	m->sa->eb = ebsave;
@@ -980,6 +1087,26 @@ sql_relation2stmt(backend *be, sql_rel *r, int top)
 	return s;
 }
 
+/* End the plan.  The merge table members left out on their statistics
+ * are shown as comments after it, where the optimizers leave them. */
+int
+backend_dumpend(backend *be, MalBlkPtr mb)
+{
+	mvc *m = be->mvc;
+	InstrPtr q;
+
+	pushEndInstruction(mb);
+	for (node *n = m->skipped ? m->skipped->h : NULL; n; n = n->next) {
+		if ((q = newComment(mb, n->data)) == NULL) {
+			sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
+			return -1;
+		}
+		pushInstruction(mb, q);
+	}
+	m->skipped = NULL;
+	return 0;
+}
+
 static int
 #if defined(__GNUC__) && __GNUC__ == 4 && __GNUC_MINOR__ <= 8
 /* bug on CentOS 7 (gnuc 4.8.5) where this function gets inlined and
@@ -1035,8 +1162,8 @@ backend_dumpstmt_body(backend *be, MalBlkPtr mb, sql_rel *r, int top, int add_en
 		}
 		pushInstruction(mb, q);
 	}
-	if (add_end)
-		pushEndInstruction(mb);
+	if (add_end && backend_dumpend(be, mb) < 0)
+		return -1;
 	if (querylog)
 		(void) pushInt(mb, querylog, mb->stop);
 	return 0;
@@ -1066,9 +1193,11 @@ backend_dumpstmt(backend *be, MalBlkPtr mb, sql_rel *r, int top, int add_end, co
 	return -1;
 }
 
+static MT_Lock sql_gencodeLock = MT_LOCK_INITIALIZER(sql_gencodeLock);
+
 /* SQL procedures, functions and PREPARE statements are compiled into a parameterised plan */
 static int
-backend_dumpproc_body(backend *be, Client c, sql_rel *r)
+backend_dumpproc_body(backend *be, Client c, sql_rel *r, Module shared)
 {
 	mvc *m = be->mvc;
 	MalBlkPtr mb = 0;
@@ -1116,11 +1245,23 @@ backend_dumpproc_body(backend *be, Client c, sql_rel *r)
 	if ((res = backend_dumpstmt(be, mb, r, m->emode == m_prepare, 1, be->q ? be->q->f->query : NULL)) < 0)
 		goto cleanup;
 
-	SQLaddQueryToCache(c);
-	added_to_cache = 1;
-	// optimize this code the 'old' way
-	if (m->emode == m_prepare && !c->curprg->def->errors)
-		c->curprg->def->errors = SQLoptimizeFunction(c,c->curprg->def);
+	if (shared) {
+		/* shared plans only become visible to other sessions once optimized */
+		if (!c->curprg->def->errors)
+			c->curprg->def->errors = SQLoptimizeFunction(c,c->curprg->def);
+		if (!c->curprg->def->errors) {
+			MT_lock_set(&sql_gencodeLock);
+			insertSymbol(shared, c->curprg);
+			MT_lock_unset(&sql_gencodeLock);
+			added_to_cache = 1;
+		}
+	} else {
+		SQLaddQueryToCache(c);
+		added_to_cache = 1;
+		// optimize this code the 'old' way
+		if (m->emode == m_prepare && !c->curprg->def->errors)
+			c->curprg->def->errors = SQLoptimizeFunction(c,c->curprg->def);
+	}
 	if (c->curprg->def->errors) {
 		sql_error(m, 10, SQLSTATE(42000) "Internal error while compiling statement: %s", c->curprg->def->errors);
 	} else {
@@ -1137,22 +1278,20 @@ cleanup:
 	return res;
 }
 
-int
-backend_dumpproc(backend *be, Client c, cq *cq, sql_rel *r)
+static int
+backend_dumpproc_(backend *be, Client c, const char *mod, const char *name, sql_rel *r, Module shared)
 {
 	mvc *m = be->mvc;
 	Symbol symbackup = c->curprg;
 	backend bebackup = *be;		/* backup current backend */
 	exception_buffer ebsave = m->sa->eb;
 	int argc = 1;
-	const char *sql_private_module = putName(sql_private_module_name);
 
 	if (m->params)
 		argc += list_length(m->params);
 	if (argc < MAXARG)
 		argc = MAXARG;
-	assert(cq && strlen(cq->name) < IDLENGTH);
-	c->curprg = newFunctionArgs(sql_private_module, cq->name = putName(cq->name), FUNCTIONsymbol, argc);
+	c->curprg = newFunctionArgs(mod, name, FUNCTIONsymbol, argc);
 	if (c->curprg == NULL) {
 		sql_error(m, 10, SQLSTATE(HY013) MAL_MALLOC_FAIL);
 		goto bailout;
@@ -1160,7 +1299,7 @@ backend_dumpproc(backend *be, Client c, cq *cq, sql_rel *r)
 		sql_error(m, 10, "%s", m->sa->eb.msg);
 		freeSymbol(c->curprg);
 		goto bailout;
-	} else if (backend_dumpproc_body(be, c, r) < 0) {
+	} else if (backend_dumpproc_body(be, c, r, shared) < 0) {
 		goto bailout;
 	}
 	*be = bebackup;
@@ -1174,6 +1313,24 @@ backend_dumpproc(backend *be, Client c, cq *cq, sql_rel *r)
 	return -1;
 }
 
+int
+backend_dumpproc(backend *be, Client c, cq *cq, sql_rel *r)
+{
+	assert(cq && strlen(cq->name) < IDLENGTH);
+	cq->name = putName(cq->name);
+	return backend_dumpproc_(be, c, putName(sql_private_module_name), cq->name, r, NULL);
+}
+
+/* Plans of auto-parameterized queries are compiled into the shared module,
+ * from where they are called by all sessions. */
+int
+backend_dumpplan(backend *be, Client c, sql_func *f, sql_rel *r)
+{
+	const char *sql_shared_module = putName(sql_shared_module_name);
+
+	return backend_dumpproc_(be, c, sql_shared_module, putName(f->imp), r, getModule(sql_shared_module));
+}
+
 int
 monet5_has_module(ptr M, char *module)
 {
@@ -1187,8 +1344,6 @@ monet5_has_module(ptr M, char *module)
 	return 0;
 }
 
-static MT_Lock sql_gencodeLock = MT_LOCK_INITIALIZER(sql_gencodeLock);
-
 static str
 monet5_cache_remove(Module m, const char *nme)
 {
@@ -22,7 +22,9 @@
 #include "mal_function.h"
 
 extern int backend_dumpproc(backend *be, Client c, cq *q, sql_rel *r);
+extern int backend_dumpplan(backend *be, Client c, sql_func *f, sql_rel *r);
 extern int backend_dumpstmt(backend *be, MalBlkPtr mb, sql_rel *r, int top, int addend, const char *query);
+extern int backend_dumpend(backend *be, MalBlkPtr mb);
 extern int monet5_has_module(ptr M, char *module);
 extern void monet5_freecode(const char *mod, int clientid, const char *name);
 extern int monet5_resolve_function(ptr M, sql_func *f, const char *fimp, bool *side_effect);
@@ -41,5 +43,6 @@ extern int constantAtom(backend *be, MalBlkPtr mb, atom *a);
 extern InstrPtr table_func_create_result(MalBlkPtr mb, InstrPtr q, sql_func *f, list *restypes);
 extern sql_rel *relational_func_create_result_part1(mvc *sql, sql_rel *r, int *nargs);
 extern InstrPtr relational_func_create_result_part2(MalBlkPtr mb, InstrPtr q, sql_rel *r);
+extern char *relational_remote_send_name(allocator *sa, const char *name);
 
 #endif /* _SQL2MAL_H */
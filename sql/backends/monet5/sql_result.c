@@ -1853,6 +1853,31 @@ mvc_export_result(backend *b, stream *s, int res_id, bool header, lng starttime,
 	return res;
 }
 
+/* Write the rows of a result table of a pipelined COPY INTO export.  The
+ * columns are first replaced by those of the next partition, if given. */
+int
+mvc_export_partition(backend *b, stream *s, int res_id, BAT **cols)
+{
+	res_table *t = res_tables_find(b->results, res_id);
+
+	if (!s || !t)
+		return 0;
+	if (cols) {
+		for (int i = 0; i < t->nr_cols; i++) {
+			res_col *c = t->cols + i;
+
+			assert(!c->cached);
+			BBPretain(cols[i]->batCacheid);
+			BBPrelease(c->b);
+			c->b = cols[i]->batCacheid;
+		}
+		t->nr_rows = BATcount(cols[0]);
+	}
+	if (b->output_format == OFMT_NONE)
+		return 0;
+	return mvc_export_table(b, s, t, 0, t->nr_rows, "", t->tsep, t->rsep, t->ssep, t->ns);
+}
+
 int
 mvc_export_chunk(backend *b, stream *s, int res_id, BUN offset, BUN nr)
 {
@@ -41,7 +41,9 @@
 #include "mal_namespace.h"
 #include "mal_linker.h"
 #include "mal_scenario.h"
+#include "mal_session.h"
 #include "mal_authorize.h"
+#include "mal_recycle.h"
 #include "mcrypt.h"
 #include "mutils.h"
 #include "bat5.h"
@@ -55,6 +57,9 @@
 #include "sql_upgrades.h"
 #include "rel_semantic.h"
 #include "rel_rel.h"
+#include "rel_exp.h"
+#include "rel_psm.h"
+#include "rel_rewriter.h"
 
 #define MAX_SQL_MODULES 128
 static int sql_modules = 0;
@@ -273,6 +278,8 @@ SQLexit(Client c)
 	(void) c;		/* not used */
 	MT_lock_set(&sql_contextLock);
 	if (SQLstore) {
+		qc_plan_clean();
+		RECYCLEsetsource(NULL);
 		mvc_exit(SQLstore);
 		SQLstore = NULL;
 	}
@@ -548,6 +555,20 @@ SQLprepareClient(Client c, const char *pwhash, const char *challenge, const char
 				m->reply_size = value;
 			} else if (sscanf(tok, "size_header=%d", &value) == 1) {
 				be->sizeheader = value != 0;
+			} else if (sscanf(tok, "block_size=%d", &value) == 1) {
+				if (value < 0 || value > MAX_BLOCK) {
+					msg = createException(SQL, "SQLprepareClient", SQLSTATE(42000) "Block_size must be between 0 and %d", MAX_BLOCK);
+					goto bailout1;
+				}
+				/* switched to after the welcome, see SQLreader */
+				c->blocksize = value > BLOCK ? (size_t) value : BLOCK;
+			} else if (strncmp(tok, "compression=", 12) == 0) {
+				/* clients only ask for the methods offered in the
+				 * challenge, otherwise we do without */
+				if (!block_stream_compression(tok + 12, &c->compression))
+					c->compression = BS_COMPRESSION_NONE;
+			} else if (sscanf(tok, "compression_level=%d", &value) == 1) {
+				c->compressionlevel = value;
 			} else if (sscanf(tok, "columnar_protocol=%d", &value) == 1) {
 				c->protocol = (value != 0) ? PROTOCOL_COLUMNAR : PROTOCOL_9;
 			} else if (sscanf(tok, "time_zone=%d", &value) == 1) {
@@ -669,6 +690,7 @@ SQLinit(Client c, const char *initpasswd)
 		MT_lock_unset(&sql_contextLock);
 		throw(SQL, "SQLinit", SQLSTATE(42000) "Catalogue initialization failed");
 	}
+	RECYCLEsetsource(SQLrecycleSource);
 	sqlinit = GDKgetenv("sqlinit");
 	if (sqlinit) {		/* add sqlinit to the fdin stack */
 		buffer *b = (buffer *) GDKmalloc(sizeof(buffer));
@@ -1091,6 +1113,10 @@ SQLreader(Client c, backend *be)
 	language = be->language;	/* 'S', 's' or 'X' */
 	m = be->mvc;
 	m->errstr[0] = 0;
+	if (language == 0) {
+		/* a parked session may continue on another thread */
+		mvc_set_stack(m);
+	}
 	/*
 	 * Continue processing any left-over input from the previous round.
 	 */
@@ -1150,7 +1176,24 @@ SQLreader(Client c, backend *be)
 					go = false;
 					break;
 				}
+				/* the client switches to the negotiated block size
+				 * and compression once it has seen the welcome, i.e.
+				 * the first prompt */
+				if (go && blocked && c->blocksize > BLOCK
+					&& (block_stream_set_size(c->fdout, c->blocksize) < 0
+						|| block_stream_set_size(in->s, c->blocksize) < 0
+						|| block_stream_set_compression(c->fdout, c->compression, c->compressionlevel) < 0
+						|| block_stream_set_compression(in->s, c->compression, c->compressionlevel) < 0)) {
+					go = false;
+					break;
+				}
 				in->eof = false;
+				/* give up the thread while waiting for the next request,
+				 * whose language is then read when the session resumes */
+				if (go && blocked && MSparkClient(c)) {
+					be->language = 0;
+					return msg;
+				}
 			}
 			while (bstream_getoob(in) > 0)
 				;
@@ -1334,6 +1377,200 @@ SQLchannelcmd(Client c, backend *be)
 
 #define MAX_QUERY 	(64*1024*1024)
 
+static sql_rel *
+rel_count_distributed(visitor *v, sql_rel *rel)
+{
+	if (is_basetable(rel->op) && rel->l) {
+		sql_table *t = (sql_table *) rel->l;
+
+		if (isMergeTable(t) || isReplicaTable(t) || isRemote(t) ||
+			(t->s && t->s->parts && partition_find_part(v->sql->session->tr, t, NULL)))
+			v->changes++;
+	}
+	return rel;
+}
+
+/* Plans over merge, partitioned, replica and remote tables need the
+ * constants: members are pruned on them and remote plans are shipped
+ * with them, parameters are unknown over there. */
+static bool
+rel_is_distributed(mvc *m, sql_rel *rel)
+{
+	visitor v = { .sql = m };
+
+	rel = rel_visitor_topdown(&v, rel, &rel_count_distributed);
+	return rel && v.changes > 0;
+}
+
+static bool
+exp_is_parameter(sql_exp *e)
+{
+	return e && e->type == e_atom && !e->l && !e->r && !e->f;
+}
+
+static sql_exp *
+exp_bind_parameter(visitor *v, sql_rel *rel, sql_exp *e, int depth)
+{
+	(void) depth;
+	if (is_select(rel->op) && rel->l && e->type == e_cmp && is_theta_exp(e->flag)) {
+		sql_exp *l = e->l, *r = e->r, *f = e->f;
+		sql_column *c;
+
+		if (!f && exp_is_parameter(l)) {
+			l = e->r;
+			r = e->l;
+		}
+		if (l->type == e_column && (c = exp_find_column(rel->l, l, -2)) != NULL) {
+			int tpe = c->type.type->localtype;
+
+			if (exp_is_parameter(r) && exp_subtype(r)->type->localtype == tpe &&
+				qc_plan_bind(v->data, r->flag, c) < 0)
+				return NULL;
+			if (exp_is_parameter(f) && exp_subtype(f)->type->localtype == tpe &&
+				qc_plan_bind(v->data, f->flag, c) < 0)
+				return NULL;
+		}
+	}
+	return e;
+}
+
+/* Remember the columns the parameters select on, see qp_pruned. */
+static int
+rel_bind_parameters(mvc *m, sql_rel *rel, qp *p)
+{
+	visitor v = { .sql = m, .data = p };
+
+	return rel_exp_visitor_topdown(&v, rel, &exp_bind_parameter, true) ? 0 : -1;
+}
+
+/* The regular compilation prunes a selection on a constant at or beyond
+ * the minimum or maximum of its column, the shared plan would scan it. */
+static bool
+qp_pruned(mvc *m, qp *p, list *args)
+{
+	if (!p->cols)
+		return false;
+	for (node *n = p->cols->h; n; n = n->next) {
+		qp_col *b = n->data;
+		sql_schema *s = mvc_bind_schema(m, b->sname);
+		sql_table *t = s ? mvc_bind_table(m, s, b->tname) : NULL;
+		sql_column *c = t ? mvc_bind_column(m, t, b->cname) : NULL;
+		sql_exp *e = list_fetch(args, b->nr);
+		bool nonil = false, unique = false, pruned = false;
+		double unique_est = 0.0;
+		ValRecord min, max;
+		atom a;
+		int ok;
+
+		if (!c || !e)
+			return true;
+		ok = mvc_col_stats(m, c, &nonil, &unique, &unique_est, &min, &max);
+		if ((ok & 1) == 1) {
+			if (!VALisnil(&min)) {
+				a = (atom) { .tpe = c->type, .data = min };
+				pruned |= atom_cmp(e->l, &a) <= 0;
+			}
+			VALclear(&min);
+		}
+		if ((ok & 2) == 2) {
+			if (!VALisnil(&max)) {
+				a = (atom) { .tpe = c->type, .data = max };
+				pruned |= atom_cmp(e->l, &a) >= 0;
+			}
+			VALclear(&max);
+		}
+		if (pruned)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Queries which only differ in their constants share their plan with all
+ * sessions. The constants are lifted into parameters and the shape of the
+ * query is looked up in the plan cache. On a miss the shape is compiled
+ * once, like a prepared statement, into the shared module. The session
+ * then only calls the shared plan with its own constants.
+ * Returns NULL when the query has to be compiled the regular way.
+ */
+static sql_rel *
+SQLsharedplan(Client c, backend *be)
+{
+	mvc *m = be->mvc;
+	sql_trans *tr = m->session->tr;
+	int schema_version = (int) ATOMIC_GET(&m->session->schema_version);
+	list *values = NULL, *args, *tl;
+	symbol *sym;
+	char *ctx, *key = NULL;
+	qp *p;
+
+	/* plans depend on the catalog, which should not be changed by the transaction itself */
+	if (!qc_plan_capacity() || m->emode != m_normal || m->emod != mod_none || m->params || be->subbackend ||
+		!list_empty(tr->changes) || has_snapshots(tr) || (tr->localtmps && !os_empty(tr->localtmps, tr)))
+		return NULL;
+	ctx = sa_message(m->sa, "%d,%d,%d,%u,%d,%d,%s,%s", m->user_id, m->role_id, m->timezone, m->div_min_scale,
+					 m->sql_optimizer, m->no_int128, getSQLoptimizer(m), m->session->schema_name);
+	for (node *n = m->schema_path->h; n && ctx; n = n->next)
+		ctx = sa_message(m->sa, "%s,%s", ctx, (char *) n->data);
+	if (!ctx || !(sym = qc_shape(m, m->sym, ctx, &key, &values))) {
+		m->params = NULL;
+		return NULL;
+	}
+
+	if (!(p = qc_plan_find(key, schema_version))) {
+		sql_rel *r;
+
+		m->emode = m_prepare;
+		r = sql_symbol2relation(be, sym);
+		if (r && !mvc_status(m) && !rel_is_distributed(m, r) && (p = qc_plan_create(key, schema_version, m->params)) != NULL) {
+			if (rel_bind_parameters(m, r, p) < 0 || backend_dumpplan(be, c, p->f, r) < 0) {
+				qc_plan_release(p);
+				p = NULL;
+			} else {
+				qc_plan_publish(p, m->type);
+			}
+		}
+		m->emode = m_normal;
+		be->no_mitosis = 0;
+		if (!p) {
+			/* forget about the failed attempt */
+			*m->errstr = 0;
+			m->session->status = 0;
+			m->params = NULL;
+			qc_plan_reject(key, schema_version);
+			return NULL;
+		}
+	}
+	m->params = NULL;
+	if (!p->f) {
+		qc_plan_release(p);
+		return NULL;
+	}
+
+	args = sa_list(m->sa);
+	tl = sa_list(m->sa);
+	for (node *n = values->h, *o = p->f->ops->h; n && o; n = n->next, o = o->next) {
+		sql_arg *a = o->data;
+		atom *v = qc_plan_arg(m->sa, n->data, &a->type);
+
+		if (!v) {
+			/* the constant doesn't fit the type of the parameter */
+			qc_plan_release(p);
+			return NULL;
+		}
+		append(args, exp_atom(m->sa, v));
+		append(tl, &a->type);
+	}
+	if (qp_pruned(m, p, args)) {
+		qc_plan_release(p);
+		return NULL;
+	}
+	be->plan = p;
+	m->type = p->type;
+	m->emod |= mod_exec;
+	return rel_psm_stmt(m->sa, exp_op(m->sa, list_empty(args) ? NULL : args, sql_dup_subfunc(m->sa, p->f, tl, NULL)));
+}
+
 static str
 SQLparser_body(Client c, backend *be)
 {
@@ -1422,7 +1659,10 @@ SQLparser_body(Client c, backend *be)
 		sqlcleanup(be, 0);
 		return msg;
 	} else {
-		sql_rel *r = sql_symbol2relation(be, m->sym);
+		sql_rel *r = SQLsharedplan(c, be);
+
+		if (!r)
+			r = sql_symbol2relation(be, m->sym);
 
 		if (!r || (err = mvc_status(m) && m->type != Q_TRANS && *m->errstr)) {
 			if (strlen(m->errstr) > 6 && m->errstr[5] == '!')
@@ -1491,7 +1731,8 @@ SQLparser_body(Client c, backend *be)
 				m->session->status = -10;
 			if (err == 0) {
 				/* no parsing error encountered, finalize the code of the query wrapper */
-				pushEndInstruction(c->curprg->def);
+				if (backend_dumpend(be, c->curprg->def) < 0)
+					msg = createException(SQL, "SQLparser", SQLSTATE(HY013) MAL_MALLOC_FAIL);
 
 				/* check the query wrapper for errors */
 				if (msg == MAL_SUCCEED)
@@ -1649,7 +1890,7 @@ SQLengine_(Client c)
 	}
 
 	str msg = SQLreader(c, be);
-	if (msg || c->mode <= FINISHCLIENT)
+	if (msg || c->mode <= FINISHCLIENT || c->parked)
 		return msg;
 
 	if (be->language == 'X') {
@@ -645,7 +645,9 @@ stmt_bat(backend *be, sql_column *c, int access, int partition)
 
 	c = find_real_column(be, c);
 
-	if (access == RD_EXT)
+	/* the bounds of a run length encoded column have one entry per
+	 * run, these cannot be split on the row count */
+	if (access == RD_EXT || (c->storage_type && c->storage_type[0] == 'R'))
 		partition = 0;
 
 	/* for read access tid.project(col) */
@@ -1388,6 +1390,59 @@ stmt_sample(backend *be, stmt *s, stmt *sample, stmt *seed)
 	return NULL;
 }
 
+/* Keep all candidates when the scalar condition holds, none otherwise.
+ * Unlike a select on the condition this does not touch the columns. */
+stmt *
+stmt_guard(backend *be, stmt *cand, stmt *cond)
+{
+	MalBlkPtr mb = be->mb;
+	InstrPtr q = NULL;
+	int last;
+
+	if (cand == NULL || cond == NULL || cand->nr < 0 || cond->nr < 0)
+		goto bailout;
+	q = newStmt(mb, calcRef, ifthenelseRef);
+	if (q == NULL)
+		goto bailout;
+	setVarType(mb, getArg(q, 0), TYPE_lng);
+	q = pushArgument(mb, q, cond->nr);
+	q = pushNil(mb, q, TYPE_lng);
+	q = pushLng(mb, q, -1);
+	last = getDestVar(q);
+	pushInstruction(mb, q);
+
+	q = newStmt(mb, algebraRef, sliceRef);
+	if (q == NULL)
+		goto bailout;
+	q = pushArgument(mb, q, cand->nr);
+	q = pushLng(mb, q, 0);
+	q = pushArgument(mb, q, last);
+
+	bool enabled = be->mvc->sa->eb.enabled;
+	be->mvc->sa->eb.enabled = false;
+	stmt *ns = stmt_create(be->mvc->sa, st_limit);
+	be->mvc->sa->eb.enabled = enabled;
+	if (ns == NULL) {
+		freeInstruction(q);
+		goto bailout;
+	}
+
+	ns->op1 = cand;
+	ns->op2 = cond;
+	ns->nrcols = cand->nrcols;
+	ns->key = cand->key;
+	ns->aggr = cand->aggr;
+	ns->q = q;
+	ns->nr = getDestVar(q);
+	pushInstruction(mb, q);
+	return ns;
+
+  bailout:
+	if (be->mvc->sa->eb.enabled)
+		eb_error(&be->mvc->sa->eb, be->mvc->errstr[0] ? be->mvc->errstr : mb->errors ? mb->errors : *GDKerrbuf ? GDKerrbuf : "out of memory", 1000);
+	return NULL;
+}
+
 
 stmt *
 stmt_order(backend *be, stmt *s, int direction, int nullslast)
@@ -2736,6 +2791,49 @@ stmt_for(backend *be, stmt *op1, stmt *min_val)
 	return NULL;
 }
 
+stmt *
+stmt_rle(backend *be, stmt *bounds, stmt *values)
+{
+	MalBlkPtr mb = be->mb;
+	InstrPtr q = NULL;
+
+	if (bounds == NULL || values == NULL || bounds->nr < 0 || values->nr < 0)
+		return NULL;
+
+	q = newStmt(mb, rleRef, decompressRef);
+	if (q == NULL)
+		goto bailout;
+	setVarType(mb, getArg(q, 0), getArgType(mb, values->q, 0));
+	q = pushArgument(mb, q, bounds->nr);
+	q = pushArgument(mb, q, values->nr);
+
+	bool enabled = be->mvc->sa->eb.enabled;
+	be->mvc->sa->eb.enabled = false;
+	stmt *s = stmt_create(be->mvc->sa, st_join);
+	be->mvc->sa->eb.enabled = enabled;
+	if (s == NULL) {
+		freeInstruction(q);
+		return NULL;
+	}
+
+	s->op1 = bounds;
+	s->op2 = values;
+	s->flag = cmp_project;
+	s->key = 0;
+	s->nrcols = 1;
+	s->nr = getDestVar(q);
+	s->q = q;
+	s->tname = values->tname;
+	s->cname = values->cname;
+	pushInstruction(mb, q);
+	return s;
+
+  bailout:
+	if (be->mvc->sa->eb.enabled)
+		eb_error(&be->mvc->sa->eb, be->mvc->errstr[0] ? be->mvc->errstr : mb->errors ? mb->errors : *GDKerrbuf ? GDKerrbuf : "out of memory", 1000);
+	return NULL;
+}
+
 stmt *
 stmt_join2(backend *be, stmt *l, stmt *ra, stmt *rb, int cmp, int anti, int symmetric, int swapped)
 {
@@ -3166,6 +3264,22 @@ stmt_catalog(backend *be, int type, stmt *args)
 	s->q = q;
 	s->nr = getDestVar(q);
 	pushInstruction(mb, q);
+	/* UDF languages with a prepare function in their MAL module get it called
+	 * on a new function, e.g. to compile C UDFs ahead of their first call */
+	if (type == ddl_create_function) {
+		stmt *fs = args->op4.lval->h->next->next->data;
+		sql_func *f = fs->op4.aval->data.val.pval;
+		Module m;
+
+		if (LANG_EXT(f->lang) && f->mod && (m = getModule(putName(f->mod))) &&
+			findSymbolInModule(m, putName("prepare"))) {
+			q = newStmtArgs(mb, f->mod, "prepare", 2);
+			if (q == NULL)
+				goto bailout;
+			q = pushPtr(mb, q, f);
+			pushInstruction(mb, q);
+		}
+	}
 	return s;
 
   bailout:
@@ -4285,8 +4399,28 @@ stmt_func(backend *be, stmt *ops, const char *name, sql_rel *rel, int f_union)
 
 	int nargs;
 	sql_rel *r = relational_func_create_result_part1(be->mvc, rel, &nargs);
+	InstrPtr sq = NULL;
 	if (ops)
 		nargs += list_length(ops->op4.lval);
+	if (p && !f_union) {
+		/* (c, x1, ..., xn) := user.s1(args) starts the remote execution,
+		 * (y1, ..., yn) := user.%1(c, x1, ..., xn) collects its results */
+		const char *sname = relational_remote_send_name(be->mvc->sa, name);
+
+		if (sname == NULL || (sq = newStmtArgs(mb, sql_private_module_name, sname, nargs + 1)) == NULL)
+			goto bailout;
+		sq->argc = sq->retc = 0;
+		for (int i = 0; i <= list_length(r->exps); i++)
+			sq = pushReturn(mb, sq, newTmpVariable(mb, TYPE_str));
+		if (ops) {
+			for (node *n = ops->op4.lval->h; n; n = n->next) {
+				stmt *op = n->data;
+
+				sq = pushArgument(mb, sq, op->nr);
+			}
+		}
+		pushInstruction(mb, sq);
+	}
 	if (f_union)
 		q = newStmt(mb, batmalRef, multiplexRef);
 	else
@@ -4298,7 +4432,10 @@ stmt_func(backend *be, stmt *ops, const char *name, sql_rel *rel, int f_union)
 		q = pushStr(mb, q, sql_private_module_name);
 		q = pushStr(mb, q, name);
 	}
-	if (ops) {
+	if (sq) {
+		for (int i = 0; i < sq->retc; i++)
+			q = pushArgument(mb, q, getArg(sq, i));
+	} else if (ops) {
 		for (node *n = ops->op4.lval->h; n; n = n->next) {
 			stmt *op = n->data;
 
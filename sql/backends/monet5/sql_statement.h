@@ -222,6 +222,7 @@ extern stmt *stmt_project_delta(backend *be, stmt *col, stmt *upd);
 extern stmt *stmt_left_project(backend *be, stmt *op1, stmt *op2, stmt *op3);
 extern stmt *stmt_dict(backend *be, stmt *op1, stmt *op2);
 extern stmt *stmt_for(backend *be, stmt *op1, stmt *minval);
+extern stmt *stmt_rle(backend *be, stmt *bounds, stmt *values);
 
 extern stmt *stmt_list(backend *be, list *l);
 extern void stmt_set_nrcols(stmt *s);
@@ -246,6 +247,7 @@ extern stmt *stmt_result(backend *be, stmt *s, int nr);
  */
 extern stmt *stmt_limit(backend *sa, stmt *c, stmt *piv, stmt *gid, stmt *offset, stmt *limit, int distinct, int dir, int nullslast, int last, int order);
 extern stmt *stmt_sample(backend *be, stmt *s, stmt *sample, stmt *seed);
+extern stmt *stmt_guard(backend *be, stmt *cand, stmt *cond);
 extern stmt *stmt_order(backend *be, stmt *s, int direction, int nullslast);
 extern stmt *stmt_reorder(backend *be, stmt *s, int direction, int nullslast, stmt *orderby_ids, stmt *orderby_grp);
 
@@ -181,7 +181,7 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 					if (col && strcmp(c->base.name, col))
 						continue;
 
-					int access = c->storage_type && c->storage_type[0] == 'D' ? RD_EXT : RDONLY;
+					int access = c->storage_type && (c->storage_type[0] == 'D' || c->storage_type[0] == 'R') ? RD_EXT : RDONLY;
 					if (!(b = store->storage_api.bind_col(tr, c, access)))
 						continue; /* At the moment we ignore the error, but maybe we can change this */
 					if (VIEWtparent(b)) { /* If it is a view get the parent BAT */
@@ -353,7 +353,7 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							continue;
 						int w;
 						lng cnt;
-						bit un, hnils, issorted, isrevsorted, dict;
+						bit un, hnils, issorted, isrevsorted, dict, rle = false;
 						BAT *qd = NULL, *fb = NULL, *re = NULL;
 
 						if (cname && strcmp(c->base.name, cname))
@@ -365,7 +365,7 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 						}
 						BATiter qdi = bat_iterator(qd);
 						BATiter posi;
-						if ((dict = (c->storage_type && c->storage_type[0] == 'D'))) {
+						if ((dict = (c->storage_type && (c->storage_type[0] == 'D' || c->storage_type[0] == 'R')))) {
 							if (!(re = store->storage_api.bind_col(tr, c, RD_EXT))) {
 								bat_iterator_end(&qdi);
 								msg = createException(SQL, "sql.statistics", SQLSTATE(HY005) "Cannot access column descriptor");
@@ -383,8 +383,17 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 									goto bailout;
 								}
 							}
-							issorted = qdi.sorted && rei.sorted;
-							isrevsorted = qdi.revsorted && rei.revsorted;
+							if ((rle = c->storage_type[0] == 'R')) {
+								/* the bounds of the runs always ascend */
+								issorted = rei.sorted;
+								isrevsorted = rei.revsorted;
+								w = rei.width;
+								cnt = (lng) store->storage_api.count_col(tr, c, RDONLY);
+								un = rei.key && (BUN) cnt == qdi.count - 1;
+							} else {
+								issorted = qdi.sorted && rei.sorted;
+								isrevsorted = qdi.revsorted && rei.revsorted;
+							}
 							hnils = !rei.nonil || rei.nil;
 							posi = bat_iterator_copy(&rei);
 							bat_iterator_end(&rei);
@@ -395,9 +404,11 @@ sql_statistics(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							posi = bat_iterator_copy(&qdi);
 						}
 
-						w = qdi.width;
-						cnt = qdi.count;
-						un = qdi.key;
+						if (!rle) {
+							w = qdi.width;
+							cnt = qdi.count;
+							un = qdi.key;
+						}
 						bat_iterator_end(&qdi);
 
 						if (BUNappend(cid, &c->base.id, false) != GDK_SUCCEED ||
@@ -4434,6 +4434,25 @@ sql_update_default(Client c, mvc *sql, sql_schema *s)
 		err = SQLstatementIntern(c, query, "update", true, false, NULL);
 	}
 
+#ifdef HAVE_GEOM
+	if (err == MAL_SUCCEED && backend_has_module(&(int){0}, "geom")) {
+		sql_subtype gtp, itp;
+		sql_find_subtype(&gtp, "geometry", 0, 0);
+		sql_find_subtype(&itp, "int", 0, 0);
+		if (!sql_bind_func3(sql, s->base.name, "st_knearest", &gtp, &gtp, &itp, F_FILT, true)) {
+			sql->session->status = 0; /* if the function was not found clean the error */
+			sql->errstr[0] = '\0';
+			const char query[] =
+				"CREATE FILTER FUNCTION ST_KNearest(geom1 Geometry, geom2 Geometry, k integer) EXTERNAL NAME rtree.\"KNearest\";\n"
+				"GRANT EXECUTE ON FILTER ST_KNearest(Geometry, Geometry, integer) TO PUBLIC;\n"
+				"update sys.functions set system = true where system <> true and schema_id = 2000 and name = 'st_knearest';\n";
+			printf("Running database upgrade commands:\n%s\n", query);
+			fflush(stdout);
+			err = SQLstatementIntern(c, query, "update", true, false, NULL);
+		}
+	}
+#endif
+
 	return err;
 }
 
@@ -1105,6 +1105,12 @@ read_exp_properties(mvc *sql, sql_exp *exp, char *r, int *pos)
 				exp->p = prop_create(sql->sa, PROP_HASHCOL, exp->p);
 			skipWS(r,pos);
 			found = true;
+		} else if (strncmp(r+*pos, "GUARD",  strlen("GUARD")) == 0) {
+			(*pos)+= (int) strlen("GUARD");
+			if (!find_prop(exp->p, PROP_GUARD))
+				exp->p = prop_create(sql->sa, PROP_GUARD, exp->p);
+			skipWS(r,pos);
+			found = true;
 		} else if (strncmp(r+*pos, "MIN",  strlen("MIN")) == 0) {
 			if (!exp_read_min_or_max(sql, exp, r, pos, "MIN", PROP_MIN))
 				return NULL;
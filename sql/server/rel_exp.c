@@ -2710,7 +2710,7 @@ exp_has_func(sql_exp *e)
 	return exp_has_func_or_cmp(e, false);
 }
 
-static int
+int
 exps_have_sideeffect( list *exps)
 {
 	node *n;
@@ -183,6 +183,7 @@ extern bool exps_have_unsafe(list *exps, bool allow_identity, bool card /* on tr
 																		  unsafeness (conversions for example) */);
 extern bool exp_unsafe(sql_exp *e, bool allow_identity, bool card);
 extern int exp_has_sideeffect(sql_exp *e);
+extern int exps_have_sideeffect(list *exps);
 
 extern sql_exp *exps_find_prop(list *exps, rel_prop kind);
 
@@ -15,6 +15,7 @@
 #include "rel_optimizer_private.h"
 #include "rel_exp.h"
 #include "rel_select.h"
+#include "rel_rewriter.h"
 
 static void
 rel_no_rename_exps( list *exps )
@@ -1282,6 +1283,28 @@ rel_push_topn_and_sample_down_(visitor *v, sql_rel *rel)
 			return rel;
 		}
 
+		/* duplicate topn/sample direct under munion of remote tables, so each remote ships at most n rows */
+		if (r && !rel_is_ref(r) && is_munion(r->op) && r->exps && rel_munion_has_remote(r)) {
+			bool changed = false;
+
+			for (node *n = ((list*)r->l)->h; n; n = n->next) {
+				sql_rel *c = n->data, *x = c;
+
+				while (is_simple_project(x->op) && !need_distinct(x) && !rel_is_ref(x) && x->l && list_empty(x->r))
+					x = x->l;
+				if (x && x->op != rel->op) { /* only push topn once */
+					c = func(v->sql->sa, c, sum_limit_offset(v->sql, rel));
+					set_processed(c);
+					n->data = c;
+					changed = true;
+				}
+			}
+
+			if (changed)
+				v->changes++;
+			return rel;
+		}
+
 		/* duplicate topn/sample + [ project-order ] under union */
 		if (r && !rp)
 			rp = r->l;
@@ -1366,6 +1389,71 @@ rel_push_topn_and_sample_down_(visitor *v, sql_rel *rel)
 			v->changes++;
 			return rel;
 		}
+		/* duplicate topn/sample + [ project-order ] under munion of remote tables */
+		if (r && r->exps && is_simple_project(r->op) && !rel_is_ref(r) && !list_empty(r->r) && r->l &&
+			is_munion(rp->op) && !rel_is_ref(rp) && rel_munion_has_remote(rp)) {
+			sql_rel *u = rp, *ou = u, *x;
+			list *rcopy = NULL, *nl = sa_list(v->sql->sa);
+
+			/* only push topn/sample once */
+			for (node *n = ((list*)u->l)->h; n; n = n->next) {
+				x = n->data;
+				while (is_simple_project(x->op) && !need_distinct(x) && !rel_is_ref(x) && x->l && list_empty(x->r))
+					x = x->l;
+				if (x && x->op == rel->op)
+					return rel;
+			}
+
+			rcopy = exps_copy(v->sql, r->r);
+			for (node *n = rcopy->h ; n ; n = n->next) {
+				sql_exp *e = n->data;
+				set_descending(e); /* remove ordering properties for projected columns */
+				set_nulls_first(e);
+			}
+			for (node *n = ((list*)u->l)->h; n; n = n->next) {
+				sql_rel *c = rel_dup(n->data);
+
+				if (!is_project(c->op))
+					c = rel_project(v->sql->sa, c,
+						rel_projections(v->sql, c, NULL, 1, 1));
+				rel_rename_exps(v->sql, u->exps, c->exps);
+
+				/* introduce projects under the set */
+				c = rel_project(v->sql->sa, c, NULL);
+				c->exps = exps_copy(v->sql, r->exps);
+				/* possibly add order by column */
+				c->exps = list_distinct(list_merge(c->exps, exps_copy(v->sql, rcopy), NULL), (fcmp) exp_equal, (fdup) NULL);
+				c->nrcols = list_length(c->exps);
+				c->r = exps_copy(v->sql, r->r);
+				set_processed(c);
+				c = func(v->sql->sa, c, sum_limit_offset(v->sql, rel));
+				set_processed(c);
+				if (need_distinct(r))
+					set_distinct(c);
+				append(nl, c);
+			}
+
+			u = rel_setop_n_ary(v->sql->sa, nl, op_munion);
+			/* possibly add order by column */
+			rel_setop_n_ary_set_exps(v->sql, u, list_distinct(list_merge(exps_alias(v->sql, r->exps), rcopy, NULL), (fcmp) exp_equal, (fdup) NULL), false);
+			set_processed(u);
+
+			/* zap names */
+			rel_no_rename_exps(u->exps);
+			rel_destroy(ou);
+
+			x = rel_project(v->sql->sa, u, exps_alias(v->sql, r->exps));
+			x->r = r->r;
+			r->l = NULL;
+
+			if (need_distinct(r))
+				set_distinct(x);
+
+			rel_destroy(r);
+			rel->l = x;
+			v->changes++;
+			return rel;
+		}
 		/* a  left outer join b order by a.* limit L, can be copied into a */
 		/* topn ( project (orderby)( optional project ( left ())
 		 * rel    r                                     rp */
@@ -1073,6 +1073,192 @@ rel_is_join_on_pkey(sql_rel *rel, bool pk_fk) /* pk_fk is used to verify is a jo
 	return NULL;
 }
 
+/* the column of a member table of a merge table e refers to, when all rows
+ * of rel come from that member with the values of e unchanged */
+static sql_column *
+rel_find_member_column(sql_rel *rel, sql_exp *e, sql_rel **bt)
+{
+	sql_column *c = NULL;
+
+	if (!rel || e->type != e_column)
+		return NULL;
+	switch (rel->op) {
+	case op_basetable:
+		if (!rel_base_get_mergetable(rel))
+			return NULL;
+		return name_find_column(rel, e->l, e->r, -1, bt);
+	case op_select:
+	case op_topn:
+	case op_sample:
+	case op_semi:
+		return rel_find_member_column(rel->l, e, bt);
+	case op_join:
+		if (!(c = rel_find_member_column(rel->l, e, bt)))
+			c = rel_find_member_column(rel->r, e, bt);
+		return c;
+	case op_project:
+		if (!rel->l || need_distinct(rel) || !(e = exps_find_exp(rel->exps, e)))
+			return NULL;
+		return rel_find_member_column(rel->l, e, bt);
+	default:
+		return NULL;
+	}
+}
+
+/* The partitions read by the children of munion u, when expression e of ou
+ * (u or a projection over it) is the partition column of a range or list
+ * partitioned merge table for each child, and no partition is read twice.
+ * Rows with equal values of e then never come from different children. */
+static sql_part **
+rel_munion_parts(mvc *sql, sql_rel *ou, sql_rel *u, sql_exp *e, sql_table **mtp)
+{
+	sql_table *mt = NULL;
+	sql_part **parts;
+	int pos, i = 0;
+
+	if (ou != u && (!(e = exps_find_exp(ou->exps, e)) || e->type != e_column))
+		return NULL;
+	if (!(e = exps_find_exp(u->exps, e)) || (pos = list_position(u->exps, e)) < 0)
+		return NULL;
+	parts = SA_ZNEW_ARRAY(sql->sa, sql_part*, list_length(u->l));
+	for (node *n = ((list*)u->l)->h; n; n = n->next, i++) {
+		sql_rel *c = n->data, *bt = NULL;
+		list *pexps = rel_projections(sql, c, NULL, 1, 1);
+		sql_column *col = NULL;
+		sql_table *cmt = NULL;
+		node *m = NULL;
+
+		if (list_length(pexps) != list_length(u->exps) ||
+			!(col = rel_find_member_column(c, list_fetch(pexps, pos), &bt)) ||
+			!(cmt = rel_base_get_mergetable(bt)) || (mt && cmt != mt) ||
+			!isPartitionedByColumnTable(cmt) || cmt->part.pcol->colnr != col->colnr ||
+			!(m = members_find_child_id(cmt->members, col->t->base.id)))
+			return NULL;
+		mt = cmt;
+		parts[i] = m->data;
+		for (int j = 0; j < i; j++)
+			if (parts[j] == parts[i])
+				return NULL;
+	}
+	if (mtp)
+		*mtp = mt;
+	return parts;
+}
+
+static bool
+part_value_in(mvc *sql, sql_subtype *tpe, sql_part_value *pv, list *values)
+{
+	atom *a = atom_general_ptr(sql->sa, tpe, pv->value);
+
+	for (node *n = values->h; n; n = n->next) {
+		sql_part_value *spv = n->data;
+
+		if (atom_cmp(a, atom_general_ptr(sql->sa, tpe, spv->value)) == 0)
+			return true;
+	}
+	return false;
+}
+
+/* both partitions hold the same set of values of their partition columns */
+static bool
+parts_match(mvc *sql, sql_table *mt, sql_part *lp, sql_part *rp)
+{
+	sql_subtype *tpe = &mt->part.pcol->type;
+
+	if (lp->with_nills != rp->with_nills)
+		return false;
+	if (isRangePartitionTable(mt))
+		return atom_cmp(atom_general_ptr(sql->sa, tpe, lp->part.range.minvalue),
+						atom_general_ptr(sql->sa, tpe, rp->part.range.minvalue)) == 0 &&
+			   atom_cmp(atom_general_ptr(sql->sa, tpe, lp->part.range.maxvalue),
+						atom_general_ptr(sql->sa, tpe, rp->part.range.maxvalue)) == 0;
+	if (list_length(lp->part.values) != list_length(rp->part.values))
+		return false;
+	for (node *n = lp->part.values->h; n; n = n->next)
+		if (!part_value_in(sql, tpe, n->data, rp->part.values))
+			return false;
+	return true;
+}
+
+static sql_part *
+parts_find_match(mvc *sql, sql_table *mt, sql_part *p, sql_part **parts, int nr)
+{
+	for (int i = 0; i < nr; i++)
+		if (parts[i] && parts_match(sql, mt, p, parts[i]))
+			return parts[i];
+	return NULL;
+}
+
+/* both merge tables are partitioned the same way on columns of the same type */
+static bool
+tables_copartitioned(mvc *sql, sql_table *lmt, sql_table *rmt)
+{
+	if (lmt == rmt)
+		return true;
+	if (isRangePartitionTable(lmt) != isRangePartitionTable(rmt) ||
+		subtype_cmp(&lmt->part.pcol->type, &rmt->part.pcol->type) != 0 ||
+		list_length(lmt->members) != list_length(rmt->members))
+		return false;
+	for (node *n = lmt->members->h; n; n = n->next) {
+		bool found = false;
+
+		for (node *m = rmt->members->h; m && !found; m = m->next)
+			found = parts_match(sql, lmt, n->data, m->data);
+		if (!found)
+			return false;
+	}
+	return true;
+}
+
+/* Find an equi-join on the partition columns of co-partitioned merge tables,
+ * ie range or list partitioned with partitions of the same bounds.  The
+ * children of munions l and r are then returned in pairs reading partitions
+ * with equal bounds; a child without such a partner can't have matches. */
+static sql_exp *
+rel_is_join_on_partkey(mvc *sql, sql_rel *rel, sql_rel *ol, sql_rel *l, sql_rel *or, sql_rel *r, list **lps, list **rps)
+{
+	if (rel->op != op_join && rel->op != op_semi)
+		return NULL;
+	for (node *n = rel->exps->h; n; n = n->next) {
+		sql_exp *je = n->data, *le = je->l, *re = je->r;
+		sql_table *lmt = NULL, *rmt = NULL;
+		sql_part **lparts = NULL, **rparts = NULL;
+
+		if (je->type != e_cmp || je->flag != cmp_equal || is_anti(je) || is_semantics(je))
+			continue;
+		if (!(lparts = rel_munion_parts(sql, ol, l, le, &lmt))) {
+			le = je->r;
+			re = je->l;
+			lparts = rel_munion_parts(sql, ol, l, le, &lmt);
+		}
+		if (!lparts || !(rparts = rel_munion_parts(sql, or, r, re, &rmt)) || !tables_copartitioned(sql, lmt, rmt))
+			continue;
+
+		int i = 0, nr = list_length(r->l);
+		*lps = sa_list(sql->sa);
+		*rps = sa_list(sql->sa);
+		for (node *m = ((list*)l->l)->h; m; m = m->next, i++) {
+			sql_part *rp = parts_find_match(sql, lmt, lparts[i], rparts, nr);
+
+			if (rp) {
+				int j = 0;
+
+				for (node *o = ((list*)r->l)->h; o; o = o->next, j++) {
+					if (rparts[j] == rp) {
+						append(*lps, m->data);
+						append(*rps, o->data);
+						break;
+					}
+				}
+			}
+		}
+		if (list_empty(*lps))
+			return NULL;
+		return je;
+	}
+	return NULL;
+}
+
 static int
 exps_has_predicate( list *l )
 {
@@ -1733,6 +1919,56 @@ exps_uses_exp(list *exps, sql_exp *e)
 {
 	return list_exps_uses_exp(exps, exp_relname(e), exp_name(e));
 }
+
+/* An average with a double result over integers or floating point values
+ * can be computed from partial sums and counts.  Integers are only summed
+ * into a wider type, so the partial sums can't overflow before the
+ * average itself does.  Reals are summed as doubles, like avg does. */
+static bool
+exp_aggr_is_splittable_avg(mvc *sql, sql_exp *e)
+{
+	sql_subfunc *af = e->f, *sf;
+	sql_subtype *t;
+	list *args = e->l;
+
+	if (e->type != e_aggr || strcmp(af->func->base.name, "avg") || need_distinct(e) ||
+		list_length(args) != 1 || exp_subtype(e)->type->localtype != TYPE_dbl)
+		return false;
+	t = exp_subtype(args->h->data);
+	if (t->type->eclass == EC_FLT)
+		return true;
+	if (t->type->eclass != EC_NUM ||
+		!(sf = sql_bind_func(sql, "sys", "sum", t, NULL, F_AGGR, true, true)))
+		return false;
+	return ((sql_subtype*)sf->res->h->data)->type->localtype > t->type->localtype;
+}
+
+/* the partial sum of the values of average e, its count is added to cnts */
+static sql_exp *
+exp_avg_partials(mvc *sql, sql_exp *e, list *cnts)
+{
+	sql_exp *arg = ((list*)e->l)->h->data, *s, *c, *sarg = exp_copy(sql, arg);
+	sql_subtype *t = exp_subtype(arg);
+
+	if (t->type->eclass == EC_FLT && t->type->localtype != TYPE_dbl) {
+		/* sum(real) is a real, the partial sums would lose precision */
+		sql_subtype *dbl = sql_bind_localtype("dbl");
+		if (!(sarg = exp_convert(sql, sarg, t, dbl)))
+			return NULL;
+	}
+	sql_subfunc *sf = sql_bind_func(sql, "sys", "sum", exp_subtype(sarg), NULL, F_AGGR, true, true);
+	sql_subfunc *cf = sql_bind_func(sql, "sys", "count", t, NULL, F_AGGR, true, true);
+
+	if (!sf || !cf)
+		return NULL;
+	s = exp_aggr1(sql->sa, sarg, sf, 0, need_no_nil(e), e->card, has_nil(e));
+	exp_setalias(s, e->alias.label, exp_relname(e), exp_name(e));
+	c = exp_aggr1(sql->sa, exp_copy(sql, arg), cf, 0, need_no_nil(e), e->card, 0);
+	exp_label(sql->sa, c, ++sql->label);
+	append(cnts, c);
+	return s;
+}
+
 /*
  * Rewrite aggregations over munion all.
  *	groupby ([ union all (a, b, c) ], [gbe], [ count, sum ] )
@@ -1749,8 +1985,9 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 	sql_rel *g = rel;
 	sql_rel *u = rel->l, *ou = u;
 	sql_rel *r = NULL;
-	list *rgbe = NULL, *gbe = NULL, *exps = NULL;
+	list *rgbe = NULL, *gbe = NULL, *exps = NULL, *cexps = g->exps, *cnts = NULL;
 	node *n, *m;
+	bool partkey = false, split_avg;
 
 	// TODO why?
 	if (u->op == op_project && !need_distinct(u))
@@ -1763,11 +2000,29 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 			return rel;
 	}
 
+	/* groups on the partition key of a range or list partitioned merge
+	 * table are complete within each partition, so any aggregate is
+	 * computed per partition */
+	if (!list_empty(rel->r))
+		for (n = ((list*)rel->r)->h; n && !partkey; n = n->next)
+			partkey = rel_munion_parts(v->sql, ou, u, n->data, NULL) != NULL;
+
+	/* remote members ship the partial sums and counts of averages,
+	 * instead of all their rows */
+	split_avg = !partkey && rel_munion_has_remote(u);
+
 	/* distinct should be done over the full result */
-	for (n = g->exps->h; n; n = n->next) {
+	for (n = g->exps->h; n && !partkey; n = n->next) {
 		sql_exp *e = n->data;
 		sql_subfunc *af = e->f;
 
+		if (split_avg && exp_aggr_is_splittable_avg(v->sql, e)) {
+			if (!cnts) {
+				cexps = exps_copy(v->sql, g->exps);
+				cnts = sa_list(v->sql->sa);
+			}
+			continue;
+		}
 		if (e->type == e_atom ||
 			e->type == e_func ||
 		   (e->type == e_aggr &&
@@ -1778,6 +2033,13 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 		   need_distinct(e))))
 			return rel;
 	}
+	if (cnts) {
+		for (n = cexps->h; n; n = n->next)
+			if (exp_aggr_is_splittable_avg(v->sql, n->data) &&
+				!(n->data = exp_avg_partials(v->sql, n->data, cnts)))
+				return rel;
+		cexps = list_merge(cexps, cnts, NULL);
+	}
 
 	list *nl = sa_list(v->sql->sa);
 	for (node *n = ((list*)u->l)->h; n; n = n->next) {
@@ -1804,7 +2066,7 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 		r->r = rgbe;
 		r->nrcols = g->nrcols;
 		r->card = g->card;
-		r->exps = exps_copy(v->sql, g->exps);
+		r->exps = exps_copy(v->sql, cexps);
 		r->nrcols = list_length(r->exps);
 		set_processed(r);
 
@@ -1821,7 +2083,7 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 			sql_exp *e = n->data;
 			sql_column *c = NULL;
 
-			if ((c = exp_is_pkey(rel, e)) && partition_find_part(v->sql->session->tr, c->t, NULL)) {
+			if (partkey || ((c = exp_is_pkey(rel, e)) && partition_find_part(v->sql->session->tr, c->t, NULL))) {
 				/* check if key is partition key */
 				v->changes++;
 				return rel_inplace_setop_n_ary(v->sql, rel, nl, op_munion,
@@ -1862,7 +2124,7 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 	set_processed(u);
 
 	exps = new_exp_list(v->sql->sa);
-	for (n = u->exps->h, m = rel->exps->h; n && m; n = n->next, m = m->next) {
+	for (n = u->exps->h, m = cexps->h; n && m; n = n->next, m = m->next) {
 		sql_exp *ne, *e = n->data, *oa = m->data;
 
 		if (oa->type == e_aggr) {
@@ -1883,7 +2145,36 @@ rel_push_aggr_down_n_arry(visitor *v, sql_rel *rel)
 		append(exps, ne);
 	}
 	v->changes++;
-	return rel_inplace_groupby(rel, u, gbe, exps);
+	if (!cnts)
+		return rel_inplace_groupby(rel, u, gbe, exps);
+
+	/* averages are the total sum divided by the total count */
+	list *oexps = g->exps, *pexps = new_exp_list(v->sql->sa);
+	sql_subtype *dbl = sql_bind_localtype("dbl");
+	sql_subfunc *div = sql_bind_func(v->sql, "sys", "sql_div", dbl, dbl, F_FUNC, true, true);
+	node *c = exps->h;
+
+	assert(div);
+	for (int i = list_length(oexps); i > 0; i--)
+		c = c->next;
+	for (n = oexps->h, m = exps->h; n && m; n = n->next, m = m->next) {
+		sql_exp *oa = n->data, *ne = exp_ref(v->sql, m->data);
+
+		if (exp_aggr_is_splittable_avg(v->sql, oa)) {
+			sql_exp *s = m->data, *cnt = c->data;
+
+			/* the total sum gets a label of its own, the average keeps the original one */
+			exp_label(v->sql->sa, s, ++v->sql->label);
+			ne = exp_binop(v->sql->sa,
+						   exp_convert(v->sql, exp_ref(v->sql, s), exp_subtype(s), dbl),
+						   exp_convert(v->sql, exp_ref(v->sql, cnt), exp_subtype(cnt), dbl), div);
+			exp_setalias(ne, oa->alias.label, exp_find_rel_name(oa), exp_name(oa));
+			c = c->next;
+		}
+		append(pexps, ne);
+	}
+	rel = rel_inplace_groupby(rel, u, gbe, exps);
+	return rel_inplace_project(v->sql->sa, rel, NULL, pexps);
 }
 
 /*
@@ -3203,7 +3494,7 @@ rel_push_join_down_munion(visitor *v, sql_rel *rel)
 {
 	if ((is_join(rel->op) && !is_outerjoin(rel->op) && !is_single(rel)) || is_semi(rel->op)) {
 		sql_rel *l = rel->l, *r = rel->r, *ol = l, *or = r;
-		list *exps = rel->exps, *attr = rel->attr;
+		list *exps = rel->exps, *attr = rel->attr, *lps = NULL, *rps = NULL;
 		sql_exp *je = NULL;
 
 		/* we would like to optimize in place reference rels which point
@@ -3232,15 +3523,17 @@ rel_push_join_down_munion(visitor *v, sql_rel *rel)
 		// TODO: we could also check if the join cols are (not) unique
 		bool aligned_pk_fk = true;
 		if (!l || !r || (is_munion(l->op) && is_munion(r->op) &&
-			!(je = rel_is_join_on_pkey(rel, aligned_pk_fk))))
+			!(je = rel_is_join_on_pkey(rel, aligned_pk_fk)) &&
+			!(je = rel_is_join_on_partkey(v->sql, rel, ol, l, or, r, &lps, &rps))))
 			return rel;
 
 		// TODO: why? bailout for union semijoin without pkey joins expressions
 		if (is_semi(rel->op) && is_munion(l->op) && !je)
 			return rel;
 
-		/* if both sides are munions we assume that they will have the same number of children */
-		if (is_munion(l->op) && is_munion(r->op) && list_length(l->l) != list_length(r->l))
+		/* if both sides are munions we assume that they will have the same number of children,
+		 * unless they are paired on their partitions */
+		if (is_munion(l->op) && is_munion(r->op) && !lps && list_length(l->l) != list_length(r->l))
 			return rel;
 
 		if (is_munion(l->op) && !need_distinct(l) && !is_single(l) &&
@@ -3272,8 +3565,12 @@ rel_push_join_down_munion(visitor *v, sql_rel *rel)
 			       je) {
 			/* join(munion(a,b,c), munion(d,e,f)) -> munion(join(a,d), join(b,e), join(c,f)) */
 			list *cps = sa_list(v->sql->sa);
+			if (!lps) {
+				lps = l->l;
+				rps = r->l;
+			}
 			/* create pairwise joins between left and right parts. assume eq num of parts (see earlier bailout) */
-			for (node *n = ((list*)l->l)->h, *m=((list*)r->l)->h; n && m; n = n->next, m = m->next) {
+			for (node *n = lps->h, *m = rps->h; n && m; n = n->next, m = m->next) {
 				/* left part */
 				sql_rel *lp = rel_dup(n->data);
 				if (!is_project(lp->op))
@@ -47,30 +47,181 @@ typedef struct {
 		semantics:1;
 	int flag;
 	list *values;
+	sql_exp *lexp;	/* values only known at execution time */
+	sql_exp *hexp;
+	list *vexps;
 } range_limit;
 
 typedef struct {
 	list *cols;
 	list *ranges;
+	list *guards;	/* range_limits on the partition column to check at execution time */
+	sql_table *mt;
 	sql_rel *sel;
 } merge_table_prune_info;
 
 static sql_rel *merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_info *info);
 
+/* compare a value only known at execution time with a partition bound */
+static sql_exp *
+part_bound_compare(mvc *sql, sql_exp *val, atom *bound, int flag)
+{
+	sql_exp *b = exp_atom(sql->sa, bound);
+	sql_subtype *vt = exp_subtype(val);
+
+	if (subtype_cmp(vt, atom_type(bound)) != 0 && !(b = exp_convert(sql, b, atom_type(bound), vt)))
+		return NULL;
+	return exp_compare_func(sql, exp_copy(sql, val), b, compare_func((comp_type) flag, 0), 0);
+}
+
+/* combine two guards with the boolean function fname ("and" or "or") */
+static sql_exp *
+part_guard_combine(mvc *sql, sql_exp *l, sql_exp *r, const char *fname)
+{
+	sql_subtype *bt = sql_bind_localtype("bit");
+	sql_subfunc *f;
+
+	if (!l || !r)
+		return l ? l : r;
+	if (!(f = sql_bind_func_result(sql, "sys", fname, F_FUNC, true, bt, 2, bt, bt)))
+		return NULL;
+	return exp_binop(sql->sa, l, r, f);
+}
+
+/* the condition under which a partition may hold a value equal to val,
+ * *all is set when it may hold any value */
+static sql_exp *
+part_value_guard(mvc *sql, sql_table *mt, sql_part *pd, sql_exp *val, bool *all)
+{
+	sql_column *pcol = mt->part.pcol;
+	sql_exp *guard = NULL, *g;
+
+	if (isRangePartitionTable(mt)) {
+		atom *rmin = atom_general_ptr(sql->sa, &pcol->type, pd->part.range.minvalue);
+		atom *rmax = atom_general_ptr(sql->sa, &pcol->type, pd->part.range.maxvalue);
+		/* the upper limit is exclusive, unless both limits are the same */
+		bool max_differ_min = rmin->isnull || rmax->isnull || ATOMcmp(pcol->type.type->localtype, &rmin->data.val, &rmax->data.val) != 0;
+
+		if (rmin->isnull && rmax->isnull) {
+			*all = pd->with_nills != 1;
+			return *all ? NULL : exp_atom_bool(sql->sa, 0);
+		}
+		if (!rmin->isnull && !(guard = part_bound_compare(sql, val, rmin, cmp_gte)))
+			return NULL;
+		if (!rmax->isnull && !(g = part_bound_compare(sql, val, rmax, max_differ_min ? cmp_lt : cmp_lte)))
+			return NULL;
+		return rmax->isnull ? guard : part_guard_combine(sql, guard, g, "and");
+	}
+	for (node *m = pd->part.values->h; m; m = m->next) {
+		sql_part_value *spv = (sql_part_value*) m->data;
+
+		if (!(g = part_bound_compare(sql, val, atom_general_ptr(sql->sa, &pcol->type, spv->value), cmp_equal)) ||
+			!(guard = part_guard_combine(sql, guard, g, "or")))
+			return NULL;
+	}
+	/* a partition with just null values never holds an equal value */
+	return guard ? guard : exp_atom_bool(sql->sa, 0);
+}
+
+/* Predicates on the partition column with values only known at execution
+ * time, such as the parameters of prepared statements, can not prune the
+ * partitions here.  They become a guard of the select on each partition,
+ * which skips the scan of a partition when the guard fails.  The guard is
+ * conservative, the select itself still checks the predicates.  On success
+ * *guard is NULL when the partition can not be skipped. */
+static bool
+part_guard(visitor *v, merge_table_prune_info *info, sql_table *pt, sql_exp **guard)
+{
+	mvc *sql = v->sql;
+	sql_table *mt = info->mt;
+	sql_column *pcol = mt->part.pcol;
+	sql_part *pd = NULL;
+	sql_exp *res = NULL;
+
+	*guard = NULL;
+	for (node *n = mt->members->h; n && !pd; n = n->next) {
+		sql_part *p = n->data;
+
+		if (p->member == pt->base.id)
+			pd = p;
+	}
+	if (!pd || !isTable(pt))
+		return true;
+	for (node *n = info->guards->h; n; n = n->next) {
+		range_limit *next = n->data;
+		list *vals = next->vexps;
+		sql_exp *alts = NULL, *g = NULL;
+		bool all = false;
+
+		if (isRangePartitionTable(mt) && next->flag != cmp_equal && next->flag != cmp_in) {
+			atom *rmin = atom_general_ptr(sql->sa, &pcol->type, pd->part.range.minvalue);
+			atom *rmax = atom_general_ptr(sql->sa, &pcol->type, pd->part.range.maxvalue);
+
+			if (rmin->isnull && rmax->isnull) {
+				if (pd->with_nills == 1) /* the partition just holds null values */
+					g = exp_atom_bool(sql->sa, 0);
+			} else if (next->hexp != next->lexp) { /* range case */
+				sql_exp *h = NULL;
+
+				if ((!rmax->isnull && !(g = part_bound_compare(sql, next->lexp, rmax, cmp_lt))) ||
+					(!rmin->isnull && !(h = part_bound_compare(sql, next->hexp, rmin, cmp_gte))))
+					return false;
+				g = part_guard_combine(sql, g, h, "and");
+			} else if ((next->flag == cmp_gt || next->flag == cmp_gte) && !rmax->isnull) {
+				g = part_bound_compare(sql, next->lexp, rmax, cmp_lt);
+			} else if (next->flag == cmp_lt && !rmin->isnull) {
+				g = part_bound_compare(sql, next->lexp, rmin, cmp_gt);
+			} else if (next->flag == cmp_lte && !rmin->isnull) {
+				g = part_bound_compare(sql, next->lexp, rmin, cmp_gte);
+			} else {
+				continue;
+			}
+			if (!g && !(rmin->isnull && rmax->isnull))
+				return false;
+			if (g && !(res = part_guard_combine(sql, res, g, "and")))
+				return false;
+			continue;
+		}
+		if (next->flag != cmp_equal && next->flag != cmp_in)
+			continue;
+		if (!vals)
+			vals = append(sa_list(sql->sa), next->lexp);
+		for (node *m = vals->h; m && !all; m = m->next) {
+			if (!(g = part_value_guard(sql, mt, pd, m->data, &all)) && !all)
+				return false;
+			if (!all && !(alts = part_guard_combine(sql, alts, g, "or")))
+				return false;
+		}
+		if (!all && !(res = part_guard_combine(sql, res, alts, "and")))
+			return false;
+	}
+	if (res) {
+		*guard = exp_compare(sql->sa, res, exp_atom_bool(sql->sa, 1), cmp_equal);
+		(*guard)->p = prop_create(sql->sa, PROP_GUARD, (*guard)->p);
+	}
+	return true;
+}
+
 static sql_rel *
 rel_wrap_select_around_mt_child(visitor *v, sql_rel *t, merge_table_prune_info *info)
 {
 	// TODO: it has to be a table (merge table component) add checks
 	sql_table *subt = (sql_table *)t->l;
+	sql_exp *guard = NULL;
 
 	if (isMergeTable(subt)) {
 		if ((t = merge_table_prune_and_unionize(v, t, info)) == NULL)
 			return NULL;
+	} else if (info && !list_empty(info->guards) && !part_guard(v, info, subt, &guard)) {
+		return NULL;
 	}
 
 	if (info) {
 		t = rel_select(v->sql->sa, t, NULL);
 		t->exps = exps_copy(v->sql, info->sel->exps);
+		/* the guard goes first, so nothing is scanned when it fails */
+		if (guard)
+			list_prepend(t->exps, guard);
 		set_processed(t);
 		set_processed(t);
 	}
@@ -126,6 +277,46 @@ rel_unionize_mt_tables_munion(visitor *v, sql_rel* mt, list* tables, merge_table
 	return mu;
 }
 
+/* The min and max of a column of a merge table member.  Those of read only
+ * members can't change, those of other members may only be used for plans
+ * which are not kept for later executions, ie not for prepared statements.
+ * Queries over merge tables are not turned into shared plans, they are
+ * compiled with their own constants and so pruned on them. */
+static void
+member_col_ranges(visitor *v, sql_table *pt, sql_column *col, atom **cmin, atom **cmax)
+{
+	sql_trans *tr = v->sql->session->tr;
+	sqlstore *store = tr->store;
+
+	if (pt->access == TABLE_READONLY) {
+		void *min = NULL, *max = NULL;
+
+		if (sql_trans_ranges(tr, col, &min, &max) && min && max) {
+			*cmin = atom_general_ptr(v->sql->sa, &col->type, min);
+			*cmax = atom_general_ptr(v->sql->sa, &col->type, max);
+		}
+	} else {
+		ValRecord min, max;
+
+		if (store->storage_api.col_ranges(tr, col, &min, &max)) {
+			*cmin = atom_general_ptr(v->sql->sa, &col->type, VALget(&min));
+			*cmax = atom_general_ptr(v->sql->sa, &col->type, VALget(&max));
+			VALclear(&min);
+			VALclear(&max);
+		}
+	}
+}
+
+/* remember the members skipped on their statistics, for explain */
+static void
+member_skipped(mvc *sql, sql_table *mt, sql_table *pt)
+{
+	if (!sql->skipped)
+		sql->skipped = sa_list(sql->sa);
+	list_append(sql->skipped, sa_message(sql->sa, "%s.%s skipped from merge table %s.%s by its statistics",
+										  pt->s->base.name, pt->base.name, mt->s->base.name, mt->base.name));
+}
+
 static sql_rel *
 merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_info *info)
 {
@@ -142,6 +333,7 @@ merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_in
 		sql_table *pt = find_sql_table_id(v->sql->session->tr, mt->s, pd->member);
 		sqlstore *store = v->sql->session->tr->store;
 		int skip = 0;
+		bool stats_skip = false;
 
 		/* At the moment we throw an error in the optimizer, but later this rewriter should move out from the optimizers */
 		if ((isMergeTable(pt) || isReplicaTable(pt)) && list_empty(pt->members))
@@ -179,14 +371,10 @@ merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_in
 							continue;
 
 						assert(col && (lval || values));
-						if (!skip && pt->access == TABLE_READONLY) {
+						if (!skip && (pt->access == TABLE_READONLY || (v->storage_based_opt && isNonPartitionedTable(mt)))) {
 							/* check if the part falls within the bounds of the select expression else skip this (keep at least on part-table) */
 							if (!cmin && !cmax && first_attempt) {
-								void *min = NULL, *max = NULL;
-								if (sql_trans_ranges(v->sql->session->tr, col, &min, &max) && min && max) {
-									cmin = atom_general_ptr(v->sql->sa, &col->type, min);
-									cmax = atom_general_ptr(v->sql->sa, &col->type, max);
-								}
+								member_col_ranges(v, pt, col, &cmin, &cmax);
 								first_attempt = false; /* no more attempts to read from storage */
 							}
 
@@ -233,6 +421,7 @@ merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_in
 									skip |= nskip;
 								}
 							}
+							stats_skip = skip;
 						}
 						if (!skip && isPartitionedByColumnTable(mt) && strcmp(mt->part.pcol->base.name, col->base.name) == 0) {
 							if (!next->semantics && ((lval && lval->isnull) || (hval && hval->isnull))) {
@@ -406,6 +595,8 @@ merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_in
 		}
 		if (!skip)
 			append(tables, rel_rename_part(v->sql, rel_basetable(v->sql, pt, pt->base.name), mt_rel, mtalias));
+		else if (stats_skip)
+			member_skipped(v->sql, mt, pt);
 	}
 	if (list_empty(tables)) { /* No table passed the predicates, generate dummy relation */
 		list *converted = sa_list(v->sql->sa);
@@ -438,8 +629,14 @@ merge_table_prune_and_unionize(visitor *v, sql_rel *mt_rel, merge_table_prune_in
 					if (!(next = merge_table_prune_and_unionize(v, next, info)))
 						return NULL;
 				} else if (info) { /* propagate select under union */
+					sql_exp *guard = NULL;
+
+					if (!list_empty(info->guards) && !part_guard(v, info, subt, &guard))
+						return NULL;
 					next = rel_select(v->sql->sa, next, NULL);
 					next->exps = exps_copy(v->sql, info->sel->exps);
+					if (guard)
+						list_prepend(next->exps, guard);
 					set_processed(next);
 				}
 
@@ -487,6 +684,8 @@ rel_merge_table_rewrite_(visitor *v, sql_rel *rel)
 				*info = (merge_table_prune_info) {
 					.cols = sa_list(v->sql->sa),
 					.ranges = sa_list(v->sql->sa),
+					.guards = sa_list(v->sql->sa),
+					.mt = mt,
 					.sel = sel
 				};
 				for (node *n = sel->exps->h; n; n = n->next) {
@@ -495,6 +694,9 @@ rel_merge_table_rewrite_(visitor *v, sql_rel *rel)
 
 					if (e->type != e_cmp || (!is_theta_exp(flag) && flag != cmp_in) || is_symmetric(e) || !(c = rel_find_exp(rel, c)))
 						continue;
+					/* values of predicates on the partition column may also be checked at execution time */
+					bool guard = !is_anti(e) && !is_semantics(e) && isPartitionedByColumnTable(mt) &&
+						c->type == e_column && strcmp(c->r, mt->part.pcol->base.name) == 0;
 
 					if (flag == cmp_gt || flag == cmp_gte || flag == cmp_lte || flag == cmp_lt || flag == cmp_equal) {
 						sql_exp *l = e->r, *h = e->f;
@@ -513,6 +715,16 @@ rel_merge_table_rewrite_(visitor *v, sql_rel *rel)
 							};
 							list_append(info->cols, c);
 							list_append(info->ranges, next);
+						} else if (guard && exp_is_atom(l) && !exp_has_sideeffect(l) &&
+								   (!h || (exp_is_atom(h) && !exp_has_sideeffect(h)))) {
+							range_limit *next = SA_NEW(v->sql->sa, range_limit);
+
+							*next = (range_limit) {
+								.lexp = l,
+								.hexp = h ? h : l,
+								.flag = flag,
+							};
+							list_append(info->guards, next);
 						}
 					}
 					if (flag == cmp_in) { /* handle in lists */
@@ -538,6 +750,14 @@ rel_merge_table_rewrite_(visitor *v, sql_rel *rel)
 							};
 							list_append(info->cols, c);
 							list_append(info->ranges, next);
+						} else if (guard && exps_are_atoms(vals) && !exps_have_sideeffect(vals)) {
+							range_limit *next = SA_NEW(v->sql->sa, range_limit);
+
+							*next = (range_limit) {
+								.vexps = vals,
+								.flag = flag,
+							};
+							list_append(info->guards, next);
 						}
 					}
 				}
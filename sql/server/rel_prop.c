@@ -109,6 +109,7 @@ propkind2string( prop *p)
 		PT(HASHCOL);
 		PT(REMOTE);
 		PT(USED);
+		PT(GUARD);
 		PT(GROUPINGS);
 		PT(MIN);
 		PT(MAX);
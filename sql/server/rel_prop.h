@@ -23,6 +23,7 @@ typedef enum rel_prop {
 	PROP_HASHCOL,   /* could use hash idx */
 	PROP_REMOTE,    /* uri for remote execution */
 	PROP_USED,      /* number of times exp is used */
+	PROP_GUARD,     /* scalar condition which decides for a whole partition */
 	PROP_GROUPINGS  /* used by ROLLUP/CUBE/GROUPING SETS, value contains the list of sets */
 } rel_prop;
 
@@ -883,7 +883,7 @@ has_generic_decimal_result(list *types)
 
 
 static sql_rel *
-rel_create_func(sql_query *query, dlist *qname, dlist *params, symbol *res, dlist *ext_name, dlist *body, sql_ftype type, sql_flang lang, int replace)
+rel_create_func(sql_query *query, dlist *qname, dlist *params, symbol *res, dlist *ext_name, dlist *body, sql_ftype type, sql_flang lang, int map, int replace)
 {
 	mvc *sql = query->sql;
 	const char *fname = qname_schema_object(qname);
@@ -928,6 +928,10 @@ rel_create_func(sql_query *query, dlist *qname, dlist *params, symbol *res, dlis
 		return sql_error(sql, 02, SQLSTATE(42000) "CREATE %s: %s functions creation via SQL not supported", F, fn);
 	else if (LANG_EXT(lang) && !(type == F_FUNC || type == F_AGGR || type == F_UNION || type == F_LOADER))
 		return sql_error(sql, 02, SQLSTATE(42000) "CREATE %s: %ss creation via external programming languages not supported", F, fn);
+	else if (map && !(lang == FUNC_LANG_C || lang == FUNC_LANG_CPP || lang == FUNC_LANG_PY || lang == FUNC_LANG_PY3))
+		return sql_error(sql, 02, SQLSTATE(42000) "CREATE %s: parallel execution is only supported for C, CPP and PYTHON functions", F);
+	else if (map && type != F_FUNC)
+		return sql_error(sql, 02, SQLSTATE(42000) "CREATE %s: %ss cannot be executed in parallel, only scalar functions can", F, fn);
 
 	if (sname && !(s = mvc_bind_schema(sql, sname)))
 		return sql_error(sql, ERR_NOTFOUND, SQLSTATE(3F000) "CREATE %s: no such schema '%s'", F, sname);
@@ -1017,11 +1021,11 @@ rel_create_func(sql_query *query, dlist *qname, dlist *params, symbol *res, dlis
 			slang = "R";
 			break;
 		case FUNC_LANG_C:
-			mod = "capi";
+			mod = map ? "capimap" : "capi";
 			slang = "C";
 			break;
 		case FUNC_LANG_CPP:
-			mod = "capi";
+			mod = map ? "capimap" : "capi";
 			slang = "CPP";
 			break;
 		case FUNC_LANG_J:
@@ -1030,7 +1034,7 @@ rel_create_func(sql_query *query, dlist *qname, dlist *params, symbol *res, dlis
 			break;
 		case FUNC_LANG_PY:
 		case FUNC_LANG_PY3:
-			mod = "pyapi3";
+			mod = map ? "pyapi3map" : "pyapi3";
 			slang = "Python";
 			break;
 		default:
@@ -1590,8 +1594,9 @@ rel_psm(sql_query *query, symbol *s)
 		sql_ftype type = (sql_ftype) l->h->next->next->next->next->next->data.i_val;
 		sql_flang lang = (sql_flang) l->h->next->next->next->next->next->next->data.i_val;
 		int repl = l->h->next->next->next->next->next->next->next->data.i_val;
+		int map = l->h->next->next->next->next->next->next->next->next->data.i_val;
 
-		ret = rel_create_func(query, l->h->data.lval, l->h->next->data.lval, l->h->next->next->data.sym, l->h->next->next->next->data.lval, l->h->next->next->next->next->data.lval, type, lang, repl);
+		ret = rel_create_func(query, l->h->data.lval, l->h->next->data.lval, l->h->next->next->data.sym, l->h->next->next->next->data.lval, l->h->next->next->next->next->data.lval, type, lang, map, repl);
 		sql->type = Q_SCHEMA;
 	} 	break;
 	case SQL_DROP_FUNC:
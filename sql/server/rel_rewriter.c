@@ -254,6 +254,24 @@ find_member_pos(list *l, sql_table *t)
 	return -1;
 }
 
+/* one of the members of munion rel is a remote table, which is read over
+ * the network */
+bool
+rel_munion_has_remote(sql_rel *rel)
+{
+	if (!rel || !is_munion(rel->op))
+		return false;
+	for (node *n = ((list*)rel->l)->h; n; n = n->next) {
+		sql_rel *c = n->data;
+
+		while (c && (is_simple_project(c->op) || is_select(c->op)) && c->l)
+			c = c->l;
+		if (c && is_basetable(c->op) && c->l && isRemote((sql_table*)c->l))
+			return true;
+	}
+	return false;
+}
+
 /* The important task of the relational optimizer is to optimize the
    join order.
 
@@ -43,6 +43,7 @@ try_remove_empty_select(visitor *v, sql_rel *rel)
 }
 
 extern int find_member_pos(list *l, sql_table *t);
+extern bool rel_munion_has_remote(sql_rel *rel);
 extern sql_column *name_find_column(sql_rel *rel, const char *rname, const char *name, int pnr, sql_rel **bt);
 
 extern int exp_joins_rels(sql_exp *e, list *rels);
@@ -1312,6 +1312,8 @@ static int
 score_se(visitor *v, sql_rel *rel, sql_exp *e)
 {
 	int score = 0;
+	if (find_prop(e->p, PROP_GUARD)) /* a partition guard decides for all rows at once */
+		return INT_MAX;
 	if (e->type == e_cmp && !is_complex_exp(e->flag)) {
 		sql_exp *l = e->l;
 
@@ -792,16 +792,7 @@ mvc_create(sql_store *store, allocator *pa, int clientid, int debug, bstream *rs
 	m->pa = pa;
 	m->sa = NULL;
 	m->ta = sa_create(m->pa);
-#ifdef __has_builtin
-#if __has_builtin(__builtin_frame_address)
-	m->sp = (uintptr_t) __builtin_frame_address(0);
-#define BUILTIN_USED
-#endif
-#endif
-#ifndef BUILTIN_USED
-	m->sp = (uintptr_t)(&m);
-#endif
-#undef BUILTIN_USED
+	mvc_set_stack(m);
 
 	m->params = NULL;
 	m->sizeframes = MAXPARAMS;
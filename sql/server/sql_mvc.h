@@ -162,6 +162,7 @@ typedef struct mvc {
 	int nid;	                /* numbers for relational names */
 	list *cascade_action;       /* protection against recursive cascade actions */
 	list *schema_path;          /* schema search path for object lookup */
+	list *skipped;              /* merge table members skipped on their statistics, shown by explain */
 	uintptr_t sp;
 } mvc;
 
@@ -319,6 +320,21 @@ extern void *sql_error(mvc *sql, int error_code, _In_z_ _Printf_format_string_ c
 
 extern int symbol_cmp(mvc* sql, symbol *s1, symbol *s2);
 
+/* record the base of the stack of the thread serving the session */
+static inline void mvc_set_stack(mvc *sql)
+{
+#ifdef __has_builtin
+#if __has_builtin(__builtin_frame_address)
+	sql->sp = (uintptr_t) __builtin_frame_address(0);
+#define BUILTIN_USED
+#endif
+#endif
+#ifndef BUILTIN_USED
+	sql->sp = (uintptr_t)(&sql);
+#endif
+#undef BUILTIN_USED
+}
+
 static inline int mvc_highwater(mvc *sql)
 {
 	int rc = 0;
@@ -2353,6 +2353,7 @@ func_def:
 				append_int(f, $2);
 				append_int(f, FUNC_LANG_MAL);
 				append_int(f, $1);
+				append_int(f, FALSE);
 			  $$ = _symbol_create_list( SQL_CREATE_FUNC, f ); }
  |  create_or_replace func_def_type qname
 	'(' opt_paramlist ')'
@@ -2367,26 +2368,33 @@ func_def:
 				append_int(f, $2);
 				append_int(f, FUNC_LANG_SQL);
 				append_int(f, $1);
+				append_int(f, FALSE);
 			  $$ = _symbol_create_list( SQL_CREATE_FUNC, f ); }
   | create_or_replace func_def_type qname
 	'(' opt_paramlist ')'
     func_def_opt_return
     LANGUAGE IDENT function_body
 		{
-			int lang = 0;
+			int lang = 0, map = FALSE;
 			dlist *f = L();
 			char l = *$9;
+			size_t len = strlen($9);
 
+			/* a _MAP suffix declares the function safe to run per partition */
+			if (len > 4 && strcasecmp($9 + len - 4, "_MAP") == 0) {
+				map = TRUE;
+				len -= 4;
+			}
 			if (l == 'R' || l == 'r')
 				lang = FUNC_LANG_R;
 			else if (l == 'P' || l == 'p') {
-				if (strcasecmp($9, "PYTHON3") == 0) {
+				if (len == 7 && strncasecmp($9, "PYTHON3", len) == 0) {
 					lang = FUNC_LANG_PY3;
 				} else {
 					lang = FUNC_LANG_PY;
 				}
 			} else if (l == 'C' || l == 'c') {
-				if (strcasecmp($9, "CPP") == 0) {
+				if (len == 3 && strncasecmp($9, "CPP", len) == 0) {
 					lang = FUNC_LANG_CPP;
 				} else {
 					lang = FUNC_LANG_C;
@@ -2406,6 +2414,7 @@ func_def:
 			append_int(f, $2);
 			append_int(f, lang);
 			append_int(f, $1);
+			append_int(f, map);
 			$$ = _symbol_create_list( SQL_CREATE_FUNC, f );
 		}
 ;
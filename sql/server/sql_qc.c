@@ -16,6 +16,7 @@
 #include "sql_mvc.h"
 #include "sql_atom.h"
 #include "rel_exp.h"
+#include "sql_semantic.h"
 #include "gdk_time.h"
 
 qc *
@@ -195,3 +196,645 @@ qc_size(qc *cache)
 {
 	return cache ? cache->nr : 0;
 }
+
+/*
+ * Shared plans
+ * Queries which only differ in the constants used in their predicates
+ * share a single plan. The constants are lifted into parameters, the
+ * resulting shape of the query (together with the session settings which
+ * influence its compilation) is the key into a server wide cache. The
+ * plans themselves are compiled by the backend into its shared module.
+ */
+static MT_Lock qc_planLock = MT_LOCK_INITIALIZER(qc_planLock);
+static qp **qc_plans = NULL;	/* hash buckets */
+static BUN qc_planmask = 0;
+static qp *qc_newest = NULL, *qc_oldest = NULL;
+static int qc_nplans = 0;
+static int qc_plancapacity = -1;
+static ATOMIC_TYPE qc_plannr = ATOMIC_VAR_INIT(0);
+
+int
+qc_plan_capacity(void)
+{
+	if (qc_plancapacity < 0)
+		qc_plancapacity = GDKgetenv_int("sql_plan_cache", DEFAULT_PLANCACHESIZE);
+	return qc_plancapacity;
+}
+
+typedef struct shape {
+	mvc *sql;
+	char *key;
+	size_t len, size;
+	list *values;		/* the lifted constants */
+	int cond;			/* within the conditions of a query */
+	bool error;
+	bool valued;		/* a constant in a condition stays part of the shape */
+} shape;
+
+static void
+shape_add(shape *sh, const char *data, size_t len)
+{
+	if (sh->error)
+		return;
+	if (sh->len + len >= sh->size) {
+		size_t size = (sh->len + len + 1) * 2;
+		char *key = sa_realloc(sh->sql->sa, sh->key, size, sh->size);
+
+		if (!key) {
+			sh->error = true;
+			return;
+		}
+		sh->key = key;
+		sh->size = size;
+	}
+	memcpy(sh->key + sh->len, data, len);
+	sh->len += len;
+	sh->key[sh->len] = 0;
+}
+
+static void
+shape_int(shape *sh, char tag, lng v)
+{
+	char buf[32];
+	int len = snprintf(buf, sizeof(buf), "%c" LLFMT, tag, v);
+
+	shape_add(sh, buf, (size_t) len);
+}
+
+static void
+shape_str(shape *sh, const char *s)
+{
+	if (!s) {
+		shape_add(sh, "~", 1);
+		return;
+	}
+	size_t len = strlen(s);
+	shape_int(sh, 's', (lng) len);
+	shape_add(sh, ":", 1);
+	shape_add(sh, s, len);
+}
+
+static void
+shape_type(shape *sh, sql_subtype *t)
+{
+	if (!t->type) {
+		shape_add(sh, "~", 1);
+		return;
+	}
+	shape_int(sh, 't', t->type->base.id);
+	shape_int(sh, ',', t->digits);
+	shape_int(sh, ',', t->scale);
+}
+
+static symbol *shape_symbol(shape *sh, symbol *s);
+
+static bool
+shape_atom(dnode *n)
+{
+	return n && n->type == type_symbol && n->data.sym && n->data.sym->token == SQL_ATOM;
+}
+
+/* constants are lifted from the operands of comparisons, ranges and
+ * in-lists. Comparisons of constants are folded by the optimizer and
+ * like patterns are rewritten depending on their value, those stay part
+ * of the shape. */
+static bool
+shape_liftable(tokens token, dlist *l, int i)
+{
+	switch (token) {
+	case SQL_COMPARE:
+		return dlist_length(l) == 3 &&
+			((i == 0 && !shape_atom(l->h->next->next)) || (i == 2 && !shape_atom(l->h)));
+	case SQL_BETWEEN:
+	case SQL_NOT_BETWEEN:
+		return dlist_length(l) == 4 &&
+			((i == 0 && !(shape_atom(l->h->next->next) && shape_atom(l->h->next->next->next))) ||
+			 ((i == 2 || i == 3) && !shape_atom(l->h)));
+	default:
+		return false;
+	}
+}
+
+static symbol *
+shape_literal(shape *sh, symbol *s)
+{
+	if (s && s->token == SQL_ATOM && s->type == type_symbol) {
+		atom *a = ((AtomNode *) s)->a;
+
+		if (a && !a->isnull && a->tpe.type) {
+			sql_class ec = a->tpe.type->eclass;
+
+			if (EC_EXACTNUM(ec) || ec == EC_FLT || EC_VARCHAR(ec)) {
+				int nr = list_length(sh->sql->params);
+
+				sql_add_param(sh->sql, NULL, NULL);
+				if (!list_append(sh->values, a)) {
+					sh->error = true;
+					return NULL;
+				}
+				shape_add(sh, "?", 1);
+				return symbol_create_int(sh->sql->sa, SQL_PARAMETER, nr);
+			}
+		}
+	}
+	return shape_symbol(sh, s);
+}
+
+static dlist *
+shape_dlist(shape *sh, dlist *l, tokens token, bool lift)
+{
+	allocator *sa = sh->sql->sa;
+	dlist *nl;
+	int i = 0;
+
+	if (!l) {
+		shape_add(sh, "~", 1);
+		return NULL;
+	}
+	if (!(nl = dlist_create(sa))) {
+		sh->error = true;
+		return NULL;
+	}
+	shape_add(sh, "[", 1);
+	for (dnode *n = l->h; n && !sh->error; n = n->next, i++) {
+		dlist *res = NULL;
+
+		switch (n->type) {
+		case type_int:
+			shape_int(sh, 'i', n->data.i_val);
+			res = dlist_append_int(sa, nl, n->data.i_val);
+			break;
+		case type_lng:
+			shape_int(sh, 'l', n->data.l_val);
+			res = dlist_append_lng(sa, nl, n->data.l_val);
+			break;
+		case type_string:
+			shape_str(sh, n->data.sval);
+			res = dlist_append_string(sa, nl, n->data.sval);
+			break;
+		case type_list:
+			/* the values of 'a IN (...)' */
+			res = dlist_append_list(sa, nl, shape_dlist(sh, n->data.lval, 0,
+						(token == SQL_IN || token == SQL_NOT_IN) && i == 1 && l->h->type == type_symbol && !shape_atom(l->h)));
+			break;
+		case type_symbol:
+			if (lift || shape_liftable(token, l, i))
+				res = dlist_append_symbol(sa, nl, shape_literal(sh, n->data.sym));
+			else
+				res = dlist_append_symbol(sa, nl, shape_symbol(sh, n->data.sym));
+			break;
+		case type_type:
+			shape_type(sh, &n->data.typeval);
+			res = dlist_append_type(sa, nl, &n->data.typeval);
+			break;
+		}
+		if (!res)
+			sh->error = true;
+	}
+	shape_add(sh, "]", 1);
+	return nl;
+}
+
+static symbol *
+shape_select(shape *sh, SelectNode *s)
+{
+	SelectNode *n = (SelectNode *) newSelectNode(sh->sql->sa, s->distinct, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	if (!n) {
+		sh->error = true;
+		return NULL;
+	}
+	n->lateral = s->lateral;
+	shape_int(sh, 'd', s->distinct);
+	shape_int(sh, 'L', s->lateral);
+	n->limit = shape_symbol(sh, s->limit);
+	n->offset = shape_symbol(sh, s->offset);
+	n->sample = shape_symbol(sh, s->sample);
+	n->seed = shape_symbol(sh, s->seed);
+	n->name = shape_symbol(sh, s->name);
+	n->orderby = shape_symbol(sh, s->orderby);
+	sh->cond++;
+	n->having = shape_symbol(sh, s->having);
+	sh->cond--;
+	n->groupby = shape_symbol(sh, s->groupby);
+	sh->cond++;
+	n->where = shape_symbol(sh, s->where);
+	n->from = shape_symbol(sh, s->from);
+	sh->cond--;
+	n->window = shape_symbol(sh, s->window);
+	n->selection = shape_dlist(sh, s->selection, SQL_SELECT, false);
+	n->into = shape_dlist(sh, s->into, SQL_SELECT, false);
+	return (symbol *) n;
+}
+
+static symbol *
+shape_symbol(shape *sh, symbol *s)
+{
+	allocator *sa = sh->sql->sa;
+	symbol *ns = NULL;
+
+	if (!s) {
+		shape_add(sh, "~", 1);
+		return NULL;
+	}
+	shape_int(sh, '(', s->token);
+	shape_int(sh, ':', s->type);
+	switch (s->type) {
+	case type_int:
+		shape_int(sh, 'i', s->data.i_val);
+		ns = symbol_create_int(sa, s->token, s->data.i_val);
+		break;
+	case type_lng:
+		shape_int(sh, 'l', s->data.l_val);
+		ns = symbol_create_lng(sa, s->token, s->data.l_val);
+		break;
+	case type_string:
+		shape_str(sh, s->data.sval);
+		ns = symbol_create(sa, s->token, s->data.sval);
+		break;
+	case type_list:
+		ns = symbol_create_list(sa, s->token, shape_dlist(sh, s->data.lval, s->token, false));
+		break;
+	case type_type:
+		shape_type(sh, &s->data.typeval);
+		if ((ns = SA_NEW(sa, symbol)) != NULL)
+			*ns = *s;
+		break;
+	case type_symbol:
+		if (s->token == SQL_SELECT) {
+			ns = shape_select(sh, (SelectNode *) s);
+		} else if (s->token == SQL_ATOM) {
+			atom *a = ((AtomNode *) s)->a;
+
+			shape_add(sh, "a", 1);
+			if (sh->cond)
+				sh->valued = true;
+			if (a) {
+				shape_type(sh, &a->tpe);
+				if (a->isnull) {
+					shape_add(sh, "n", 1);
+				} else {
+					char *v = atom2string(sa, a);
+
+					if (!v)
+						sh->error = true;
+					shape_str(sh, v);
+				}
+				a = atom_copy(sa, a);
+			}
+			ns = newAtomNode(sa, a);
+		} else {
+			ns = symbol_create_symbol(sa, s->token, shape_symbol(sh, s->data.sym));
+		}
+		break;
+	}
+	shape_add(sh, ")", 1);
+	if (!ns)
+		sh->error = true;
+	return ns;
+}
+
+static bool
+shape_query(symbol *s)
+{
+	switch (s->token) {
+	case SQL_SELECT:
+		return s->type == type_symbol && !((SelectNode *) s)->into;
+	case SQL_UNION:
+	case SQL_EXCEPT:
+	case SQL_INTERSECT:
+		return s->type == type_list;
+	case SQL_WITH: {
+		dnode *n = s->type == type_list ? s->data.lval->h->next : NULL;
+		return n && n->type == type_symbol && n->data.sym && shape_query(n->data.sym);
+	}
+	default:
+		return false;
+	}
+}
+
+/* Returns a copy of the query with its constants replaced by parameters
+ * (added to sql->params), the constants themselves are in 'values'.
+ * Shared plans are compiled without value based optimization, queries
+ * with constants in their conditions which cannot be lifted are left to
+ * the regular compilation. */
+symbol *
+qc_shape(mvc *sql, symbol *s, const char *ctx, char **key, list **values)
+{
+	shape sh = { .sql = sql };
+	symbol *ns;
+
+	if (!s || !shape_query(s) || !(sh.values = sa_list(sql->sa)))
+		return NULL;
+	shape_str(&sh, ctx);
+	ns = shape_symbol(&sh, s);
+	if (sh.error || sh.valued || !ns)
+		return NULL;
+	*key = sh.key;
+	*values = sh.values;
+	return ns;
+}
+
+/* Convert a lifted constant to the type of its parameter, only if that
+ * doesn't change its value, ie the query keeps its meaning. */
+atom *
+qc_plan_arg(allocator *sa, atom *a, sql_subtype *t)
+{
+	sql_class from = a->tpe.type->eclass, to = t->type->eclass;
+	atom *na = NULL;
+
+	if (EC_VARCHAR(from) && (EC_VARCHAR(to) || EC_TEMP(to))) {
+		na = atom_cast(sa, a, t);
+	} else if (EC_EXACTNUM(from) && EC_EXACTNUM(to)) {
+		atom *back = NULL;
+
+		if (from == EC_NUM && to == EC_NUM && atom_digits(a) > t->digits)
+			return NULL;	/* out of range, don't let the conversion complain */
+		if ((na = atom_cast(sa, a, t)) == NULL ||
+			(back = atom_cast(sa, na, &a->tpe)) == NULL || atom_cmp(back, a) != 0)
+			na = NULL;
+	} else if (to == EC_FLT && t->type->localtype == TYPE_dbl && (EC_EXACTNUM(from) || from == EC_FLT)) {
+		na = atom_cast(sa, a, t);
+	} else if (to == EC_FLT && from == EC_NUM && atom_num_digits(a) <= 7) {
+		na = atom_cast(sa, a, t);	/* exact in single precision */
+	}
+	return na;
+}
+
+static void
+qp_destroy(qp *p)
+{
+	if (p->f && p->f->instantiated)
+		backend_freecode(sql_shared_module_name, 0, p->f->imp);
+	sa_destroy(p->sa);
+}
+
+/* the buckets are sized for the capacity, called with qc_planLock held */
+static bool
+qp_buckets(void)
+{
+	BUN n = 64;
+
+	if (qc_plans)
+		return true;
+	while (n < (BUN) qc_plan_capacity())
+		n <<= 1;
+	if (!(qc_plans = GDKzalloc(n * sizeof(qp *))))
+		return false;
+	qc_planmask = n - 1;
+	return true;
+}
+
+static void
+qp_use(qp *p)
+{
+	if (p == qc_newest)
+		return;
+	if (p->older || p->newer || p == qc_oldest) {
+		if (p->newer)
+			p->newer->older = p->older;
+		if (p->older)
+			p->older->newer = p->newer;
+		else
+			qc_oldest = p->newer;
+	}
+	p->newer = NULL;
+	p->older = qc_newest;
+	if (qc_newest)
+		qc_newest->newer = p;
+	else
+		qc_oldest = p;
+	qc_newest = p;
+}
+
+/* unlink the plan from the cache, returns it when it can be destroyed */
+static qp *
+qp_evict(qp *p)
+{
+	qp **b = &qc_plans[p->hash & qc_planmask];
+
+	while (*b != p)
+		b = &(*b)->next;
+	*b = p->next;
+	if (p->newer)
+		p->newer->older = p->older;
+	else
+		qc_newest = p->older;
+	if (p->older)
+		p->older->newer = p->newer;
+	else
+		qc_oldest = p->newer;
+	p->next = p->older = p->newer = NULL;
+	p->evicted = true;
+	qc_nplans--;
+	return p->pins ? NULL : p;
+}
+
+qp *
+qc_plan_find(const char *key, int schema_version)
+{
+	BUN hash = strHash(key);
+	qp *res = NULL, *n, *garbage = NULL;
+
+	MT_lock_set(&qc_planLock);
+	for (qp *p = qc_plans ? qc_plans[hash & qc_planmask] : NULL; p; p = n) {
+		n = p->next;
+		if (p->schema_version < schema_version) {
+			/* compiled against an older catalog */
+			qp *g = qp_evict(p);
+			if (g) {
+				g->next = garbage;
+				garbage = g;
+			}
+			continue;
+		}
+		if (p->hash == hash && p->schema_version == schema_version && strcmp(p->key, key) == 0) {
+			res = p;
+			res->pins++;
+			res->count++;
+			qp_use(p);
+			break;
+		}
+	}
+	MT_lock_unset(&qc_planLock);
+	for (qp *g = garbage; g; g = n) {
+		n = g->next;
+		qp_destroy(g);
+	}
+	return res;
+}
+
+static qp *
+qp_create(const char *key, int schema_version)
+{
+	allocator *sa = sa_create(NULL);
+	qp *p;
+
+	if (!sa)
+		return NULL;
+	if (!(p = SA_ZNEW(sa, qp)) || !(p->key = sa_strdup(sa, key))) {
+		sa_destroy(sa);
+		return NULL;
+	}
+	p->sa = sa;
+	p->hash = strHash(key);
+	p->schema_version = schema_version;
+	p->pins = 1;
+	p->evicted = true;	/* not yet in the cache */
+	return p;
+}
+
+/* Create a pinned plan for the query shape, its parameters are taken over
+ * from the compilation. The backend generates the code for 'f'. */
+qp *
+qc_plan_create(const char *key, int schema_version, list *params)
+{
+	qp *p = qp_create(key, schema_version);
+	char name[IDLENGTH];
+	sql_func *f;
+
+	if (!p)
+		return NULL;
+	if (!(f = SA_NEW(p->sa, sql_func))) {
+		sa_destroy(p->sa);
+		return NULL;
+	}
+	(void) snprintf(name, sizeof(name), "q_%d", (int) ATOMIC_INC(&qc_plannr));
+	*f = (sql_func) {
+		.mod = sql_shared_module_name,
+		.type = F_PROC,
+		.lang = FUNC_LANG_SQL,
+		.ops = sa_list(p->sa),
+	};
+	base_init(p->sa, &f->base, 0, true, NULL);
+	f->base.name = f->imp = sa_strdup(p->sa, name);
+	if (!f->ops || !f->imp) {
+		sa_destroy(p->sa);
+		return NULL;
+	}
+	if (params) {
+		for (node *n = params->h; n; n = n->next) {
+			sql_arg *a = n->data;
+
+			if (!list_append(f->ops, sql_create_arg(p->sa, NULL, &a->type, ARG_IN))) {
+				sa_destroy(p->sa);
+				return NULL;
+			}
+		}
+	}
+	p->f = f;
+	return p;
+}
+
+/* remember that parameter 'nr' selects on column 'c', when its value
+ * lies outside the range of the column the regular compilation prunes
+ * the selection, which the shared plan can't */
+int
+qc_plan_bind(qp *p, int nr, sql_column *c)
+{
+	qp_col *b;
+
+	if (!p->cols && !(p->cols = sa_list(p->sa)))
+		return -1;
+	if (!(b = SA_NEW(p->sa, qp_col)))
+		return -1;
+	*b = (qp_col) {
+		.nr = nr,
+		.sname = sa_strdup(p->sa, c->t->s->base.name),
+		.tname = sa_strdup(p->sa, c->t->base.name),
+		.cname = sa_strdup(p->sa, c->base.name),
+	};
+	if (!b->sname || !b->tname || !b->cname || !list_append(p->cols, b))
+		return -1;
+	return 0;
+}
+
+static void
+qp_publish(qp *p)
+{
+	qp *n, *garbage = NULL;
+	int capacity = qc_plan_capacity();
+
+	MT_lock_set(&qc_planLock);
+	if (!qp_buckets()) {
+		MT_lock_unset(&qc_planLock);
+		if (!p->pins)
+			qp_destroy(p);
+		return;
+	}
+	/* another session may have been compiling the same query */
+	for (qp *o = qc_plans[p->hash & qc_planmask]; o; o = n) {
+		n = o->next;
+		if (o->hash == p->hash && o->schema_version == p->schema_version && strcmp(o->key, p->key) == 0) {
+			qp *g = qp_evict(o);
+			if (g) {
+				g->next = garbage;
+				garbage = g;
+			}
+		}
+	}
+	/* the cache is full, drop the least recently used */
+	while (qc_oldest && qc_nplans >= capacity) {
+		qp *g = qp_evict(qc_oldest);
+		if (g) {
+			g->next = garbage;
+			garbage = g;
+		}
+	}
+	p->evicted = false;
+	p->next = qc_plans[p->hash & qc_planmask];
+	qc_plans[p->hash & qc_planmask] = p;
+	qp_use(p);
+	qc_nplans++;
+	MT_lock_unset(&qc_planLock);
+	for (qp *g = garbage; g; g = n) {
+		n = g->next;
+		qp_destroy(g);
+	}
+}
+
+void
+qc_plan_publish(qp *p, mapi_query_t type)
+{
+	p->type = type;
+	p->f->instantiated = true;
+	qp_publish(p);
+}
+
+/* remember the query shape cannot be parameterized */
+void
+qc_plan_reject(const char *key, int schema_version)
+{
+	qp *p = qp_create(key, schema_version);
+
+	if (p) {
+		p->pins = 0;
+		qp_publish(p);
+	}
+}
+
+void
+qc_plan_release(qp *p)
+{
+	bool destroy;
+
+	MT_lock_set(&qc_planLock);
+	destroy = --p->pins == 0 && p->evicted;
+	MT_lock_unset(&qc_planLock);
+	if (destroy)
+		qp_destroy(p);
+}
+
+void
+qc_plan_clean(void)
+{
+	MT_lock_set(&qc_planLock);
+	while (qc_oldest) {
+		qp *g = qp_evict(qc_oldest);
+		if (g)
+			qp_destroy(g);
+	}
+	GDKfree(qc_plans);
+	qc_plans = NULL;
+	MT_lock_unset(&qc_planLock);
+}
@@ -51,4 +51,37 @@ sql_export cq *qc_insert(qc *cache, allocator *sa, sql_rel *r, symbol *s, list *
 sql_export void qc_delete(qc *cache, cq *q);
 extern int qc_size(qc *cache);
 
+/* plans shared by all sessions, for queries which only differ in their constants */
+#define DEFAULT_PLANCACHESIZE 0
+typedef struct qp_col {
+	int nr;				/* the parameter */
+	const char *sname, *tname, *cname;	/* the column it is compared with */
+} qp_col;
+
+typedef struct qp {
+	struct qp *next;	/* next plan in the hash bucket */
+	struct qp *older, *newer;	/* the plans in order of use */
+	allocator *sa;		/* the plan is allocated from this sa */
+	const char *key;	/* the normalized query shape */
+	BUN hash;
+	int schema_version;	/* catalog version the plan was compiled against */
+	mapi_query_t type;	/* sql_query_t: Q_PARSE,Q_SCHEMA,.. */
+	int pins;			/* number of sessions using the plan */
+	bool evicted;		/* no longer in the cache, destroyed when unpinned */
+	lng count;			/* number of times the plan is matched */
+	sql_func *f;		/* the shared plan, NULL if the shape cannot be parameterized */
+	list *cols;			/* qp_col: parameters which select on a column */
+} qp;
+
+extern int qc_plan_capacity(void);
+extern symbol *qc_shape(mvc *sql, symbol *s, const char *ctx, char **key, list **values);
+extern atom *qc_plan_arg(allocator *sa, atom *a, sql_subtype *t);
+extern qp *qc_plan_find(const char *key, int schema_version);
+extern qp *qc_plan_create(const char *key, int schema_version, list *params);
+extern int qc_plan_bind(qp *p, int nr, sql_column *c);
+extern void qc_plan_publish(qp *p, mapi_query_t type);
+extern void qc_plan_reject(const char *key, int schema_version);
+extern void qc_plan_release(qp *p);
+extern void qc_plan_clean(void);
+
 #endif /*_SQL_QC_H_*/
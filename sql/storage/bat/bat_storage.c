@@ -919,6 +919,10 @@ cs_bind_bat( column_storage *cs, int access, size_t cnt)
 	if (b == NULL)
 		return NULL;
 	assert(b->batRestricted == BAT_READ);
+	/* the bounds of a run length encoded column have one entry per
+	 * run, runs are never appended to */
+	if (cs->st == ST_RLE)
+		cnt = BATcount(b);
 	/* return slice */
 	BAT *s = BATslice(b, 0, cnt);
 	bat_destroy(b);
@@ -1301,6 +1305,8 @@ cs_update_bat( sql_trans *tr, sql_delta **batp, sql_table *t, BAT *tids, BAT *up
 	if (!BATcount(tids))
 		return LOG_OK;
 
+	/* runs only exist in read only tables */
+	assert(cs->st != ST_RLE);
 	if (tids && (tids->ttype == TYPE_msk || mask_cand(tids))) {
 		tids = BATunmask(tids);
 		if (!tids)
@@ -1831,6 +1837,8 @@ cs_update_val( sql_trans *tr, sql_delta **batp, sql_table *t, oid rid, void *upd
 	column_storage *cs = &bat->cs;
 	storage *s = ATOMIC_PTR_GET(&t->data);
 	assert(!is_oid_nil(rid));
+
+	assert(cs->st != ST_RLE);	/* runs only exist in read only tables */
 	int inplace = is_new || cs->cleared || segments_is_append (s->segs->h, tr, rid);
 
 	if (cs->st == ST_DICT) {
@@ -2123,6 +2131,7 @@ delta_append_bat(sql_trans *tr, sql_delta **batp, sqlid id, BUN offset, BAT *off
 		return LOG_ERR;
 
 	lock_column(tr->store, id);
+	assert(bat->cs.st != ST_RLE);	/* runs only exist in read only tables */
 	if (bat->cs.st == ST_DICT) {
 		BAT *ni = dict_append_bat(tr, batp, oi);
 		bat = *batp;
@@ -2208,6 +2217,7 @@ delta_append_val(sql_trans *tr, sql_delta **batp, sqlid id, BUN offset, BAT *off
 	lock_column(tr->store, id);
 	sql_delta *bat = *batp;
 
+	assert(bat->cs.st != ST_RLE);	/* runs only exist in read only tables */
 	if (bat->cs.st == ST_DICT) {
 		/* possibly a new array is returned */
 		i = dict_append_val(tr, batp, i, cnt);
@@ -2335,7 +2345,7 @@ append_col(sql_trans *tr, sql_column *c, BUN offset, BAT *offsets, void *data, B
 	if ((delta = bind_col_data(tr, c, NULL)) == NULL)
 		return LOG_ERR;
 
-	assert(delta->cs.st == ST_DEFAULT || delta->cs.st == ST_DICT || delta->cs.st == ST_FOR);
+	assert(delta->cs.st == ST_DEFAULT || delta->cs.st == ST_DICT || delta->cs.st == ST_FOR || delta->cs.st == ST_RLE);
 
 	odelta = delta;
 	if ((res = append_col_execute(tr, &delta, c->base.id, offset, offsets, data, cnt, isbat, tpe, c->storage_type)) != LOG_OK)
@@ -2758,7 +2768,7 @@ min_max_col(sql_trans *tr, sql_column *c)
 	if ((d = ATOMIC_PTR_GET(&c->data))) {
 		if (d->cs.st == ST_FOR)
 			return 0;
-		int access = d->cs.st == ST_DICT ? RD_EXT : RDONLY;
+		int access = d->cs.st == ST_DICT || d->cs.st == ST_RLE ? RD_EXT : RDONLY;
 		lock_column(tr->store, c->base.id);
 		if (c->min && c->max) {
 			unlock_column(tr->store, c->base.id);
@@ -2793,6 +2803,44 @@ min_max_col(sql_trans *tr, sql_column *c)
 	return ok;
 }
 
+/* The min and max of the values stored for a column.  Unlike min_max_col
+ * and col_stats these are never taken from the statistics set by analyze,
+ * which may be outdated, and they are computed when unknown, e.g. after
+ * an append.  Deleted rows may make the range wider than needed. */
+static int
+col_ranges(sql_trans *tr, sql_column *c, ValPtr min, ValPtr max)
+{
+	int ok = 0;
+	BAT *b = NULL;
+	sql_delta *d = NULL;
+
+	assert(tr->active);
+	if (!c || !isTable(c->t) || !c->t->s || !(d = ATOMIC_PTR_GET(&c->data)))
+		return 0;
+	/* the pending updates are not part of the stored range */
+	if (d->cs.st == ST_FOR || d->cs.ucnt > 0)
+		return 0;
+	int access = d->cs.st == ST_DICT || d->cs.st == ST_RLE ? RD_EXT : RDONLY;
+	if (!(b = bind_col(tr, c, access)) || !(b = bind_no_view(b, false)))
+		return 0;
+	if (ATOMlinear(b->ttype) && BATcount(b) > 0) {
+		void *nmin = BATmin(b, NULL), *nmax = BATmax(b, NULL);
+		const void *nil = ATOMnilptr(b->ttype);
+
+		if (nmin && nmax && ATOMcmp(b->ttype, nmin, nil) != 0 && ATOMcmp(b->ttype, nmax, nil) != 0 &&
+			VALinit(min, b->ttype, nmin)) {
+			if (VALinit(max, b->ttype, nmax))
+				ok = 1;
+			else
+				VALclear(min);
+		}
+		GDKfree(nmin);
+		GDKfree(nmax);
+	}
+	bat_destroy(b);
+	return ok;
+}
+
 static size_t
 count_segs(segment *s)
 {
@@ -2822,6 +2870,36 @@ count_del(sql_trans *tr, sql_table *t, int access)
 	return count_deletes(d->segs->h, tr);
 }
 
+/* The commit time of the latest change of the table, if the transaction
+ * sees the latest committed state of the table and has no changes of its own */
+static bool
+tab_version(sql_trans *tr, sql_table *t, ulng *version)
+{
+	storage *d;
+	ulng v;
+
+	if (!isTable(t) || isTempTable(t) || tr->parent)
+		return false;
+	d = ATOMIC_PTR_GET(&t->data);
+	if (!d || d->cs.ts >= tr->ts)
+		return false;
+	v = d->cs.ts;
+	for (segment *s = d->segs->h; s; s = ATOMIC_PTR_GET(&s->next)) {
+		if (s->ts >= tr->ts)
+			return false;
+		v = MAX(v, s->ts);
+	}
+	for (node *n = ol_first_node(t->columns); n; n = n->next) {
+		sql_delta *ds = ATOMIC_PTR_GET(&((sql_column *) n->data)->data);
+
+		if (!ds || ds->cs.ts >= tr->ts)
+			return false;
+		v = MAX(v, ds->cs.ts);
+	}
+	*version = v;
+	return true;
+}
+
 static int
 sorted_col(sql_trans *tr, sql_column *col)
 {
@@ -2910,7 +2988,7 @@ col_stats(sql_trans *tr, sql_column *c, bool *nonil, bool *unique, double *uniqu
 			return ok;
 		}
 		int eclass = c->type.type->eclass;
-		int access = d->cs.st == ST_DICT ? RD_EXT : RDONLY;
+		int access = d->cs.st == ST_DICT || d->cs.st == ST_RLE ? RD_EXT : RDONLY;
 		if ((b = bind_col(tr, c, access))) {
 			if (!(b = bind_no_view(b, false)))
 				return ok;
@@ -2940,6 +3018,11 @@ col_stats(sql_trans *tr, sql_column *c, bool *nonil, bool *unique, double *uniqu
 					*unique = off->tkey;
 					*unique_est = off->tunique_est;
 					MT_lock_unset(&off->theaplock);
+				} else if (d->cs.st == ST_RLE) {
+					/* the values of the runs hold all distinct values */
+					*unique_est = bi.unique_est;
+					if (*unique_est == 0)
+						*unique_est = (double)BATguess_uniques(b,NULL);
 				}
 			}
 			bat_iterator_end(&bi);
@@ -3128,6 +3211,13 @@ create_col(sql_trans *tr, sql_column *c)
 				bat->cs.st = ST_DICT;
 			} else if (strncmp(c->storage_type, "FOR", 3) == 0) {
 				bat->cs.st = ST_FOR;
+			} else if (strcmp(c->storage_type, "RLE") == 0) {
+				sqlstore *store = tr->store;
+				int bid = log_find_bat(store->logger, -c->base.id);
+				if (bid <= 0)
+					return LOG_ERR;
+				bat->cs.ebid = temp_dup(bid);
+				bat->cs.st = ST_RLE;
 			}
 		}
 		return ok;
@@ -3732,11 +3822,17 @@ clear_cs(sql_trans *tr, column_storage *cs, bool renew, bool temp)
 	BUN sz = 0;
 
 	(void)tr;
-	assert(cs->st == ST_DEFAULT || cs->st == ST_DICT || cs->st == ST_FOR);
+	assert(cs->st == ST_DEFAULT || cs->st == ST_DICT || cs->st == ST_FOR || cs->st == ST_RLE);
 	if (cs->bid && renew) {
 		b = quick_descriptor(cs->bid);
 		if (b) {
-			sz += BATcount(b);
+			if (cs->st == ST_RLE) {
+				/* the bounds hold one more entry than there are runs */
+				const oid *bnd = Tloc(b, 0);
+				sz += bnd[BATcount(b) - 1] - bnd[0];
+			} else {
+				sz += BATcount(b);
+			}
 			if (cs->st == ST_DICT) {
 				bat nebid = temp_copy(cs->ebid, true, temp); /* create empty copy */
 				BAT *n = COLnew(0, TYPE_bte, 0, PERSISTENT);
@@ -3753,6 +3849,23 @@ clear_cs(sql_trans *tr, column_storage *cs, bool renew, bool temp)
 				temp_destroy(cs->bid);
 				cs->bid = temp_create(n); /* create empty copy */
 				bat_destroy(n);
+			} else if (cs->st == ST_RLE) {
+				bat nebid = temp_copy(cs->ebid, true, temp); /* create empty copy */
+				BAT *n = COLnew(0, TYPE_oid, 1, PERSISTENT);
+				oid o = 0;
+
+				if (nebid == BID_NIL || !n || BUNappend(n, &o, false) != GDK_SUCCEED) {
+					temp_destroy(nebid);
+					bat_destroy(n);
+					return BUN_NONE;
+				}
+				temp_destroy(cs->ebid);
+				cs->ebid = nebid;
+				if (!temp)
+					bat_set_access(n, BAT_READ);
+				temp_destroy(cs->bid);
+				cs->bid = temp_create(n); /* no runs */
+				bat_destroy(n);
 			} else {
 				bat nbid = temp_copy(cs->bid, true, false); /* create empty copy */
 
@@ -5114,6 +5227,21 @@ col_compress(sql_trans *tr, sql_column *col, storage_type st, BAT *o, BAT *u)
 			return LOG_ERR;
 		d->cs.ebid = temp_create(u);
 	}
+	if (st == ST_DEFAULT && d->cs.ebid) {
+		/* an expanded column no longer needs its dictionary or runs */
+		temp_destroy(d->cs.ebid);
+		d->cs.ebid = 0;
+	}
+	if (st == ST_RLE && d->cs.ucnt) {
+		/* the run length encoding is made of the updated column, the
+		 * pending updates cannot be applied to the runs */
+		if (odelta == d) {
+			temp_destroy(d->cs.uibid);
+			temp_destroy(d->cs.uvbid);
+		}
+		d->cs.uibid = d->cs.uvbid = 0;
+		d->cs.ucnt = 0;
+	}
 	return LOG_OK;
 }
 
@@ -5142,7 +5270,9 @@ bat_storage_init( store_functions *sf)
 	sf->count_col = &count_col;
 	sf->count_idx = &count_idx;
 	sf->dcount_col = &dcount_col;
+	sf->tab_version = &tab_version;
 	sf->min_max_col = &min_max_col;
+	sf->col_ranges = &col_ranges;
 	sf->set_stats_col = &set_stats_col;
 	sf->sorted_col = &sorted_col;
 	sf->unique_col = &unique_col;
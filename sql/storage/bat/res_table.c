@@ -93,9 +93,11 @@ res_col_create(sql_trans *tr, res_table *t, const char *tn, const char *name, co
 	}
 	c->b = b->batCacheid;
 	c->cached = cached;
-	if (cached)
+	if (cached) {
+		/* the result may be exported by another thread */
+		BBPdisown(b->batCacheid);
 		c->p = (void*)b;
-	else
+	} else
 		bat_incref(c->b);
 	t->cur_col++;
 	assert(t->cur_col <= t->nr_cols);
@@ -159,7 +159,9 @@ typedef size_t (*count_del_fptr) (sql_trans *tr, sql_table *t, int access);
 typedef size_t (*count_col_fptr) (sql_trans *tr, sql_column *c, int access);
 typedef size_t (*count_idx_fptr) (sql_trans *tr, sql_idx *i, int access);
 typedef size_t (*dcount_col_fptr) (sql_trans *tr, sql_column *c);
+typedef bool (*tab_version_fptr) (sql_trans *tr, sql_table *t, ulng *version);
 typedef int (*min_max_col_fptr) (sql_trans *tr, sql_column *c);
+typedef int (*col_ranges_fptr) (sql_trans *tr, sql_column *c, ValPtr min, ValPtr max);
 typedef int (*set_stats_col_fptr) (sql_trans *tr, sql_column *c, double *unique_est, char *min, char *max);
 typedef int (*prop_col_fptr) (sql_trans *tr, sql_column *c);
 typedef int (*proprec_col_fptr) (sql_trans *tr, sql_column *c, bool *nonil, bool *unique, double *unique_est, ValPtr min, ValPtr max);
@@ -213,6 +215,7 @@ typedef enum storage_type {
 	ST_DEFAULT = 0,
 	ST_DICT,
 	ST_FOR,
+	ST_RLE,
 } storage_type;
 
 typedef int (*col_compress_fptr) (sql_trans *tr, sql_column *c, storage_type st, BAT *offsets, BAT *vals);
@@ -247,7 +250,9 @@ typedef struct store_functions {
 	count_col_fptr count_col;
 	count_idx_fptr count_idx;
 	dcount_col_fptr dcount_col;
+	tab_version_fptr tab_version;	/* commit time of the last change seen */
 	min_max_col_fptr min_max_col;
+	col_ranges_fptr col_ranges;	/* min and max of the stored values, ignoring set statistics */
 	set_stats_col_fptr set_stats_col;
 	prop_col_fptr sorted_col;
 	prop_col_fptr unique_col;
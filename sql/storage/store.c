@@ -974,19 +974,19 @@ load_func(sql_trans *tr, sql_schema *s, sqlid fid, subrids *rs)
 	}
 	t->imp =_STRDUP(v);
 	store->table_api.column_find_string_end(cbat);
+	t->lang = (sql_flang) store->table_api.column_find_int(tr, find_sql_column(funcs, "language"), rid);
 	if (update_env) {
 		v = "inspect";
 	} else {
 		v = store->table_api.column_find_string_start(tr, find_sql_column(funcs, "mod"), rid, &cbat);
 	}
 	if (strcmp(v, "pyapi") == 0 ||	 /* pyapi module no longer used */
-		strcmp(v, "pyapi3map") == 0) /* pyapi3map module no longer used */
+		(strcmp(v, "pyapi3map") == 0 && ((int) t->lang == 7 || (int) t->lang == 11))) /* old forking PYTHON_MAP functions */
 		t->mod =_STRDUP("pypapi3");
 	else
 		t->mod =_STRDUP(v);
 	if (!update_env)
 		store->table_api.column_find_string_end(cbat);
-	t->lang = (sql_flang) store->table_api.column_find_int(tr, find_sql_column(funcs, "language"), rid);
 	t->instantiated = t->lang != FUNC_LANG_SQL && t->lang != FUNC_LANG_MAL;
 	t->type = (sql_ftype) store->table_api.column_find_int(tr, find_sql_column(funcs, "type"), rid);
 	t->side_effect = (bool) store->table_api.column_find_bte(tr, find_sql_column(funcs, "side_effect"), rid);
@@ -0,0 +1,60 @@
+import os, sys, tempfile, pymonetdb
+
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# A COPY INTO export of a large result is formatted by several threads.
+# The server is started with tablet_threads=4 so this does not depend
+# on the number of cores, and the result is sorted so that it is
+# exported in one piece.  The export is loaded back and compared.
+
+with tempfile.TemporaryDirectory() as farm_dir:
+    dbpath = os.path.join(farm_dir, 'db1')
+    os.mkdir(dbpath)
+    csv = os.path.join(farm_dir, 'copy_into_parallel.csv')
+
+    with process.server(args=['--set', 'tablet_threads=4'],
+                        mapiport='0', dbname='db1', dbfarm=farm_dir,
+                        stdin=process.PIPE, stdout=process.PIPE,
+                        stderr=process.PIPE) as s:
+        conn = pymonetdb.connect(database='db1', port=s.dbport, autocommit=True)
+        cur = conn.cursor()
+
+        cur.execute("CREATE TABLE fmt (i INT, d DECIMAL(10,2), s VARCHAR(20))")
+        cur.execute("INSERT INTO fmt SELECT value, CASE WHEN value % 7 = 0 THEN NULL ELSE value / 100.0 END, CASE WHEN value % 5 = 0 THEN 'a,\"b\"' || value ELSE 'r' || value END FROM generate_series(0, 100000)")
+
+        cur.execute("CALL logging.setcomplevel('MAL_SERVER', 'INFO')")
+        cur.execute("COPY SELECT * FROM fmt ORDER BY i INTO '{}' USING DELIMITERS ',',E'\\n','\"' NULL AS 'NIL'".format(csv))
+        cur.execute("CALL logging.flush()")
+        cur.execute("CALL logging.resetcomplevel('MAL_SERVER')")
+
+        with open(os.path.join(dbpath, 'mdbtrace.log'), encoding='utf-8', errors='replace') as f:
+            trace = f.read()
+        if 'Formatting 100000 rows with 4 threads' not in trace:
+            sys.stderr.write('Expected the export to be formatted by 4 threads\n')
+
+        cur.execute("CREATE TABLE fmt2 (i INT, d DECIMAL(10,2), s VARCHAR(20))")
+        cur.execute("COPY INTO fmt2 FROM '{}' USING DELIMITERS ',',E'\\n','\"' NULL AS 'NIL'".format(csv))
+
+        cur.execute("SELECT count(*) FROM fmt2")
+        res = cur.fetchall()
+        if res != [(100000,)]:
+            sys.stderr.write('Expected [(100000,)], got {}\n'.format(res))
+
+        cur.execute("SELECT i, d, s FROM fmt2 WHERE i IN (0, 1, 99995) ORDER BY i")
+        res = [(i, None if d is None else str(d), s) for (i, d, s) in cur.fetchall()]
+        if res != [(0, None, 'a,"b"0'), (1, '0.01', 'r1'), (99995, None, 'a,"b"99995')]:
+            sys.stderr.write('Unexpected rows {}\n'.format(res))
+
+        cur.execute("SELECT count(*) FROM (SELECT * FROM fmt EXCEPT ALL SELECT * FROM fmt2) AS d")
+        res = cur.fetchall()
+        if res != [(0,)]:
+            sys.stderr.write('Expected [(0,)], got {}\n'.format(res))
+
+        cur.execute("DROP TABLE fmt")
+        cur.execute("DROP TABLE fmt2")
+        cur.close()
+        conn.close()
+        s.communicate()
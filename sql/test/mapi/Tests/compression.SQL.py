@@ -0,0 +1,58 @@
+import os
+import subprocess
+
+from MonetDBtesting import malmapi
+
+TSTDB = os.environ['TSTDB']
+MAPIPORT = int(os.environ['MAPIPORT'])
+
+# a result of several large blocks which compresses well, and a query
+# which does not
+literal = ''.join(chr(ord('a') + (i * 7919) % 26) for i in range(100000))
+query = f"SELECT length('{literal}'), '{literal}', repeat('0123456789', 300000);\n"
+
+class Connection(malmapi.Connection):
+    """A connection which asks for the given handshake options"""
+    def __init__(self, options):
+        super().__init__()
+        self.options = options
+        self.challenge = None
+
+    def _challenge_response(self, challenge):
+        self.challenge = challenge
+        return super()._challenge_response(challenge) + f'FILETRANS:{self.options}:'
+
+def connect(options):
+    conn = Connection(options)
+    conn.connect(database=TSTDB, username='monetdb', password='monetdb',
+                 language='sql', hostname='localhost', port=MAPIPORT)
+    return conn
+
+def run_mclient(method):
+    url = f'monetdb://localhost:{MAPIPORT}/{TSTDB}?compression_method={method}&compression_level=3'
+    cmd = ['mclient', '-d', url, '-fcsv']
+    return subprocess.run(cmd, input=query, stdout=subprocess.PIPE,
+                          check=True, encoding='utf-8').stdout
+
+# the server lists the methods it offers in its challenge
+conn = connect('auto_commit=1')
+offered = [f for f in conn.challenge.split(':') if f.startswith('COMPRESSION=')]
+assert len(offered) == 1, f'Found {conn.challenge!r}'
+offered = [m for m in offered[0][12:].split(',') if m]
+conn.disconnect()
+
+# every method, and one the server does not offer, which mclient
+# negotiates down to no compression
+for method in ['none'] + offered + ['nosuchmethod']:
+    fields = run_mclient(method).rstrip('\n').split(',')
+    assert len(fields) == 3, f'{method}: found {len(fields)} fields'
+    assert fields[0] == str(len(literal)), f'{method}: found {fields[0]!r}'
+    assert fields[1] == literal, f'{method}: large literal got mangled'
+    assert fields[2] == '0123456789' * 300000, f'{method}: large result got mangled'
+
+# a client asking for a method which is not offered can still log in,
+# the session then does without compression
+conn = connect('auto_commit=1,compression=nosuchmethod,compression_level=3')
+res = conn.cmd('sselect 42;')
+assert '42' in res, f'Found {res!r}'
+conn.disconnect()
@@ -0,0 +1,27 @@
+import os
+import subprocess
+
+TSTDB = os.environ['TSTDB']
+MAPIPORT = os.environ['MAPIPORT']
+
+# mclient negotiates blocks of up to 1 MiB, i.e. well beyond the 8 KiB
+# blocks with their two byte count.  Both the query and its result span
+# several of those large blocks.
+literal = ''.join(chr(ord('a') + i % 26) for i in range(3 * 1024 * 1024 // 2))
+query = f"SELECT length('{literal}'), '{literal}', repeat('0123456789', 300000);\n"
+
+def run_mclient(query):
+    cmd = ['mclient', '-d', f'monetdb://localhost:{MAPIPORT}/{TSTDB}', '-fcsv']
+    return subprocess.run(cmd, input=query, stdout=subprocess.PIPE,
+                          check=True, encoding='utf-8').stdout
+
+out = run_mclient(query).rstrip('\n')
+fields = out.split(',')
+
+assert len(fields) == 3, f'Found {len(fields)} fields'
+
+assert fields[0] == str(len(literal)), f'Found {fields[0]!r}'
+
+assert fields[1] == literal, 'Large literal got mangled'
+
+assert fields[2] == '0123456789' * 300000, 'Large result got mangled'
@@ -0,0 +1,3 @@
+@echo off
+
+sample5.exe %HOST% %MAPIPORT% sql
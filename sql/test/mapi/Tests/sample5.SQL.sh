@@ -0,0 +1,3 @@
+#!/bin/sh
+
+sample5 $HOST $MAPIPORT sql
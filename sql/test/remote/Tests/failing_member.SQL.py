@@ -0,0 +1,80 @@
+import os, sys, tempfile, time, pymonetdb
+
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# A merge table over several remote members of which one fails.  The
+# other members have been started by then and their results are never
+# collected, their connections must still be closed when the query
+# fails.
+
+with tempfile.TemporaryDirectory() as farm_dir:
+    for name in ('node1', 'node2', 'super'):
+        os.mkdir(os.path.join(farm_dir, name))
+
+    with process.server(mapiport='0', dbname='node1',
+                        dbfarm=os.path.join(farm_dir, 'node1'),
+                        stdin=process.PIPE, stdout=process.PIPE,
+                        stderr=process.PIPE) as node1_proc, \
+         process.server(mapiport='0', dbname='node2',
+                        dbfarm=os.path.join(farm_dir, 'node2'),
+                        stdin=process.PIPE, stdout=process.PIPE,
+                        stderr=process.PIPE) as node2_proc, \
+         process.server(args=['--set', 'gdk_nr_threads=2'],
+                        mapiport='0', dbname='super',
+                        dbfarm=os.path.join(farm_dir, 'super'),
+                        stdin=process.PIPE, stdout=process.PIPE,
+                        stderr=process.PIPE) as super_proc:
+        node1_conn = pymonetdb.connect(database='node1', port=node1_proc.dbport, autocommit=True)
+        node1_cur = node1_conn.cursor()
+        node2_conn = pymonetdb.connect(database='node2', port=node2_proc.dbport, autocommit=True)
+        node2_cur = node2_conn.cursor()
+        super_conn = pymonetdb.connect(database='super', port=super_proc.dbport, autocommit=True)
+        super_cur = super_conn.cursor()
+
+        # the member on node2 fails with a division by zero
+        node2_cur.execute("create table bad (v int)")
+        node2_cur.execute("insert into bad values (0)")
+        super_cur.execute("create merge table mt (v int)")
+        super_cur.execute("create remote table bad (v int) on 'mapi:monetdb://localhost:{}/node2'".format(node2_proc.dbport))
+        super_cur.execute("alter table mt add table bad")
+        for i in range(6):
+            node1_cur.execute("create table p{} (v int)".format(i))
+            node1_cur.execute("insert into p{} select value from generate_series(1, 10001)".format(i))
+            super_cur.execute("create remote table p{} (v int) on 'mapi:monetdb://localhost:{}/node1'".format(i, node1_proc.dbport))
+            super_cur.execute("alter table mt add table p{}".format(i))
+
+        for i in range(5):
+            try:
+                super_cur.execute("select sum(10 / v) from mt")
+                sys.stderr.write("Exception expected")
+            except pymonetdb.DatabaseError as e:
+                pass
+
+        # the supervisor closes the connections of the started members,
+        # after which node1 only has our own session
+        for i in range(50):
+            node1_cur.execute("select count(*) from sys.sessions")
+            sessions = node1_cur.fetchall()
+            if sessions == [(1,)]:
+                break
+            time.sleep(0.1)
+        if sessions != [(1,)]:
+            sys.stderr.write("Just our own session expected on node1, found {}".format(sessions))
+
+        # the healthy members still work
+        super_cur.execute("select count(*) from mt where v > 0")
+        if super_cur.fetchall() != [(60000,)]:
+            sys.stderr.write("Just row (60000,) expected")
+
+        node1_cur.close()
+        node1_conn.close()
+        node2_cur.close()
+        node2_conn.close()
+        super_cur.close()
+        super_conn.close()
+        node1_proc.communicate()
+        node2_proc.communicate()
+        super_proc.communicate()
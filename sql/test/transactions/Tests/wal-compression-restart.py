@@ -0,0 +1,38 @@
+import os, sys, tempfile, pymonetdb
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# bulk appends are written to the WAL in compressed form, check that
+# they are recovered after the server was killed before a checkpoint
+with tempfile.TemporaryDirectory() as farm_dir:
+    os.mkdir(os.path.join(farm_dir, 'db1'))
+    with process.server(args=['--set', 'wal_compression=gz'],
+                        mapiport='0', dbname='db1',
+                        dbfarm=os.path.join(farm_dir, 'db1'),
+                        stdin=process.PIPE,
+                        stdout=process.PIPE, stderr=process.PIPE) as s:
+        cli = pymonetdb.connect(port=s.dbport,database='db1',autocommit=True)
+        cur = cli.cursor()
+        cur.execute("CREATE TABLE foo(i INT, s VARCHAR(20), b BOOLEAN);")
+        cur.execute("INSERT INTO foo SELECT value, 'v' || (value % 1000), value % 3 = 0 FROM generate_series(0, 100000);")
+        cur.execute("INSERT INTO foo VALUES (-1, 'small', NULL);")
+        cur.close()
+        cli.close()
+        s.kill()
+        s.communicate()
+    with process.server(args=['--set', 'wal_compression=gz'],
+                        mapiport='0', dbname='db1',
+                        dbfarm=os.path.join(farm_dir, 'db1'),
+                        stdin=process.PIPE,
+                        stdout=process.PIPE, stderr=process.PIPE) as s:
+        cli = pymonetdb.connect(port=s.dbport,database='db1',autocommit=True)
+        cur = cli.cursor()
+        cur.execute("SELECT count(*), sum(i), count(DISTINCT s), count(b), sum(CASE WHEN b THEN 1 ELSE 0 END) FROM foo;")
+        res = cur.fetchall()
+        if res != [(100001, 4999949999, 1001, 100000, 33334)]:
+            sys.stderr.write(f'Expected [(100001, 4999949999, 1001, 100000, 33334)], got {res}\n')
+        cur.close()
+        cli.close()
+        s.communicate()
@@ -51,3 +51,11 @@ def function_with_more_than_one_result_bat(tab):
     for key,val in histo.items():
         nhisto.append((key, str(val)))
     return sorted(nhisto)
+
+# Returns the remarks in the MAL plan, without the optimizer trace
+def comments(tab):
+    res = []
+    for row in tab:
+        if row[0].startswith('#') and row[0].find('usec') < 0:
+            res.append(row)
+    return res
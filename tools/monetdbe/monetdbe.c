@@ -93,6 +93,10 @@ typedef struct {
 	Client c;
 	char *msg;
 	int registered_thread;	/* 1 = registered in monetdbe_open, 2 = done by GDK (also deregister done there) */
+	MT_Sema claim;		/* held by the call using the client */
+	MT_Lock timer;		/* the query timer and timeout, also set by monetdbe_query_cancel */
+	ATOMIC_PTR_TYPE pending; /* submitted query which was not awaited yet */
+	ATOMIC_TYPE interrupt;	/* the pending query was cancelled */
 	monetdbe_data_blob blob_null;
 	monetdbe_data_date date_null;
 	monetdbe_data_time time_null;
@@ -108,6 +112,16 @@ typedef struct {
 	monetdbe_database_internal *mdbe;
 } monetdbe_result_internal;
 
+typedef struct {
+	monetdbe_database_internal *mdbe;
+	char *query;
+	MT_Id tid;
+	ATOMIC_TYPE done;
+	monetdbe_result *result;
+	monetdbe_cnt affected_rows;
+	lng querytimeout;	/* of the client, restored when awaited */
+} monetdbe_async_internal;
+
 typedef struct {
 	monetdbe_statement res;
 	ValRecord *data;
@@ -130,6 +144,7 @@ static date date_from_data(monetdbe_data_date *ptr);
 static daytime time_from_data(monetdbe_data_time *ptr);
 
 static char* monetdbe_cleanup_result_internal(monetdbe_database_internal *mdbe, monetdbe_result_internal* res);
+static char* monetdbe_result_fetch_internal(monetdbe_result* mres, monetdbe_column** res, size_t column_index);
 
 static int
 date_is_null(monetdbe_data_date *value)
@@ -194,6 +209,64 @@ set_error( monetdbe_database_internal *mdbe, char *err)
 	return mdbe->msg;
 }
 
+/* Calls on a connection are bracketed by monetdbe_enter and
+ * monetdbe_leave.  These make the calling thread known to GDK, as it
+ * need not be the thread that opened the connection, and give it the
+ * exclusive use of the connection's client.  A submitted query owns
+ * the client until it is awaited.  It is recorded as pending under the
+ * semaphore, other calls are refused meanwhile as the thread that
+ * submitted it would wait for its own query. */
+static char monetdbe_busy[] = "MAL:monetdbe.monetdbe_enter:A submitted query on this connection was not awaited";
+
+/* the client is served by the calling thread from now on */
+static void
+monetdbe_set_thread(monetdbe_database_internal *mdbe)
+{
+	if (mdbe->c == NULL)
+		return;
+	MT_thread_set_qry_ctx(&mdbe->c->qryctx);
+	if (mdbe->c->sqlcontext)
+		mvc_set_stack(((backend *) mdbe->c->sqlcontext)->mvc);
+}
+
+static char*
+monetdbe_enter(monetdbe_database_internal *mdbe, bool *registered)
+{
+	*registered = MT_thread_register();
+	MT_sema_down(&mdbe->claim);
+	if (ATOMIC_PTR_GET(&mdbe->pending) != NULL) {
+		MT_sema_up(&mdbe->claim);
+		if (*registered)
+			MT_thread_deregister();
+		return monetdbe_busy;
+	}
+	ATOMIC_SET(&mdbe->interrupt, 0);
+	monetdbe_set_thread(mdbe);
+	return MAL_SUCCEED;
+}
+
+static void
+monetdbe_leave(monetdbe_database_internal *mdbe, bool registered)
+{
+	MT_sema_up(&mdbe->claim);
+	if (registered)
+		MT_thread_deregister();
+}
+
+/* start the query timer, a cancelled query stops right away */
+static void
+monetdbe_start_query(monetdbe_database_internal *mdbe)
+{
+	Client c = mdbe->c;
+
+	MT_lock_set(&mdbe->timer);
+	c->qryctx.starttime = GDKusec();
+	c->qryctx.endtime = c->querytimeout ? c->qryctx.starttime + c->querytimeout : 0;
+	if (ATOMIC_GET(&mdbe->interrupt))
+		c->qryctx.endtime = QRY_INTERRUPT;
+	MT_lock_unset(&mdbe->timer);
+}
+
 static char*
 commit_action(mvc* m, monetdbe_database_internal *mdbe, monetdbe_result **result, monetdbe_result_internal *res_internal)
 {
@@ -395,6 +468,7 @@ monetdbe_query_internal(monetdbe_database_internal *mdbe, char* query, monetdbe_
 	}
 
 	assert(language);
+	monetdbe_start_query(mdbe);
 	b->language = language;
 	b->output_format = OFMT_NONE;
 	b->no_mitosis = 0;
@@ -484,6 +558,9 @@ monetdbe_close_internal(monetdbe_database_internal *mdbe)
 			freeException(msg);
 		MCcloseClient(mdbe->c);
 	}
+	MT_sema_destroy(&mdbe->claim);
+	MT_lock_destroy(&mdbe->timer);
+	ATOMIC_PTR_DESTROY(&mdbe->pending);
 	GDKfree(mdbe);
 	return 0;
 }
@@ -566,8 +643,8 @@ monetdbe_open_internal(monetdbe_database_internal *mdbe, monetdbe_options *opts
 	mdbe->c->curmodule = mdbe->c->usermodule = userModule();
 	mdbe->c->workerlimit = monetdbe_workers_internal(mdbe, opts);
 	mdbe->c->memorylimit = monetdbe_memory_internal(mdbe, opts);
-	mdbe->c->querytimeout = monetdbe_querytimeout_internal(mdbe, opts);
-	mdbe->c->sessiontimeout = monetdbe_sessiontimeout_internal(mdbe, opts);
+	mdbe->c->querytimeout = monetdbe_querytimeout_internal(mdbe, opts) * LL_CONSTANT(1000000);	// from sec to usec
+	mdbe->c->sessiontimeout = monetdbe_sessiontimeout_internal(mdbe, opts) * LL_CONSTANT(1000000);
 	if (mdbe->msg)
 		goto cleanup;
 	if (mdbe->c->usermodule == NULL) {
@@ -879,8 +956,7 @@ monetdbe_open_remote(monetdbe_database_internal *mdbe, monetdbe_options *opts) {
 		return -2;
 	}
 	stk->keepAlive = TRUE;
-	c->qryctx.starttime = GDKusec();
-	c->qryctx.endtime = c->querytimeout ? c->qryctx.starttime + c->querytimeout : 0;
+	monetdbe_start_query(mdbe);
 	if ( (mdbe->msg = runMALsequence(c, mb, 1, 0, stk, 0, 0)) != MAL_SUCCEED ) {
 		freeStack(stk);
 		freeSymbol(c->curprg);
@@ -925,6 +1001,10 @@ monetdbe_open(monetdbe_database *dbhdl, char *url, monetdbe_options *opts)
 	*dbhdl = (monetdbe_database)mdbe;
 	mdbe->msg = NULL;
 	mdbe->c = NULL;
+	MT_sema_init(&mdbe->claim, 1, "monetdbe");
+	MT_lock_init(&mdbe->timer, "monetdbe_timer");
+	ATOMIC_PTR_INIT(&mdbe->pending, NULL);
+	ATOMIC_INIT(&mdbe->interrupt, 0);
 
 	bool is_remote = (opts && (opts->remote != NULL));
 	if (!monetdbe_embedded_initialized) {
@@ -960,9 +1040,17 @@ monetdbe_close(monetdbe_database dbhdl)
 
 	int err = 0;
 	int registered_thread = mdbe->registered_thread;
+	monetdbe_query_handle pending;
 
-	if (mdbe->c)
-		MT_thread_set_qry_ctx(&mdbe->c->qryctx);
+	/* a query still running on the connection is stopped first */
+	MT_sema_down(&mdbe->claim);
+	if ((pending = ATOMIC_PTR_GET(&mdbe->pending)) != NULL) {
+		MT_sema_up(&mdbe->claim);
+		monetdbe_query_cancel(pending);
+		(void) monetdbe_query_await(pending, NULL, NULL);
+		MT_sema_down(&mdbe->claim);
+	}
+	monetdbe_set_thread(mdbe);
 	MT_lock_set(&embedded_lock);
 	if (mdbe->mid)
 		err = monetdbe_close_remote(mdbe);
@@ -1081,14 +1169,9 @@ monetdbe_get_autocommit(monetdbe_database dbhdl, int* result)
 	return mdbe->msg;
 }
 
-char*
-monetdbe_set_autocommit(monetdbe_database dbhdl, int value)
+static char*
+monetdbe_set_autocommit_internal(monetdbe_database_internal *mdbe, int value)
 {
-	if (!dbhdl)
-		return NULL;
-
-	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
-
 	if (!validate_database_handle_noerror(mdbe)) {
 
 		return NULL;
@@ -1110,6 +1193,23 @@ monetdbe_set_autocommit(monetdbe_database dbhdl, int value)
 	return mdbe->msg;
 }
 
+char*
+monetdbe_set_autocommit(monetdbe_database dbhdl, int value)
+{
+	if (!dbhdl)
+		return NULL;
+
+	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
+	bool registered;
+	char *msg;
+
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
+	msg = monetdbe_set_autocommit_internal(mdbe, value);
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
 int
 monetdbe_in_transaction(monetdbe_database dbhdl)
 {
@@ -1589,8 +1689,12 @@ monetdbe_query(monetdbe_database dbhdl, char* query, monetdbe_result** result, m
 		return NULL;
 	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
 
+	bool registered;
+	char *msg;
+
 	assert(mdbe->c);
-	MT_thread_set_qry_ctx(&mdbe->c->qryctx);
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
 	if (mdbe->mid) {
 		mdbe->msg = monetdbe_query_remote(mdbe, query, result, affected_rows, NULL);
 	}
@@ -1598,7 +1702,128 @@ monetdbe_query(monetdbe_database dbhdl, char* query, monetdbe_result** result, m
 		mdbe->msg = monetdbe_query_internal(mdbe, query, result, affected_rows, NULL, 'S');
 	}
 
-	return mdbe->msg;
+	msg = mdbe->msg;
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
+static void
+monetdbe_query_worker(void *arg)
+{
+	monetdbe_async_internal *qh = arg;
+	monetdbe_database_internal *mdbe = qh->mdbe;
+
+	monetdbe_set_thread(mdbe);
+	if (mdbe->mid)
+		mdbe->msg = monetdbe_query_remote(mdbe, qh->query, &qh->result, &qh->affected_rows, NULL);
+	else
+		mdbe->msg = monetdbe_query_internal(mdbe, qh->query, &qh->result, &qh->affected_rows, NULL, 'S');
+	MT_thread_set_qry_ctx(NULL);
+	ATOMIC_SET(&qh->done, 1);
+}
+
+char*
+monetdbe_query_submit(monetdbe_database dbhdl, char* query, monetdbe_query_handle *handle)
+{
+	if (!dbhdl)
+		return NULL;
+	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
+	monetdbe_async_internal *qh;
+
+	bool registered;
+	char *msg;
+
+	assert(mdbe->c);
+	if (!handle)
+		return createException(MAL, "monetdbe.monetdbe_query_submit", "Parameter handle is NULL");
+	*handle = NULL;
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
+	clear_error(mdbe);
+	if ((qh = GDKzalloc(sizeof(monetdbe_async_internal))) == NULL ||
+		(qh->query = GDKstrdup(query)) == NULL) {
+		GDKfree(qh);
+		set_error(mdbe, createException(MAL, "monetdbe.monetdbe_query_submit", MAL_MALLOC_FAIL));
+	} else {
+		qh->mdbe = mdbe;
+		qh->affected_rows = -1;
+		qh->querytimeout = mdbe->c->querytimeout;
+		ATOMIC_INIT(&qh->done, 0);
+		ATOMIC_PTR_SET(&mdbe->pending, qh);
+		if (MT_create_thread(&qh->tid, monetdbe_query_worker, qh, MT_THR_JOINABLE, "monetdbe_query") < 0) {
+			ATOMIC_PTR_SET(&mdbe->pending, NULL);
+			GDKfree(qh->query);
+			GDKfree(qh);
+			set_error(mdbe, createException(MAL, "monetdbe.monetdbe_query_submit", "Cannot start the query thread"));
+		} else {
+			/* the client belongs to the query until it is awaited */
+			*handle = qh;
+			MT_thread_set_qry_ctx(NULL);
+			monetdbe_leave(mdbe, registered);
+			return MAL_SUCCEED;
+		}
+	}
+	msg = mdbe->msg;
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
+int
+monetdbe_query_poll(monetdbe_query_handle handle)
+{
+	monetdbe_async_internal *qh = handle;
+
+	return qh ? (int) ATOMIC_GET(&qh->done) : 1;
+}
+
+char*
+monetdbe_query_await(monetdbe_query_handle handle, monetdbe_result** result, monetdbe_cnt* affected_rows)
+{
+	monetdbe_async_internal *qh = handle;
+
+	if (!qh)
+		return NULL;
+	monetdbe_database_internal *mdbe = qh->mdbe;
+	bool registered = MT_thread_register();
+	char *msg;
+
+	MT_join_thread(qh->tid);
+	MT_sema_down(&mdbe->claim);
+	monetdbe_set_thread(mdbe);
+	if (result)
+		*result = qh->result;
+	else if (qh->result)
+		set_error(mdbe, monetdbe_cleanup_result_internal(mdbe, (monetdbe_result_internal*) qh->result));
+	if (affected_rows && qh->affected_rows >= 0)
+		*affected_rows = qh->affected_rows;
+	msg = mdbe->msg;
+	MT_lock_set(&mdbe->timer);
+	mdbe->c->querytimeout = qh->querytimeout;
+	MT_lock_unset(&mdbe->timer);
+	ATOMIC_PTR_SET(&mdbe->pending, NULL);
+	GDKfree(qh->query);
+	GDKfree(qh);
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
+void
+monetdbe_query_cancel(monetdbe_query_handle handle)
+{
+	monetdbe_async_internal *qh = handle;
+
+	if (!qh)
+		return;
+	/* the interpreter checks for this between instructions, as it
+	 * does for a query timeout.  A statement which did not get that far
+	 * times out right away, as its timer is still to be started. */
+	MT_lock_set(&qh->mdbe->timer);
+	ATOMIC_SET(&qh->mdbe->interrupt, 1);
+	if (!ATOMIC_GET(&qh->done)) {
+		qh->mdbe->c->querytimeout = 1;
+		qh->mdbe->c->qryctx.endtime = QRY_INTERRUPT;
+	}
+	MT_lock_unset(&qh->mdbe->timer);
 }
 
 char*
@@ -1609,9 +1834,12 @@ monetdbe_prepare(monetdbe_database dbhdl, char* query, monetdbe_statement **stmt
 	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
 
 	int prepare_id = 0;
+	bool registered;
+	char *msg;
 
 	assert(mdbe->c);
-	MT_thread_set_qry_ctx(&mdbe->c->qryctx);
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
 	if (!stmt) {
 		set_error(mdbe, createException(MAL, "monetdbe.monetdbe_prepare", "Parameter stmt is NULL"));
 		assert(mdbe->msg != MAL_SUCCEED); /* help Coverity */
@@ -1663,7 +1891,9 @@ monetdbe_prepare(monetdbe_database dbhdl, char* query, monetdbe_statement **stmt
 		}
 	}
 
-	return mdbe->msg;
+	msg = mdbe->msg;
+	monetdbe_leave(mdbe, registered);
+	return msg;
 }
 
 char*
@@ -1728,11 +1958,10 @@ monetdbe_bind(monetdbe_statement *stmt, void *data, size_t i)
 	return MAL_SUCCEED;
 }
 
-char*
-monetdbe_execute(monetdbe_statement *stmt, monetdbe_result **result, monetdbe_cnt *affected_rows)
+static char*
+monetdbe_execute_internal(monetdbe_stmt_internal *stmt_internal, monetdbe_result **result, monetdbe_cnt *affected_rows)
 {
 	monetdbe_result_internal *res_internal = NULL;
-	monetdbe_stmt_internal *stmt_internal = (monetdbe_stmt_internal*)stmt;
 	backend *b = (backend *) stmt_internal->mdbe->c->sqlcontext;
 	mvc *m = b->mvc;
 	monetdbe_database_internal *mdbe = stmt_internal->mdbe;
@@ -1741,7 +1970,6 @@ monetdbe_execute(monetdbe_statement *stmt, monetdbe_result **result, monetdbe_cn
 	Symbol s = NULL;
 
 	assert(mdbe->c);
-	MT_thread_set_qry_ctx(&mdbe->c->qryctx);
 	if ((mdbe->msg = SQLtrans(m)) != MAL_SUCCEED)
 		return mdbe->msg;
 
@@ -1754,6 +1982,7 @@ monetdbe_execute(monetdbe_statement *stmt, monetdbe_result **result, monetdbe_cn
 	}
 
 	s = findSymbolInModule(mdbe->c->usermodule, q->f->imp);
+	monetdbe_start_query(mdbe);
 	if ((mdbe->msg = callMAL(mdbe->c, s->def, &glb, stmt_internal->args)) != MAL_SUCCEED)
 		goto cleanup;
 
@@ -1779,6 +2008,21 @@ cleanup:
 	return commit_action(m, stmt_internal->mdbe, result, res_internal);
 }
 
+char*
+monetdbe_execute(monetdbe_statement *stmt, monetdbe_result **result, monetdbe_cnt *affected_rows)
+{
+	monetdbe_stmt_internal *stmt_internal = (monetdbe_stmt_internal*)stmt;
+	monetdbe_database_internal *mdbe = stmt_internal->mdbe;
+	bool registered;
+	char *msg;
+
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
+	msg = monetdbe_execute_internal(stmt_internal, result, affected_rows);
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
 char*
 monetdbe_cleanup_statement(monetdbe_database dbhdl, monetdbe_statement *stmt)
 {
@@ -1786,11 +2030,14 @@ monetdbe_cleanup_statement(monetdbe_database dbhdl, monetdbe_statement *stmt)
 	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
 	mvc *m = ((backend *) mdbe->c->sqlcontext)->mvc;
 	cq *q = stmt_internal->q;
+	bool registered;
+	char *msg;
 
 	assert(!stmt_internal->mdbe || mdbe == stmt_internal->mdbe);
 
 	assert(mdbe->c);
-	MT_thread_set_qry_ctx(&mdbe->c->qryctx);
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
 	for (size_t i = 0; i < stmt_internal->res.nparam + 1; i++) {
 		ValPtr data = &stmt_internal->data[i];
 		VALclear(data);
@@ -1803,6 +2050,7 @@ monetdbe_cleanup_statement(monetdbe_database dbhdl, monetdbe_statement *stmt)
 
 	if (q)
 		qc_delete(m->qc, q);
+	monetdbe_leave(mdbe, registered);
 	return MAL_SUCCEED;
 }
 
@@ -1811,16 +2059,21 @@ monetdbe_cleanup_result(monetdbe_database dbhdl, monetdbe_result* result)
 {
 	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
 	monetdbe_result_internal* res = (monetdbe_result_internal *) result;
+	bool registered;
+	char *msg;
 
 	assert(mdbe->c);
-	MT_thread_set_qry_ctx(&mdbe->c->qryctx);
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
 	if (!result) {
 		set_error(mdbe, createException(MAL, "monetdbe.monetdbe_cleanup_result", "Parameter result is NULL"));
 	} else {
 		mdbe->msg = monetdbe_cleanup_result_internal(mdbe, res);
 	}
 
-	return mdbe->msg;
+	msg = mdbe->msg;
+	monetdbe_leave(mdbe, registered);
+	return msg;
 }
 
 static inline void
@@ -1900,7 +2153,7 @@ monetdbe_get_columns_remote(monetdbe_database_internal *mdbe, const char* schema
 	if (!mdbe->msg)
 		for (size_t c = 0; c < result->ncols; c++) {
 			monetdbe_column* rcol;
-			if ((mdbe->msg = monetdbe_result_fetch(result, &rcol, c)) != NULL) {
+			if ((mdbe->msg = monetdbe_result_fetch_internal(result, &rcol, c)) != NULL) {
 				break;
 			}
 
@@ -1934,8 +2187,8 @@ monetdbe_get_columns_remote(monetdbe_database_internal *mdbe, const char* schema
 	return mdbe->msg;
 }
 
-char*
-monetdbe_get_columns(monetdbe_database dbhdl, const char* schema_name, const char *table_name, size_t *column_count, monetdbe_column **columns)
+static char*
+monetdbe_get_columns_internal(monetdbe_database dbhdl, const char* schema_name, const char *table_name, size_t *column_count, monetdbe_column **columns)
 {
 	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
 	mvc *m = NULL;
@@ -1991,6 +2244,20 @@ cleanup:
 	return mdbe->msg;
 }
 
+char*
+monetdbe_get_columns(monetdbe_database dbhdl, const char* schema_name, const char *table_name, size_t *column_count, monetdbe_column **columns)
+{
+	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
+	bool registered;
+	char *msg;
+
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
+	msg = monetdbe_get_columns_internal(dbhdl, schema_name, table_name, column_count, columns);
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
 #define GENERATE_BASE_HEADERS(type, tpename) \
 	static int tpename##_is_null(type *value)
 
@@ -1999,7 +2266,9 @@ cleanup:
 	static int tpename##_is_null(tpe *value) { return *value == mname##_nil; }
 
 #ifdef bool
+/* the macros below paste bool into names, it stays usable as a type */
 #undef bool
+typedef _Bool bool;
 #endif
 
 GENERATE_BASE_FUNCTIONS(int8_t, bool, bit)
@@ -2191,8 +2460,8 @@ cleanup:
 	return msg;
 }
 
-char*
-monetdbe_append(monetdbe_database dbhdl, const char *schema, const char *table, monetdbe_column **input, size_t column_count)
+static char*
+monetdbe_append_internal(monetdbe_database dbhdl, const char *schema, const char *table, monetdbe_column **input, size_t column_count)
 {
 	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
 	mvc *m = NULL;
@@ -2633,6 +2902,20 @@ cleanup:
 	return mdbe->msg;
 }
 
+char*
+monetdbe_append(monetdbe_database dbhdl, const char *schema, const char *table, monetdbe_column **input, size_t column_count)
+{
+	monetdbe_database_internal *mdbe = (monetdbe_database_internal*)dbhdl;
+	bool registered;
+	char *msg;
+
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
+	msg = monetdbe_append_internal(dbhdl, schema, table, input, column_count);
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
 const void *
 monetdbe_null(monetdbe_database dbhdl, monetdbe_types t)
 {
@@ -2663,8 +2946,8 @@ monetdbe_null(monetdbe_database dbhdl, monetdbe_types t)
 	return NULL;
 }
 
-char*
-monetdbe_result_fetch(monetdbe_result* mres, monetdbe_column** res, size_t column_index)
+static char*
+monetdbe_result_fetch_internal(monetdbe_result* mres, monetdbe_column** res, size_t column_index)
 {
 	BAT* b = NULL;
 	int bat_type;
@@ -2897,6 +3180,20 @@ cleanup:
 	return mdbe->msg;
 }
 
+char*
+monetdbe_result_fetch(monetdbe_result* mres, monetdbe_column** res, size_t column_index)
+{
+	monetdbe_database_internal *mdbe = ((monetdbe_result_internal*) mres)->mdbe;
+	bool registered;
+	char *msg;
+
+	if ((msg = monetdbe_enter(mdbe, &registered)) != MAL_SUCCEED)
+		return msg;
+	msg = monetdbe_result_fetch_internal(mres, res, column_index);
+	monetdbe_leave(mdbe, registered);
+	return msg;
+}
+
 static void
 data_from_date(date d, monetdbe_data_date *ptr)
 {
@@ -96,6 +96,7 @@ typedef struct {
 } monetdbe_result;
 
 typedef void* monetdbe_database;
+typedef void* monetdbe_query_handle;
 
 typedef struct {
 	const char *host;
@@ -173,6 +174,14 @@ monetdbe_export char* monetdbe_query(monetdbe_database dbhdl, char* query, monet
 monetdbe_export char* monetdbe_result_fetch(monetdbe_result *mres, monetdbe_column** res, size_t column_index);
 monetdbe_export char* monetdbe_cleanup_result(monetdbe_database dbhdl, monetdbe_result* result);
 
+/* Run a query in the background.  The connection is in use until the
+ * query is awaited, which returns its result and frees the handle;
+ * other calls on the connection fail meanwhile. */
+monetdbe_export char* monetdbe_query_submit(monetdbe_database dbhdl, char* query, monetdbe_query_handle *handle);
+monetdbe_export int   monetdbe_query_poll(monetdbe_query_handle handle);
+monetdbe_export char* monetdbe_query_await(monetdbe_query_handle handle, monetdbe_result** result, monetdbe_cnt* affected_rows);
+monetdbe_export void  monetdbe_query_cancel(monetdbe_query_handle handle);
+
 monetdbe_export char* monetdbe_prepare(monetdbe_database dbhdl, char *query, monetdbe_statement **stmt, monetdbe_result** result);
 monetdbe_export char* monetdbe_bind(monetdbe_statement *stmt, void *data, size_t parameter_nr);
 monetdbe_export char* monetdbe_execute(monetdbe_statement *stmt, monetdbe_result **result, monetdbe_cnt* affected_rows);